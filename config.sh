@@ -50,6 +50,10 @@ if __name__ == '__main__':
             help='A directory to search for branch direction predictors')
     search_group.add_argument('--btb-dir', action='append', default=[], metavar='DIR',
             help='A directory to search for branch target predictors')
+    search_group.add_argument('--memory-dependence-dir', action='append', default=[], metavar='DIR',
+            help='A directory to search for memory dependence predictors')
+    search_group.add_argument('--value-predictor-dir', action='append', default=[], metavar='DIR',
+            help='A directory to search for value predictors')
     search_group.add_argument('--prefetcher-dir', action='append', default=[], metavar='DIR',
             help='A directory to search for prefetchers')
     search_group.add_argument('--replacement-dir', action='append', default=[], metavar='DIR',
@@ -88,6 +92,8 @@ if __name__ == '__main__':
         'module_dir': args.module_dir,
         'branch_dir': args.branch_dir,
         'btb_dir': args.btb_dir,
+        'memory_dependence_dir': args.memory_dependence_dir,
+        'value_dir': args.value_predictor_dir,
         'pref_dir': args.prefetcher_dir,
         'repl_dir': args.replacement_dir,
         'compile_all_modules': args.compile_all_modules,
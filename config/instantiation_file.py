@@ -42,8 +42,16 @@ core_builder_parts = {
     'execute_width': '.execute_width(champsim::bandwidth::maximum_type{{{execute_width}}})',
     'lq_width': '.lq_width(champsim::bandwidth::maximum_type{{{lq_width}}})',
     'sq_width': '.sq_width(champsim::bandwidth::maximum_type{{{sq_width}}})',
+    'store_buffer_size': '.store_buffer_size({store_buffer_size})',
+    'store_buffer_width': '.store_buffer_width(champsim::bandwidth::maximum_type{{{store_buffer_width}}})',
+    'wrong_path_depth': '.wrong_path_depth({wrong_path_depth})',
+    'ftq_size': '.ftq_size({ftq_size})',
+    'threads': '.threads({threads})',
+    'fetch_policy': '.fetch_policy(champsim::thread_fetch_policy::{fetch_policy})',
     'retire_width': '.retire_width(champsim::bandwidth::maximum_type{{{retire_width}}})',
     'mispredict_penalty': '.mispredict_penalty({mispredict_penalty})',
+    'violation_penalty': '.violation_penalty({violation_penalty})',
+    'replay_penalty': '.replay_penalty({replay_penalty})',
     'decode_latency': '.decode_latency({decode_latency})',
     'dispatch_latency': '.dispatch_latency({dispatch_latency})',
     'schedule_latency': '.schedule_latency({schedule_latency})',
@@ -55,6 +63,8 @@ core_builder_parts = {
     'L1D': ['.l1d_bandwidth({^l1d_ptr}.MAX_TAG)', '.data_queues(&{^data_queues})'],
     '_branch_predictor_data': '.branch_predictor<{^branch_predictor_string}>()',
     '_btb_data': '.btb<{^btb_string}>()',
+    '_memory_dependence_predictor_data': '.memory_dependence_predictor<{^memory_dependence_predictor_string}>()',
+    '_value_predictor_data': '.value_predictor<{^value_predictor_string}>()',
     '_index': '.index({_index})',
     'frequency': '.clock_period(champsim::chrono::picoseconds{{{^clock_period}}})'
 }
@@ -72,6 +82,8 @@ cache_builder_parts = {
     'log2_sets': '.log2_sets({log2_sets})',
     'ways': '.ways({ways})',
     'log2_ways': '.log2_ways({log2_ways})',
+    'sampled_sets': '.sampled_sets({sampled_sets})',
+    'sectors': '.sectors({sectors})',
     'pq_size': '.pq_size({pq_size})',
     'mshr_size': '.mshr_size({mshr_size})',
     'latency': '.latency({latency})',
@@ -79,6 +91,14 @@ cache_builder_parts = {
     'fill_latency': '.fill_latency({fill_latency})',
     'max_tag_check': '.tag_bandwidth(champsim::bandwidth::maximum_type{{{max_tag_check}}})',
     'max_fill': '.fill_bandwidth(champsim::bandwidth::maximum_type{{{max_fill}}})',
+    'banks': '.banks({banks})',
+    'max_bank_tag_check': '.bank_bandwidth(champsim::bandwidth::maximum_type{{{max_bank_tag_check}}})',
+    'bank_busy': '.bank_busy({bank_busy})',
+    'bank_hash': '.bank_hash(champsim::cache_bank_hash::{bank_hash})',
+    'inclusion': '.inclusion(champsim::cache_inclusion::{inclusion})',
+    'partition_interval': '.partition_interval({partition_interval})',
+    'umon_sets': '.umon_sets({umon_sets})',
+    'victim_buffer': '.victim_buffer({victim_buffer})',
     '_offset_bits': '.offset_bits(champsim::data::bits{{{_offset_bits}}})',
     'prefetch_activate': '.prefetch_activate({^prefetch_activate_string})',
     '_replacement_data': '.replacement<{^replacement_string}>()',
@@ -98,6 +118,8 @@ ptw_builder_parts = {
     'frequency': '.clock_period(champsim::chrono::picoseconds{{{^clock_period}}})'
 }
 
+slice_fmtstr = '"{name}", champsim::chrono::picoseconds{{{^clock_period}}}, {^upper_levels_string}, {^slice_levels_string}, {slice_latency}, champsim::slice_hash::{slice_hash}, champsim::data::bits{{{_offset_bits}}}'
+
 def vector_string(iterable):
     ''' Produce a string that avoids a warning on clang under -Wbraced-scalar-init if there is only one member '''
     hoisted = list(iterable)
@@ -112,12 +134,15 @@ def get_cpu_builder(cpu, caches, ul_pairs):
     required_parts = [
     ]
 
+    # The caches are built with emplace_front(), so they are held in reverse order
     def cache_index(name):
-        return next(filter(lambda x: x[1]['name'] == name, enumerate(caches)))[0]
+        return len(caches) - 1 - next(filter(lambda x: x[1]['name'] == name, enumerate(caches)))[0]
 
     local_params = {
         '^branch_predictor_string': ', '.join(f'class {k["class"]}' for k in cpu.get('_branch_predictor_data',[])),
         '^btb_string': ', '.join(f'class {k["class"]}' for k in cpu.get('_btb_data',[])),
+        '^memory_dependence_predictor_string': ', '.join(f'class {k["class"]}' for k in cpu.get('_memory_dependence_predictor_data',[])),
+        '^value_predictor_string': ', '.join(f'class {k["class"]}' for k in cpu.get('_value_predictor_data',[])),
         '^fetch_queues': f'channels.at({ul_pairs.index((cpu.get("L1I"), cpu.get("name")))})',
         '^data_queues': f'channels.at({ul_pairs.index((cpu.get("L1D"), cpu.get("name")))})',
         '^l1i_ptr': f'(*std::next(std::begin(caches), {cache_index(cpu.get("L1I"))}))',
@@ -126,11 +151,31 @@ def get_cpu_builder(cpu, caches, ul_pairs):
     if 'frequency' in cpu:
         local_params['^clock_period'] = int(1000000/cpu['frequency'])
 
+    local_core_builder_parts = {
+        ('wrong_path_loads', True): '.set_wrong_path_loads()',
+        ('wrong_path_loads', False): '.reset_wrong_path_loads()',
+        ('partitioned_queues', True): '.set_partitioned_queues()',
+        ('partitioned_queues', False): '.reset_partitioned_queues()'
+    }
+
+    # Braces are doubled, since the parts are formatted below
+    execution_port_parts = ('.add_execution_port({{{{{}}}}})'.format(', '.join(f'OP_{c}' for c in port)) for port in cpu.get('execution_ports', []))
+    functional_unit_parts = itertools.chain(*(
+        itertools.chain(
+            (f'.op_latency(OP_{op}, {unit["latency"]})',) if 'latency' in unit else tuple(),
+            (f'.unpipelined_op(OP_{op})',) if not unit.get('pipelined', True) else tuple()
+        )
+        for op, unit in cpu.get('functional_units', {}).items()
+    ))
+
     builder_parts = itertools.chain(util.multiline(itertools.chain(
         ('champsim::core_builder{{ champsim::defaults::default_core }}',),
         required_parts,
         *(util.wrap_list(v) for k,v in core_builder_parts.items() if k in cpu),
-        (v for k,v in dib_builder_parts.items() if k in cpu.get('DIB',{}))
+        (v for k,v in local_core_builder_parts.items() if k[0] in cpu and k[1] == cpu[k[0]]),
+        (v for k,v in dib_builder_parts.items() if k in cpu.get('DIB',{})),
+        execution_port_parts,
+        functional_unit_parts
     ), indent=1, line_end=''))
     yield from (part.format(**cpu, **local_params) for part in builder_parts)
 
@@ -149,7 +194,13 @@ def get_cache_builder(elem, ul_pairs):
         ('wq_check_full_addr', True): '.set_wq_checks_full_addr()',
         ('wq_check_full_addr', False): '.reset_wq_checks_full_addr()',
         ('virtual_prefetch', True): '.set_virtual_prefetch()',
-        ('virtual_prefetch', False): '.reset_virtual_prefetch()'
+        ('virtual_prefetch', False): '.reset_virtual_prefetch()',
+        ('directory', True): '.set_coherence_directory()',
+        ('directory', False): '.reset_coherence_directory()',
+        ('_clean_writebacks', True): '.set_clean_writebacks()',
+        ('_eviction_notices', True): '.set_eviction_notices()',
+        ('way_partitioning', True): '.set_way_partitioning()',
+        ('way_partitioning', False): '.reset_way_partitioning()'
     }
 
     uppers = (v for v in ul_pairs if v[0] == elem.get('name'))
@@ -226,14 +277,17 @@ def get_ref_vector_function(rtype, func_name, basename):
     yield from cxx.function(func_name, wrapped, rtype=wrapped_rtype)
     yield ''
 
-def get_builder_function_call(class_name, builders):
+def get_builder_function_call(class_name, builders, static_dispatch=False):
     '''
     Generate a call to a function that consumes builders.
 
     :param class_name: The name of the C++ class to build.
     :param builders: A sequence of builders to pass as parameters.
+    :param static_dispatch: Whether the built elements call their modules directly, rather than through the module concepts.
     '''
     yield f'build<{class_name}>('
+    if static_dispatch:
+        yield '  champsim::modules::static_dispatch,'
 
     builder_head, builder_tail = util.cut(builders, n=-1)
     for b in builder_head:
@@ -246,6 +300,67 @@ def get_builder_function_call(class_name, builders):
 
     yield ')'
 
+def slice_name(cache, index):
+    ''' The name of the given slice of a sliced cache '''
+    return f'{cache["name"]}_slice{index}'
+
+def divide_sets(cache, slices):
+    '''
+    Divide the sizing of a sliced cache evenly among the slices.
+    Sizes given as powers of two are converted to absolute sizes.
+    '''
+    sizings = {
+        'sets': lambda c: c['sets'],
+        'log2_sets': lambda c: 2**c['log2_sets'],
+        'size': lambda c: c['size'],
+        'log2_size': lambda c: 2**c['log2_size']
+    }
+    retval = {k:v for k,v in cache.items() if k not in sizings}
+    for k,sizing in sizings.items():
+        if k in cache:
+            retval[k.replace('log2_', '')] = max(sizing(cache) // slices, 1)
+    return retval
+
+def expand_slices(caches):
+    '''
+    Split each cache with more than one slice into a series of independent caches, and a router that connects them to the upper levels.
+
+    The sets (or size) of the cache are divided among the slices. Every other parameter applies to each slice individually.
+
+    :param caches: the caches in the system
+    :returns: a tuple of the resulting caches and the routers
+    '''
+    sliced = [c for c in caches if c.get('slices', 1) > 1]
+    sliced_names = [c['name'] for c in sliced]
+
+    def make_slices(cache):
+        base = divide_sets({k:v for k,v in cache.items() if k not in ('slices', 'slice_hash', 'slice_latency')}, cache['slices'])
+        return ({**base, 'name': slice_name(cache, i)} for i in range(cache['slices']))
+
+    routers = [util.chain(cache, { 'slice_hash': 'xor_fold', 'slice_latency': 0 }) for cache in sliced]
+    caches = [*itertools.chain(
+        (c for c in caches if c['name'] not in sliced_names),
+        *map(make_slices, sliced)
+    )]
+    return caches, routers
+
+def get_slice_pairs(routers, ul_pairs):
+    ''' Get a sequence of (slice_name, upper_name) for each combination of slice and upper level of the given routers. '''
+    return [(slice_name(r, i), upper) for r in routers for _,upper in filter(lambda v: v[0] == r['name'], ul_pairs) for i in range(r['slices'])]
+
+def get_slice_router(router, ul_pairs, global_clock_period):
+    '''
+    Generate the constructor arguments for a champsim::slice_router
+    '''
+    uppers = [v for v in ul_pairs if v[0] == router['name']]
+    slice_levels = (', '.join(f'&channels.at({ul_pairs.index((slice_name(router, i), u))})' for i in range(router['slices'])) for _,u in uppers)
+    local_params = {
+        '^clock_period': int(1000000/router['frequency']) if 'frequency' in router else global_clock_period,
+        '^upper_levels_string': '{'+', '.join(f'&channels.at({ul_pairs.index(v)})' for v in uppers)+'}',
+        '^slice_levels_string': '{'+', '.join(f'std::vector<champsim::channel*>{{{s}}}' for s in slice_levels)+'}'
+    }
+    return f'champsim::slice_router{{{slice_fmtstr.format(**router, **local_params)}}}'
+
 def cache_queue_defaults(cache):
     return {
         'rq_size': cache.get('rq_size', cache['_queue_factor']),
@@ -295,9 +410,10 @@ def module_include_files(datas):
 
     yield from (f'#include "{f}"' for _,f in candidates)
 
-def decorate_queues(caches, ptws, pmem):
+def decorate_queues(caches, ptws, pmem, routers=tuple()):
     return util.chain(
             *({c['name']: cache_queue_defaults(c)} for c in caches),
+            *({r['name']: cache_queue_defaults(r)} for r in routers),
             *({p['name']: ptw_queue_defaults(p)} for p in ptws),
             {pmem['name']: {
                     'rq_size':'std::numeric_limits<std::size_t>::max()',
@@ -312,17 +428,23 @@ def decorate_queues(caches, ptws, pmem):
 def get_queue_info(ul_pairs, decoration):
     return [decoration.get(ll) for ll,_ in ul_pairs]
 
-def get_instantiation_lines(cores, caches, ptws, pmem, vmem, build_id):
+def get_instantiation_lines(cores, caches, ptws, pmem, vmem, build_id, static_dispatch=False):
     '''
     Generate the lines for a C++ file that instantiates a configuration.
+
+    :param static_dispatch: Whether the caches and cores are compiled for their modules, so that the module hooks are called directly.
     '''
     classname = f'champsim::configured::generated_environment<0x{build_id}>'
+    caches, routers = expand_slices(caches)
     ul_pairs = get_upper_levels(cores, caches, ptws)
-    queues = get_queue_info(ul_pairs, decorate_queues(caches, ptws, pmem))
+    ul_pairs = ul_pairs + get_slice_pairs(routers, ul_pairs)
+    queues = get_queue_info(ul_pairs, decorate_queues(caches, ptws, pmem, routers))
 
     datas = itertools.filterfalse(operator.methodcaller('get', 'legacy', False), itertools.chain(
         *(c['_branch_predictor_data'] for c in cores),
         *(c['_btb_data'] for c in cores),
+        *(c.get('_memory_dependence_predictor_data', []) for c in cores),
+        *(c.get('_value_predictor_data', []) for c in cores),
         *(c['_prefetcher_data'] for c in caches),
         *(c['_replacement_data'] for c in caches)
     ))
@@ -370,14 +492,20 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem, build_id):
 
     cache_instantiation_body = (
         'caches {',
-        *get_builder_function_call('CACHE', map(functools.partial(get_cache_builder, ul_pairs=ul_pairs), caches)),
+        *get_builder_function_call('CACHE', map(functools.partial(get_cache_builder, ul_pairs=ul_pairs), caches), static_dispatch=static_dispatch),
         '},'
     )
 
+    router_instantiation_body = (
+        'routers {',
+        *('  '+r+',' for r in map(functools.partial(get_slice_router, ul_pairs=ul_pairs, global_clock_period=global_clock_period), routers)),
+        '},'
+    ) if routers else tuple()
+
     core_instantiation_body = (
         'cores {',
         *get_builder_function_call('O3_CPU',
-                                   map(functools.partial(get_cpu_builder, caches=caches, ul_pairs=ul_pairs), cores)),
+                                   map(functools.partial(get_cpu_builder, caches=caches, ul_pairs=ul_pairs), cores), static_dispatch=static_dispatch),
         '}'
     )
 
@@ -389,6 +517,7 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem, build_id):
     yield from vmem_instantiation_body
     yield from ptw_instantiation_body
     yield from cache_instantiation_body
+    yield from router_instantiation_body
     yield from core_instantiation_body
     yield '{'
     yield '}'
@@ -409,6 +538,7 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem, build_id):
         'std::transform(std::begin(cores), std::end(cores), std::back_inserter(retval), make_ref);',
         'std::transform(std::begin(caches), std::end(caches), std::back_inserter(retval), make_ref);',
         'std::transform(std::begin(ptws), std::end(ptws), std::back_inserter(retval), make_ref);',
+        'std::transform(std::begin(routers), std::end(routers), std::back_inserter(retval), make_ref);',
         'retval.push_back(std::ref<champsim::operable>(DRAM));',
         'return retval;'
     ), rtype='std::vector<std::reference_wrapper<champsim::operable>>')
@@ -419,6 +549,7 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem, build_id):
 
 def get_instantiation_header(num_cpus, env, build_id):
     yield '#include "environment.h"'
+    yield '#include "slice_router.h"'
     yield '#include "vmem.h"'
     yield '#include <forward_list>'
     yield 'template <>'
@@ -429,6 +560,7 @@ def get_instantiation_header(num_cpus, env, build_id):
         'VirtualMemory vmem;',
         'std::forward_list<PageTableWalker> ptws;',
         'std::forward_list<CACHE> caches;',
+        'std::forward_list<champsim::slice_router> routers;',
         'std::forward_list<O3_CPU> cores;',
 
         'public:',
@@ -233,12 +233,19 @@ class NormalizedConfiguration:
             (
                 'frequency', 'ifetch_buffer_size', 'decode_buffer_size', 'dispatch_buffer_size', 'register_file_size', 'rob_size', 'lq_size',
                 'sq_size', 'fetch_width', 'decode_width', 'dispatch_width', 'execute_width', 'lq_width', 'sq_width',
-                'retire_width', 'mispredict_penalty', 'scheduler_size', 'decode_latency', 'dispatch_latency',
-                'schedule_latency', 'execute_latency', 'branch_predictor', 'btb', 'DIB'
+                'store_buffer_size', 'store_buffer_width', 'wrong_path_depth', 'wrong_path_loads', 'ftq_size', 'threads', 'fetch_policy',
+                'partitioned_queues', 'retire_width',
+                'mispredict_penalty', 'scheduler_size', 'decode_latency', 'dispatch_latency', 'schedule_latency', 'execute_latency', 'branch_predictor',
+                'btb', 'memory_dependence_predictor', 'violation_penalty', 'value_predictor', 'replay_penalty', 'DIB', 'execution_ports', 'functional_units'
             )
         )
         self.cores = [util.chain(cpu, core_from_config, {'name': f'cpu{i}'}) for i,cpu in enumerate(self.cores)]
 
+        # Both the wrong path and the fetch target queue follow a single predicted path
+        for cpu in self.cores:
+            if cpu.get('threads', 1) not in (0, 1) and (cpu.get('wrong_path_depth', 0) != 0 or cpu.get('ftq_size', 0) != 0):
+                raise ValueError(f'{cpu["name"]}: a core with more than one thread may not have a wrong_path_depth or an ftq_size')
+
         if verbose:
             print('P: core count', len(self.cores))
 
@@ -293,7 +300,7 @@ class NormalizedConfiguration:
             print('P: vmem', list(self.vmem.keys()))
 
         self.root = util.subdict(config_file,
-            ('block_size', 'page_size', 'heartbeat_frequency')
+            ('block_size', 'page_size', 'heartbeat_frequency', 'static_module_dispatch')
         )
 
     def merge(self, rhs):
@@ -305,7 +312,7 @@ class NormalizedConfiguration:
         self.vmem = util.chain(self.vmem, rhs.vmem)
         self.root = util.chain(self.root, rhs.root)
 
-    def apply_defaults_in(self, branch_context, btb_context, prefetcher_context, replacement_context, verbose=False):
+    def apply_defaults_in(self, branch_context, btb_context, prefetcher_context, replacement_context, memory_dependence_context, value_context, verbose=False): # pylint: disable=line-too-long,
         ''' Apply defaults and produce a result suitible for writing the generated files. '''
         if verbose:
             print('D: keys in root', list(self.root.keys()))
@@ -359,6 +366,8 @@ class NormalizedConfiguration:
 
         branch_parse = functools.partial(module_parse, context=branch_context)
         btb_parse = functools.partial(module_parse, context=btb_context)
+        memory_dependence_parse = functools.partial(module_parse, context=memory_dependence_context)
+        value_parse = functools.partial(module_parse, context=value_context)
         replacement_parse = functools.partial(module_parse, context=replacement_context)
         def prefetcher_parse(mod_name, cache):
             return {
@@ -402,6 +411,14 @@ class NormalizedConfiguration:
                 # Mark queues that need to match full addresses on collision
                '_queue_check_full_addr': cache.get('_first_level', False) or cache.get('wq_check_full_addr', False),
 
+                # The victims of the upper levels are the only source of blocks for an exclusive cache
+               **({'_clean_writebacks': True} if caches.get(cache.get('lower_level'), {}).get('inclusion') == 'exclusive' else {}),
+
+                # A directory is told of the blocks that leave a core, by the caches above it that are the last in the core to hold them
+               **({'_eviction_notices': True} if caches.get(cache.get('lower_level'), {}).get('directory', False) and (
+                   cache.get('inclusion', 'non_inclusive') != 'non_inclusive' or not any(c.get('lower_level') == k for c in caches.values())
+               ) else {}),
+
                 # Get module path names and unique module names
                '_replacement_data': list(map(replacement_parse, util.wrap_list(cache.get('replacement', 'lru')))),
                '_prefetcher_data': [*map(functools.partial(prefetcher_parse, cache=cache), util.wrap_list(cache.get('prefetcher', 'no')))]
@@ -424,7 +441,13 @@ class NormalizedConfiguration:
                 '_branch_predictor_data':
                     [*map(branch_parse, util.wrap_list(c.get('branch_predictor', 'hashed_perceptron')))],
                 '_btb_data':
-                    [*map(btb_parse, util.wrap_list(c.get('btb', 'basic_btb')))]
+                    [*map(btb_parse, util.wrap_list(c.get('btb', 'basic_btb')))],
+                # Without a memory dependence predictor, loads wait for exactly the stores they read from
+                '_memory_dependence_predictor_data':
+                    [*map(memory_dependence_parse, util.wrap_list(c.get('memory_dependence_predictor', [])))],
+                # Without a value predictor, the consumers of each load wait for it to complete
+                '_value_predictor_data':
+                    [*map(value_parse, util.wrap_list(c.get('value_predictor', [])))]
              } for c in cores),
             ).values()
         )
@@ -440,17 +463,19 @@ class NormalizedConfiguration:
             'repl': util.combine_named(*(c['_replacement_data'] for c in caches.values()), replacement_context.find_all()),
             'pref': util.combine_named(*(c['_prefetcher_data'] for c in caches.values()), prefetcher_context.find_all()),
             'branch': util.combine_named(*(c['_branch_predictor_data'] for c in cores), branch_context.find_all()),
-            'btb': util.combine_named(*(c['_btb_data'] for c in cores), btb_context.find_all())
+            'btb': util.combine_named(*(c['_btb_data'] for c in cores), btb_context.find_all()),
+            'memory_dependence': util.combine_named(*(c['_memory_dependence_predictor_data'] for c in cores), memory_dependence_context.find_all()),
+            'value': util.combine_named(*(c['_value_predictor_data'] for c in cores), value_context.find_all())
         }
 
         config_extern = {
-            **util.subdict(root_config, ('block_size', 'page_size', 'heartbeat_frequency')),
+            **util.subdict(root_config, ('block_size', 'page_size', 'heartbeat_frequency', 'static_module_dispatch')),
             'num_cores': len(cores)
         }
 
         return elements, module_info, config_extern
 
-def parse_config(*configs, module_dir=None, branch_dir=None, btb_dir=None, pref_dir=None, repl_dir=None, compile_all_modules=False, verbose=False): # pylint: disable=line-too-long,
+def parse_config(*configs, module_dir=None, branch_dir=None, btb_dir=None, pref_dir=None, repl_dir=None, memory_dependence_dir=None, value_dir=None, compile_all_modules=False, verbose=False): # pylint: disable=line-too-long,
     '''
     This is the main parsing dispatch function. Programmatic use of the configuration system should use this as an entry point.
 
@@ -460,6 +485,8 @@ def parse_config(*configs, module_dir=None, branch_dir=None, btb_dir=None, pref_
     :param btb_dir: A directory to search for branch target predictors
     :param pref_dir: A directory to search for prefetchers
     :param repl_dir: A directory to search for replacement policies
+    :param memory_dependence_dir: A directory to search for memory dependence predictors
+    :param value_dir: A directory to search for value predictors
     :param compile_all_modules: If true, all modules in the given directories will be compiled. If false, only the module in the configuration will be compiled.
     :param verbose: Print extra verbose output
     '''
@@ -479,7 +506,9 @@ def parse_config(*configs, module_dir=None, branch_dir=None, btb_dir=None, pref_
         branch_context = modules.ModuleSearchContext(list_dirs('branch', branch_dir or []), verbose=verbose),
         btb_context = modules.ModuleSearchContext(list_dirs('btb', btb_dir or []), verbose=verbose),
         replacement_context = modules.ModuleSearchContext(list_dirs('replacement', repl_dir or []), verbose=verbose),
-        prefetcher_context = modules.ModuleSearchContext(list_dirs('prefetcher', pref_dir or []), verbose=verbose)
+        prefetcher_context = modules.ModuleSearchContext(list_dirs('prefetcher', pref_dir or []), verbose=verbose),
+        memory_dependence_context = modules.ModuleSearchContext(list_dirs('memory_dependence', memory_dependence_dir or []), verbose=verbose),
+        value_context = modules.ModuleSearchContext(list_dirs('value_predictor', value_dir or []), verbose=verbose)
     )
     if verbose:
         for k,v in contexts.items():
@@ -493,7 +522,9 @@ def parse_config(*configs, module_dir=None, branch_dir=None, btb_dir=None, pref_
             *(c['_replacement_data'] for c in elements['caches']),
             *(c['_prefetcher_data'] for c in elements['caches']),
             *(c['_branch_predictor_data'] for c in elements['cores']),
-            *(c['_btb_data'] for c in elements['cores'])
+            *(c['_btb_data'] for c in elements['cores']),
+            *(c['_memory_dependence_predictor_data'] for c in elements['cores']),
+            *(c['_value_predictor_data'] for c in elements['cores'])
         ))]
 
     return executable_name(*configs), elements, modules_to_compile, module_info, config_file
@@ -18,6 +18,7 @@
 #define BLOCK_H
 
 #include "champsim.h"
+#include "coherence.h"
 
 namespace champsim
 {
@@ -26,11 +27,18 @@ struct cache_block {
   bool prefetch = false;
   bool dirty = false;
 
+  // Per-sector state, used when a tag covers more than one sector
+  uint64_t valid_sectors = 0;
+  uint64_t dirty_sectors = 0;
+
+  champsim::coherence_state coherence = champsim::coherence_state::invalid;
+
   champsim::address address{};
   champsim::address v_address{};
   champsim::address data{};
 
   uint32_t pf_metadata = 0;
+  uint32_t cpu = 0; // The CPU whose request filled the block
 };
 } // namespace champsim
 
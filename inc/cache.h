@@ -22,13 +22,16 @@
 #undef CHAMPSIM_MODULE
 #endif
 
+#include <algorithm>
 #include <array>
 #include <cstddef> // for size_t
 #include <cstdint> // for uint64_t, uint32_t, uint8_t
 #include <deque>
+#include <functional>
 #include <iterator> // for size
 #include <limits>   // for numeric_limits
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
@@ -45,7 +48,9 @@
 #include "modules.h"
 #include "operable.h"
 #include "util/to_underlying.h" // for to_underlying
+#include "victim_buffer.h"
 #include "waitable.h"
+#include "way_partitioner.h"
 
 class CACHE : public champsim::operable
 {
@@ -72,6 +77,10 @@ class CACHE : public champsim::operable
     bool skip_fill;
     bool is_translated;
     bool translate_issued = false;
+    bool clean_writeback = false;
+    bool is_writeback = false;
+    bool evicted = false;
+    bool set_only = false; // The lookup is made by a worker of a parallel warmup, and may touch nothing outside of its set
 
     uint8_t asid[2] = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
 
@@ -79,6 +88,7 @@ class CACHE : public champsim::operable
 
     std::vector<uint64_t> instr_depend_on_me{};
     std::vector<std::deque<response_type>*> to_return{};
+    channel_type* upper_level = nullptr;
 
     explicit tag_lookup_type(request_type req) : tag_lookup_type(req, false, false) {}
     tag_lookup_type(const request_type& req, bool local_pref, bool skip);
@@ -94,12 +104,14 @@ public:
     struct returned_value {
       champsim::address data;
       uint32_t pf_metadata;
+      champsim::coherence_state state = champsim::coherence_state::exclusive;
     };
     champsim::waitable<returned_value> data_promise{};
     uint32_t cpu;
 
     access_type type;
     bool prefetch_from_this;
+    bool clean_writeback;
 
     uint8_t asid[2] = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
 
@@ -113,10 +125,20 @@ public:
   };
 
 private:
+  // The hot path is a template over the types that the module hooks are called through, and is defined in cache_dispatch.h
+  template <typename P, typename R>
+  long operate_with();
+  template <typename P, typename R>
   bool try_hit(const tag_lookup_type& handle_pkt);
+  template <typename P>
+  bool try_oracle_hit(const tag_lookup_type& handle_pkt);
+  [[nodiscard]] bool writes_through(const tag_lookup_type& handle_pkt) const;
+  [[nodiscard]] request_type write_through_packet(const tag_lookup_type& handle_pkt) const;
+  template <typename P, typename R>
   bool handle_fill(const mshr_type& fill_mshr);
   bool handle_miss(const tag_lookup_type& handle_pkt);
   bool handle_write(const tag_lookup_type& handle_pkt);
+  bool handle_probe(const typename channel_type::probe_type& probe);
   void finish_packet(const response_type& packet);
   void finish_translation(const response_type& packet);
 
@@ -126,12 +148,50 @@ public:
   using BLOCK = champsim::cache_block;
 
 private:
-  static BLOCK fill_block(mshr_type mshr, uint32_t metadata);
+  static BLOCK fill_block(mshr_type mshr, uint32_t metadata, uint64_t sector_mask);
   using set_type = std::vector<BLOCK>;
 
   std::pair<set_type::iterator, set_type::iterator> get_set_span(champsim::address address);
   [[nodiscard]] std::pair<set_type::const_iterator, set_type::const_iterator> get_set_span(champsim::address address) const;
-  [[nodiscard]] long get_set_index(champsim::address address) const;
+  [[nodiscard]] champsim::data::bits get_tag_offset_bits() const;
+  [[nodiscard]] uint64_t get_sector_mask(champsim::address address) const;
+  [[nodiscard]] long get_bank_index(champsim::address address) const;
+  [[nodiscard]] bool bank_available(champsim::address address) const;
+  void reserve_bank(champsim::address address);
+  bool writeback_sectors(BLOCK& victim, uint32_t triggering_cpu, uint64_t instr_id, bool evicted);
+  bool writeback_block(BLOCK& victim, uint32_t triggering_cpu, uint64_t instr_id, bool evicted);
+  void back_invalidate(const BLOCK& victim, uint32_t triggering_cpu);
+
+  enum class fill_kind { bypass, upgrade, sector, block };
+  struct placed_fill {
+    fill_kind kind;
+    set_type::iterator way; // The way that holds the fill, or the end of the set if it bypassed this level
+    uint32_t pf_metadata;
+    BLOCK evicted{}; // The block that left this level, if it is valid
+  };
+  using writeback_function = std::function<bool(BLOCK&, bool)>;
+
+  /**
+   * Place a fill into its set, for both the timed fill and the functional lookup.
+   * A fill into a tag that is present fills the sector, or upgrades the permission. Otherwise a victim is chosen, the block that leaves this level
+   * is written back, and the fill is installed. The prefetcher, the replacement policy, the victim buffer, and the partitioner are all updated.
+   *
+   * :param allocate: Whether the fill may be held by this level
+   * :param set_only: Whether the fill is made by a worker of a parallel warmup, which may not update the statistics of the cache
+   * :param writeback: Writes a block back to the lower level, and whether the block was evicted. It may refuse, in which case the fill must be retried.
+   * :return: Where the fill was placed, or nothing if a writeback was refused
+   */
+  template <typename P, typename R>
+  std::optional<placed_fill> place_fill(const mshr_type& fill_mshr, bool allocate, bool set_only, const writeback_function& writeback);
+  [[nodiscard]] static bool needs_write_permission(const BLOCK& way, access_type type);
+  void update_directory(const tag_lookup_type& handle_pkt);
+  void send_directory_probes(champsim::address address, uint32_t triggering_cpu, champsim::probe_type type, uint64_t targets);
+  void monitor_utility(const tag_lookup_type& handle_pkt);
+  template <typename R>
+  set_type::iterator swap_victim(const tag_lookup_type& handle_pkt, set_type::iterator set_begin, set_type::iterator set_end);
+  void functional_lookup(const tag_lookup_type& handle_pkt, std::vector<request_type>& to_lower);
+  [[nodiscard]] champsim::coherence_state get_granted_state(champsim::address address, const BLOCK* way) const;
+  void record_sample(access_type type, long set, bool hit);
 
   template <typename T>
   bool should_activate_prefetcher(const T& pkt) const;
@@ -143,12 +203,29 @@ private:
   champsim::address module_address(const T& element) const;
 
   auto matches_address(champsim::address address) const;
+  auto matches_tag(champsim::address address) const;
   std::pair<mshr_type, request_type> mshr_and_forward_packet(const tag_lookup_type& handle_pkt);
 
   std::deque<tag_lookup_type> internal_PQ{};
   std::deque<tag_lookup_type> inflight_tag_check{};
   std::deque<tag_lookup_type> translation_stash{};
 
+  // Outcomes in the sampled sets, which are kept across phases to guide the oracle for the other sets
+  struct set_sample_type {
+    uint64_t accesses = 0;
+    uint64_t misses = 0;
+    double miss_credit = 0;
+  };
+  std::array<set_sample_type, champsim::to_underlying(access_type::NUM_TYPES)> set_samples{};
+
+  // Occupancy of each bank of the tag array
+  struct tag_bank_type {
+    champsim::chrono::clock::time_point last_lookup = champsim::chrono::clock::time_point::max();
+    champsim::chrono::clock::time_point busy_until{};
+    long lookups = 0;
+  };
+  std::vector<tag_bank_type> tag_banks;
+
 public:
   std::vector<channel_type*> upper_levels;
   channel_type* lower_level;
@@ -157,17 +234,46 @@ public:
   uint32_t cpu = 0;
   std::string NAME;
   uint32_t NUM_SET, NUM_WAY, MSHR_SIZE;
+  uint32_t NUM_SAMPLED_SET;
+  uint32_t NUM_SECTOR;
   std::size_t PQ_SIZE;
   champsim::chrono::clock::duration HIT_LATENCY;
   champsim::chrono::clock::duration FILL_LATENCY;
   champsim::data::bits OFFSET_BITS;
   set_type block{static_cast<typename set_type::size_type>(NUM_SET * NUM_WAY)};
   champsim::bandwidth::maximum_type MAX_TAG, MAX_FILL;
+  uint32_t NUM_BANK;
+  champsim::bandwidth::maximum_type MAX_BANK_TAG;
+  champsim::chrono::clock::duration BANK_BUSY;
+  champsim::cache_bank_hash BANK_HASH;
+  champsim::cache_inclusion INCLUSION;
   bool prefetch_as_load;
   bool match_offset_bits;
   bool virtual_prefetch;
+  bool has_directory;
+  bool clean_writebacks;
+  bool eviction_notices;
   std::vector<access_type> pref_activate_mask;
 
+private:
+  // The sharers of each block, as masks over the upper levels in their original order (upper_levels is rotated as it is served).
+  // Each set of the directory tracks as many blocks as a set of the cache, in the order that they were last requested.
+  struct directory_entry_type {
+    champsim::block_number block{};
+    uint64_t sharers = 0;
+    uint64_t invalidated = 0;
+    bool exclusive = false;
+  };
+  std::vector<channel_type*> directory_ports;
+  std::vector<std::vector<directory_entry_type>> directory;
+
+  // The division of the ways among the CPUs, if the cache is partitioned
+  std::optional<champsim::way_partitioner> partitioner;
+
+  // The blocks most recently evicted from the sets, if the cache has a victim buffer
+  std::optional<champsim::victim_buffer> victims;
+
+public:
   using stats_type = cache_stats;
 
   stats_type sim_stats, roi_stats;
@@ -206,6 +312,14 @@ public:
   [[nodiscard]] std::vector<std::size_t> get_pq_size() const;
   [[nodiscard]] std::vector<double> get_pq_occupancy_ratio() const;
 
+  /**
+   * Check whether a set is fully modeled. The other sets hold no blocks, and their accesses hit or miss at the miss ratio of the sampled sets.
+   * A dirty writeback to one of these sets is passed through to the lower level whether it hits or misses, so that the traffic below this cache
+   * does not depend on the outcomes of the oracle. The writeback waits at its tag check until the write queue of the lower level has room.
+   */
+  [[nodiscard]] bool is_sampled_set(long set) const;
+  [[nodiscard]] long get_set_index(champsim::address address) const;
+
   [[deprecated("Use get_set_index() instead.")]] [[nodiscard]] uint64_t get_set(uint64_t address) const;
   [[deprecated("This function should not be used to access the blocks directly.")]] [[nodiscard]] uint64_t get_way(uint64_t address, uint64_t set) const;
 
@@ -214,6 +328,30 @@ public:
 
   [[deprecated]] bool prefetch_line(uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata);
 
+  /**
+   * Look up a request in the tag array without any timing, for a functional warmup.
+   * The prefetcher and the replacement policy are trained as they would be by a timed access, and a miss is filled at once.
+   *
+   * :param req: The request, as it would arrive from an upper level
+   * :param translate: Gives the physical address for a CPU and a virtual address, for the request and any prefetches that are not translated
+   * :return: The requests that this cache sends to its lower level, which are the misses, the writebacks, and the prefetches that do not fill this level
+   */
+  std::vector<request_type> functional_access(request_type req, const std::function<champsim::address(uint32_t, champsim::address)>& translate);
+
+  /**
+   * Look up a translated request as in functional_access(), touching nothing outside of the set of the request, so that lookups in different sets may be
+   * made from different threads at once. This requires that the cache is set-local. No statistics are kept.
+   *
+   * :return: The requests that this cache sends to its lower level
+   */
+  std::vector<request_type> functional_access_in_set(const request_type& req);
+
+  /**
+   * Check whether the sets of this cache are independent of one another, which requires that its modules are set-local and that it has no victim buffer,
+   * way partitioning, directory, or oracle for sets that are not sampled.
+   */
+  [[nodiscard]] bool is_set_local() const;
+
   [[deprecated("Use CACHE::prefetch_line(pf_addr, fill_this_level, prefetch_metadata) instead.")]] bool
   prefetch_line(uint64_t ip, uint64_t base_addr, uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata);
 
@@ -234,6 +372,7 @@ public:
     virtual void impl_prefetcher_cycle_operate() = 0;
     virtual void impl_prefetcher_final_stats() = 0;
     virtual void impl_prefetcher_branch_operate(champsim::address ip, uint8_t branch_type, champsim::address branch_target) = 0;
+    [[nodiscard]] virtual bool impl_is_set_local() const = 0;
   };
 
   struct replacement_module_concept {
@@ -248,7 +387,10 @@ public:
                                                champsim::address victim_addr, access_type type, bool hit) = 0;
     virtual void impl_replacement_cache_fill(uint32_t triggering_cpu, long set, long way, champsim::address full_addr, champsim::address ip,
                                              champsim::address victim_addr, access_type type) = 0;
+    virtual void impl_replacement_sector_fill(uint32_t triggering_cpu, long set, long way, champsim::address full_addr, champsim::address ip,
+                                              access_type type) = 0;
     virtual void impl_replacement_final_stats() = 0;
+    [[nodiscard]] virtual bool impl_is_set_local() const = 0;
   };
 
   template <typename... Ps>
@@ -268,6 +410,7 @@ public:
     void impl_prefetcher_cycle_operate() final;
     void impl_prefetcher_final_stats() final;
     void impl_prefetcher_branch_operate(champsim::address ip, uint8_t branch_type, champsim::address branch_target) final;
+    [[nodiscard]] bool impl_is_set_local() const final;
   };
 
   template <typename... Rs>
@@ -289,12 +432,30 @@ public:
                                        champsim::address victim_addr, access_type type, bool hit) final;
     void impl_replacement_cache_fill(uint32_t triggering_cpu, long set, long way, champsim::address full_addr, champsim::address ip,
                                      champsim::address victim_addr, access_type type) final;
+    void impl_replacement_sector_fill(uint32_t triggering_cpu, long set, long way, champsim::address full_addr, champsim::address ip,
+                                      access_type type) final;
     void impl_replacement_final_stats() final;
+    [[nodiscard]] bool impl_is_set_local() const final;
   };
 
   std::unique_ptr<prefetcher_module_concept> pref_module_pimpl;
   std::unique_ptr<replacement_module_concept> repl_module_pimpl;
 
+  // The modules, seen as the concepts or as the models that they were built as. A call through a model is direct, since the models are final.
+  template <typename P>
+  [[nodiscard]] P& pref_module() const
+  {
+    return static_cast<P&>(*pref_module_pimpl);
+  }
+  template <typename R>
+  [[nodiscard]] R& repl_module() const
+  {
+    return static_cast<R&>(*repl_module_pimpl);
+  }
+
+  // The cycle of this cache, which calls the modules through their concepts unless the cache was built with static dispatch
+  long (CACHE::*bound_operate)() = &CACHE::operate_with<prefetcher_module_concept, replacement_module_concept>;
+
   // NOLINTBEGIN(readability-make-member-function-const): legacy modules use non-const hooks
   void impl_prefetcher_initialize() const;
   [[nodiscard]] uint32_t impl_prefetcher_cache_operate(champsim::address addr, champsim::address ip, bool cache_hit, bool useful_prefetch, access_type type,
@@ -312,19 +473,40 @@ public:
                                      champsim::address victim_addr, access_type type, bool hit) const;
   void impl_replacement_cache_fill(uint32_t triggering_cpu, long set, long way, champsim::address full_addr, champsim::address ip,
                                    champsim::address victim_addr, access_type type) const;
+  void impl_replacement_sector_fill(uint32_t triggering_cpu, long set, long way, champsim::address full_addr, champsim::address ip, access_type type) const;
   void impl_replacement_final_stats() const;
   // NOLINTEND(readability-make-member-function-const)
 
   template <typename... Ps, typename... Rs>
   explicit CACHE(champsim::cache_builder<champsim::cache_builder_module_type_holder<Ps...>, champsim::cache_builder_module_type_holder<Rs...>> b)
-      : champsim::operable(b.m_clock_period), upper_levels(b.m_uls), lower_level(b.m_ll), lower_translate(b.m_lt), NAME(b.m_name), NUM_SET(b.get_num_sets()),
-        NUM_WAY(b.get_num_ways()), MSHR_SIZE(b.get_num_mshrs()), PQ_SIZE(b.m_pq_size), HIT_LATENCY(b.get_hit_latency() * b.m_clock_period),
+      : champsim::operable(b.m_clock_period), tag_banks(b.get_num_banks()), upper_levels(b.m_uls), lower_level(b.m_ll), lower_translate(b.m_lt),
+        NAME(b.m_name), NUM_SET(b.get_num_sets()), NUM_WAY(b.get_num_ways()), MSHR_SIZE(b.get_num_mshrs()), NUM_SAMPLED_SET(b.get_num_sampled_sets()),
+        NUM_SECTOR(b.get_num_sectors()), PQ_SIZE(b.m_pq_size), HIT_LATENCY(b.get_hit_latency() * b.m_clock_period),
         FILL_LATENCY(b.get_fill_latency() * b.m_clock_period), OFFSET_BITS(b.m_offset_bits), MAX_TAG(b.get_tag_bandwidth()), MAX_FILL(b.get_fill_bandwidth()),
-        prefetch_as_load(b.m_pref_load), match_offset_bits(b.m_wq_full_addr), virtual_prefetch(b.m_va_pref), pref_activate_mask(b.m_pref_act_mask),
+        NUM_BANK(b.get_num_banks()), MAX_BANK_TAG(b.get_bank_bandwidth()), BANK_BUSY(b.m_bank_busy * b.m_clock_period), BANK_HASH(b.m_bank_hash),
+        INCLUSION(b.m_inclusion), prefetch_as_load(b.m_pref_load), match_offset_bits(b.m_wq_full_addr), virtual_prefetch(b.m_va_pref),
+        has_directory(b.m_directory), clean_writebacks(b.m_clean_wb), eviction_notices(b.m_eviction_notices), pref_activate_mask(b.m_pref_act_mask),
+        directory_ports(b.m_uls), directory(b.m_directory ? b.get_num_sets() : 0),
+        partitioner(b.m_way_partition ? std::optional<champsim::way_partitioner>{std::in_place, NUM_CPUS, NUM_SET, NUM_WAY,
+                                                                                  std::min<long>(b.m_umon_sets, NUM_SAMPLED_SET), b.m_partition_interval}
+                                      : std::nullopt),
+        victims(b.m_victim_buffer > 0 ? std::optional<champsim::victim_buffer>{std::in_place, b.m_victim_buffer, get_tag_offset_bits()} : std::nullopt),
         pref_module_pimpl(std::make_unique<prefetcher_module_model<Ps...>>(this)), repl_module_pimpl(std::make_unique<replacement_module_model<Rs...>>(this))
   {
   }
 
+  /**
+   * Build a cache whose cycle is compiled for its modules, so that their hooks are called directly and may be inlined.
+   * The translation unit that builds it must include cache_dispatch.h.
+   */
+  template <typename... Ps, typename... Rs>
+  CACHE(champsim::modules::static_dispatch_t,
+        champsim::cache_builder<champsim::cache_builder_module_type_holder<Ps...>, champsim::cache_builder_module_type_holder<Rs...>> b)
+      : CACHE(b)
+  {
+    bound_operate = &CACHE::operate_with<prefetcher_module_model<Ps...>, replacement_module_model<Rs...>>;
+  }
+
   CACHE(const CACHE&) = delete;
   CACHE(CACHE&&);
   CACHE& operator=(const CACHE&) = delete;
@@ -423,6 +605,12 @@ void CACHE::prefetcher_module_model<Ps...>::impl_prefetcher_branch_operate(champ
   std::apply([&](auto&... p) { (..., process_one(p)); }, intern_);
 }
 
+template <typename... Ps>
+bool CACHE::prefetcher_module_model<Ps...>::impl_is_set_local() const
+{
+  return (true && ... && champsim::modules::prefetcher::is_set_local<Ps>);
+}
+
 template <typename... Rs>
 void CACHE::replacement_module_model<Rs...>::impl_initialize_replacement()
 {
@@ -518,6 +706,41 @@ void CACHE::replacement_module_model<Rs...>::impl_replacement_cache_fill(uint32_
   std::apply([&](auto&... r) { (..., process_one(r)); }, intern_);
 }
 
+template <typename... Rs>
+void CACHE::replacement_module_model<Rs...>::impl_replacement_sector_fill(uint32_t triggering_cpu, long set, long way, champsim::address full_addr,
+                                                                          champsim::address ip, access_type type)
+{
+  [[maybe_unused]] auto process_one = [&](auto& r) {
+    using namespace champsim::modules;
+
+    /* Strong addresses */
+    if constexpr (replacement::has_sector_fill<decltype(r), uint32_t, long, long, champsim::address, champsim::address, access_type>)
+      r.replacement_sector_fill(triggering_cpu, set, way, full_addr, ip, type);
+
+    /* Otherwise, this module alone is updated as for a miss with no victim */
+    /* Strong addresses */
+    else if constexpr (replacement::has_update_state<decltype(r), uint32_t, long, long, champsim::address, champsim::address, access_type, bool>)
+      r.update_replacement_state(triggering_cpu, set, way, full_addr, ip, type, false);
+
+    /* Strong addresses */
+    else if constexpr (replacement::has_update_state<decltype(r), uint32_t, long, long, champsim::address, champsim::address, champsim::address, access_type,
+                                                     bool>)
+      r.update_replacement_state(triggering_cpu, set, way, full_addr, ip, champsim::address{}, type, false);
+
+    /* Raw integer access type */
+    else if constexpr (replacement::has_update_state<decltype(r), uint32_t, long, long, champsim::address, champsim::address, champsim::address,
+                                                     std::underlying_type_t<access_type>, bool>)
+      r.update_replacement_state(triggering_cpu, set, way, full_addr, ip, champsim::address{}, champsim::to_underlying(type), false);
+
+    /* Raw integer addresses, raw integer access type */
+    else if constexpr (replacement::has_update_state<decltype(r), uint32_t, long, long, uint64_t, uint64_t, uint64_t, std::underlying_type_t<access_type>,
+                                                     bool>)
+      r.update_replacement_state(triggering_cpu, set, way, full_addr.to<uint64_t>(), ip.to<uint64_t>(), uint64_t{0}, champsim::to_underlying(type), false);
+  };
+
+  std::apply([&](auto&... r) { (..., process_one(r)); }, intern_);
+}
+
 template <typename... Rs>
 void CACHE::replacement_module_model<Rs...>::impl_replacement_final_stats()
 {
@@ -530,6 +753,12 @@ void CACHE::replacement_module_model<Rs...>::impl_replacement_final_stats()
   std::apply([&](auto&... r) { (..., process_one(r)); }, intern_);
 }
 
+template <typename... Rs>
+bool CACHE::replacement_module_model<Rs...>::impl_is_set_local() const
+{
+  return (true && ... && champsim::modules::replacement::is_set_local<Rs>);
+}
+
 #ifdef SET_ASIDE_CHAMPSIM_MODULE
 #undef SET_ASIDE_CHAMPSIM_MODULE
 #define CHAMPSIM_MODULE
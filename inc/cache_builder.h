@@ -32,6 +32,23 @@
 class CACHE;
 namespace champsim
 {
+/**
+ * The function that selects the tag bank for an address.
+ */
+enum class cache_bank_hash {
+  set_index, ///< The low bits of the set index
+  xor_fold   ///< All bits above the block offset, folded together with exclusive-or
+};
+
+/**
+ * The relationship between the contents of a cache and the contents of the caches above it.
+ */
+enum class cache_inclusion {
+  non_inclusive, ///< Neither inclusive nor exclusive (NINE)
+  inclusive,     ///< Every block above is also held here. Evictions invalidate the block in the upper levels.
+  exclusive      ///< Blocks are held either here or above, but not both. The cache is filled only by the victims of its upper levels.
+};
+
 class channel;
 template <typename... Ts>
 class cache_builder_module_type_holder
@@ -46,6 +63,8 @@ struct cache_builder_base {
   std::optional<uint32_t> m_sets{};
   double m_sets_factor{64};
   std::optional<uint32_t> m_ways{};
+  std::optional<uint32_t> m_sampled_sets{};
+  uint32_t m_sectors{1};
   std::size_t m_pq_size{std::numeric_limits<std::size_t>::max()};
   std::optional<uint32_t> m_mshr_size{};
   std::optional<uint64_t> m_hit_lat{};
@@ -53,10 +72,22 @@ struct cache_builder_base {
   std::optional<uint64_t> m_latency{};
   std::optional<champsim::bandwidth::maximum_type> m_max_tag{};
   std::optional<champsim::bandwidth::maximum_type> m_max_fill{};
+  uint32_t m_banks{1};
+  std::optional<champsim::bandwidth::maximum_type> m_max_bank_tag{};
+  uint64_t m_bank_busy{1};
+  cache_bank_hash m_bank_hash{cache_bank_hash::set_index};
+  cache_inclusion m_inclusion{cache_inclusion::non_inclusive};
+  uint64_t m_partition_interval{5000000};
+  uint32_t m_umon_sets{32};
+  uint32_t m_victim_buffer{0};
   champsim::data::bits m_offset_bits{LOG2_BLOCK_SIZE};
   bool m_pref_load{};
   bool m_wq_full_addr{};
   bool m_va_pref{};
+  bool m_directory{};
+  bool m_clean_wb{};
+  bool m_eviction_notices{};
+  bool m_way_partition{};
 
   std::vector<access_type> m_pref_act_mask{access_type::LOAD, access_type::PREFETCH};
   std::vector<champsim::channel*> m_uls{};
@@ -81,9 +112,13 @@ class cache_builder : public detail::cache_builder_base
 
   uint32_t get_num_sets() const;
   uint32_t get_num_ways() const;
+  uint32_t get_num_sampled_sets() const;
+  uint32_t get_num_sectors() const;
   uint32_t get_num_mshrs() const;
   champsim::bandwidth::maximum_type get_tag_bandwidth() const;
   champsim::bandwidth::maximum_type get_fill_bandwidth() const;
+  uint32_t get_num_banks() const;
+  champsim::bandwidth::maximum_type get_bank_bandwidth() const;
   uint64_t get_hit_latency() const;
   uint64_t get_fill_latency() const;
   uint64_t get_total_latency() const;
@@ -135,6 +170,24 @@ public:
    */
   self_type& log2_ways(uint32_t log2_ways_);
 
+  /**
+   * Specify the number of sets that are fully modeled.
+   *
+   * The value is rounded up to a power of two, and the sampled sets are spread evenly across the cache. Accesses to the remaining sets hit or
+   * miss according to the miss ratio observed in the sampled sets, and they do not allocate blocks. This is an approximation meant for
+   * exploring policies in large data caches. If this is not specified, every set is modeled.
+   */
+  self_type& sampled_sets(uint32_t sampled_sets_);
+
+  /**
+   * Specify the number of sectors covered by each tag.
+   *
+   * Each sector is the size given by offset_bits(), and keeps its own valid and dirty state. Misses fetch only the missing sector, and
+   * evictions write back only the dirty sectors. The value is rounded up to a power of two, no greater than 64. If this is not specified,
+   * each tag covers a single block.
+   */
+  self_type& sectors(uint32_t sectors_);
+
   /**
    * Specify the size of the internal prefetch queue.
    */
@@ -172,6 +225,52 @@ public:
    */
   self_type& fill_bandwidth(champsim::bandwidth::maximum_type max_write_);
 
+  /**
+   * Specify the number of banks in the tag array.
+   *
+   * The value is rounded up to a power of two, no greater than the number of sets. Each bank has its own tag check bandwidth and busy time,
+   * and tag checks are performed in order, so a check to a busy bank delays the checks behind it.
+   */
+  self_type& banks(uint32_t banks_);
+
+  /**
+   * Specify the number of tag checks each bank can begin in a cycle.
+   * If this is not specified, the tag check bandwidth is divided evenly among the banks.
+   */
+  self_type& bank_bandwidth(champsim::bandwidth::maximum_type max_bank_tag_);
+
+  /**
+   * Specify the number of cycles a bank is busy after it begins its tag checks. A value of 1 models a fully pipelined bank.
+   */
+  self_type& bank_busy(uint64_t bank_busy_);
+
+  /**
+   * Specify the function used to select the bank for an address.
+   */
+  self_type& bank_hash(cache_bank_hash bank_hash_);
+
+  /**
+   * Specify the inclusion policy of this cache with respect to its upper levels.
+   * The upper levels of an exclusive cache should be built with ``set_clean_writebacks()``, since the victims they evict are its only source of blocks.
+   */
+  self_type& inclusion(cache_inclusion inclusion_);
+
+  /**
+   * Specify the number of cycles between repartitions of the ways, if way partitioning is enabled.
+   */
+  self_type& partition_interval(uint64_t partition_interval_);
+
+  /**
+   * Specify the number of sets that the utility monitor samples, if way partitioning is enabled.
+   * The value is rounded up to a power of two, no greater than the number of sampled sets.
+   */
+  self_type& umon_sets(uint32_t umon_sets_);
+
+  /**
+   * Specify the number of entries in a fully-associative victim buffer beside the sets. If zero, the cache has no victim buffer.
+   */
+  self_type& victim_buffer(uint32_t victim_buffer_);
+
   /**
    * Specify the number of bits to be used as a block offset.
    */
@@ -212,6 +311,48 @@ public:
    */
   self_type& reset_virtual_prefetch();
 
+  /**
+   * Specify that this cache holds a directory that keeps its upper levels coherent.
+   */
+  self_type& set_coherence_directory();
+
+  /**
+   * Specify that this cache does not keep its upper levels coherent.
+   */
+  self_type& reset_coherence_directory();
+
+  /**
+   * Specify that this cache should send its clean victims to the lower level, as well as its dirty ones.
+   */
+  self_type& set_clean_writebacks();
+
+  /**
+   * Specify that this cache should discard its clean victims.
+   */
+  self_type& reset_clean_writebacks();
+
+  /**
+   * Specify that this cache should tell the directory below it of each block that it evicts, so that the directory can stop tracking the block.
+   * This is only correct if the caches above this one cannot still hold the block, that is, if there are none,
+   * or if this cache is inclusive or exclusive of them.
+   */
+  self_type& set_eviction_notices();
+
+  /**
+   * Specify that this cache should not tell the level below it of the blocks that it evicts.
+   */
+  self_type& reset_eviction_notices();
+
+  /**
+   * Specify that the ways of this cache should be partitioned among the CPUs, according to the utility of each.
+   */
+  self_type& set_way_partitioning();
+
+  /**
+   * Specify that the ways of this cache should be shared among the CPUs.
+   */
+  self_type& reset_way_partitioning();
+
   /**
    * Specify the ``access_type`` values that should activate the prefetcher.
    */
@@ -254,7 +395,8 @@ auto champsim::cache_builder<P, R>::get_num_sets() const -> uint32_t
   if (m_sets.has_value())
     value = m_sets.value();
   else if (m_size.has_value() && m_ways.has_value())
-    value = static_cast<uint32_t>(m_size.value().count() / (m_ways.value() * (1 << champsim::to_underlying(m_offset_bits)))); // casting the result of division
+    value = static_cast<uint32_t>(m_size.value().count()
+                                  / (m_ways.value() * get_num_sectors() * (1 << champsim::to_underlying(m_offset_bits)))); // casting the result of division
   else
     value = scaled_by_ul_size(m_sets_factor);
   return champsim::next_pow2(value);
@@ -266,10 +408,23 @@ auto champsim::cache_builder<P, R>::get_num_ways() const -> uint32_t
   if (m_ways.has_value())
     return m_ways.value();
   if (m_size.has_value())
-    return static_cast<uint32_t>(m_size.value().count() / (get_num_sets() * (1 << champsim::to_underlying(m_offset_bits)))); // casting the result of division
+    return static_cast<uint32_t>(m_size.value().count()
+                                 / (get_num_sets() * get_num_sectors() * (1 << champsim::to_underlying(m_offset_bits)))); // casting the result of division
   return 1;
 }
 
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::get_num_sampled_sets() const -> uint32_t
+{
+  return std::clamp(champsim::next_pow2(m_sampled_sets.value_or(get_num_sets())), 1u, std::max(get_num_sets(), 1u));
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::get_num_sectors() const -> uint32_t
+{
+  return std::clamp(champsim::next_pow2(m_sectors), 1u, 64u);
+}
+
 template <typename P, typename R>
 auto champsim::cache_builder<P, R>::get_num_mshrs() const -> uint32_t
 {
@@ -290,6 +445,20 @@ auto champsim::cache_builder<P, R>::get_fill_bandwidth() const -> champsim::band
   return m_max_fill.value_or(get_tag_bandwidth());
 }
 
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::get_num_banks() const -> uint32_t
+{
+  return std::clamp(champsim::next_pow2(m_banks), 1u, std::max(get_num_sets(), 1u));
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::get_bank_bandwidth() const -> champsim::bandwidth::maximum_type
+{
+  auto num_banks = static_cast<long>(get_num_banks());
+  auto default_bandwidth = (champsim::to_underlying(get_tag_bandwidth()) + num_banks - 1) / num_banks;
+  return std::max(m_max_bank_tag.value_or(champsim::bandwidth::maximum_type{default_bandwidth}), champsim::bandwidth::maximum_type{1});
+}
+
 template <typename P, typename R>
 auto champsim::cache_builder<P, R>::get_hit_latency() const -> uint64_t
 {
@@ -381,6 +550,20 @@ auto champsim::cache_builder<P, R>::log2_ways(uint32_t log2_ways_) -> self_type&
   return *this;
 }
 
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::sampled_sets(uint32_t sampled_sets_) -> self_type&
+{
+  m_sampled_sets = sampled_sets_;
+  return *this;
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::sectors(uint32_t sectors_) -> self_type&
+{
+  m_sectors = sectors_;
+  return *this;
+}
+
 template <typename P, typename R>
 auto champsim::cache_builder<P, R>::pq_size(uint32_t pq_size_) -> self_type&
 {
@@ -423,6 +606,62 @@ auto champsim::cache_builder<P, R>::tag_bandwidth(champsim::bandwidth::maximum_t
   return *this;
 }
 
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::banks(uint32_t banks_) -> self_type&
+{
+  m_banks = banks_;
+  return *this;
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::bank_bandwidth(champsim::bandwidth::maximum_type max_bank_tag_) -> self_type&
+{
+  m_max_bank_tag = max_bank_tag_;
+  return *this;
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::bank_busy(uint64_t bank_busy_) -> self_type&
+{
+  m_bank_busy = bank_busy_;
+  return *this;
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::bank_hash(cache_bank_hash bank_hash_) -> self_type&
+{
+  m_bank_hash = bank_hash_;
+  return *this;
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::inclusion(cache_inclusion inclusion_) -> self_type&
+{
+  m_inclusion = inclusion_;
+  return *this;
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::partition_interval(uint64_t partition_interval_) -> self_type&
+{
+  m_partition_interval = partition_interval_;
+  return *this;
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::umon_sets(uint32_t umon_sets_) -> self_type&
+{
+  m_umon_sets = umon_sets_;
+  return *this;
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::victim_buffer(uint32_t victim_buffer_) -> self_type&
+{
+  m_victim_buffer = victim_buffer_;
+  return *this;
+}
+
 template <typename P, typename R>
 auto champsim::cache_builder<P, R>::fill_bandwidth(champsim::bandwidth::maximum_type max_write_) -> self_type&
 {
@@ -485,6 +724,62 @@ auto champsim::cache_builder<P, R>::reset_virtual_prefetch() -> self_type&
   return *this;
 }
 
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::set_coherence_directory() -> self_type&
+{
+  m_directory = true;
+  return *this;
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::reset_coherence_directory() -> self_type&
+{
+  m_directory = false;
+  return *this;
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::set_clean_writebacks() -> self_type&
+{
+  m_clean_wb = true;
+  return *this;
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::reset_clean_writebacks() -> self_type&
+{
+  m_clean_wb = false;
+  return *this;
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::set_eviction_notices() -> self_type&
+{
+  m_eviction_notices = true;
+  return *this;
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::reset_eviction_notices() -> self_type&
+{
+  m_eviction_notices = false;
+  return *this;
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::set_way_partitioning() -> self_type&
+{
+  m_way_partition = true;
+  return *this;
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::reset_way_partitioning() -> self_type&
+{
+  m_way_partition = false;
+  return *this;
+}
+
 template <typename P, typename R>
 template <typename... Elems>
 auto champsim::cache_builder<P, R>::prefetch_activate(Elems... pref_act_elems) -> self_type&
@@ -0,0 +1,631 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The parts of the cache that call its modules. They are templates over the types that the hooks are called through, which are either the module
+ * concepts or the module models that the cache was built with. A cache that is built with champsim::modules::static_dispatch is compiled for its
+ * models where it is built, so this file must be included there.
+ */
+
+#ifndef CACHE_DISPATCH_H
+#define CACHE_DISPATCH_H
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <optional>
+#include <fmt/core.h>
+
+#include "bandwidth.h"
+#include "cache.h"
+#include "champsim.h"
+#include "chrono.h"
+#include "util/algorithm.h"
+#include "util/span.h"
+
+inline auto CACHE::matches_tag(champsim::address addr) const
+{
+  return [match = addr.slice_upper(get_tag_offset_bits()), shamt = get_tag_offset_bits()](const auto& entry) {
+    return entry.address.slice_upper(shamt) == match;
+  };
+}
+
+template <typename T>
+champsim::address CACHE::module_address(const T& element) const
+{
+  auto address = virtual_prefetch ? element.v_address : element.address;
+  return champsim::address{address.slice_upper(match_offset_bits ? champsim::data::bits{} : OFFSET_BITS)};
+}
+
+template <typename T>
+bool CACHE::should_activate_prefetcher(const T& pkt) const
+{
+  return !pkt.prefetch_from_this && std::count(std::begin(pref_activate_mask), std::end(pref_activate_mask), pkt.type) > 0;
+}
+
+template <bool UpdateRequest>
+auto CACHE::initiate_tag_check(champsim::channel* ul)
+{
+  return [time = current_time + (warmup ? champsim::chrono::clock::duration{} : HIT_LATENCY), ul](const auto& entry) {
+    CACHE::tag_lookup_type retval{entry};
+    retval.event_cycle = time;
+
+    if constexpr (UpdateRequest) {
+      if (entry.response_requested) {
+        retval.to_return = {&ul->returned};
+      }
+      retval.upper_level = ul;
+    } else {
+      (void)ul; // supress warning about ul being unused
+    }
+
+    if constexpr (champsim::debug_print) {
+      fmt::print("[TAG] initiate_tag_check instr_id: {} address: {} v_address: {} type: {} response_requested: {}\n", retval.instr_id, retval.address,
+                 retval.v_address, access_type_names.at(champsim::to_underlying(retval.type)), !std::empty(retval.to_return));
+    }
+
+    return retval;
+  };
+}
+
+template <typename P, typename R>
+long CACHE::operate_with()
+{
+  long progress{0};
+
+  auto is_ready = [time = current_time](const auto& entry) {
+    return entry.event_cycle <= time;
+  };
+  auto is_translated = [](const auto& entry) {
+    return entry.is_translated;
+  };
+
+  for (auto* ul : upper_levels) {
+    ul->check_collision();
+  }
+
+  // Finish returns
+  std::for_each(std::cbegin(lower_level->returned), std::cend(lower_level->returned), [this](const auto& pkt) { this->finish_packet(pkt); });
+  progress += std::distance(std::cbegin(lower_level->returned), std::cend(lower_level->returned));
+  lower_level->returned.clear();
+
+  // Respond to probes from a directory below, in the order that they were sent
+  auto probes_end = std::find_if_not(std::cbegin(lower_level->probes), std::cend(lower_level->probes), [this](const auto& x) { return this->handle_probe(x); });
+  progress += std::distance(std::cbegin(lower_level->probes), probes_end);
+  lower_level->probes.erase(std::cbegin(lower_level->probes), probes_end);
+
+  if (partitioner && partitioner->cycle()) {
+    ++sim_stats.repartitions;
+  }
+
+  // Finish translations
+  if (lower_translate != nullptr) {
+    std::for_each(std::cbegin(lower_translate->returned), std::cend(lower_translate->returned), [this](const auto& pkt) { this->finish_translation(pkt); });
+    progress += std::distance(std::cbegin(lower_translate->returned), std::cend(lower_translate->returned));
+    lower_translate->returned.clear();
+  }
+
+  // Perform fills
+  champsim::bandwidth fill_bw{MAX_FILL};
+  for (auto q : {std::ref(MSHR), std::ref(inflight_writes)}) {
+    auto [fill_begin, fill_end] = champsim::get_span_p(std::cbegin(q.get()), std::cend(q.get()), fill_bw,
+                                                       [time = current_time](const auto& x) { return x.data_promise.is_ready_at(time); });
+    auto complete_end = std::find_if_not(fill_begin, fill_end, [this](const auto& x) { return this->handle_fill<P, R>(x); });
+    fill_bw.consume(std::distance(fill_begin, complete_end));
+    q.get().erase(fill_begin, complete_end);
+  }
+
+  // Initiate tag checks
+  const champsim::bandwidth::maximum_type bandwidth_from_tag_checks{champsim::to_underlying(MAX_TAG) * (long)(HIT_LATENCY / clock_period)
+                                                                    - (long)std::size(inflight_tag_check)};
+  champsim::bandwidth initiate_tag_bw{std::clamp(bandwidth_from_tag_checks, champsim::bandwidth::maximum_type{0}, MAX_TAG)};
+  auto can_translate = [avail = (std::size(translation_stash) < static_cast<std::size_t>(MSHR_SIZE))](const auto& entry) {
+    return avail || entry.is_translated;
+  };
+  auto stash_bandwidth_consumed =
+      champsim::transform_while_n(translation_stash, std::back_inserter(inflight_tag_check), initiate_tag_bw, is_translated, initiate_tag_check<false>());
+  initiate_tag_bw.consume(stash_bandwidth_consumed);
+  std::vector<long long> channels_bandwidth_consumed{};
+
+  if (std::size(upper_levels) > 1) {
+    std::rotate(upper_levels.begin(), upper_levels.begin() + 1, upper_levels.end());
+  }
+
+  // upper levels get an equal portion of the remaining bandwidth
+  champsim::bandwidth::maximum_type per_upper_bandwidth =
+      std::size(upper_levels) >= 1
+          ? (champsim::bandwidth::maximum_type)std::max((size_t)initiate_tag_bw.amount_remaining() / std::size(upper_levels), size_t{1})
+          : champsim::bandwidth::maximum_type{};
+
+  for (auto* ul : upper_levels) {
+    for (auto q : {std::ref(ul->WQ), std::ref(ul->RQ), std::ref(ul->PQ)}) {
+      // this needs to be in this loop, we need to ensure that for cases where bandwidth doesn't divide nicely across upstreams,
+      // we don't accidentally consume more bandwidth than expected
+      champsim::bandwidth per_upper_tag_bw{std::min(per_upper_bandwidth, champsim::bandwidth::maximum_type{initiate_tag_bw.amount_remaining()})};
+      auto bandwidth_consumed =
+          champsim::transform_while_n(q.get(), std::back_inserter(inflight_tag_check), per_upper_tag_bw, can_translate, initiate_tag_check<true>(ul));
+      channels_bandwidth_consumed.push_back(bandwidth_consumed);
+      initiate_tag_bw.consume(bandwidth_consumed);
+    }
+  }
+
+  auto pq_bandwidth_consumed =
+      champsim::transform_while_n(internal_PQ, std::back_inserter(inflight_tag_check), initiate_tag_bw, can_translate, initiate_tag_check<false>());
+  initiate_tag_bw.consume(pq_bandwidth_consumed);
+
+  // Issue translations
+  std::for_each(std::begin(inflight_tag_check), std::end(inflight_tag_check), [this](auto& x) { this->issue_translation(x); });
+  std::for_each(std::begin(translation_stash), std::end(translation_stash), [this](auto& x) { this->issue_translation(x); });
+
+  // Find entries that would be ready except that they have not finished translation, move them to the stash
+  auto [last_not_missed, stash_end] = champsim::extract_if(std::begin(inflight_tag_check), std::end(inflight_tag_check), std::back_inserter(translation_stash),
+                                                           [is_ready, is_translated](const auto& x) { return is_ready(x) && !is_translated(x); });
+  progress += std::distance(last_not_missed, std::end(inflight_tag_check));
+  inflight_tag_check.erase(last_not_missed, std::end(inflight_tag_check));
+
+  // Perform tag checks
+  auto do_handle_miss = [this](const auto& pkt) {
+    if (pkt.type == access_type::WRITE && !this->match_offset_bits) {
+      return this->handle_write(pkt); // Treat writes (that is, writebacks) like fills
+    }
+    return this->handle_miss(pkt); // Treat writes (that is, stores) like reads
+  };
+  champsim::bandwidth tag_check_bw{MAX_TAG};
+  auto [tag_check_ready_begin, tag_check_ready_end] =
+      champsim::get_span_p(std::begin(inflight_tag_check), std::end(inflight_tag_check), tag_check_bw,
+                           [is_ready, is_translated](const auto& pkt) { return is_ready(pkt) && is_translated(pkt); });
+
+  // Hits are checked before misses. Tag checks stall behind the first check whose bank is not available, and a bank is reserved only by a check that finishes.
+  auto finish_tag_check_end = tag_check_ready_begin;
+  auto bank_ready_end = tag_check_ready_end;
+  auto check_in_order = [this, &finish_tag_check_end, &bank_ready_end](auto&& do_access) {
+    for (auto it = finish_tag_check_end; it != bank_ready_end; ++it) {
+      if (!this->bank_available(it->address)) {
+        bank_ready_end = it;
+        break;
+      }
+      if (do_access(*it)) {
+        this->reserve_bank(it->address);
+        // Keep the checks that did not finish in their original order
+        std::rotate(finish_tag_check_end, it, std::next(it));
+        ++finish_tag_check_end;
+      }
+    }
+  };
+  auto write_through_then = [this](auto&& do_access) {
+    return [this, do_access](const auto& pkt) {
+      if (this->writes_through(pkt) && this->lower_level->wq_occupancy() >= this->lower_level->wq_size()) {
+        return false;
+      }
+      if (!do_access(pkt)) {
+        return false;
+      }
+      if (this->writes_through(pkt)) {
+        [[maybe_unused]] auto success = this->lower_level->add_wq(this->write_through_packet(pkt));
+        assert(success);
+      }
+      return true;
+    };
+  };
+  check_in_order(write_through_then([this](const auto& pkt) { return this->try_hit<P, R>(pkt); }));
+  check_in_order(write_through_then(do_handle_miss));
+  if (bank_ready_end != tag_check_ready_end) {
+    ++sim_stats.bank_conflict_stalls;
+  }
+
+  tag_check_bw.consume(std::distance(tag_check_ready_begin, finish_tag_check_end));
+  inflight_tag_check.erase(tag_check_ready_begin, finish_tag_check_end);
+
+  pref_module<P>().impl_prefetcher_cycle_operate();
+
+  if constexpr (champsim::debug_print) {
+    fmt::print("[{}] {} cycle completed: {} tags checked: {} remaining: {} stash consumed: {} remaining: {} channel consumed: {} pq consumed {} unused consume "
+               "bw {}\n",
+               NAME, __func__, current_time.time_since_epoch() / clock_period, tag_check_bw.amount_consumed(), std::size(inflight_tag_check),
+               stash_bandwidth_consumed, std::size(translation_stash), channels_bandwidth_consumed, pq_bandwidth_consumed, initiate_tag_bw.amount_remaining());
+  }
+
+  return progress + fill_bw.amount_consumed() + initiate_tag_bw.amount_consumed() + tag_check_bw.amount_consumed();
+}
+
+template <typename P, typename R>
+bool CACHE::handle_fill(const mshr_type& fill_mshr)
+{
+  cpu = fill_mshr.cpu;
+
+  // Blocks are only allocated in sampled sets
+  const bool sampled = is_sampled_set(get_set_index(fill_mshr.address));
+
+  // An exclusive cache passes the blocks that are read from it through to the upper levels, and is filled only by their victims
+  const bool allocate = !(INCLUSION == champsim::cache_inclusion::exclusive && fill_mshr.type != access_type::WRITE && !std::empty(fill_mshr.to_return));
+
+  auto placed = place_fill<P, R>(fill_mshr, sampled && allocate, false, [this, &fill_mshr](BLOCK& victim, bool evicted) {
+    return writeback_block(victim, fill_mshr.cpu, fill_mshr.instr_id, evicted);
+  });
+  if (!placed.has_value()) {
+    return false;
+  }
+
+  const auto set_end = get_set_span(fill_mshr.address).second;
+  assert(placed->way != set_end || fill_mshr.type != access_type::WRITE || !sampled); // Writes may not bypass
+
+  if (placed->evicted.valid && INCLUSION == champsim::cache_inclusion::inclusive) {
+    back_invalidate(placed->evicted, fill_mshr.cpu);
+  }
+
+  // COLLECT STATS
+  if (placed->kind == fill_kind::upgrade || fill_mshr.type != access_type::PREFETCH)
+    sim_stats.total_miss_latency_cycles += (current_time - (fill_mshr.time_enqueued + clock_period)) / clock_period;
+  sim_stats.mshr_return.increment(std::pair{fill_mshr.type, fill_mshr.cpu});
+
+  // An upgrade returns the data that is already present
+  const auto data = (placed->kind == fill_kind::upgrade) ? placed->way->data : fill_mshr.data_promise->data;
+  response_type response{fill_mshr.address, fill_mshr.v_address, data, placed->pf_metadata, fill_mshr.instr_depend_on_me};
+  if (placed->way != set_end) {
+    response.state = get_granted_state(fill_mshr.address, &*placed->way);
+  } else {
+    response.state = has_directory ? get_granted_state(fill_mshr.address, nullptr) : fill_mshr.data_promise->state;
+  }
+  for (auto* ret : fill_mshr.to_return) {
+    ret->push_back(response);
+  }
+
+  return true;
+}
+
+template <typename P, typename R>
+auto CACHE::place_fill(const mshr_type& fill_mshr, bool allocate, bool set_only, const writeback_function& writeback) -> std::optional<placed_fill>
+{
+  const auto set = get_set_index(fill_mshr.address);
+  auto [set_begin, set_end] = get_set_span(fill_mshr.address);
+  const auto sector_mask = get_sector_mask(fill_mshr.address);
+  const auto is_prefetch = (fill_mshr.type == access_type::PREFETCH);
+  const auto is_dirty_write = (fill_mshr.type == access_type::WRITE && !fill_mshr.clean_writeback);
+
+  // The prefetcher is told of fills that bypass this level
+  if (!allocate) {
+    auto metadata_thru = pref_module<P>().impl_prefetcher_cache_fill(module_address(fill_mshr), set, std::distance(set_begin, set_end), is_prefetch,
+                                                                     champsim::address{}, fill_mshr.data_promise->pf_metadata);
+    return placed_fill{fill_kind::bypass, set_end, metadata_thru};
+  }
+
+  // A sector whose tag is already present does not need a victim, nor does a shared block that is being upgraded
+  auto tag_way = std::find_if(set_begin, set_end, [matcher = matches_tag(fill_mshr.address)](const auto& x) { return x.valid && matcher(x); });
+  if (tag_way != set_end && (tag_way->valid_sectors & sector_mask) != 0 && tag_way->coherence == champsim::coherence_state::shared) {
+    if constexpr (champsim::debug_print) {
+      fmt::print("[{}] {} upgrade instr_id: {} address: {} v_address: {} set: {} way: {} type: {} cycle: {}\n", NAME, __func__, fill_mshr.instr_id,
+                 fill_mshr.address, fill_mshr.v_address, set, std::distance(set_begin, tag_way), access_type_names.at(champsim::to_underlying(fill_mshr.type)),
+                 (current_time.time_since_epoch()) / clock_period);
+    }
+
+    // The data is already present, only the permission has changed
+    tag_way->coherence = fill_mshr.data_promise->state;
+    if (fill_mshr.type == access_type::WRITE) {
+      tag_way->dirty_sectors |= sector_mask;
+      tag_way->dirty = true;
+      tag_way->coherence = champsim::coherence_state::modified;
+    }
+    return placed_fill{fill_kind::upgrade, tag_way, tag_way->pf_metadata};
+  }
+
+  if (tag_way != set_end && NUM_SECTOR > 1) {
+    const auto way_idx = std::distance(set_begin, tag_way);
+    if constexpr (champsim::debug_print) {
+      fmt::print("[{}] {} sector instr_id: {} address: {} v_address: {} set: {} way: {} sectors: {:#x} type: {} cycle: {}\n", NAME, __func__,
+                 fill_mshr.instr_id, fill_mshr.address, fill_mshr.v_address, set, way_idx, tag_way->valid_sectors,
+                 access_type_names.at(champsim::to_underlying(fill_mshr.type)), (current_time.time_since_epoch()) / clock_period);
+    }
+
+    auto metadata_thru = pref_module<P>().impl_prefetcher_cache_fill(module_address(fill_mshr), set, way_idx, is_prefetch, champsim::address{},
+                                                                     fill_mshr.data_promise->pf_metadata);
+    repl_module<R>().impl_replacement_sector_fill(fill_mshr.cpu, set, way_idx, module_address(fill_mshr), fill_mshr.ip, fill_mshr.type);
+
+    if (is_prefetch && !set_only) {
+      ++sim_stats.pf_fill;
+    }
+
+    tag_way->valid_sectors |= sector_mask;
+    if (is_dirty_write) {
+      tag_way->dirty_sectors |= sector_mask;
+      tag_way->dirty = true;
+      tag_way->coherence = champsim::coherence_state::modified;
+    }
+    tag_way->pf_metadata = metadata_thru;
+    return placed_fill{fill_kind::sector, tag_way, metadata_thru};
+  }
+
+  // A copy that the replacement policy chose to leave in the victim buffer is replaced by the fill
+  if (victims) {
+    if (auto* stale = victims->find(fill_mshr.address); stale != nullptr) {
+      if (stale->dirty && !writeback(*stale, false)) {
+        return std::nullopt;
+      }
+      victims->take(fill_mshr.address);
+    }
+  }
+
+  auto way = std::find_if_not(set_begin, set_end, [](const auto& x) { return x.valid; });
+  if (way == set_end) {
+    way = std::next(set_begin,
+                    repl_module<R>().impl_find_victim(fill_mshr.cpu, fill_mshr.instr_id, set, &*set_begin, fill_mshr.ip, fill_mshr.address, fill_mshr.type));
+
+    // The victim must keep the set within the partition
+    if (partitioner && way != set_end) {
+      way = std::next(set_begin, partitioner->enforce(fill_mshr.cpu, set, std::distance(set_begin, way), &*set_begin));
+    }
+  }
+  assert(set_begin <= way);
+  assert(way <= set_end);
+  const auto way_idx = std::distance(set_begin, way); // cast protected by earlier assertion
+
+  if constexpr (champsim::debug_print) {
+    fmt::print("[{}] {} instr_id: {} address: {} v_address: {} set: {} way: {} type: {} prefetch_metadata: {} cycle_enqueued: {} cycle: {}\n", NAME, __func__,
+               fill_mshr.instr_id, fill_mshr.address, fill_mshr.v_address, set, way_idx, access_type_names.at(champsim::to_underlying(fill_mshr.type)),
+               fill_mshr.data_promise->pf_metadata, (fill_mshr.time_enqueued.time_since_epoch()) / clock_period,
+               (current_time.time_since_epoch()) / clock_period);
+  }
+
+  // The block that leaves this level is the victim, or the block that the victim displaces from the victim buffer
+  BLOCK* leaving = (way != set_end && way->valid) ? &*way : nullptr;
+  if (leaving != nullptr && victims) {
+    leaving = victims->next_displaced();
+  }
+
+  if (leaving != nullptr && (leaving->dirty || clean_writebacks || eviction_notices)) {
+    if (!writeback(*leaving, true)) {
+      return std::nullopt;
+    }
+  }
+
+  champsim::address evicting_address{};
+  if (way != set_end && way->valid) {
+    evicting_address = module_address(*way);
+  }
+
+  auto metadata_thru =
+      pref_module<P>().impl_prefetcher_cache_fill(module_address(fill_mshr), set, way_idx, is_prefetch, evicting_address, fill_mshr.data_promise->pf_metadata);
+  repl_module<R>().impl_replacement_cache_fill(fill_mshr.cpu, set, way_idx, module_address(fill_mshr), fill_mshr.ip, evicting_address, fill_mshr.type);
+
+  placed_fill placed{fill_kind::bypass, way, metadata_thru};
+  if (way != set_end) {
+    placed.kind = fill_kind::block;
+    if (leaving != nullptr) {
+      placed.evicted = *leaving;
+      if (leaving->prefetch && !set_only) {
+        ++sim_stats.pf_useless;
+      }
+    }
+
+    if (way->valid && victims) {
+      const auto displaced = victims->insert(*way).valid;
+      if (displaced && !set_only) {
+        ++sim_stats.victim_buffer_displaced;
+      }
+      if (!set_only) {
+        ++sim_stats.victim_buffer_inserts;
+      }
+    }
+
+    if (is_prefetch && !set_only) {
+      ++sim_stats.pf_fill;
+    }
+
+    *way = fill_block(fill_mshr, metadata_thru, sector_mask);
+
+    if (partitioner) {
+      partitioner->touch(set, way_idx);
+    }
+  }
+
+  return placed;
+}
+
+template <typename P, typename R>
+bool CACHE::try_hit(const tag_lookup_type& handle_pkt)
+{
+  if (!handle_pkt.set_only) {
+    cpu = handle_pkt.cpu;
+  }
+
+  if (!is_sampled_set(get_set_index(handle_pkt.address))) {
+    return try_oracle_hit<P>(handle_pkt);
+  }
+
+  // access cache
+  auto [set_begin, set_end] = get_set_span(handle_pkt.address);
+  auto way = std::find_if(set_begin, set_end, [matcher = matches_tag(handle_pkt.address)](const auto& x) { return x.valid && matcher(x); });
+  if (way == set_end && victims) {
+    way = swap_victim<R>(handle_pkt, set_begin, set_end);
+  }
+  const auto sector_mask = get_sector_mask(handle_pkt.address);
+  const auto sector_miss = (way != set_end && NUM_SECTOR > 1 && (way->valid_sectors & sector_mask) == 0);
+  const auto upgrade_miss = (way != set_end && !sector_miss && !handle_pkt.is_writeback && needs_write_permission(*way, handle_pkt.type));
+  const auto hit = (way != set_end && !sector_miss && !upgrade_miss);
+  const auto useful_prefetch = (hit && way->prefetch && !handle_pkt.prefetch_from_this);
+
+  if constexpr (champsim::debug_print) {
+    fmt::print("[{}] {} instr_id: {} address: {} v_address: {} data: {} set: {} way: {} ({}) type: {} cycle: {}\n", NAME, __func__, handle_pkt.instr_id,
+               handle_pkt.address, handle_pkt.v_address, handle_pkt.data, get_set_index(handle_pkt.address), std::distance(set_begin, way),
+               hit ? "HIT" : "MISS", access_type_names.at(champsim::to_underlying(handle_pkt.type)), current_time.time_since_epoch() / clock_period);
+  }
+
+  auto metadata_thru = handle_pkt.pf_metadata;
+  if (should_activate_prefetcher(handle_pkt)) {
+    metadata_thru =
+        pref_module<P>().impl_prefetcher_cache_operate(module_address(handle_pkt), handle_pkt.ip, hit, useful_prefetch, handle_pkt.type, metadata_thru);
+  }
+
+  // update replacement policy
+  const auto way_idx = std::distance(set_begin, hit ? way : set_end);
+  repl_module<R>().impl_update_replacement_state(handle_pkt.cpu, get_set_index(handle_pkt.address), way_idx, module_address(handle_pkt), handle_pkt.ip, {},
+                                                 handle_pkt.type, hit);
+
+  if (hit) {
+    if (!handle_pkt.set_only) {
+      sim_stats.hits.increment(std::pair{handle_pkt.type, handle_pkt.cpu});
+      record_sample(handle_pkt.type, get_set_index(handle_pkt.address), true);
+    }
+
+    if (has_directory) {
+      update_directory(handle_pkt);
+    }
+
+    if (partitioner) {
+      partitioner->touch(get_set_index(handle_pkt.address), way_idx);
+      monitor_utility(handle_pkt);
+    }
+
+    response_type response{handle_pkt.address, handle_pkt.v_address, way->data, metadata_thru, handle_pkt.instr_depend_on_me};
+    response.state = get_granted_state(handle_pkt.address, &*way);
+
+    // A block that is read from an exclusive cache moves to the upper level, along with the responsibility to write it back
+    const auto moves_up = (INCLUSION == champsim::cache_inclusion::exclusive && handle_pkt.type != access_type::WRITE && !std::empty(handle_pkt.to_return));
+    if (moves_up && way->dirty) {
+      response.state = champsim::coherence_state::modified;
+    }
+
+    for (auto* ret : handle_pkt.to_return) {
+      ret->push_back(response);
+    }
+
+    if (moves_up) {
+      way->valid = false;
+      way->dirty = false;
+      way->coherence = champsim::coherence_state::invalid;
+    }
+
+    way->dirty |= (handle_pkt.type == access_type::WRITE && !handle_pkt.clean_writeback);
+    if (handle_pkt.type == access_type::WRITE && !handle_pkt.clean_writeback) {
+      way->dirty_sectors |= sector_mask;
+
+      // A writeback into a shared block leaves it shared, since the directory still counts other sharers
+      if (way->coherence != champsim::coherence_state::shared) {
+        way->coherence = champsim::coherence_state::modified;
+      }
+    }
+
+    // update prefetch stats and reset prefetch bit
+    if (useful_prefetch) {
+      if (!handle_pkt.set_only) {
+        ++sim_stats.pf_useful;
+      }
+      way->prefetch = false;
+    }
+  }
+
+  if (sector_miss && !handle_pkt.set_only) {
+    sim_stats.sector_misses.increment(std::pair{handle_pkt.type, handle_pkt.cpu});
+  }
+
+  if (upgrade_miss && !handle_pkt.set_only) {
+    ++sim_stats.coherence_upgrades;
+  }
+
+  return hit;
+}
+
+template <typename P>
+bool CACHE::try_oracle_hit(const tag_lookup_type& handle_pkt)
+{
+  // Misses are spread evenly through the accesses, at the miss ratio of the sampled sets. Before any samples are taken, every access misses.
+  // A miss that could not be handled keeps its credit until it is retried.
+  auto& sample = set_samples.at(champsim::to_underlying(handle_pkt.type));
+  if (sample.miss_credit < 1) {
+    sample.miss_credit += (sample.accesses > 0) ? static_cast<double>(sample.misses) / static_cast<double>(sample.accesses) : 1.0;
+  }
+  const auto hit = (sample.miss_credit < 1);
+
+  if constexpr (champsim::debug_print) {
+    fmt::print("[{}] {} instr_id: {} address: {} v_address: {} data: {} set: {} ({}) type: {} cycle: {}\n", NAME, __func__, handle_pkt.instr_id,
+               handle_pkt.address, handle_pkt.v_address, handle_pkt.data, get_set_index(handle_pkt.address), hit ? "HIT" : "MISS",
+               access_type_names.at(champsim::to_underlying(handle_pkt.type)), current_time.time_since_epoch() / clock_period);
+  }
+
+  auto metadata_thru = handle_pkt.pf_metadata;
+  if (should_activate_prefetcher(handle_pkt)) {
+    metadata_thru = pref_module<P>().impl_prefetcher_cache_operate(module_address(handle_pkt), handle_pkt.ip, hit, false, handle_pkt.type, metadata_thru);
+  }
+
+  if (hit) {
+    sim_stats.hits.increment(std::pair{handle_pkt.type, handle_pkt.cpu});
+    record_sample(handle_pkt.type, get_set_index(handle_pkt.address), true);
+
+    if (has_directory) {
+      update_directory(handle_pkt);
+    }
+
+    response_type response{handle_pkt.address, handle_pkt.v_address, handle_pkt.data, metadata_thru, handle_pkt.instr_depend_on_me};
+    response.state = get_granted_state(handle_pkt.address, nullptr);
+    for (auto* ret : handle_pkt.to_return) {
+      ret->push_back(response);
+    }
+  }
+
+  return hit;
+}
+
+template <typename R>
+auto CACHE::swap_victim(const tag_lookup_type& handle_pkt, set_type::iterator set_begin, set_type::iterator set_end) -> set_type::iterator
+{
+  // The victim buffer is probed alongside the set
+  if (victims->find(handle_pkt.address) == nullptr) {
+    return set_end;
+  }
+
+  const auto set = get_set_index(handle_pkt.address);
+  auto way = std::find_if_not(set_begin, set_end, [](const auto& x) { return x.valid; });
+  if (way == set_end) {
+    way = std::next(set_begin, repl_module<R>().impl_find_victim(handle_pkt.cpu, handle_pkt.instr_id, set, &*set_begin, handle_pkt.ip, handle_pkt.address,
+                                                                 handle_pkt.type));
+
+    // The victim must keep the set within the partition
+    if (partitioner && way != set_end) {
+      way = std::next(set_begin, partitioner->enforce(handle_pkt.cpu, set, std::distance(set_begin, way), &*set_begin));
+    }
+  }
+
+  // If the replacement policy bypasses, the block stays in the victim buffer and the access misses
+  if (way == set_end) {
+    return set_end;
+  }
+
+  // The buffer entry that is taken makes room for the block that it is swapped with
+  auto swapped = victims->take(handle_pkt.address);
+  champsim::address evicting_address{};
+  if (way->valid) {
+    evicting_address = module_address(*way);
+    victims->insert(*way);
+    ++sim_stats.victim_buffer_inserts;
+  }
+
+  if constexpr (champsim::debug_print) {
+    fmt::print("[{}] {} instr_id: {} address: {} set: {} way: {} evicting: {} cycle: {}\n", NAME, __func__, handle_pkt.instr_id, handle_pkt.address, set,
+               std::distance(set_begin, way), evicting_address, current_time.time_since_epoch() / clock_period);
+  }
+
+  repl_module<R>().impl_replacement_cache_fill(handle_pkt.cpu, set, std::distance(set_begin, way), module_address(handle_pkt), handle_pkt.ip,
+                                               evicting_address, handle_pkt.type);
+  *way = swapped;
+
+  if (partitioner) {
+    partitioner->touch(set, std::distance(set_begin, way));
+  }
+
+  ++sim_stats.victim_buffer_hits;
+  return way;
+}
+
+#endif
@@ -5,6 +5,7 @@
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "channel.h"
 #include "event_counter.h"
@@ -24,6 +25,52 @@ struct cache_stats {
   champsim::stats::event_counter<std::pair<access_type, std::remove_cv_t<decltype(NUM_CPUS)>>> mshr_return = {};
 
   long total_miss_latency_cycles{};
+
+  // sectored blocks
+  uint64_t sectors_per_tag = 1;
+  champsim::stats::event_counter<std::pair<access_type, std::remove_cv_t<decltype(NUM_CPUS)>>> sector_misses = {};
+  uint64_t sector_writebacks = 0;
+
+  // tag banks
+  uint64_t banks = 1;
+  uint64_t bank_conflict_stalls = 0;
+
+  // coherence
+  bool has_directory = false;
+  uint64_t coherence_upgrades = 0;
+  uint64_t probes_received = 0;
+  uint64_t probe_writebacks = 0;
+  uint64_t coherence_misses = 0;
+  uint64_t invalidations_sent = 0;
+  uint64_t downgrades_sent = 0;
+
+  // inclusion
+  uint64_t back_invalidations = 0;
+  uint64_t inclusion_victims = 0;
+
+  // way partitioning, as of the end of the phase
+  std::vector<long> partition_ways{};
+  std::vector<long> partition_occupancy{};
+  uint64_t repartitions = 0;
+
+  // victim buffer
+  uint64_t victim_buffer_entries = 0;
+  uint64_t victim_buffer_hits = 0;
+  uint64_t victim_buffer_inserts = 0;
+  uint64_t victim_buffer_displaced = 0;
+
+  // set sampling
+  uint64_t sampled_sets = 0;
+  uint64_t total_sets = 0;
+  uint64_t sampled_hits = 0;
+  uint64_t sampled_misses = 0;
+  uint64_t oracle_hits = 0;
+  uint64_t oracle_misses = 0;
+
+  [[nodiscard]] bool is_set_sampled() const { return sampled_sets < total_sets; }
+  [[nodiscard]] double sampled_miss_ratio() const;
+  [[nodiscard]] double sampled_miss_ratio_confidence() const;
+  [[nodiscard]] double sampling_scale() const;
 };
 
 cache_stats operator-(cache_stats lhs, cache_stats rhs);
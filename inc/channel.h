@@ -27,6 +27,7 @@
 #include "access_type.h"
 #include "address.h"
 #include "champsim.h"
+#include "coherence.h"
 
 namespace champsim
 {
@@ -53,6 +54,9 @@ class channel
     bool forward_checked = false;
     bool is_translated = true;
     bool response_requested = true;
+    bool clean_writeback = false; // A writeback of a block that was not modified, sent only to an exclusive lower level
+    bool is_writeback = false;    // Data sent by a cache for a block that it held, rather than by a store
+    bool evicted = false;         // The sender and the levels above it no longer hold the block, so a directory below may stop tracking it
 
     uint8_t asid[2] = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
     access_type type{access_type::LOAD};
@@ -76,6 +80,9 @@ class channel
     uint32_t pf_metadata = 0;
     std::vector<uint64_t> instr_depend_on_me{};
 
+    // The permission granted to the upper level
+    champsim::coherence_state state = champsim::coherence_state::exclusive;
+
     response(champsim::address addr, champsim::address v_addr, champsim::address data_, uint32_t pf_meta, std::vector<uint64_t> deps)
         : address(addr), v_address(v_addr), data(data_), pf_metadata(pf_meta), instr_depend_on_me(deps)
     {
@@ -83,6 +90,13 @@ class channel
     explicit response(request req) : response(req.address, req.v_address, req.data, req.pf_metadata, req.instr_depend_on_me) {}
   };
 
+  // Sent from a directory to the upper levels that share a block
+  struct probe {
+    champsim::address address{};
+    uint32_t cpu = std::numeric_limits<uint32_t>::max();
+    champsim::probe_type type{champsim::probe_type::invalidate};
+  };
+
   template <typename R>
   bool do_add_queue(R& queue, std::size_t queue_size, const typename R::value_type& packet);
 
@@ -95,10 +109,12 @@ class channel
 public:
   using response_type = response;
   using request_type = request;
+  using probe_type = probe;
   using stats_type = cache_queue_stats;
 
   std::deque<request_type> RQ{}, PQ{}, WQ{};
   std::deque<response_type> returned{};
+  std::deque<probe_type> probes{};
 
   stats_type sim_stats{}, roi_stats{};
 
@@ -0,0 +1,42 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef COHERENCE_H
+#define COHERENCE_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace champsim
+{
+/**
+ * The MESI state of a block in a cache that is kept coherent by a directory.
+ * Caches that are not below a directory hold every block in the exclusive (or modified) state.
+ */
+enum class coherence_state : uint8_t { invalid = 0, shared, exclusive, modified };
+
+/**
+ * The kinds of probe that a lower level sends to the upper levels that may hold a block.
+ * A directory sends invalidations and downgrades, and an inclusive cache sends back-invalidations for the blocks that it evicts.
+ */
+enum class probe_type : uint8_t { invalidate = 0, downgrade, back_invalidate };
+
+using namespace std::literals::string_view_literals;
+inline constexpr std::array<std::string_view, 4> coherence_state_names{"I"sv, "S"sv, "E"sv, "M"sv};
+} // namespace champsim
+
+#endif
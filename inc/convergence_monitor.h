@@ -0,0 +1,106 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CONVERGENCE_MONITOR_H
+#define CONVERGENCE_MONITOR_H
+
+#include <optional>
+#include <vector>
+
+#include "cache_stats.h"
+#include "core_stats.h"
+#include "dram_stats.h"
+
+namespace champsim
+{
+struct environment;
+
+/**
+ * The options for ending a warmup once the behavior of the hierarchy has settled.
+ * The statistics are compared over windows of instructions, and the warmup ends once they change by no more than the tolerance for a number of
+ * windows in a row. The length of the phase is then the limit of the warmup.
+ */
+struct convergence_options {
+  long long window = 0; // The number of instructions in each window, on every CPU. If zero, the warmup runs for its full length.
+  double tolerance = 0.02;
+  long stable_windows = 3;
+};
+
+/**
+ * Decides when a warmup has converged, from the statistics of the hierarchy over windows of instructions.
+ *
+ * The metrics of each window are the branch MPKI of each CPU, the miss rate of each cache, and the row buffer hit rate of each DRAM channel.
+ * A metric is stable if it changes by no more than the tolerance from the previous window, relative to the previous value or to one, whichever
+ * is larger. Rates are therefore compared absolutely, and MPKI relatively. A metric with no events in either window is ignored.
+ */
+class convergence_monitor
+{
+public:
+  using metrics_type = std::vector<std::optional<double>>;
+
+  // The cumulative statistics of the phase at the end of a window
+  struct snapshot_type {
+    std::vector<cpu_stats> cpus{};
+    std::vector<cache_stats> caches{};
+    std::vector<dram_stats> dram{};
+  };
+
+private:
+  convergence_options options;
+  long long next_window;
+  long long completed_windows = 0;
+  long stable_windows = 0;
+  snapshot_type last_snapshot;
+  std::optional<metrics_type> last_metrics{};
+
+public:
+  convergence_monitor(convergence_options opts, snapshot_type initial);
+
+  /**
+   * Take the statistics of the phase so far. The instruction counts are taken as retired so far, rather than at the end of the phase.
+   */
+  [[nodiscard]] static snapshot_type snapshot(environment& env);
+
+  /**
+   * Find the metrics of the window between two snapshots
+   */
+  [[nodiscard]] static metrics_type window_metrics(const snapshot_type& begin, const snapshot_type& end);
+
+  /**
+   * Check whether every metric that was measured in both windows is within the tolerance of its previous value
+   */
+  [[nodiscard]] static bool is_stable(const metrics_type& previous, const metrics_type& current, double tolerance);
+
+  /**
+   * Record the end of a window
+   *
+   * :return: True if the warmup has converged
+   */
+  bool observe(snapshot_type snapshot);
+
+  /**
+   * Check whether every CPU has finished the current window, and if so, record it
+   *
+   * :return: True if the warmup has converged
+   */
+  bool operate(environment& env);
+
+  [[nodiscard]] bool converged() const;
+  [[nodiscard]] long long windows() const;
+};
+} // namespace champsim
+
+#endif
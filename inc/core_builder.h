@@ -17,10 +17,14 @@
 #ifndef CORE_BUILDER_H
 #define CORE_BUILDER_H
 
+#include <array>
 #include <cstdint>
 #include <limits>
+#include <optional>
+#include <vector>
 
 #include "chrono.h"
+#include "instruction.h"
 
 class CACHE;
 class O3_CPU;
@@ -31,6 +35,15 @@ template <typename...>
 class core_builder_module_type_holder
 {
 };
+
+/**
+ * The policies by which a core with several hardware threads chooses the thread to fetch from each cycle
+ */
+enum class thread_fetch_policy {
+  round_robin, // Each thread in turn
+  icount       // The thread with the fewest instructions in the front end and waiting to execute
+};
+
 namespace detail
 {
 struct core_builder_base {
@@ -49,6 +62,14 @@ struct core_builder_base {
   std::size_t m_rob_size{1};
   std::size_t m_lq_size{1};
   std::size_t m_sq_size{1};
+  std::size_t m_store_buffer_size{0};
+  std::size_t m_wrong_path_depth{0};
+  bool m_wrong_path_loads{false};
+  std::size_t m_ftq_size{0};
+
+  std::size_t m_threads{1};
+  thread_fetch_policy m_fetch_policy{thread_fetch_policy::icount};
+  bool m_partitioned_queues{false};
 
   champsim::bandwidth::maximum_type m_fetch_width{1};
   champsim::bandwidth::maximum_type m_decode_width{1};
@@ -57,17 +78,24 @@ struct core_builder_base {
   champsim::bandwidth::maximum_type m_execute_width{1};
   champsim::bandwidth::maximum_type m_lq_width{1};
   champsim::bandwidth::maximum_type m_sq_width{1};
+  champsim::bandwidth::maximum_type m_store_buffer_width{1};
   champsim::bandwidth::maximum_type m_retire_width{1};
   champsim::bandwidth::maximum_type m_dib_inorder_width{1};
 
   unsigned m_dib_hit_latency{};
 
   unsigned m_mispredict_penalty{};
+  unsigned m_violation_penalty{};
+  unsigned m_replay_penalty{};
   unsigned m_decode_latency{};
   unsigned m_dispatch_latency{};
   unsigned m_schedule_latency{};
   unsigned m_execute_latency{};
 
+  std::vector<std::vector<op_class>> m_execution_ports{};
+  std::array<std::optional<unsigned>, NUM_OP_CLASSES> m_op_latency{};
+  std::array<bool, NUM_OP_CLASSES> m_op_unpipelined{};
+
   CACHE* m_l1i{};
   champsim::bandwidth::maximum_type m_l1i_bw{1};
   champsim::bandwidth::maximum_type m_l1d_bw{1};
@@ -76,14 +104,15 @@ struct core_builder_base {
 };
 } // namespace detail
 
-template <typename B = core_builder_module_type_holder<>, typename T = core_builder_module_type_holder<>>
+template <typename B = core_builder_module_type_holder<>, typename T = core_builder_module_type_holder<>, typename D = core_builder_module_type_holder<>,
+          typename V = core_builder_module_type_holder<>>
 class core_builder : public detail::core_builder_base
 {
-  using self_type = core_builder<B, T>;
+  using self_type = core_builder<B, T, D, V>;
 
   friend class ::O3_CPU;
 
-  template <typename OTHER_B, typename OTHER_T>
+  template <typename OTHER_B, typename OTHER_T, typename OTHER_D, typename OTHER_V>
   friend class core_builder;
 
   explicit core_builder(const detail::core_builder_base& other) : detail::core_builder_base(other) {}
@@ -153,6 +182,11 @@ public:
    */
   self_type& sq_size(std::size_t sq_size_);
 
+  /**
+   * Specify the number of blocks in the write-combining store buffer between retirement and the L1D. If zero, retired stores are written directly.
+   */
+  self_type& store_buffer_size(std::size_t store_buffer_size_);
+
   /**
    * Specify the width of the instruction fetch.
    */
@@ -188,11 +222,59 @@ public:
    */
   self_type& sq_width(champsim::bandwidth::maximum_type sq_width_);
 
+  /**
+   * Specify the number of blocks that the store buffer may write to the L1D each cycle.
+   */
+  self_type& store_buffer_width(champsim::bandwidth::maximum_type store_buffer_width_);
+
   /**
    * Specify the width of the retirement.
    */
   self_type& retire_width(champsim::bandwidth::maximum_type retire_width_);
 
+  /**
+   * Specify the number of blocks that the core may fetch down the predicted path after a misprediction, before the branch resolves.
+   * If zero, fetch stalls until the branch resolves.
+   */
+  self_type& wrong_path_depth(std::size_t wrong_path_depth_);
+
+  /**
+   * Replay the recent loads of the blocks that are fetched down the wrong path.
+   */
+  self_type& set_wrong_path_loads();
+
+  /**
+   * Do not issue loads down the wrong path.
+   */
+  self_type& reset_wrong_path_loads();
+
+  /**
+   * Specify the number of fetch blocks that the branch predictor may run ahead of fetch, in the fetch target queue.
+   * If zero, branches are predicted as they are fetched.
+   */
+  self_type& ftq_size(std::size_t ftq_size_);
+
+  /**
+   * Specify the number of hardware threads, each of which runs its own trace.
+   * A core with more than one thread does not fetch down the wrong path, and does not have a fetch target queue.
+   */
+  self_type& threads(std::size_t threads_);
+
+  /**
+   * Specify the policy by which the core chooses the thread to fetch from each cycle.
+   */
+  self_type& fetch_policy(thread_fetch_policy fetch_policy_);
+
+  /**
+   * Divide the ROB, load queue, and store queue evenly between the hardware threads.
+   */
+  self_type& set_partitioned_queues();
+
+  /**
+   * Share the ROB, load queue, and store queue between the hardware threads.
+   */
+  self_type& reset_partitioned_queues();
+
   /**
    * Specify the maximum size of the DIB inorder width.
    */
@@ -205,6 +287,18 @@ public:
    */
   self_type& mispredict_penalty(unsigned mispredict_penalty_);
 
+  /**
+   * Specify the penalty, in cycles, for a load that issued before an older store to the same address.
+   * Fetch stalls for this long, as the pipeline is flushed after the load. This only applies with a memory dependence predictor.
+   */
+  self_type& violation_penalty(unsigned violation_penalty_);
+
+  /**
+   * Specify the penalty, in cycles, for a load whose value was mispredicted.
+   * Fetch stalls for this long, as the consumers of the load are replayed. This only applies with a value predictor.
+   */
+  self_type& replay_penalty(unsigned replay_penalty_);
+
   /**
    * Specify the latency of the decode.
    */
@@ -225,6 +319,22 @@ public:
    */
   self_type& execute_latency(unsigned execute_latency_);
 
+  /**
+   * Add an execution port, which issues one instruction each cycle of any of the given classes.
+   * If no ports are added, any instruction may issue up to the execute width.
+   */
+  self_type& add_execution_port(std::vector<op_class> classes_);
+
+  /**
+   * Specify the latency of execution for one class of instruction, in place of the execute latency.
+   */
+  self_type& op_latency(op_class op_, unsigned latency_);
+
+  /**
+   * Specify that one class of instruction is not pipelined, so that it holds its port for the whole of its latency.
+   */
+  self_type& unpipelined_op(op_class op_);
+
   /**
    * Specify the latency of execution.
    */
@@ -259,259 +369,390 @@ public:
    * Specify the branch direction predictor.
    */
   template <typename... Bs>
-  core_builder<core_builder_module_type_holder<Bs...>, T> branch_predictor();
+  core_builder<core_builder_module_type_holder<Bs...>, T, D, V> branch_predictor();
 
   /**
    * Specify the branch target predictor.
    */
   template <typename... Ts>
-  core_builder<B, core_builder_module_type_holder<Ts...>> btb();
+  core_builder<B, core_builder_module_type_holder<Ts...>, D, V> btb();
+
+  /**
+   * Specify the memory dependence predictor. If none is given, each load waits for exactly the older stores to its address.
+   */
+  template <typename... Ds>
+  core_builder<B, T, core_builder_module_type_holder<Ds...>, V> memory_dependence_predictor();
+
+  /**
+   * Specify the load value predictor. If none is given, the consumers of each load wait for it to complete.
+   */
+  template <typename... Vs>
+  core_builder<B, T, D, core_builder_module_type_holder<Vs...>> value_predictor();
 };
 } // namespace champsim
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::index(uint32_t cpu_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::index(uint32_t cpu_) -> self_type&
 {
   m_cpu = cpu_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::clock_period(champsim::chrono::picoseconds clock_period_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::clock_period(champsim::chrono::picoseconds clock_period_) -> self_type&
 {
   m_clock_period = clock_period_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::dib_set(std::size_t dib_set_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::dib_set(std::size_t dib_set_) -> self_type&
 {
   m_dib_set = dib_set_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::dib_way(std::size_t dib_way_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::dib_way(std::size_t dib_way_) -> self_type&
 {
   m_dib_way = dib_way_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::dib_window(std::size_t dib_window_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::dib_window(std::size_t dib_window_) -> self_type&
 {
   m_dib_window = dib_window_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::ifetch_buffer_size(std::size_t ifetch_buffer_size_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::ifetch_buffer_size(std::size_t ifetch_buffer_size_) -> self_type&
 {
   m_ifetch_buffer_size = ifetch_buffer_size_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::decode_buffer_size(std::size_t decode_buffer_size_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::decode_buffer_size(std::size_t decode_buffer_size_) -> self_type&
 {
   m_decode_buffer_size = decode_buffer_size_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::dispatch_buffer_size(std::size_t dispatch_buffer_size_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::dispatch_buffer_size(std::size_t dispatch_buffer_size_) -> self_type&
 {
   m_dispatch_buffer_size = dispatch_buffer_size_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::register_file_size(std::size_t register_file_size_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::register_file_size(std::size_t register_file_size_) -> self_type&
 {
   m_register_file_size = register_file_size_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::rob_size(std::size_t rob_size_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::rob_size(std::size_t rob_size_) -> self_type&
 {
   m_rob_size = rob_size_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::dib_hit_buffer_size(std::size_t dib_hit_buffer_size_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::dib_hit_buffer_size(std::size_t dib_hit_buffer_size_) -> self_type&
 {
   m_dib_hit_buffer_size = dib_hit_buffer_size_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::lq_size(std::size_t lq_size_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::lq_size(std::size_t lq_size_) -> self_type&
 {
   m_lq_size = lq_size_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::sq_size(std::size_t sq_size_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::sq_size(std::size_t sq_size_) -> self_type&
 {
   m_sq_size = sq_size_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::fetch_width(champsim::bandwidth::maximum_type fetch_width_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::store_buffer_size(std::size_t store_buffer_size_) -> self_type&
+{
+  m_store_buffer_size = store_buffer_size_;
+  return *this;
+}
+
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::fetch_width(champsim::bandwidth::maximum_type fetch_width_) -> self_type&
 {
   m_fetch_width = fetch_width_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::decode_width(champsim::bandwidth::maximum_type decode_width_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::decode_width(champsim::bandwidth::maximum_type decode_width_) -> self_type&
 {
   m_decode_width = decode_width_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::dispatch_width(champsim::bandwidth::maximum_type dispatch_width_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::dispatch_width(champsim::bandwidth::maximum_type dispatch_width_) -> self_type&
 {
   m_dispatch_width = dispatch_width_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::schedule_width(champsim::bandwidth::maximum_type schedule_width_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::schedule_width(champsim::bandwidth::maximum_type schedule_width_) -> self_type&
 {
   m_schedule_width = schedule_width_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::execute_width(champsim::bandwidth::maximum_type execute_width_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::execute_width(champsim::bandwidth::maximum_type execute_width_) -> self_type&
 {
   m_execute_width = execute_width_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::lq_width(champsim::bandwidth::maximum_type lq_width_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::lq_width(champsim::bandwidth::maximum_type lq_width_) -> self_type&
 {
   m_lq_width = lq_width_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::sq_width(champsim::bandwidth::maximum_type sq_width_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::sq_width(champsim::bandwidth::maximum_type sq_width_) -> self_type&
 {
   m_sq_width = sq_width_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::retire_width(champsim::bandwidth::maximum_type retire_width_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::store_buffer_width(champsim::bandwidth::maximum_type store_buffer_width_) -> self_type&
+{
+  m_store_buffer_width = store_buffer_width_;
+  return *this;
+}
+
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::wrong_path_depth(std::size_t wrong_path_depth_) -> self_type&
+{
+  m_wrong_path_depth = wrong_path_depth_;
+  return *this;
+}
+
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::set_wrong_path_loads() -> self_type&
+{
+  m_wrong_path_loads = true;
+  return *this;
+}
+
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::reset_wrong_path_loads() -> self_type&
+{
+  m_wrong_path_loads = false;
+  return *this;
+}
+
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::ftq_size(std::size_t ftq_size_) -> self_type&
+{
+  m_ftq_size = ftq_size_;
+  return *this;
+}
+
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::threads(std::size_t threads_) -> self_type&
+{
+  m_threads = threads_;
+  return *this;
+}
+
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::fetch_policy(thread_fetch_policy fetch_policy_) -> self_type&
+{
+  m_fetch_policy = fetch_policy_;
+  return *this;
+}
+
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::set_partitioned_queues() -> self_type&
+{
+  m_partitioned_queues = true;
+  return *this;
+}
+
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::reset_partitioned_queues() -> self_type&
+{
+  m_partitioned_queues = false;
+  return *this;
+}
+
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::retire_width(champsim::bandwidth::maximum_type retire_width_) -> self_type&
 {
   m_retire_width = retire_width_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::dib_inorder_width(champsim::bandwidth::maximum_type dib_inorder_width_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::dib_inorder_width(champsim::bandwidth::maximum_type dib_inorder_width_) -> self_type&
 {
   m_dib_inorder_width = dib_inorder_width_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::mispredict_penalty(unsigned mispredict_penalty_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::mispredict_penalty(unsigned mispredict_penalty_) -> self_type&
 {
   m_mispredict_penalty = mispredict_penalty_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::decode_latency(unsigned decode_latency_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::violation_penalty(unsigned violation_penalty_) -> self_type&
+{
+  m_violation_penalty = violation_penalty_;
+  return *this;
+}
+
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::replay_penalty(unsigned replay_penalty_) -> self_type&
+{
+  m_replay_penalty = replay_penalty_;
+  return *this;
+}
+
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::decode_latency(unsigned decode_latency_) -> self_type&
 {
   m_decode_latency = decode_latency_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::dib_hit_latency(unsigned dib_hit_latency_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::dib_hit_latency(unsigned dib_hit_latency_) -> self_type&
 {
   m_dib_hit_latency = dib_hit_latency_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::dispatch_latency(unsigned dispatch_latency_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::dispatch_latency(unsigned dispatch_latency_) -> self_type&
 {
   m_dispatch_latency = dispatch_latency_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::schedule_latency(unsigned schedule_latency_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::schedule_latency(unsigned schedule_latency_) -> self_type&
 {
   m_schedule_latency = schedule_latency_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::execute_latency(unsigned execute_latency_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::execute_latency(unsigned execute_latency_) -> self_type&
 {
   m_execute_latency = execute_latency_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::l1i(CACHE* l1i_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::add_execution_port(std::vector<op_class> classes_) -> self_type&
+{
+  m_execution_ports.push_back(std::move(classes_));
+  return *this;
+}
+
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::op_latency(op_class op_, unsigned latency_) -> self_type&
+{
+  m_op_latency.at(op_) = latency_;
+  return *this;
+}
+
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::unpipelined_op(op_class op_) -> self_type&
+{
+  m_op_unpipelined.at(op_) = true;
+  return *this;
+}
+
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::l1i(CACHE* l1i_) -> self_type&
 {
   m_l1i = l1i_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::l1i_bandwidth(champsim::bandwidth::maximum_type l1i_bw_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::l1i_bandwidth(champsim::bandwidth::maximum_type l1i_bw_) -> self_type&
 {
   m_l1i_bw = l1i_bw_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::l1d_bandwidth(champsim::bandwidth::maximum_type l1d_bw_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::l1d_bandwidth(champsim::bandwidth::maximum_type l1d_bw_) -> self_type&
 {
   m_l1d_bw = l1d_bw_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::fetch_queues(champsim::channel* fetch_queues_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::fetch_queues(champsim::channel* fetch_queues_) -> self_type&
 {
   m_fetch_queues = fetch_queues_;
   return *this;
 }
 
-template <typename B, typename T>
-auto champsim::core_builder<B, T>::data_queues(champsim::channel* data_queues_) -> self_type&
+template <typename B, typename T, typename D, typename V>
+auto champsim::core_builder<B, T, D, V>::data_queues(champsim::channel* data_queues_) -> self_type&
 {
   m_data_queues = data_queues_;
   return *this;
 }
 
-template <typename B, typename T>
+template <typename B, typename T, typename D, typename V>
 template <typename... Bs>
-auto champsim::core_builder<B, T>::branch_predictor() -> champsim::core_builder<core_builder_module_type_holder<Bs...>, T>
+auto champsim::core_builder<B, T, D, V>::branch_predictor() -> champsim::core_builder<core_builder_module_type_holder<Bs...>, T, D, V>
 {
-  return champsim::core_builder<core_builder_module_type_holder<Bs...>, T>{*this};
+  return champsim::core_builder<core_builder_module_type_holder<Bs...>, T, D, V>{*this};
 }
 
-template <typename B, typename T>
+template <typename B, typename T, typename D, typename V>
 template <typename... Ts>
-auto champsim::core_builder<B, T>::btb() -> champsim::core_builder<B, core_builder_module_type_holder<Ts...>>
+auto champsim::core_builder<B, T, D, V>::btb() -> champsim::core_builder<B, core_builder_module_type_holder<Ts...>, D, V>
+{
+  return champsim::core_builder<B, core_builder_module_type_holder<Ts...>, D, V>{*this};
+}
+
+template <typename B, typename T, typename D, typename V>
+template <typename... Ds>
+auto champsim::core_builder<B, T, D, V>::memory_dependence_predictor() -> champsim::core_builder<B, T, core_builder_module_type_holder<Ds...>, V>
+{
+  return champsim::core_builder<B, T, core_builder_module_type_holder<Ds...>, V>{*this};
+}
+
+template <typename B, typename T, typename D, typename V>
+template <typename... Vs>
+auto champsim::core_builder<B, T, D, V>::value_predictor() -> champsim::core_builder<B, T, D, core_builder_module_type_holder<Vs...>>
 {
-  return champsim::core_builder<B, core_builder_module_type_holder<Ts...>>{*this};
+  return champsim::core_builder<B, T, D, core_builder_module_type_holder<Vs...>>{*this};
 }
 
 #endif
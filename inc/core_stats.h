@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "event_counter.h"
 #include "instruction.h"
@@ -13,13 +14,51 @@ struct cpu_stats {
   long long begin_cycles = 0;
   long long end_instrs = 0;
   long long end_cycles = 0;
+
+  // The instructions retired by each hardware thread, if the core has more than one
+  std::vector<long long> thread_begin_instrs{};
+  std::vector<long long> thread_end_instrs{};
   uint64_t total_rob_occupancy_at_branch_mispredict = 0;
 
+  // write-combining store buffer
+  uint64_t store_buffer_stores = 0;
+  uint64_t store_buffer_coalesced = 0;
+  uint64_t store_buffer_writes = 0;
+  uint64_t store_buffer_full_stalls = 0;
+  uint64_t store_buffer_forwards = 0;
+
+  // wrong-path fetch
+  uint64_t wrong_path_episodes = 0;
+  uint64_t wrong_path_fetches = 0;
+  uint64_t wrong_path_loads = 0;
+
+  // decoupled front end
+  uint64_t ftq_occupancy = 0; // The sum over cycles of the entries in the FTQ
+  uint64_t fdip_prefetches = 0;
+  uint64_t fdip_lead_cycles = 0;  // The sum of the cycles between each prefetch and the fetch of its block
+  uint64_t fdip_unprefetched = 0; // Blocks that were fetched before a prefetch could be issued for them
+
+  // memory dependence prediction
+  uint64_t dependence_predicted_waits = 0; // Loads that waited for the store they read from
+  uint64_t dependence_false_waits = 0;     // Loads that waited for a store they do not read from
+  uint64_t dependence_violations = 0;      // Loads that issued before the store they read from
+
+  // value prediction
+  uint64_t value_predictions = 0;      // Loads whose consumers were woken with a predicted outcome
+  uint64_t value_mispredictions = 0;   // Predicted loads whose consumers were replayed
+  uint64_t address_predictions = 0;    // Loads that issued early to a predicted address
+  uint64_t address_mispredictions = 0; // Loads whose predicted address was not the address they read
+
   champsim::stats::event_counter<branch_type> total_branch_types = {};
   champsim::stats::event_counter<branch_type> branch_type_misses = {};
 
+  // execution ports
+  champsim::stats::event_counter<std::size_t> port_issues = {};   // The instructions issued by each port
+  champsim::stats::event_counter<op_class> port_contention = {}; // The cycles that ready instructions of each class waited for a port
+
   [[nodiscard]] auto instrs() const { return end_instrs - begin_instrs; }
   [[nodiscard]] auto cycles() const { return end_cycles - begin_cycles; }
+  [[nodiscard]] auto thread_instrs(std::size_t thread) const { return thread_end_instrs.at(thread) - thread_begin_instrs.at(thread); }
 };
 
 cpu_stats operator-(cpu_stats lhs, cpu_stats rhs);
@@ -0,0 +1,123 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FUNCTIONAL_WARMUP_H
+#define FUNCTIONAL_WARMUP_H
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "address.h"
+#include "channel.h"
+
+class CACHE;
+class O3_CPU;
+class VirtualMemory;
+struct ooo_model_instr;
+
+namespace champsim
+{
+struct environment;
+class slice_router;
+
+/**
+ * Warms the caches, branch predictors, and prefetchers with the instructions of a trace, without any timing.
+ *
+ * The instruction and data addresses of each instruction are looked up directly in the tag arrays of the hierarchy. Misses are filled at once,
+ * and the requests that each level sends to the next, including writebacks and prefetches, are followed to the last level of cache.
+ * Translations are taken from the virtual memory, and are looked up in the TLBs on the way.
+ * There are no queues, MSHRs, or bandwidth limits, so no time passes.
+ *
+ * With more than one thread, the lower levels are warmed in a pipeline beside the cores. The caches that the cores and the TLBs read, and every
+ * cache above them, are warmed in program order on the calling thread. The others are grouped by their distance from it into stages, each with
+ * its own thread. A stage receives the requests to its caches in batches, in the order that they would have been made, and splits each batch by
+ * set index among its threads, which are started once and wait for each batch. This is exact only for caches whose modules touch no state outside of the set, so other caches are warmed
+ * in order by a single thread of the stage. The contents of every cache are the same as if the hierarchy had been warmed in order.
+ */
+class functional_warmup
+{
+  using channel_type = champsim::channel;
+  using request_type = typename channel_type::request_type;
+
+  std::unordered_map<const channel_type*, CACHE*> caches{}; // The cache that serves each channel
+  std::vector<const champsim::slice_router*> routers{};
+  VirtualMemory* vmem = nullptr;
+
+  std::vector<std::optional<champsim::block_number>> last_fetch; // The block that each CPU fetched most recently
+
+  struct pending_type {
+    CACHE* cache;
+    request_type req;
+  };
+  struct placement_type {
+    std::size_t stage;
+    bool set_local;
+  };
+  struct stage_type;
+
+  constexpr static std::size_t BATCH_SIZE = 1 << 14;
+  constexpr static std::size_t MAX_BATCHES = 4; // The number of batches that may wait for each stage
+
+  std::size_t num_threads;
+  std::unordered_map<const CACHE*, placement_type> placement{}; // The caches that are warmed beside the cores
+  std::vector<std::unique_ptr<stage_type>> stages{};
+  std::vector<pending_type> outgoing{}; // The requests to the first stage that are not yet sent
+
+  [[nodiscard]] CACHE* find_cache(const channel_type* channel, champsim::address address) const;
+  [[nodiscard]] std::vector<CACHE*> caches_below(const channel_type* channel) const;
+  void place_caches(environment& env);
+
+  void access(const channel_type* channel, request_type req);
+  champsim::address translate(const channel_type* translate_channel, uint32_t cpu, champsim::address v_address);
+
+  void send(std::size_t stage, std::vector<pending_type> batch);
+  void run_stage(std::size_t stage);
+  void run_shard(std::size_t stage, std::size_t shard);
+  std::vector<pending_type> process(std::size_t stage, const std::vector<pending_type>& batch);
+  void process_shard(std::size_t stage, const std::vector<pending_type>& batch, std::size_t shard,
+                     std::vector<std::pair<std::size_t, pending_type>>& result) const;
+
+public:
+  /**
+   * :param env: The environment to warm
+   * :param threads: The number of threads that warm each stage of the lower levels. If one, the hierarchy is warmed on the calling thread.
+   */
+  explicit functional_warmup(environment& env, std::size_t threads = 1);
+  ~functional_warmup();
+
+  functional_warmup(const functional_warmup&) = delete;
+  functional_warmup& operator=(const functional_warmup&) = delete;
+  functional_warmup(functional_warmup&&) = delete;
+  functional_warmup& operator=(functional_warmup&&) = delete;
+
+  /**
+   * Wait until the lower levels have been warmed with every instruction so far.
+   * The hierarchy must be drained before its state or its statistics are read.
+   */
+  void drain();
+
+  /**
+   * Warm the hierarchy of a CPU with one instruction, and retire it
+   */
+  void operate(O3_CPU& cpu, ooo_model_instr& instr);
+};
+} // namespace champsim
+
+#endif
@@ -17,8 +17,12 @@
 #ifndef INF_STREAM_H
 #define INF_STREAM_H
 
+#include <algorithm>
+#include <array>
 #include <bzlib.h>
 #include <cassert>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <lzma.h>
 #include <memory>
@@ -116,7 +120,8 @@ struct gzip_tag_t {
   {
     deflate_state_type state{new state_type};
     *state = state_type{Z_NULL, 0, 0, Z_NULL, 0, 0, NULL, NULL, Z_NULL, Z_NULL, Z_NULL, 0, 0UL, 0UL};
-    ::deflateInit(state.get(), compression);
+    constexpr int default_mem_level = 8;
+    ::deflateInit2(state.get(), compression, Z_DEFLATED, window, default_mem_level, Z_DEFAULT_STRATEGY);
     return state;
   }
 
@@ -283,6 +288,70 @@ auto inf_istream<T, S>::inf_streambuf<I>::underflow() -> int_type
              std::next(this->out_buf.data(), static_cast<std::make_signed_t<decltype(bytes_remaining)>>(bytes_remaining)));
   return base_type::traits_type::to_int_type(this->out_buf.front());
 }
+
+template <typename Tag, typename StreamType = std::ofstream>
+class def_ostream
+{
+  using strm_in_buf_type = typename Tag::in_char_type;
+  using strm_out_buf_type = typename Tag::out_char_type;
+
+  constexpr static std::size_t CHUNK = (1 << 16);
+
+  std::array<strm_in_buf_type, CHUNK> in_buf;
+  std::array<typename StreamType::char_type, CHUNK> out_buf; // Held as the stream's characters, so that it is written without a copy
+  typename Tag::deflate_state_type strm = Tag::new_deflate_state();
+  std::unique_ptr<StreamType> underlying;
+
+  void deflate_chunk(std::size_t count, bool flush);
+
+public:
+  explicit def_ostream(std::string s) : underlying(std::make_unique<StreamType>(s, std::ios::binary)) {}
+  explicit def_ostream(StreamType&& str) : underlying(std::make_unique<StreamType>(std::move(str))) {}
+
+  def_ostream(const def_ostream&) = delete;
+  def_ostream& operator=(const def_ostream&) = delete;
+
+  // Finish the compressed stream, so that it can be read without the writer
+  ~def_ostream() { deflate_chunk(0, true); }
+
+  def_ostream& write(const char* s, std::streamsize count)
+  {
+    assert(count >= 0);
+    auto remaining = static_cast<std::size_t>(count);
+    while (remaining > 0) {
+      auto chunk_size = std::min(remaining, CHUNK);
+      std::memcpy(in_buf.data(), s, chunk_size);
+      deflate_chunk(chunk_size, false);
+      s += chunk_size;
+      remaining -= chunk_size;
+    }
+    return *this;
+  }
+
+  [[nodiscard]] bool fail() const { return underlying->fail(); }
+};
+
+template <typename T, typename S>
+void def_ostream<T, S>::deflate_chunk(std::size_t count, bool flush)
+{
+  strm->avail_in = static_cast<unsigned>(count);
+  strm->next_in = in_buf.data();
+
+  auto result = T::status_type::CAN_CONTINUE;
+  do {
+    strm->avail_out = static_cast<unsigned>(out_buf.size());
+    strm->next_out = reinterpret_cast<strm_out_buf_type*>(out_buf.data());
+
+    // Perform deflation
+    result = T::deflate(strm, flush);
+    assert(result == T::status_type::CAN_CONTINUE || result == T::status_type::END);
+
+    auto bytes_written = std::size(out_buf) - strm->avail_out;
+    underlying->write(out_buf.data(), static_cast<std::streamsize>(bytes_written));
+  }
+  // Repeat until all of the input is consumed, and the stream is finished if flushing
+  while (strm->avail_in > 0 || (flush && result != T::status_type::END));
+}
 } // namespace champsim
 
 #endif
@@ -0,0 +1,290 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INSTR_POOL_H
+#define INSTR_POOL_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "instruction.h"
+
+namespace champsim
+{
+/**
+ * The instructions that are in flight in one core, from fetch to retirement.
+ *
+ * An instruction is placed in the pool when it is fetched, and stays in the same place until it retires. The stages of the pipeline refer to it by
+ * its handle, so it is never copied between them, and a reference to it remains valid for as long as it is in flight.
+ * The pool is allocated to hold as many instructions as the stages can. It grows if that is exceeded, without moving any instruction.
+ */
+class instr_pool
+{
+public:
+  using handle_type = std::size_t;
+
+private:
+  std::deque<std::optional<ooo_model_instr>> storage;
+  std::vector<handle_type> free_list{}; // The next handle to allocate is at the back
+
+public:
+  explicit instr_pool(std::size_t capacity);
+
+  /**
+   * Place an instruction in the pool
+   *
+   * :return: The handle of the instruction
+   */
+  handle_type allocate(ooo_model_instr instr);
+
+  /**
+   * Remove an instruction from the pool. Its handle may then be reused.
+   */
+  void release(handle_type handle);
+
+  [[nodiscard]] ooo_model_instr& operator[](handle_type handle);
+  [[nodiscard]] const ooo_model_instr& operator[](handle_type handle) const;
+
+  [[nodiscard]] std::size_t size() const;
+  [[nodiscard]] std::size_t capacity() const;
+};
+
+/**
+ * A queue between stages of the pipeline, held as a ring buffer of handles into an instruction pool.
+ *
+ * Instructions are passed between queues by handle with ``push_back_handle()`` and ``pop_front_handle()``.
+ * The queue otherwise behaves as a sequence of instructions: ``push_back()`` and ``insert()`` place new instructions in the pool, and ``pop_front()``
+ * and ``erase()`` remove them from it. Instructions may only be removed from the front, except by ``remove_if()`` and ``extract_if()``.
+ * The capacity is that of the stage, but the queue grows if it is exceeded, since a stage may be filled directly.
+ * The queue counts the instructions of each hardware thread as they enter and leave it.
+ */
+class instr_queue
+{
+  template <typename Q, typename V>
+  class iterator_base
+  {
+    friend class instr_queue;
+
+    Q* queue = nullptr;
+    std::ptrdiff_t pos = 0;
+
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = ooo_model_instr;
+    using difference_type = std::ptrdiff_t;
+    using pointer = V*;
+    using reference = V&;
+
+    iterator_base() = default;
+    iterator_base(Q* q, std::ptrdiff_t p) : queue(q), pos(p) {}
+
+    // A mutable iterator converts to a const iterator
+    template <typename OQ, typename OV, typename = std::enable_if_t<std::is_const_v<Q> && !std::is_const_v<OQ>>>
+    iterator_base(iterator_base<OQ, OV> other) : queue(other.queue), pos(other.pos) // NOLINT(google-explicit-constructor)
+    {
+    }
+
+    reference operator*() const { return (*queue)[static_cast<std::size_t>(pos)]; }
+    pointer operator->() const { return &(**this); }
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    iterator_base& operator++()
+    {
+      ++pos;
+      return *this;
+    }
+    iterator_base operator++(int)
+    {
+      auto retval = *this;
+      ++pos;
+      return retval;
+    }
+    iterator_base& operator--()
+    {
+      --pos;
+      return *this;
+    }
+    iterator_base operator--(int)
+    {
+      auto retval = *this;
+      --pos;
+      return retval;
+    }
+    iterator_base& operator+=(difference_type n)
+    {
+      pos += n;
+      return *this;
+    }
+    iterator_base& operator-=(difference_type n)
+    {
+      pos -= n;
+      return *this;
+    }
+
+    friend iterator_base operator+(iterator_base it, difference_type n) { return it += n; }
+    friend iterator_base operator+(difference_type n, iterator_base it) { return it += n; }
+    friend iterator_base operator-(iterator_base it, difference_type n) { return it -= n; }
+    friend difference_type operator-(const iterator_base& lhs, const iterator_base& rhs) { return lhs.pos - rhs.pos; }
+
+    friend bool operator==(const iterator_base& lhs, const iterator_base& rhs) { return lhs.pos == rhs.pos; }
+    friend bool operator!=(const iterator_base& lhs, const iterator_base& rhs) { return lhs.pos != rhs.pos; }
+    friend bool operator<(const iterator_base& lhs, const iterator_base& rhs) { return lhs.pos < rhs.pos; }
+    friend bool operator>(const iterator_base& lhs, const iterator_base& rhs) { return lhs.pos > rhs.pos; }
+    friend bool operator<=(const iterator_base& lhs, const iterator_base& rhs) { return lhs.pos <= rhs.pos; }
+    friend bool operator>=(const iterator_base& lhs, const iterator_base& rhs) { return lhs.pos >= rhs.pos; }
+
+    template <typename, typename>
+    friend class iterator_base;
+  };
+
+public:
+  using handle_type = instr_pool::handle_type;
+  using value_type = ooo_model_instr;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using iterator = iterator_base<instr_queue, value_type>;
+  using const_iterator = iterator_base<const instr_queue, const value_type>;
+
+private:
+  instr_pool* pool;
+  std::vector<handle_type> ring;
+  std::size_t head = 0;
+  std::size_t count = 0;
+  std::vector<size_type> thread_counts{};
+
+  [[nodiscard]] std::size_t slot(size_type pos) const;
+  void grow();
+  void count_in(handle_type handle);
+  void count_out(handle_type handle);
+
+public:
+  instr_queue(instr_pool& instrs, std::size_t capacity);
+
+  /**
+   * Append an instruction that is already in the pool
+   */
+  void push_back_handle(handle_type handle);
+
+  /**
+   * Remove the first instruction from the queue, but not from the pool
+   *
+   * :return: The handle of the instruction
+   */
+  handle_type pop_front_handle();
+
+  void push_back(value_type instr);
+  template <typename It>
+  iterator insert(const_iterator pos, It first, It last);
+  void pop_front();
+  iterator erase(const_iterator first, const_iterator last);
+
+  /**
+   * Remove the instructions that satisfy the predicate, wherever they are in the queue. The others keep their order.
+   *
+   * :return: The number of instructions removed
+   */
+  template <typename Pred>
+  size_type remove_if(Pred pred);
+
+  /**
+   * Remove the instructions that satisfy the predicate, wherever they are in the queue, but not from the pool. The others keep their order.
+   *
+   * :return: The handles of the instructions removed, in order
+   */
+  template <typename Pred>
+  std::vector<handle_type> extract_if(Pred pred);
+
+  [[nodiscard]] reference operator[](size_type pos);
+  [[nodiscard]] const_reference operator[](size_type pos) const;
+  [[nodiscard]] reference at(size_type pos);
+  [[nodiscard]] const_reference at(size_type pos) const;
+  [[nodiscard]] reference front() { return (*this)[0]; }
+  [[nodiscard]] const_reference front() const { return (*this)[0]; }
+  [[nodiscard]] reference back() { return (*this)[count - 1]; }
+  [[nodiscard]] const_reference back() const { return (*this)[count - 1]; }
+
+  [[nodiscard]] iterator begin() { return {this, 0}; }
+  [[nodiscard]] iterator end() { return {this, static_cast<difference_type>(count)}; }
+  [[nodiscard]] const_iterator begin() const { return {this, 0}; }
+  [[nodiscard]] const_iterator end() const { return {this, static_cast<difference_type>(count)}; }
+  [[nodiscard]] const_iterator cbegin() const { return begin(); }
+  [[nodiscard]] const_iterator cend() const { return end(); }
+
+  [[nodiscard]] size_type size() const { return count; }
+  [[nodiscard]] bool empty() const { return count == 0; }
+
+  /**
+   * :return: The number of instructions in the queue from a hardware thread
+   */
+  [[nodiscard]] size_type count_of(std::size_t thread) const { return thread < std::size(thread_counts) ? thread_counts[thread] : 0; }
+};
+
+template <typename It>
+auto instr_queue::insert(const_iterator pos, It first, It last) -> iterator
+{
+  assert(pos == cend()); // Instructions may only be appended
+  auto retval = iterator{this, pos.pos};
+  std::for_each(first, last, [this](const auto& instr) { this->push_back(instr); });
+  return retval;
+}
+
+template <typename Pred>
+auto instr_queue::remove_if(Pred pred) -> size_type
+{
+  size_type kept = 0;
+  for (size_type pos = 0; pos < count; ++pos) {
+    auto handle = ring[slot(pos)];
+    if (pred(std::as_const((*pool)[handle]))) {
+      count_out(handle);
+      pool->release(handle);
+    } else {
+      ring[slot(kept)] = handle;
+      ++kept;
+    }
+  }
+  return std::exchange(count, kept) - kept;
+}
+
+template <typename Pred>
+auto instr_queue::extract_if(Pred pred) -> std::vector<handle_type>
+{
+  std::vector<handle_type> extracted;
+  size_type kept = 0;
+  for (size_type pos = 0; pos < count; ++pos) {
+    auto handle = ring[slot(pos)];
+    if (pred(std::as_const((*pool)[handle]))) {
+      count_out(handle);
+      extracted.push_back(handle);
+    } else {
+      ring[slot(kept)] = handle;
+      ++kept;
+    }
+  }
+  count = kept;
+  return extracted;
+}
+} // namespace champsim
+
+#endif
@@ -22,6 +22,7 @@
 #include <cstdint>
 #include <functional>
 #include <limits>
+#include <optional>
 #include <string_view>
 #include <vector>
 
@@ -42,11 +43,15 @@ enum branch_type {
   NOT_BRANCH
 };
 
+// the classes of functional unit that execute instructions
+enum op_class { OP_ALU = 0, OP_SLOW_ALU, OP_FP, OP_LOAD, OP_STORE, OP_BRANCH, NUM_OP_CLASSES };
+
 using PHYSICAL_REGISTER_ID = int16_t; // signed to use -1 to indicate no physical register
 
 using namespace std::literals::string_view_literals;
 inline constexpr std::array branch_type_names{"BRANCH_DIRECT_JUMP"sv, "BRANCH_INDIRECT"sv,      "BRANCH_CONDITIONAL"sv,
                                               "BRANCH_DIRECT_CALL"sv, "BRANCH_INDIRECT_CALL"sv, "BRANCH_RETURN"sv};
+inline constexpr std::array op_class_names{"ALU"sv, "SLOW_ALU"sv, "FP"sv, "LOAD"sv, "STORE"sv, "BRANCH"sv};
 
 namespace champsim
 {
@@ -104,10 +109,13 @@ struct ooo_model_instr : champsim::program_ordered<ooo_model_instr> {
   bool branch_mispredicted = false; // A branch can be mispredicted even if the direction prediction is correct when the predicted target is not correct
 
   std::array<uint8_t, 2> asid = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
+  std::size_t thread = 0; // The hardware thread of the core that runs this instruction
 
   branch_type branch{NOT_BRANCH};
   champsim::address branch_target{};
 
+  op_class op{OP_ALU};
+
   bool dib_checked = false;
   bool fetch_issued = false;
   bool fetch_completed = false;
@@ -117,7 +125,7 @@ struct ooo_model_instr : champsim::program_ordered<ooo_model_instr> {
   bool completed = false;
 
   unsigned completed_mem_ops = 0;
-  int num_reg_dependent = 0;
+  int num_reg_dependent = 0; // The source registers that are not yet valid, once scheduled
 
   std::vector<PHYSICAL_REGISTER_ID> destination_registers = {}; // output registers
   std::vector<PHYSICAL_REGISTER_ID> source_registers = {};      // input registers
@@ -125,6 +133,11 @@ struct ooo_model_instr : champsim::program_ordered<ooo_model_instr> {
   std::vector<champsim::address> destination_memory = {};
   std::vector<champsim::address> source_memory = {};
 
+  std::optional<uint64_t> load_value{};                 // The value read by the first load, if the trace records it
+  std::optional<uint64_t> predicted_load{};             // The predicted value of the first load
+  std::optional<champsim::address> predicted_address{}; // The predicted address of the first load, to which it issued early
+  bool load_reported = false;                           // The outcome of the first load has been checked and given to the value predictor
+
   // these are indices of instructions in the ROB that depend on me
   std::vector<std::reference_wrapper<ooo_model_instr>> registers_instrs_depend_on_me;
 
@@ -189,11 +202,31 @@ private:
     } else {
       branch_taken = false;
     }
+
+    if (is_branch) {
+      op = OP_BRANCH;
+    } else if (!std::empty(source_memory)) {
+      op = OP_LOAD;
+    } else if (!std::empty(destination_memory)) {
+      op = OP_STORE;
+    }
   }
 
 public:
   ooo_model_instr(uint8_t cpu, input_instr instr) : ooo_model_instr(instr, {cpu, cpu}) {}
   ooo_model_instr(uint8_t /*cpu*/, cloudsuite_instr instr) : ooo_model_instr(instr, {instr.asid[0], instr.asid[1]}) {}
+  ooo_model_instr(uint8_t cpu, value_instr instr) : ooo_model_instr(instr, {cpu, cpu})
+  {
+    if (!std::empty(source_memory)) {
+      load_value = instr.load_value;
+    }
+
+    if (op == OP_ALU && instr.instr_class == champsim::INSTR_CLASS_FP) {
+      op = OP_FP;
+    } else if (op == OP_ALU && instr.instr_class == champsim::INSTR_CLASS_SLOW_ALU) {
+      op = OP_SLOW_ALU;
+    }
+  }
 
   [[nodiscard]] std::size_t num_mem_ops() const { return std::size(destination_memory) + std::size(source_memory); }
 };
@@ -18,8 +18,10 @@
 #define MODULES_H
 
 #include <cstdint>
+#include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "access_type.h"
 #include "address.h"
@@ -99,6 +101,86 @@ struct btb : public bound_to<O3_CPU> {
   constexpr static bool has_btb_prediction = decltype(predict_branch_member_impl<T, Args...>(0))::value;
 };
 
+struct memory_dependence_predictor : public bound_to<O3_CPU> {
+  explicit memory_dependence_predictor(O3_CPU* cpu) : bound_to<O3_CPU>(cpu) {}
+
+  template <typename T, typename... Args>
+  static auto initialize_member_impl(int) -> decltype(std::declval<T>().initialize_dependence_predictor(std::declval<Args>()...), std::true_type{});
+  template <typename, typename...>
+  static auto initialize_member_impl(long) -> std::false_type;
+
+  template <typename T, typename... Args>
+  static auto predict_member_impl(int) -> decltype(std::declval<T>().predict_dependence(std::declval<Args>()...), std::true_type{});
+  template <typename, typename...>
+  static auto predict_member_impl(long) -> std::false_type;
+
+  template <typename T, typename... Args>
+  static auto store_dispatched_member_impl(int) -> decltype(std::declval<T>().store_dispatched(std::declval<Args>()...), std::true_type{});
+  template <typename, typename...>
+  static auto store_dispatched_member_impl(long) -> std::false_type;
+
+  template <typename T, typename... Args>
+  static auto store_executed_member_impl(int) -> decltype(std::declval<T>().store_executed(std::declval<Args>()...), std::true_type{});
+  template <typename, typename...>
+  static auto store_executed_member_impl(long) -> std::false_type;
+
+  template <typename T, typename... Args>
+  static auto violation_member_impl(int) -> decltype(std::declval<T>().dependence_violation(std::declval<Args>()...), std::true_type{});
+  template <typename, typename...>
+  static auto violation_member_impl(long) -> std::false_type;
+
+  template <typename T, typename... Args>
+  constexpr static bool has_initialize = decltype(initialize_member_impl<T, Args...>(0))::value;
+
+  template <typename T, typename... Args>
+  constexpr static bool has_predict_dependence = decltype(predict_member_impl<T, Args...>(0))::value;
+
+  template <typename T, typename... Args>
+  constexpr static bool has_store_dispatched = decltype(store_dispatched_member_impl<T, Args...>(0))::value;
+
+  template <typename T, typename... Args>
+  constexpr static bool has_store_executed = decltype(store_executed_member_impl<T, Args...>(0))::value;
+
+  template <typename T, typename... Args>
+  constexpr static bool has_dependence_violation = decltype(violation_member_impl<T, Args...>(0))::value;
+};
+
+struct value_predictor : public bound_to<O3_CPU> {
+  explicit value_predictor(O3_CPU* cpu) : bound_to<O3_CPU>(cpu) {}
+
+  template <typename T, typename... Args>
+  static auto initialize_member_impl(int) -> decltype(std::declval<T>().initialize_value_predictor(std::declval<Args>()...), std::true_type{});
+  template <typename, typename...>
+  static auto initialize_member_impl(long) -> std::false_type;
+
+  template <typename T, typename... Args>
+  static auto predict_member_impl(int) -> decltype(std::declval<T>().predict_load(std::declval<Args>()...), std::true_type{});
+  template <typename, typename...>
+  static auto predict_member_impl(long) -> std::false_type;
+
+  template <typename T, typename... Args>
+  static auto predict_address_member_impl(int) -> decltype(std::declval<T>().predict_load_address(std::declval<Args>()...), std::true_type{});
+  template <typename, typename...>
+  static auto predict_address_member_impl(long) -> std::false_type;
+
+  template <typename T, typename... Args>
+  static auto last_result_member_impl(int) -> decltype(std::declval<T>().last_load_result(std::declval<Args>()...), std::true_type{});
+  template <typename, typename...>
+  static auto last_result_member_impl(long) -> std::false_type;
+
+  template <typename T, typename... Args>
+  constexpr static bool has_initialize = decltype(initialize_member_impl<T, Args...>(0))::value;
+
+  template <typename T, typename... Args>
+  constexpr static bool has_predict_load = decltype(predict_member_impl<T, Args...>(0))::value;
+
+  template <typename T, typename... Args>
+  constexpr static bool has_predict_load_address = decltype(predict_address_member_impl<T, Args...>(0))::value;
+
+  template <typename T, typename... Args>
+  constexpr static bool has_last_load_result = decltype(last_result_member_impl<T, Args...>(0))::value;
+};
+
 struct prefetcher : public bound_to<CACHE> {
   explicit prefetcher(CACHE* cache) : bound_to<CACHE>(cache) {}
   bool prefetch_line(champsim::address pf_addr, bool fill_this_level, uint32_t prefetch_metadata) const;
@@ -129,6 +211,11 @@ struct prefetcher : public bound_to<CACHE> {
   template <typename, typename...>
   static auto final_stats_member_impl(long) -> std::false_type;
 
+  template <typename T>
+  static auto set_local_member_impl(int) -> std::bool_constant<T::set_local>;
+  template <typename>
+  static auto set_local_member_impl(long) -> std::false_type;
+
   template <typename T, typename... Args>
   static auto branch_operate_member_impl(int) -> decltype(std::declval<T>().prefetcher_branch_operate(std::declval<Args>()...), std::true_type{});
   template <typename, typename...>
@@ -151,6 +238,13 @@ struct prefetcher : public bound_to<CACHE> {
 
   template <typename T, typename... Args>
   constexpr static bool has_branch_operate = decltype(branch_operate_member_impl<T, Args...>(0))::value;
+
+  /**
+   * A prefetcher declares that it is set-local with the member ``static constexpr bool set_local = true;``.
+   * Its hooks then touch no state outside of the set that they are called for, and it issues no prefetches.
+   */
+  template <typename T>
+  constexpr static bool is_set_local = decltype(set_local_member_impl<T>(0))::value;
 };
 
 struct replacement : public bound_to<CACHE> {
@@ -176,11 +270,21 @@ struct replacement : public bound_to<CACHE> {
   template <typename, typename...>
   static auto cache_fill_member_impl(long) -> std::false_type;
 
+  template <typename T, typename... Args>
+  static auto sector_fill_member_impl(int) -> decltype(std::declval<T>().replacement_sector_fill(std::declval<Args>()...), std::true_type{});
+  template <typename, typename...>
+  static auto sector_fill_member_impl(long) -> std::false_type;
+
   template <typename T, typename... Args>
   static auto final_stats_member_impl(int) -> decltype(std::declval<T>().replacement_final_stats(std::declval<Args>()...), std::true_type{});
   template <typename, typename...>
   static auto final_stats_member_impl(long) -> std::false_type;
 
+  template <typename T>
+  static auto set_local_member_impl(int) -> std::bool_constant<T::set_local>;
+  template <typename>
+  static auto set_local_member_impl(long) -> std::false_type;
+
   template <typename T, typename... Args>
   constexpr static bool has_initialize = decltype(initialize_member_impl<T, Args...>(0))::value;
 
@@ -193,9 +297,43 @@ struct replacement : public bound_to<CACHE> {
   template <typename T, typename... Args>
   constexpr static bool has_cache_fill = decltype(cache_fill_member_impl<T, Args...>(0))::value;
 
+  template <typename T, typename... Args>
+  constexpr static bool has_sector_fill = decltype(sector_fill_member_impl<T, Args...>(0))::value;
+
   template <typename T, typename... Args>
   constexpr static bool has_final_stats = decltype(final_stats_member_impl<T, Args...>(0))::value;
+
+  /**
+   * A replacement policy declares that it is set-local with the member ``static constexpr bool set_local = true;``.
+   * Its hooks then touch no state outside of the set that they are called for.
+   */
+  template <typename T>
+  constexpr static bool is_set_local = decltype(set_local_member_impl<T>(0))::value;
 };
+
+/**
+ * Selects the constructors of CACHE and O3_CPU that call the modules directly, rather than through the module concepts.
+ * The paths that call the hooks are then compiled for the modules, wherever the element is built.
+ */
+struct static_dispatch_t {
+  explicit static_dispatch_t() = default;
+};
+inline constexpr static_dispatch_t static_dispatch{};
+
+/**
+ * A description of the run, for the modules that keep files between runs and must know whether those files still apply to it.
+ */
+struct run_description {
+  std::vector<std::string> trace_names{};
+  long long warmup_instructions = 0;
+  long long simulation_instructions = 0;
+  std::string data_directory = "."; // The directory in which modules keep their files
+};
+
+/**
+ * The description of the current run. It is set by the simulator before the modules are initialized.
+ */
+run_description& current_run();
 } // namespace champsim::modules
 
 #endif
@@ -0,0 +1,156 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MSL_OPTGEN_H
+#define MSL_OPTGEN_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace champsim::msl
+{
+/**
+ * The occupancy vector of OPTgen, which reconstructs the decisions of Belady's optimal policy for one set over a window of past accesses.
+ *
+ * Time is counted in accesses to the set. Each element of the vector holds the number of blocks that the optimal policy would keep in the cache at that time.
+ * A reuse interval is a hit for the optimal policy if the cache has room for the block at every time in the interval.
+ *
+ * Akanksha Jain and Calvin Lin. 2016. Back to the future: leveraging Belady's algorithm for improved cache replacement.
+ * In Proceedings of the 43rd International Symposium on Computer Architecture (ISCA '16).
+ */
+class optgen
+{
+  uint8_t capacity;
+  std::vector<uint8_t> occupancy;
+  uint64_t current = 0;
+
+  uint64_t num_hits = 0;
+  uint64_t num_accesses = 0;
+
+public:
+  /**
+   * :param capacity_: The number of blocks in the set
+   * :param history: The length of the window, in accesses
+   */
+  optgen(std::size_t capacity_, std::size_t history) : capacity(static_cast<uint8_t>(capacity_)), occupancy(history, 0)
+  {
+    assert(capacity_ <= std::numeric_limits<uint8_t>::max());
+    assert(history > 0);
+  }
+
+  /**
+   * The time of the next access to the set
+   */
+  [[nodiscard]] uint64_t now() const { return current; }
+
+  /**
+   * Check whether a time is still covered by the window
+   */
+  [[nodiscard]] bool in_window(uint64_t then) const { return then < current && current - then < std::size(occupancy); }
+
+  /**
+   * Determine whether the optimal policy would have kept a block from the given time until now.
+   * If so, the block occupies the cache over that interval.
+   *
+   * :param then: The time of the previous access to the block, which must be in the window
+   * :return: True if the optimal policy would hit
+   */
+  bool should_cache(uint64_t then)
+  {
+    assert(in_window(then));
+    auto slot = [this](uint64_t t) -> uint8_t& { return occupancy[t % std::size(occupancy)]; };
+
+    for (auto t = then; t < current; ++t) {
+      if (slot(t) >= capacity) {
+        return false;
+      }
+    }
+
+    for (auto t = then; t < current; ++t) {
+      ++slot(t);
+    }
+    ++num_hits;
+    return true;
+  }
+
+  /**
+   * Record an access to the set, advancing the time
+   */
+  void add_access()
+  {
+    occupancy[current % std::size(occupancy)] = 0;
+    ++current;
+    ++num_accesses;
+  }
+
+  [[nodiscard]] uint64_t hits() const { return num_hits; }
+  [[nodiscard]] uint64_t accesses() const { return num_accesses; }
+};
+
+/**
+ * A small history of the accesses to one sampled set, for training predictors of reuse.
+ *
+ * Each entry holds the tag of a block, the signature of its last access, and the time of that access.
+ * When the sampler is full, the entry whose last access is oldest is replaced.
+ */
+class reuse_sampler
+{
+public:
+  struct entry_type {
+    bool valid = false;
+    uint64_t tag = 0;
+    uint32_t signature = 0;
+    uint64_t last_access = 0;
+  };
+
+private:
+  std::vector<entry_type> entries;
+
+public:
+  explicit reuse_sampler(std::size_t size) : entries(size) {}
+
+  /**
+   * Find the entry for a block
+   *
+   * :return: A pointer to the entry, or nullptr if the block is not in the sampler
+   */
+  entry_type* find(uint64_t tag)
+  {
+    auto found = std::find_if(std::begin(entries), std::end(entries), [tag](const auto& x) { return x.valid && x.tag == tag; });
+    return found == std::end(entries) ? nullptr : &*found;
+  }
+
+  /**
+   * Insert an entry for a block that is not in the sampler
+   *
+   * :return: The entry that was replaced, which is not valid if there was room
+   */
+  entry_type insert(uint64_t tag, uint32_t signature, uint64_t now)
+  {
+    auto victim = std::min_element(std::begin(entries), std::end(entries), [](const auto& x, const auto& y) {
+      return (!x.valid && y.valid) || (x.valid == y.valid && x.last_access < y.last_access);
+    });
+    auto evicted = *victim;
+    *victim = entry_type{true, tag, signature, now};
+    return evicted;
+  }
+};
+} // namespace champsim::msl
+
+#endif
@@ -22,6 +22,7 @@
 #undef CHAMPSIM_MODULE
 #endif
 
+#include <algorithm>
 #include <array>
 #include <bitset>
 #include <deque>
@@ -29,18 +30,24 @@
 #include <memory>
 #include <optional>
 #include <queue>
+#include <set>
 #include <stdexcept>
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 
+#include <fmt/core.h>
+
 #include "bandwidth.h"
 #include "champsim.h"
 #include "channel.h"
 #include "core_builder.h"
 #include "core_stats.h"
+#include "instr_pool.h"
 #include "instruction.h"
 #include "modules.h"
 #include "operable.h"
+#include "pipeline_trace.h"
 #include "register_allocator.h"
 #include "util/lru_table.h"
 #include "util/to_underlying.h"
@@ -61,6 +68,8 @@ public:
   CacheBus(uint32_t cpu_idx, champsim::channel* ll) : lower_level(ll), cpu(cpu_idx) {}
   bool issue_read(request_type packet);
   bool issue_write(request_type packet);
+
+  [[nodiscard]] channel_type* lower_channel() const { return lower_level; }
 };
 
 struct LSQ_ENTRY : champsim::program_ordered<LSQ_ENTRY> {
@@ -69,14 +78,19 @@ struct LSQ_ENTRY : champsim::program_ordered<LSQ_ENTRY> {
   champsim::chrono::clock::time_point ready_time{champsim::chrono::clock::time_point::max()};
 
   std::array<uint8_t, 2> asid = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
+  std::size_t thread = 0;
   bool fetch_issued = false;
 
   uint64_t producer_id = std::numeric_limits<uint64_t>::max();
   std::vector<std::reference_wrapper<std::optional<LSQ_ENTRY>>> lq_depend_on_me{};
+  std::vector<std::pair<uint64_t, champsim::address>> lq_speculated_past_me{}; // Younger loads to this address that did not wait for it, by ID and IP
+
+  ooo_model_instr* rob_entry = nullptr; // The instruction, which does not move while it is in flight
 
   LSQ_ENTRY(champsim::address addr, champsim::program_ordered<LSQ_ENTRY>::id_type id, champsim::address ip, std::array<uint8_t, 2> asid);
-  void finish(ooo_model_instr& rob_entry) const;
-  void finish(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end) const;
+  explicit LSQ_ENTRY(champsim::address addr, ooo_model_instr& instr);
+  void finish() const;
+  void finish(ooo_model_instr& instr) const;
 };
 
 // cpu
@@ -98,6 +112,9 @@ public:
 
   bool show_heartbeat = true;
 
+  // The instructions are traced through the pipeline only if this is set
+  std::unique_ptr<champsim::pipeline_tracer> pipeline_trace{};
+
   using stats_type = cpu_stats;
 
   stats_type roi_stats{}, sim_stats{};
@@ -110,37 +127,134 @@ public:
   using dib_type = champsim::lru_table<champsim::address, dib_shift, dib_shift>;
   dib_type DIB;
 
+  // The instructions in flight, which the stages of the pipeline hold by handle
+  champsim::instr_pool instr_pool;
+
   // reorder buffer, load/store queue, register file
-  std::deque<ooo_model_instr> IFETCH_BUFFER;
-  std::deque<ooo_model_instr> DISPATCH_BUFFER;
-  std::deque<ooo_model_instr> DECODE_BUFFER;
-  std::deque<ooo_model_instr> ROB;
-  std::deque<ooo_model_instr> DIB_HIT_BUFFER;
+  champsim::instr_queue IFETCH_BUFFER;
+  champsim::instr_queue DISPATCH_BUFFER;
+  champsim::instr_queue DECODE_BUFFER;
+  champsim::instr_queue ROB;
+  champsim::instr_queue DIB_HIT_BUFFER;
 
   std::vector<std::optional<LSQ_ENTRY>> LQ;
   std::deque<LSQ_ENTRY> SQ;
 
+  // Indices into the load and store queues, so that they need not be searched
+  std::priority_queue<std::size_t, std::vector<std::size_t>, std::greater<>> lq_free_slots{}; // The free LQ entries, lowest first
+  std::unordered_multimap<uint64_t, std::size_t> lq_slots_by_instr{};                         // The LQ entries of each instruction
+  std::set<std::size_t> lq_unissued_slots{};                                                  // The LQ entries that have not been issued, in slot order
+  std::unordered_multimap<uint64_t, std::size_t> lq_slots_by_block{};                         // The LQ entries that have been issued, by block
+  std::unordered_map<uint64_t, std::deque<uint64_t>> sq_ids_by_address{};                     // The instructions that store to each address, oldest first
+
+  // write-combining store buffer, holding one entry for each block that retired stores have written
+  struct store_buffer_entry_type {
+    champsim::address virtual_address{}; // The address of the first store
+    champsim::address ip{};
+    uint64_t instr_id = 0;
+    std::vector<champsim::address> written{}; // The addresses of all stores, for forwarding to loads
+  };
+  std::deque<store_buffer_entry_type> STORE_BUFFER;
+
+  // wrong-path fetch, which follows the predicted path after a misprediction until the branch resolves
+  struct wrong_path_type {
+    champsim::block_number next_block{};
+    std::size_t remaining_blocks = 0;
+  };
+  std::optional<wrong_path_type> wrong_path{};
+
+  // The recent loads from each block of code, which are replayed when the block is fetched down the wrong path
+  static constexpr std::size_t WRONG_PATH_LOADS_PER_BLOCK = 4;
+  struct wrong_path_load {
+    champsim::address ip{};
+    champsim::address address{};
+  };
+  struct wrong_path_load_entry {
+    champsim::block_number code_block{};
+    std::array<wrong_path_load, WRONG_PATH_LOADS_PER_BLOCK> loads{}; // The most recent first
+    [[nodiscard]] auto index() const { return code_block.to<uint64_t>(); }
+    [[nodiscard]] auto tag() const { return code_block; }
+  };
+  champsim::lru_table<wrong_path_load_entry> wrong_path_load_table{64, 8};
+
+  // fetch target queue, which the branch predictor fills ahead of fetch when the front end is decoupled
+  struct ftq_entry_type {
+    champsim::block_number block{};
+    long instrs = 0;            // The predicted instructions in this block that have not yet been fetched, at the front of the input queue
+    bool ends_taken = false;    // The block ends at a branch that was predicted taken, or mispredicted
+    bool needs_prefetch = true; // False if the previous entry is in the same block
+    bool fetch_begun = false;
+    std::optional<champsim::chrono::clock::time_point> prefetch_time{};
+  };
+  std::deque<ftq_entry_type> FTQ;
+  std::size_t ftq_predicted_instrs = 0; // The number of instructions at the front of the input queue that the FTQ holds
+
+  // execution ports, each of which issues one instruction each cycle of the classes that it accepts
+  struct execution_port_type {
+    std::array<bool, NUM_OP_CLASSES> accepts{};
+    champsim::chrono::clock::time_point busy_until{}; // An unpipelined instruction holds its port until it completes
+  };
+  std::vector<execution_port_type> execution_ports{};
+
   // Constants
-  const std::size_t IFETCH_BUFFER_SIZE, DISPATCH_BUFFER_SIZE, DECODE_BUFFER_SIZE, REGISTER_FILE_SIZE, ROB_SIZE, SQ_SIZE, DIB_HIT_BUFFER_SIZE;
+  const std::size_t NUM_THREADS;
+  const std::size_t IFETCH_BUFFER_SIZE, DISPATCH_BUFFER_SIZE, DECODE_BUFFER_SIZE, REGISTER_FILE_SIZE, ROB_SIZE, SQ_SIZE, DIB_HIT_BUFFER_SIZE, STORE_BUFFER_SIZE;
+  const std::size_t WRONG_PATH_DEPTH;
+  const bool WRONG_PATH_LOADS;
+  const std::size_t FTQ_SIZE;
+  const champsim::thread_fetch_policy FETCH_POLICY;
+  const bool PARTITIONED_QUEUES;
+  const bool SPECULATIVE_LOADS; // Loads issue before older stores to the same address, unless the memory dependence predictor holds them
+  const bool VALUE_PREDICTION;  // The consumers of a predicted load wake before it completes
   champsim::bandwidth::maximum_type FETCH_WIDTH, DECODE_WIDTH, DISPATCH_WIDTH, SCHEDULER_SIZE, EXEC_WIDTH, DIB_INORDER_WIDTH;
-  champsim::bandwidth::maximum_type LQ_WIDTH, SQ_WIDTH;
+  champsim::bandwidth::maximum_type LQ_WIDTH, SQ_WIDTH, STORE_BUFFER_WIDTH;
   champsim::bandwidth::maximum_type RETIRE_WIDTH;
   champsim::chrono::clock::duration BRANCH_MISPREDICT_PENALTY;
+  champsim::chrono::clock::duration VIOLATION_PENALTY;
+  champsim::chrono::clock::duration REPLAY_PENALTY;
   champsim::chrono::clock::duration DISPATCH_LATENCY;
   champsim::chrono::clock::duration DECODE_LATENCY;
   champsim::chrono::clock::duration SCHEDULING_LATENCY;
   champsim::chrono::clock::duration EXEC_LATENCY;
+  std::array<champsim::chrono::clock::duration, NUM_OP_CLASSES> OP_LATENCY{};
+  std::array<bool, NUM_OP_CLASSES> OP_UNPIPELINED{};
   champsim::chrono::clock::duration DIB_HIT_LATENCY;
 
   champsim::bandwidth::maximum_type L1I_BANDWIDTH, L1D_BANDWIDTH;
 
-  RegisterAllocator reg_allocator{REGISTER_FILE_SIZE};
+  RegisterAllocator reg_allocator{REGISTER_FILE_SIZE, NUM_THREADS};
 
-  // branch
-  champsim::chrono::clock::time_point fetch_resume_time{};
+  // Each physical register lists the scheduled instructions that wait for it to be written, which are then woken into the ready list
+  std::vector<std::vector<ooo_model_instr*>> register_waiters = std::vector<std::vector<ooo_model_instr*>>(REGISTER_FILE_SIZE);
+  std::vector<ooo_model_instr*> ready_instrs{};    // Scheduled instructions whose sources are all valid, in program order
+  std::vector<ooo_model_instr*> inflight_instrs{}; // Executed instructions that have not completed, in program order
+  std::size_t scheduled_in_rob = 0;                // The scheduled instructions at the front of the ROB
+  std::optional<unsigned long> registers_to_rename{}; // The free registers needed by the next instruction to schedule, once it has had to wait
+
+  // Loads that issued early to a predicted address, whose consumers wake when that access returns
+  std::vector<ooo_model_instr*> address_predicted_loads{};
 
   const long IN_QUEUE_SIZE;
-  std::deque<ooo_model_instr> input_queue;
+
+  // hardware threads, each of which runs its own trace
+  struct thread_type {
+    std::deque<ooo_model_instr> input_queue{};
+    champsim::chrono::clock::time_point fetch_resume_time{}; // Fetch stalls until a mispredicted branch resolves
+    long long num_retired = 0;
+
+    // Kept as the instructions dispatch, execute, and retire. The instruction queues count the instructions of each thread themselves.
+    std::size_t lq_occupancy = 0;
+    std::size_t sq_occupancy = 0;
+    long executed_in_rob = 0;
+  };
+  std::vector<thread_type> threads;
+  std::size_t last_fetch_thread = NUM_THREADS - 1; // So that thread 0 fetches first
+
+  // With more than one thread, the core numbers the instructions as they are fetched, so that the threads share one program order
+  uint64_t next_instr_id = 0;
+
+  // The addresses of each thread are moved into a separate address space, which is selected by the bits above those that programs use
+  static constexpr unsigned THREAD_ADDRESS_SHIFT = 48;
 
   CacheBus L1I_bus, L1D_bus;
   CACHE* l1i;
@@ -150,32 +264,62 @@ public:
   void begin_phase() final;
   void end_phase(unsigned cpu) final;
 
+  [[nodiscard]] ooo_model_instr assign_to_thread(std::size_t thread, ooo_model_instr instr) const;
+  [[nodiscard]] std::optional<std::size_t> select_fetch_thread() const;
   void initialize_instruction();
+  void initialize_from_ftq();
   long check_dib();
   long fetch_instruction();
+  long fetch_wrong_path(champsim::bandwidth& l1i_bw);
+  long predict_fetch_targets();
+  long prefetch_fetch_targets();
   long promote_to_decode();
   long decode_instruction();
   long dispatch_instruction();
   long schedule_instruction();
   long execute_instruction();
   long operate_lsq();
+  long drain_store_buffer();
   long complete_inflight_instruction();
   long handle_memory_return();
   long retire_rob();
 
   bool do_init_instruction(ooo_model_instr& instr);
-  bool do_predict_branch(ooo_model_instr& instr);
+  template <typename B, typename T>
+  bool do_predict_branch(ooo_model_instr& instr); // Defined in ooo_cpu_dispatch.h
   void do_check_dib(ooo_model_instr& instr);
-  bool do_fetch_instruction(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end);
+  bool do_fetch_instruction(champsim::instr_queue::iterator begin, champsim::instr_queue::iterator end);
   void do_dib_update(const ooo_model_instr& instr);
+  void do_begin_wrong_path(const ooo_model_instr& branch, champsim::address predicted_target);
+  void do_squash_wrong_path();
+  void do_record_wrong_path_loads(const ooo_model_instr& instr);
+  void do_wrong_path_loads(champsim::block_number code_block);
   void do_scheduling(ooo_model_instr& instr);
   void do_execution(ooo_model_instr& instr);
+  [[nodiscard]] champsim::chrono::clock::duration execution_latency(const ooo_model_instr& instr) const;
   void do_memory_scheduling(ooo_model_instr& instr);
   void do_complete_execution(ooo_model_instr& instr);
+  void do_wakeup(PHYSICAL_REGISTER_ID physreg);
+  void do_predict_load(ooo_model_instr& instr);
+  void do_predict_load_address(ooo_model_instr& instr);
+  void do_verify_load(ooo_model_instr& instr);
+  void do_verify_load_address(ooo_model_instr& instr);
+  void do_replay(ooo_model_instr& instr);
+  void do_replay_consumers(const ooo_model_instr& producer, std::vector<PHYSICAL_REGISTER_ID> changed);
+  void do_reset_execution(ooo_model_instr& instr, std::vector<PHYSICAL_REGISTER_ID>& changed);
   void do_sq_forward_to_lq(LSQ_ENTRY& sq_entry, LSQ_ENTRY& lq_entry);
+  void do_wait_for_store(LSQ_ENTRY& sq_entry, std::optional<LSQ_ENTRY>& lq_entry);
+  void do_wait_for_predicted_store(uint64_t predicted_store, std::optional<LSQ_ENTRY>& lq_entry);
+  void do_check_dependence(const LSQ_ENTRY& sq_entry, uint64_t load_id, champsim::address load_ip);
+  std::optional<LSQ_ENTRY>& allocate_lq_entry(champsim::address address, ooo_model_instr& instr);
+  void release_lq_entry(std::optional<LSQ_ENTRY>& lq_entry);
+  [[nodiscard]] std::pair<std::deque<LSQ_ENTRY>::iterator, std::deque<LSQ_ENTRY>::iterator> find_sq_entries(uint64_t instr_id);
+  [[nodiscard]] std::deque<LSQ_ENTRY>::iterator find_forwarding_store(champsim::address address, uint64_t load_id);
 
   void do_finish_store(const LSQ_ENTRY& sq_entry);
   bool do_complete_store(const LSQ_ENTRY& sq_entry);
+  bool do_buffer_store(const LSQ_ENTRY& sq_entry);
+  [[nodiscard]] bool do_forward_from_store_buffer(champsim::address load_address) const;
   bool execute_load(const LSQ_ENTRY& lq_entry);
 
   [[nodiscard]] auto roi_instr() const { return roi_stats.instrs(); }
@@ -185,6 +329,13 @@ public:
 
   void print_deadlock() final;
 
+  void trace_pipeline(champsim::pipeline_tracer::stage s, const ooo_model_instr& instr)
+  {
+    if (pipeline_trace) {
+      pipeline_trace->stamp(s, instr, current_time);
+    }
+  }
+
 #include "module_decl.inc"
 
   struct branch_module_concept {
@@ -213,6 +364,25 @@ public:
     [[nodiscard]] bool impl_predict_branch(champsim::address ip, champsim::address predicted_target, bool always_taken, uint8_t branch_type) final;
   };
 
+  struct memory_dependence_module_concept {
+    virtual ~memory_dependence_module_concept() = default;
+
+    virtual void impl_initialize_dependence_predictor() = 0;
+    virtual uint64_t impl_predict_dependence(champsim::address ip, uint64_t instr_id) = 0;
+    virtual void impl_store_dispatched(champsim::address ip, uint64_t instr_id) = 0;
+    virtual void impl_store_executed(champsim::address ip, uint64_t instr_id) = 0;
+    virtual void impl_dependence_violation(champsim::address load_ip, champsim::address store_ip) = 0;
+  };
+
+  struct value_module_concept {
+    virtual ~value_module_concept() = default;
+
+    virtual void impl_initialize_value_predictor() = 0;
+    virtual std::optional<uint64_t> impl_predict_load(champsim::address ip) = 0;
+    virtual std::optional<champsim::address> impl_predict_load_address(champsim::address ip) = 0;
+    virtual void impl_last_load_result(champsim::address ip, champsim::address address, std::optional<uint64_t> value) = 0;
+  };
+
   template <typename... Ts>
   struct btb_module_model final : btb_module_concept {
     std::tuple<Ts...> intern_;
@@ -223,34 +393,144 @@ public:
     [[nodiscard]] std::pair<champsim::address, bool> impl_btb_prediction(champsim::address ip, uint8_t branch_type) final;
   };
 
-  std::unique_ptr<branch_module_concept> branch_module_pimpl;
+  template <typename... Ds>
+  struct memory_dependence_module_model final : memory_dependence_module_concept {
+    std::tuple<Ds...> intern_;
+    explicit memory_dependence_module_model(O3_CPU* cpu) : intern_(Ds{cpu}...) { (void)cpu; /* silence -Wunused-but-set-parameter when sizeof...(Ds) == 0 */ }
+
+    void impl_initialize_dependence_predictor() final;
+    [[nodiscard]] uint64_t impl_predict_dependence(champsim::address ip, uint64_t instr_id) final;
+    void impl_store_dispatched(champsim::address ip, uint64_t instr_id) final;
+    void impl_store_executed(champsim::address ip, uint64_t instr_id) final;
+    void impl_dependence_violation(champsim::address load_ip, champsim::address store_ip) final;
+  };
+
+  template <typename... Vs>
+  struct value_module_model final : value_module_concept {
+    std::tuple<Vs...> intern_;
+    explicit value_module_model(O3_CPU* cpu) : intern_(Vs{cpu}...) { (void)cpu; /* silence -Wunused-but-set-parameter when sizeof...(Vs) == 0 */ }
+
+    void impl_initialize_value_predictor() final;
+    [[nodiscard]] std::optional<uint64_t> impl_predict_load(champsim::address ip) final;
+    [[nodiscard]] std::optional<champsim::address> impl_predict_load_address(champsim::address ip) final;
+    void impl_last_load_result(champsim::address ip, champsim::address address, std::optional<uint64_t> value) final;
+  };
+
+  std::vector<std::unique_ptr<branch_module_concept>> branch_module_pimpl; // One for each thread, so that each has its own history
   std::unique_ptr<btb_module_concept> btb_module_pimpl;
+  std::unique_ptr<memory_dependence_module_concept> memory_dependence_module_pimpl;
+  std::unique_ptr<value_module_concept> value_module_pimpl;
+
+  // The modules, seen as the concepts or as the models that they were built as. A call through a model is direct, since the models are final.
+  template <typename B>
+  [[nodiscard]] B& branch_module(std::size_t thread) const
+  {
+    return static_cast<B&>(*branch_module_pimpl.at(thread));
+  }
+  template <typename T>
+  [[nodiscard]] T& btb_module() const
+  {
+    return static_cast<T&>(*btb_module_pimpl);
+  }
+
+  // The branch prediction of this core, which calls the modules through their concepts unless the core was built with static dispatch
+  bool (O3_CPU::*bound_predict_branch)(ooo_model_instr&) = &O3_CPU::do_predict_branch<branch_module_concept, btb_module_concept>;
 
   // NOLINTBEGIN(readability-make-member-function-const): legacy modules use non-const hooks
   void impl_initialize_branch_predictor() const;
-  void impl_last_branch_result(champsim::address ip, champsim::address target, bool taken, uint8_t branch_type) const;
-  [[nodiscard]] bool impl_predict_branch(champsim::address ip, champsim::address predicted_target, bool always_taken, uint8_t branch_type) const;
+  void impl_last_branch_result(std::size_t thread, champsim::address ip, champsim::address target, bool taken, uint8_t branch_type) const;
+  [[nodiscard]] bool impl_predict_branch(std::size_t thread, champsim::address ip, champsim::address predicted_target, bool always_taken,
+                                         uint8_t branch_type) const;
 
   void impl_initialize_btb() const;
   void impl_update_btb(champsim::address ip, champsim::address predicted_target, bool taken, uint8_t branch_type) const;
   [[nodiscard]] std::pair<champsim::address, bool> impl_btb_prediction(champsim::address ip, uint8_t branch_type) const;
+
+  void impl_initialize_dependence_predictor() const;
+  [[nodiscard]] uint64_t impl_predict_dependence(champsim::address ip, uint64_t instr_id) const;
+  void impl_store_dispatched(champsim::address ip, uint64_t instr_id) const;
+  void impl_store_executed(champsim::address ip, uint64_t instr_id) const;
+  void impl_dependence_violation(champsim::address load_ip, champsim::address store_ip) const;
+
+  void impl_initialize_value_predictor() const;
+  [[nodiscard]] std::optional<uint64_t> impl_predict_load(champsim::address ip) const;
+  [[nodiscard]] std::optional<champsim::address> impl_predict_load_address(champsim::address ip) const;
+  void impl_last_load_result(champsim::address ip, champsim::address address, std::optional<uint64_t> value) const;
   // NOLINTEND(readability-make-member-function-const)
 
-  template <typename... Bs, typename... Ts>
-  explicit O3_CPU(champsim::core_builder<champsim::core_builder_module_type_holder<Bs...>, champsim::core_builder_module_type_holder<Ts...>> b)
+  template <typename... Bs, typename... Ts, typename... Ds, typename... Vs>
+  explicit O3_CPU(champsim::core_builder<champsim::core_builder_module_type_holder<Bs...>, champsim::core_builder_module_type_holder<Ts...>,
+                                         champsim::core_builder_module_type_holder<Ds...>, champsim::core_builder_module_type_holder<Vs...>>
+                      b)
       : champsim::operable(b.m_clock_period), cpu(b.m_cpu),
         DIB(b.m_dib_set, b.m_dib_way, {champsim::data::bits{champsim::lg2(b.m_dib_window)}}, {champsim::data::bits{champsim::lg2(b.m_dib_window)}}),
-        LQ(b.m_lq_size), IFETCH_BUFFER_SIZE(b.m_ifetch_buffer_size), DISPATCH_BUFFER_SIZE(b.m_dispatch_buffer_size), DECODE_BUFFER_SIZE(b.m_decode_buffer_size),
+        instr_pool(b.m_ifetch_buffer_size + b.m_decode_buffer_size + b.m_dib_hit_buffer_size + b.m_dispatch_buffer_size + b.m_rob_size),
+        IFETCH_BUFFER(instr_pool, b.m_ifetch_buffer_size), DISPATCH_BUFFER(instr_pool, b.m_dispatch_buffer_size),
+        DECODE_BUFFER(instr_pool, b.m_decode_buffer_size), ROB(instr_pool, b.m_rob_size), DIB_HIT_BUFFER(instr_pool, b.m_dib_hit_buffer_size),
+        LQ(b.m_lq_size), NUM_THREADS(std::max<std::size_t>(b.m_threads, 1)), IFETCH_BUFFER_SIZE(b.m_ifetch_buffer_size),
+        DISPATCH_BUFFER_SIZE(b.m_dispatch_buffer_size), DECODE_BUFFER_SIZE(b.m_decode_buffer_size),
         REGISTER_FILE_SIZE(b.m_register_file_size), ROB_SIZE(b.m_rob_size), SQ_SIZE(b.m_sq_size), DIB_HIT_BUFFER_SIZE(b.m_dib_hit_buffer_size),
+        STORE_BUFFER_SIZE(b.m_store_buffer_size), WRONG_PATH_DEPTH(b.m_wrong_path_depth),
+        WRONG_PATH_LOADS(b.m_wrong_path_loads), FTQ_SIZE(b.m_ftq_size), FETCH_POLICY(b.m_fetch_policy),
+        PARTITIONED_QUEUES(b.m_partitioned_queues), SPECULATIVE_LOADS(sizeof...(Ds) > 0), VALUE_PREDICTION(sizeof...(Vs) > 0),
         FETCH_WIDTH(b.m_fetch_width), DECODE_WIDTH(b.m_decode_width), DISPATCH_WIDTH(b.m_dispatch_width), SCHEDULER_SIZE(b.m_schedule_width),
-        EXEC_WIDTH(b.m_execute_width), DIB_INORDER_WIDTH(b.m_dib_inorder_width), LQ_WIDTH(b.m_lq_width), SQ_WIDTH(b.m_sq_width), RETIRE_WIDTH(b.m_retire_width),
-        BRANCH_MISPREDICT_PENALTY(b.m_mispredict_penalty * b.m_clock_period), DISPATCH_LATENCY(b.m_dispatch_latency * b.m_clock_period),
+        EXEC_WIDTH(b.m_execute_width), DIB_INORDER_WIDTH(b.m_dib_inorder_width), LQ_WIDTH(b.m_lq_width), SQ_WIDTH(b.m_sq_width),
+        STORE_BUFFER_WIDTH(b.m_store_buffer_width), RETIRE_WIDTH(b.m_retire_width),
+        BRANCH_MISPREDICT_PENALTY(b.m_mispredict_penalty * b.m_clock_period), VIOLATION_PENALTY(b.m_violation_penalty * b.m_clock_period),
+        REPLAY_PENALTY(b.m_replay_penalty * b.m_clock_period), DISPATCH_LATENCY(b.m_dispatch_latency * b.m_clock_period),
         DECODE_LATENCY(b.m_decode_latency * b.m_clock_period), SCHEDULING_LATENCY(b.m_schedule_latency * b.m_clock_period),
         EXEC_LATENCY(b.m_execute_latency * b.m_clock_period), DIB_HIT_LATENCY(b.m_dib_hit_latency * b.m_clock_period), L1I_BANDWIDTH(b.m_l1i_bw),
-        L1D_BANDWIDTH(b.m_l1d_bw), IN_QUEUE_SIZE(2 * champsim::to_underlying(b.m_fetch_width)), L1I_bus(b.m_cpu, b.m_fetch_queues),
-        L1D_bus(b.m_cpu, b.m_data_queues), l1i(b.m_l1i), branch_module_pimpl(std::make_unique<branch_module_model<Bs...>>(this)),
-        btb_module_pimpl(std::make_unique<btb_module_model<Ts...>>(this))
+        L1D_BANDWIDTH(b.m_l1d_bw), IN_QUEUE_SIZE(2 * champsim::to_underlying(b.m_fetch_width) * static_cast<long>(1 + FTQ_SIZE)), threads(NUM_THREADS),
+        L1I_bus(b.m_cpu, b.m_fetch_queues), L1D_bus(b.m_cpu, b.m_data_queues), l1i(b.m_l1i), btb_module_pimpl(std::make_unique<btb_module_model<Ts...>>(this)),
+        memory_dependence_module_pimpl(std::make_unique<memory_dependence_module_model<Ds...>>(this)),
+        value_module_pimpl(std::make_unique<value_module_model<Vs...>>(this))
   {
+    // Both the wrong path and the FTQ follow a single predicted path
+    if (NUM_THREADS > 1 && (WRONG_PATH_DEPTH > 0 || FTQ_SIZE > 0)) {
+      throw std::invalid_argument{"A core with more than one thread may not fetch down the wrong path or have a fetch target queue"};
+    }
+
+    for (std::size_t thread = 0; thread < NUM_THREADS; ++thread) {
+      branch_module_pimpl.push_back(std::make_unique<branch_module_model<Bs...>>(this));
+    }
+
+    for (std::size_t slot = 0; slot < std::size(LQ); ++slot) {
+      lq_free_slots.push(slot);
+    }
+
+    for (std::size_t op = 0; op < NUM_OP_CLASSES; ++op) {
+      OP_LATENCY.at(op) = b.m_op_latency.at(op).value_or(b.m_execute_latency) * b.m_clock_period;
+    }
+    OP_UNPIPELINED = b.m_op_unpipelined;
+
+    for (const auto& classes : b.m_execution_ports) {
+      execution_port_type port;
+      for (auto op : classes) {
+        port.accepts.at(op) = true;
+      }
+      execution_ports.push_back(port);
+    }
+
+    // An instruction of a class that no port accepts could never issue
+    for (std::size_t op = 0; op < NUM_OP_CLASSES && !std::empty(execution_ports); ++op) {
+      if (std::none_of(std::begin(execution_ports), std::end(execution_ports), [op](const auto& x) { return x.accepts.at(op); })) {
+        throw std::invalid_argument{fmt::format("No execution port accepts the class {}", op_class_names.at(op))};
+      }
+    }
+  }
+
+  /**
+   * Build a core whose branch prediction is compiled for its branch predictor and BTB, so that their hooks are called directly and may be inlined.
+   * The translation unit that builds it must include ooo_cpu_dispatch.h.
+   */
+  template <typename... Bs, typename... Ts, typename... Ds, typename... Vs>
+  O3_CPU(champsim::modules::static_dispatch_t,
+         champsim::core_builder<champsim::core_builder_module_type_holder<Bs...>, champsim::core_builder_module_type_holder<Ts...>,
+                                champsim::core_builder_module_type_holder<Ds...>, champsim::core_builder_module_type_holder<Vs...>>
+             b)
+      : O3_CPU(b)
+  {
+    bound_predict_branch = &O3_CPU::do_predict_branch<branch_module_model<Bs...>, btb_module_model<Ts...>>;
   }
 };
 
@@ -369,6 +649,160 @@ std::pair<champsim::address, bool> O3_CPU::btb_module_model<Ts...>::impl_btb_pre
   return return_type{};
 }
 
+template <typename... Ds>
+void O3_CPU::memory_dependence_module_model<Ds...>::impl_initialize_dependence_predictor()
+{
+  [[maybe_unused]] auto process_one = [&](auto& d) {
+    using namespace champsim::modules;
+    if constexpr (memory_dependence_predictor::has_initialize<decltype(d)>)
+      d.initialize_dependence_predictor();
+  };
+
+  std::apply([&](auto&... d) { (..., process_one(d)); }, intern_);
+}
+
+template <typename... Ds>
+uint64_t O3_CPU::memory_dependence_module_model<Ds...>::impl_predict_dependence(champsim::address ip, uint64_t instr_id)
+{
+  using return_type = uint64_t;
+  [[maybe_unused]] auto process_one = [&](auto& d) {
+    using namespace champsim::modules;
+
+    /* Strong addresses */
+    if constexpr (memory_dependence_predictor::has_predict_dependence<decltype(d), champsim::address, uint64_t>)
+      return return_type{d.predict_dependence(ip, instr_id)};
+
+    /* Raw integer addresses */
+    if constexpr (memory_dependence_predictor::has_predict_dependence<decltype(d), uint64_t, uint64_t>)
+      return return_type{d.predict_dependence(ip.to<uint64_t>(), instr_id)};
+
+    return std::numeric_limits<return_type>::max();
+  };
+
+  if constexpr (sizeof...(Ds) > 0) {
+    return std::apply([&](auto&... d) { return (..., process_one(d)); }, intern_);
+  }
+  return std::numeric_limits<return_type>::max();
+}
+
+template <typename... Ds>
+void O3_CPU::memory_dependence_module_model<Ds...>::impl_store_dispatched(champsim::address ip, uint64_t instr_id)
+{
+  [[maybe_unused]] auto process_one = [&](auto& d) {
+    using namespace champsim::modules;
+    if constexpr (memory_dependence_predictor::has_store_dispatched<decltype(d), champsim::address, uint64_t>)
+      d.store_dispatched(ip, instr_id);
+    if constexpr (memory_dependence_predictor::has_store_dispatched<decltype(d), uint64_t, uint64_t>)
+      d.store_dispatched(ip.to<uint64_t>(), instr_id);
+  };
+
+  std::apply([&](auto&... d) { (..., process_one(d)); }, intern_);
+}
+
+template <typename... Ds>
+void O3_CPU::memory_dependence_module_model<Ds...>::impl_store_executed(champsim::address ip, uint64_t instr_id)
+{
+  [[maybe_unused]] auto process_one = [&](auto& d) {
+    using namespace champsim::modules;
+    if constexpr (memory_dependence_predictor::has_store_executed<decltype(d), champsim::address, uint64_t>)
+      d.store_executed(ip, instr_id);
+    if constexpr (memory_dependence_predictor::has_store_executed<decltype(d), uint64_t, uint64_t>)
+      d.store_executed(ip.to<uint64_t>(), instr_id);
+  };
+
+  std::apply([&](auto&... d) { (..., process_one(d)); }, intern_);
+}
+
+template <typename... Ds>
+void O3_CPU::memory_dependence_module_model<Ds...>::impl_dependence_violation(champsim::address load_ip, champsim::address store_ip)
+{
+  [[maybe_unused]] auto process_one = [&](auto& d) {
+    using namespace champsim::modules;
+    if constexpr (memory_dependence_predictor::has_dependence_violation<decltype(d), champsim::address, champsim::address>)
+      d.dependence_violation(load_ip, store_ip);
+    if constexpr (memory_dependence_predictor::has_dependence_violation<decltype(d), uint64_t, uint64_t>)
+      d.dependence_violation(load_ip.to<uint64_t>(), store_ip.to<uint64_t>());
+  };
+
+  std::apply([&](auto&... d) { (..., process_one(d)); }, intern_);
+}
+
+template <typename... Vs>
+void O3_CPU::value_module_model<Vs...>::impl_initialize_value_predictor()
+{
+  [[maybe_unused]] auto process_one = [&](auto& v) {
+    using namespace champsim::modules;
+    if constexpr (value_predictor::has_initialize<decltype(v)>)
+      v.initialize_value_predictor();
+  };
+
+  std::apply([&](auto&... v) { (..., process_one(v)); }, intern_);
+}
+
+template <typename... Vs>
+std::optional<uint64_t> O3_CPU::value_module_model<Vs...>::impl_predict_load(champsim::address ip)
+{
+  using return_type = std::optional<uint64_t>;
+  [[maybe_unused]] auto process_one = [&](auto& v) {
+    using namespace champsim::modules;
+
+    /* Strong addresses */
+    if constexpr (value_predictor::has_predict_load<decltype(v), champsim::address>)
+      return return_type{v.predict_load(ip)};
+
+    /* Raw integer addresses */
+    if constexpr (value_predictor::has_predict_load<decltype(v), uint64_t>)
+      return return_type{v.predict_load(ip.to<uint64_t>())};
+
+    return return_type{};
+  };
+
+  if constexpr (sizeof...(Vs) > 0) {
+    return std::apply([&](auto&... v) { return (..., process_one(v)); }, intern_);
+  }
+  return return_type{};
+}
+
+template <typename... Vs>
+std::optional<champsim::address> O3_CPU::value_module_model<Vs...>::impl_predict_load_address(champsim::address ip)
+{
+  using return_type = std::optional<champsim::address>;
+  [[maybe_unused]] auto process_one = [&](auto& v) {
+    using namespace champsim::modules;
+
+    /* Strong addresses */
+    if constexpr (value_predictor::has_predict_load_address<decltype(v), champsim::address>)
+      return return_type{v.predict_load_address(ip)};
+
+    /* Raw integer addresses */
+    if constexpr (value_predictor::has_predict_load_address<decltype(v), uint64_t>) {
+      auto predicted = v.predict_load_address(ip.to<uint64_t>());
+      return predicted.has_value() ? return_type{champsim::address{predicted.value()}} : return_type{};
+    }
+
+    return return_type{};
+  };
+
+  if constexpr (sizeof...(Vs) > 0) {
+    return std::apply([&](auto&... v) { return (..., process_one(v)); }, intern_);
+  }
+  return return_type{};
+}
+
+template <typename... Vs>
+void O3_CPU::value_module_model<Vs...>::impl_last_load_result(champsim::address ip, champsim::address address, std::optional<uint64_t> value)
+{
+  [[maybe_unused]] auto process_one = [&](auto& v) {
+    using namespace champsim::modules;
+    if constexpr (value_predictor::has_last_load_result<decltype(v), champsim::address, champsim::address, std::optional<uint64_t>>)
+      v.last_load_result(ip, address, value);
+    if constexpr (value_predictor::has_last_load_result<decltype(v), uint64_t, uint64_t, std::optional<uint64_t>>)
+      v.last_load_result(ip.to<uint64_t>(), address.to<uint64_t>(), value);
+  };
+
+  std::apply([&](auto&... v) { (..., process_one(v)); }, intern_);
+}
+
 #ifdef SET_ASIDE_CHAMPSIM_MODULE
 #undef SET_ASIDE_CHAMPSIM_MODULE
 #define CHAMPSIM_MODULE
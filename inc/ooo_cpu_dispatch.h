@@ -0,0 +1,77 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The parts of the core that call its branch predictor and BTB. They are templates over the types that the hooks are called through, which are
+ * either the module concepts or the module models that the core was built with. A core that is built with champsim::modules::static_dispatch is
+ * compiled for its models where it is built, so this file must be included there.
+ */
+
+#ifndef OOO_CPU_DISPATCH_H
+#define OOO_CPU_DISPATCH_H
+
+#include <fmt/core.h>
+
+#include "cache.h"
+#include "champsim.h"
+#include "instruction.h"
+#include "ooo_cpu.h"
+
+template <typename B, typename T>
+bool O3_CPU::do_predict_branch(ooo_model_instr& arch_instr)
+{
+  bool stop_fetch = false;
+
+  // handle branch prediction for all instructions as at this point we do not know if the instruction is a branch
+  sim_stats.total_branch_types.increment(arch_instr.branch);
+  auto [predicted_branch_target, always_taken] = btb_module<T>().impl_btb_prediction(arch_instr.ip, arch_instr.branch);
+  arch_instr.branch_prediction =
+      branch_module<B>(arch_instr.thread).impl_predict_branch(arch_instr.ip, predicted_branch_target, always_taken, arch_instr.branch) || always_taken;
+  if (!arch_instr.branch_prediction) {
+    predicted_branch_target = champsim::address{};
+  }
+
+  if (arch_instr.is_branch) {
+    if constexpr (champsim::debug_print) {
+      fmt::print("[BRANCH] instr_id: {} ip: {} taken: {}\n", arch_instr.instr_id, arch_instr.ip, arch_instr.branch_taken);
+    }
+
+    // call code prefetcher every time the branch predictor is used
+    l1i->impl_prefetcher_branch_operate(arch_instr.ip, arch_instr.branch, predicted_branch_target);
+
+    if (predicted_branch_target != arch_instr.branch_target
+        || (((arch_instr.branch == BRANCH_CONDITIONAL) || (arch_instr.branch == BRANCH_OTHER))
+            && arch_instr.branch_taken != arch_instr.branch_prediction)) { // conditional branches are re-evaluated at decode when the target is computed
+      sim_stats.total_rob_occupancy_at_branch_mispredict += std::size(ROB);
+      sim_stats.branch_type_misses.increment(arch_instr.branch);
+      if (!warmup) {
+        threads.at(arch_instr.thread).fetch_resume_time = champsim::chrono::clock::time_point::max();
+        stop_fetch = true;
+        arch_instr.branch_mispredicted = true;
+        do_begin_wrong_path(arch_instr, predicted_branch_target);
+      }
+    } else {
+      stop_fetch = arch_instr.branch_taken; // if correctly predicted taken, then we can't fetch anymore instructions this cycle
+    }
+
+    btb_module<T>().impl_update_btb(arch_instr.ip, arch_instr.branch_target, arch_instr.branch_taken, arch_instr.branch);
+    branch_module<B>(arch_instr.thread).impl_last_branch_result(arch_instr.ip, arch_instr.branch_target, arch_instr.branch_taken, arch_instr.branch);
+  }
+
+  return stop_fetch;
+}
+
+#endif
@@ -24,6 +24,7 @@
 #include <vector>
 
 #include "cache_stats.h"
+#include "convergence_monitor.h"
 #include "core_stats.h"
 #include "dram_stats.h"
 
@@ -36,11 +37,16 @@ struct phase_info {
   long long length;
   std::vector<std::size_t> trace_index;
   std::vector<std::string> trace_names;
+  bool is_functional = false; // Warm the hierarchy without timing, instead of simulating the core
+  std::size_t functional_threads = 1; // The number of threads that warm each of the lower levels, in a functional phase
+  convergence_options convergence{};
 };
 
 struct phase_stats {
   std::string name;
   std::vector<std::string> trace_names;
+  std::vector<uint32_t> trace_cpus{};            // The CPU that runs each trace, on one of its hardware threads
+  std::vector<long long> warmup_instructions{}; // The length of the warmup of each CPU, if it was ended once converged
   std::vector<O3_CPU::stats_type> roi_cpu_stats, sim_cpu_stats;
   std::vector<CACHE::stats_type> roi_cache_stats, sim_cache_stats;
   std::vector<DRAM_CHANNEL::stats_type> roi_dram_stats, sim_dram_stats;
@@ -0,0 +1,99 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PIPELINE_TRACE_H
+#define PIPELINE_TRACE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+
+#include "chrono.h"
+#include "inf_stream.h"
+#include "instruction.h"
+
+namespace champsim
+{
+/**
+ * Records the time at which each instruction reaches each stage of the pipeline, and writes them in the O3PipeView format, which Konata can display.
+ *
+ * Only the instructions in a window of instruction IDs are traced, and of those only one in every ``period``. The records of the instructions in flight
+ * are held in a ring buffer that is allocated once. An instruction whose place in the ring is held by one still in flight is not traced.
+ * When an instruction retires, its record is formatted into a buffer, which is compressed and written to the file in large blocks.
+ */
+class pipeline_tracer
+{
+public:
+  enum class stage : std::size_t { fetch, fetch_issue, fetch_complete, decode, dispatch, schedule, execute, memory_return, complete, retire, count };
+
+  struct options {
+    uint64_t begin = 0;                                  // The first instruction ID to trace
+    uint64_t end = std::numeric_limits<uint64_t>::max(); // One past the last instruction ID to trace
+    uint64_t period = 1;                                 // Trace one in every this many instructions
+    std::size_t capacity = 4096;                         // The most traced instructions that may be in flight at once
+  };
+
+private:
+  using time_point = champsim::chrono::clock::time_point;
+  using stream_type = champsim::def_ostream<champsim::decomp_tags::gzip_tag_t<>>;
+
+  struct record {
+    bool live = false;
+    uint64_t instr_id = 0;
+    uint64_t ip = 0;
+    std::optional<uint64_t> load_address{};
+    std::optional<uint64_t> store_address{};
+    bool is_branch = false;
+    std::array<std::optional<time_point>, static_cast<std::size_t>(stage::count)> stamps{};
+  };
+
+  options opts;
+  std::vector<record> ring;
+  fmt::memory_buffer pending{};
+  stream_type output;
+  uint64_t num_dropped = 0;
+
+  [[nodiscard]] bool is_sampled(uint64_t instr_id) const;
+  [[nodiscard]] record& slot(uint64_t instr_id);
+  void write(const record& rec);
+  void flush();
+
+public:
+  pipeline_tracer(std::string filename, options trace_opts);
+  ~pipeline_tracer();
+
+  pipeline_tracer(const pipeline_tracer&) = delete;
+  pipeline_tracer& operator=(const pipeline_tracer&) = delete;
+
+  /**
+   * Record that an instruction has reached a stage.
+   * An instruction is traced from when it is fetched, and its record is written when it retires.
+   */
+  void stamp(stage s, const ooo_model_instr& instr, time_point time);
+
+  /**
+   * The number of sampled instructions that were not traced because the ring was full
+   */
+  [[nodiscard]] uint64_t dropped() const { return num_dropped; }
+};
+} // namespace champsim
+
+#endif
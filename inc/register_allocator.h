@@ -1,8 +1,9 @@
-#include <array>
 #include <cstdint>
+#include <limits>
 #include <list>
 #include <optional>
 #include <queue>
+#include <vector>
 
 #ifndef REG_ALLOC_H
 #define REG_ALLOC_H
@@ -19,19 +20,25 @@ struct physical_register {
 class RegisterAllocator
 {
 private:
-  std::array<PHYSICAL_REGISTER_ID, std::numeric_limits<uint8_t>::max() + 1> frontend_RAT, backend_RAT;
+  static constexpr std::size_t ARCH_REGISTERS = std::numeric_limits<uint8_t>::max() + 1;
+
+  // Each hardware thread has its own architectural registers, which follow those of the threads before it in the RATs
+  std::vector<PHYSICAL_REGISTER_ID> frontend_RAT, backend_RAT;
   std::queue<PHYSICAL_REGISTER_ID> free_registers;
   std::vector<physical_register> physical_register_file;
 
+  [[nodiscard]] static std::size_t arch_index(int16_t reg, std::size_t thread);
+
 public:
-  RegisterAllocator(size_t num_physical_registers);
-  PHYSICAL_REGISTER_ID rename_dest_register(int16_t reg, champsim::program_ordered<ooo_model_instr>::id_type producer_id);
-  PHYSICAL_REGISTER_ID rename_src_register(int16_t reg);
+  explicit RegisterAllocator(size_t num_physical_registers, std::size_t num_threads = 1);
+  PHYSICAL_REGISTER_ID rename_dest_register(int16_t reg, champsim::program_ordered<ooo_model_instr>::id_type producer_id, std::size_t thread = 0);
+  PHYSICAL_REGISTER_ID rename_src_register(int16_t reg, std::size_t thread = 0);
   void complete_dest_register(PHYSICAL_REGISTER_ID physreg);
+  void invalidate_dest_register(PHYSICAL_REGISTER_ID physreg);
   void retire_dest_register(PHYSICAL_REGISTER_ID physreg);
   void free_register(PHYSICAL_REGISTER_ID physreg);
   bool isValid(PHYSICAL_REGISTER_ID physreg) const;
-  bool isAllocated(PHYSICAL_REGISTER_ID archreg) const;
+  bool isAllocated(PHYSICAL_REGISTER_ID archreg, std::size_t thread = 0) const;
   unsigned long count_free_registers() const;
   int count_reg_dependencies(const ooo_model_instr& instr) const;
   void reset_frontend_RAT();
@@ -0,0 +1,119 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SLICE_ROUTER_H
+#define SLICE_ROUTER_H
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "address.h"
+#include "channel.h"
+#include "chrono.h"
+#include "operable.h"
+
+namespace champsim
+{
+/**
+ * The function used to select the slice of a sliced cache that holds a block.
+ * Both fold the entire block number, so that each slice sees an even distribution of set indices.
+ */
+enum class slice_hash { xor_fold, multiplicative };
+
+/**
+ * Connects each upper level of a sliced cache to every slice.
+ *
+ * Requests that arrive from an upper level are held for the routing latency, then placed in the queues of the slice
+ * selected by the address hash. A request that is held takes a place in the queue of its slice, so the router adds no
+ * buffering beyond the queues of the slices. Responses from the slices are held for the routing latency on the return path as well.
+ * Each slice is an independent CACHE, with its own MSHR and queues.
+ */
+class slice_router : public champsim::operable
+{
+  using channel_type = champsim::channel;
+  using request_type = typename channel_type::request_type;
+  using response_type = typename channel_type::response_type;
+
+  template <typename T>
+  struct routed_type {
+    T packet;
+    champsim::chrono::clock::time_point event_cycle;
+  };
+
+  struct routed_queue_type {
+    std::deque<routed_type<request_type>> packets{};
+    std::vector<std::size_t> per_slice{}; // The number of packets held for each slice
+  };
+
+  struct port_type {
+    channel_type* upper_level;
+    std::vector<channel_type*> slices;
+
+    routed_queue_type RQ{}, WQ{}, PQ{};
+    std::deque<routed_type<response_type>> returned{};
+  };
+
+  std::vector<port_type> ports;
+
+  template <typename F, typename G>
+  long accept_requests(std::deque<request_type>& source, routed_queue_type& queue, const std::vector<channel_type*>& slices, F&& occupancy_func,
+                       G&& size_func);
+  template <typename F>
+  long route_requests(routed_queue_type& queue, const std::vector<channel_type*>& slices, F&& add_func);
+  long route_responses(port_type& port);
+
+public:
+  const std::string NAME;
+  const std::size_t NUM_SLICE;
+  const champsim::chrono::clock::duration ROUTE_LATENCY;
+  const slice_hash HASH;
+  const champsim::data::bits OFFSET_BITS;
+
+  /**
+   * :param name: The name of the sliced cache, used in deadlock printing
+   * :param clock_period: The clock period of the network between the upper levels and the slices
+   * :param upper_levels: The channels to each upper level of the sliced cache
+   * :param slice_levels: For each upper level, the channels to each slice. Each inner vector must have one channel per slice.
+   * :param latency: The number of cycles taken to route a packet in each direction
+   * :param hash: The function used to select a slice
+   * :param offset_bits: The number of block offset bits, which do not participate in the hash
+   */
+  slice_router(std::string name, champsim::chrono::picoseconds clock_period, std::vector<channel_type*> upper_levels,
+               std::vector<std::vector<channel_type*>> slice_levels, long latency, slice_hash hash, champsim::data::bits offset_bits);
+
+  long operate() final;
+  void print_deadlock() final;
+
+  [[nodiscard]] std::size_t get_slice(champsim::address address) const;
+
+  /**
+   * Find the channel to the slice that holds a block, as seen from one of the upper levels
+   *
+   * :return: The channel, or nullptr if the channel is not an upper level of this router
+   */
+  [[nodiscard]] channel_type* route(const channel_type* upper_level, champsim::address address) const;
+
+  /**
+   * Get the channels to every slice, as seen from one of the upper levels
+   *
+   * :return: The channels, which are empty if the channel is not an upper level of this router
+   */
+  [[nodiscard]] std::vector<channel_type*> slice_channels(const channel_type* upper_level) const;
+};
+} // namespace champsim
+
+#endif
@@ -25,6 +25,11 @@ namespace champsim
 constexpr char REG_STACK_POINTER = 6;
 constexpr char REG_FLAGS = 25;
 constexpr char REG_INSTRUCTION_POINTER = 26;
+
+// the classes that the extended format may record for an instruction that is not a branch or memory operation
+constexpr unsigned char INSTR_CLASS_ALU = 0;
+constexpr unsigned char INSTR_CLASS_SLOW_ALU = 1;
+constexpr unsigned char INSTR_CLASS_FP = 2;
 } // namespace champsim
 
 // instruction format
@@ -64,6 +69,25 @@ struct cloudsuite_instr {
 
   unsigned char asid[2];
 };
+
+// The standard format, followed by the value read by the first load of the instruction and the class of the instruction
+struct value_instr {
+  // instruction pointer or PC (Program Counter)
+  unsigned long long ip;
+
+  // branch info
+  unsigned char is_branch;
+  unsigned char branch_taken;
+
+  unsigned char destination_registers[NUM_INSTR_DESTINATIONS]; // output registers
+  unsigned char source_registers[NUM_INSTR_SOURCES];           // input registers
+
+  unsigned long long destination_memory[NUM_INSTR_DESTINATIONS]; // output memory
+  unsigned long long source_memory[NUM_INSTR_SOURCES];           // input memory
+
+  unsigned long long load_value; // the value read from the first source memory address
+  unsigned char instr_class;     // one of the champsim::INSTR_CLASS_ values
+};
 // NOLINTEND(cppcoreguidelines-avoid-c-arrays,modernize-avoid-c-arrays)
 
 #endif
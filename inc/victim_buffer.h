@@ -0,0 +1,87 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VICTIM_BUFFER_H
+#define VICTIM_BUFFER_H
+
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+#include "address.h"
+#include "block.h"
+
+namespace champsim
+{
+/**
+ * A small, fully-associative buffer that holds the blocks evicted from the sets of a cache, after Jouppi (ISCA 1990).
+ *
+ * Blocks are kept in order of insertion, and the oldest block is displaced when the buffer is full.
+ * The entries are indexed by their tags, so that a lookup does not search the whole buffer.
+ */
+class victim_buffer
+{
+  using list_type = std::list<champsim::cache_block>;
+
+  std::size_t SIZE;
+  champsim::data::bits TAG_OFFSET;
+
+  list_type entries{}; // The newest entry is at the front
+  std::unordered_map<uint64_t, list_type::iterator> index{};
+
+  [[nodiscard]] uint64_t get_key(champsim::address addr) const;
+
+public:
+  /**
+   * :param size: The number of entries
+   * :param tag_offset: The number of low bits of the address that are not part of the tag of the cache
+   */
+  victim_buffer(std::size_t size, champsim::data::bits tag_offset);
+
+  /**
+   * Find the entry that holds the tag of an address
+   *
+   * :return: A pointer to the entry, or nullptr if the tag is not held
+   */
+  [[nodiscard]] champsim::cache_block* find(champsim::address addr);
+
+  /**
+   * Remove the entry that holds the tag of an address
+   *
+   * :return: The removed block, which is not valid if the tag was not held
+   */
+  champsim::cache_block take(champsim::address addr);
+
+  /**
+   * The entry that the next insertion would displace
+   *
+   * :return: A pointer to the entry, or nullptr if the buffer has room
+   */
+  [[nodiscard]] champsim::cache_block* next_displaced();
+
+  /**
+   * Insert a block whose tag is not held, displacing the oldest entry if the buffer is full
+   *
+   * :return: The displaced block, which is not valid if the buffer had room
+   */
+  champsim::cache_block insert(const champsim::cache_block& block);
+
+  [[nodiscard]] std::size_t size() const;
+  [[nodiscard]] std::size_t capacity() const;
+};
+} // namespace champsim
+
+#endif
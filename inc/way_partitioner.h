@@ -0,0 +1,107 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WAY_PARTITIONER_H
+#define WAY_PARTITIONER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "address.h"
+#include "block.h"
+
+namespace champsim
+{
+/**
+ * Utility-based way partitioning of a shared cache, after Qureshi and Patt (MICRO 2006).
+ *
+ * A utility monitor keeps a shadow tag directory for each CPU on a sample of the sets, and counts the hits at each
+ * position of its LRU stack. Every interval, a lookahead allocator divides the ways among the CPUs to maximize the
+ * total number of hits, and the counters are halved.
+ *
+ * The allocation is enforced on top of the cache's replacement policy. A CPU that holds fewer blocks in a set than its
+ * allocation takes its victim from a CPU that holds more than its own. Otherwise, the victim must be one of its own blocks.
+ * The victim chosen by the replacement policy is kept if it satisfies these rules. If not, the least recently used
+ * eligible block is chosen instead.
+ */
+class way_partitioner
+{
+  long NUM_SET;
+  long NUM_WAY;
+  long NUM_UMON_SET;
+  uint64_t INTERVAL;
+
+  // The shadow tags of the sampled sets, for each CPU, in LRU order
+  std::vector<std::vector<std::vector<uint64_t>>> shadow_tags;
+  std::vector<std::vector<uint64_t>> stack_hits;
+
+  std::vector<uint64_t> last_used;
+  uint64_t access_count = 0;
+  uint64_t cycle_count = 0;
+
+  std::vector<long> allocation;
+
+  [[nodiscard]] long get_umon_index(long set) const;
+  [[nodiscard]] uint64_t marginal_hits(std::size_t cpu, long from, long to) const;
+
+public:
+  /**
+   * :param num_cpus: The number of CPUs that share the cache
+   * :param sets: The number of sets in the cache
+   * :param ways: The number of ways in the cache
+   * :param umon_sets: The number of sets that are monitored. This is rounded to a power of two, no greater than the number of sets.
+   * :param interval: The number of cycles between repartitions
+   */
+  way_partitioner(std::size_t num_cpus, long sets, long ways, long umon_sets, uint64_t interval);
+
+  /**
+   * Record a demand access in the utility monitor.
+   */
+  void access(uint32_t cpu, long set, champsim::block_number block);
+
+  /**
+   * Record that a way has been used, for the least recently used fallback.
+   */
+  void touch(long set, long way);
+
+  /**
+   * Advance one cycle, repartitioning the ways at the end of each interval.
+   *
+   * :return: True if the ways were repartitioned
+   */
+  bool cycle();
+
+  /**
+   * Perform the lookahead allocation immediately.
+   */
+  void repartition();
+
+  /**
+   * Enforce the allocation on the victim proposed by the replacement policy.
+   *
+   * :param cpu: The CPU whose fill needs a victim
+   * :param set: The set index
+   * :param proposed: The way proposed by the replacement policy
+   * :param current_set: A pointer to the first block of the set
+   * :return: The way to evict
+   */
+  [[nodiscard]] long enforce(uint32_t cpu, long set, long proposed, const champsim::cache_block* current_set) const;
+
+  [[nodiscard]] const std::vector<long>& get_allocation() const;
+};
+} // namespace champsim
+
+#endif
@@ -0,0 +1,64 @@
+#include "store_sets.h"
+
+#include <algorithm>
+#include <limits>
+
+std::size_t store_sets::ssit_index(champsim::address ip)
+{
+  constexpr champsim::data::bits LOG2_SSIT_SIZE{champsim::lg2(SSIT_SIZE)};
+
+  auto hash = ip.slice<LOG2_SSIT_SIZE, champsim::data::bits{}>().to<std::size_t>();
+  hash ^= ip.slice<2 * LOG2_SSIT_SIZE, LOG2_SSIT_SIZE>().to<std::size_t>();
+  return hash % SSIT_SIZE;
+}
+
+uint64_t store_sets::predict_dependence(champsim::address ip, uint64_t)
+{
+  if (++predictions % CLEAR_INTERVAL == 0) {
+    ssit.fill(std::nullopt);
+    lfst.fill(std::nullopt);
+  }
+
+  auto ssid = ssit.at(ssit_index(ip));
+  if (!ssid.has_value()) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  return lfst.at(ssid.value()).value_or(std::numeric_limits<uint64_t>::max());
+}
+
+void store_sets::store_dispatched(champsim::address ip, uint64_t instr_id)
+{
+  if (auto ssid = ssit.at(ssit_index(ip)); ssid.has_value()) {
+    lfst.at(ssid.value()) = instr_id;
+  }
+}
+
+void store_sets::store_executed(champsim::address ip, uint64_t instr_id)
+{
+  // A younger store of the set may have replaced this one
+  if (auto ssid = ssit.at(ssit_index(ip)); ssid.has_value() && lfst.at(ssid.value()) == instr_id) {
+    lfst.at(ssid.value()).reset();
+  }
+}
+
+void store_sets::dependence_violation(champsim::address load_ip, champsim::address store_ip)
+{
+  auto& load_ssid = ssit.at(ssit_index(load_ip));
+  auto& store_ssid = ssit.at(ssit_index(store_ip));
+
+  if (!load_ssid.has_value() && !store_ssid.has_value()) {
+    // Neither is in a set, so they form a new one
+    load_ssid = next_ssid;
+    store_ssid = next_ssid;
+    next_ssid = (next_ssid + 1) % LFST_SIZE;
+  } else if (!load_ssid.has_value()) {
+    load_ssid = store_ssid;
+  } else if (!store_ssid.has_value()) {
+    store_ssid = load_ssid;
+  } else {
+    // Both are in sets, which merge into the smaller identifier
+    auto merged = std::min(load_ssid.value(), store_ssid.value());
+    load_ssid = merged;
+    store_ssid = merged;
+  }
+}
@@ -0,0 +1,34 @@
+#ifndef MEMORY_DEPENDENCE_STORE_SETS_H
+#define MEMORY_DEPENDENCE_STORE_SETS_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#include "address.h"
+#include "modules.h"
+
+/*
+ * Store set memory dependence prediction, after Chrysos and Emer (ISCA 1998).
+ * A load and the stores it has conflicted with share a store set. A load waits for the most recently dispatched store of its set that has not executed.
+ */
+struct store_sets : champsim::modules::memory_dependence_predictor {
+  static constexpr std::size_t SSIT_SIZE = 4096;      // Store set identifier table, indexed by instruction address
+  static constexpr std::size_t LFST_SIZE = 256;       // Last fetched store table, indexed by store set
+  static constexpr uint64_t CLEAR_INTERVAL = 1000000; // Predictions between clears of the tables, so that stale sets do not accumulate
+
+  std::array<std::optional<std::size_t>, SSIT_SIZE> ssit{};
+  std::array<std::optional<uint64_t>, LFST_SIZE> lfst{};
+  std::size_t next_ssid = 0;
+  uint64_t predictions = 0;
+
+  using memory_dependence_predictor::memory_dependence_predictor;
+
+  static std::size_t ssit_index(champsim::address ip);
+  uint64_t predict_dependence(champsim::address ip, uint64_t instr_id);
+  void store_dispatched(champsim::address ip, uint64_t instr_id);
+  void store_executed(champsim::address ip, uint64_t instr_id);
+  void dependence_violation(champsim::address load_ip, champsim::address store_ip);
+};
+
+#endif
@@ -11,6 +11,8 @@ class no : public champsim::modules::prefetcher
 public:
   using prefetcher::prefetcher;
 
+  static constexpr bool set_local = true;
+
   // void prefetcher_initialize() {}
   // void prefetcher_branch_operate(champsim::address ip, uint8_t branch_type, champsim::address branch_target) {}
   uint32_t prefetcher_cache_operate(champsim::address addr, champsim::address ip, uint8_t cache_hit, bool useful_prefetch, access_type type,
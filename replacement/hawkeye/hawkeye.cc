@@ -0,0 +1,142 @@
+#include "hawkeye.h"
+
+#include <algorithm>
+#include <cassert>
+#include <fmt/core.h>
+
+hawkeye::hawkeye(CACHE* cache) : hawkeye(cache, cache->NUM_SET, cache->NUM_WAY) {}
+
+hawkeye::hawkeye(CACHE* cache, long sets, long ways)
+    : replacement(cache), NUM_SET(sets), NUM_WAY(ways), SAMPLE_STRIDE(std::max(sets / SAMPLED_SETS, 1L)),
+      rrpv(static_cast<std::size_t>(sets * ways), maxRRPV), signatures(static_cast<std::size_t>(sets * ways), 0),
+      predictor(PREDICTOR_SIZE, champsim::msl::fwcounter<COUNTER_WIDTH>{1 << (COUNTER_WIDTH - 1)})
+{
+  const auto num_sampled = static_cast<std::size_t>((sets + SAMPLE_STRIDE - 1) / SAMPLE_STRIDE);
+  const auto history = static_cast<std::size_t>(HISTORY * ways);
+  optgens.assign(num_sampled, champsim::msl::optgen{static_cast<std::size_t>(ways), history});
+  samplers.assign(num_sampled, champsim::msl::reuse_sampler{history});
+}
+
+uint32_t hawkeye::get_signature(champsim::address ip, access_type type)
+{
+  // Prefetches are predicted separately from demands of the same PC
+  auto val = (ip.to<uint64_t>() << 1) | (type == access_type::PREFETCH ? 1 : 0);
+  val ^= (val >> 11) ^ (val >> 22);
+  return static_cast<uint32_t>(val % PREDICTOR_SIZE);
+}
+
+bool hawkeye::is_friendly(uint32_t signature) const { return predictor.at(signature).value() >= (1 << (COUNTER_WIDTH - 1)); }
+
+void hawkeye::train(long set, champsim::address full_addr, uint32_t signature)
+{
+  if (set % SAMPLE_STRIDE != 0) {
+    return;
+  }
+
+  auto& optgen = optgens.at(static_cast<std::size_t>(set / SAMPLE_STRIDE));
+  auto& sampler = samplers.at(static_cast<std::size_t>(set / SAMPLE_STRIDE));
+  const auto tag = champsim::block_number{full_addr}.to<uint64_t>();
+
+  if (auto* entry = sampler.find(tag); entry != nullptr) {
+    // Train the PC of the previous access on whether OPT would have kept the block until now
+    auto& counter = predictor.at(entry->signature);
+    if (optgen.in_window(entry->last_access) && optgen.should_cache(entry->last_access)) {
+      ++counter;
+    } else {
+      --counter;
+    }
+    entry->signature = signature;
+    entry->last_access = optgen.now();
+  } else {
+    // The sampler holds a full window, so a replaced entry was not reused within it
+    auto evicted = sampler.insert(tag, signature, optgen.now());
+    if (evicted.valid) {
+      --predictor.at(evicted.signature);
+    }
+  }
+
+  optgen.add_access();
+}
+
+void hawkeye::promote(long set, long way, uint32_t signature, bool hit)
+{
+  const auto base = static_cast<std::size_t>(set * NUM_WAY);
+  signatures.at(base + static_cast<std::size_t>(way)) = signature;
+
+  if (!is_friendly(signature)) {
+    rrpv.at(base + static_cast<std::size_t>(way)) = maxRRPV;
+    return;
+  }
+
+  // Age the other cache-friendly blocks when a new one is inserted, short of making them cache-averse
+  if (!hit) {
+    for (long other = 0; other < NUM_WAY; ++other) {
+      auto& other_rrpv = rrpv.at(base + static_cast<std::size_t>(other));
+      if (other != way && other_rrpv < maxRRPV - 1) {
+        ++other_rrpv;
+      }
+    }
+  }
+  rrpv.at(base + static_cast<std::size_t>(way)) = 0;
+}
+
+long hawkeye::find_victim(uint32_t triggering_cpu, uint64_t instr_id, long set, const champsim::cache_block* current_set, champsim::address ip,
+                          champsim::address full_addr, access_type type)
+{
+  auto begin = std::next(std::begin(rrpv), set * NUM_WAY);
+  auto end = std::next(begin, NUM_WAY);
+
+  // Prefer a cache-averse block
+  if (auto averse = std::find(begin, end, maxRRPV); averse != end) {
+    return std::distance(begin, averse);
+  }
+
+  // Otherwise, evict the oldest cache-friendly block. It was not reused, so its PC is detrained.
+  auto victim = std::max_element(begin, end);
+  assert(begin <= victim);
+  assert(victim < end);
+  --predictor.at(signatures.at(static_cast<std::size_t>(std::distance(std::begin(rrpv), victim))));
+  return std::distance(begin, victim);
+}
+
+void hawkeye::replacement_cache_fill(uint32_t triggering_cpu, long set, long way, champsim::address full_addr, champsim::address ip,
+                                     champsim::address victim_addr, access_type type)
+{
+  if (way >= NUM_WAY) {
+    return;
+  }
+
+  // Writebacks are not predicted, and are inserted as cache-averse
+  if (access_type{type} == access_type::WRITE) {
+    rrpv.at(static_cast<std::size_t>(set * NUM_WAY + way)) = maxRRPV;
+    return;
+  }
+
+  promote(set, way, get_signature(ip, type), false);
+}
+
+void hawkeye::update_replacement_state(uint32_t triggering_cpu, long set, long way, champsim::address full_addr, champsim::address ip,
+                                       champsim::address victim_addr, access_type type, uint8_t hit)
+{
+  if (access_type{type} == access_type::WRITE) {
+    return;
+  }
+
+  const auto signature = get_signature(ip, type);
+  train(set, full_addr, signature);
+
+  if (hit) {
+    promote(set, way, signature, true);
+  }
+}
+
+void hawkeye::replacement_final_stats()
+{
+  uint64_t opt_hits = 0;
+  uint64_t opt_accesses = 0;
+  for (const auto& optgen : optgens) {
+    opt_hits += optgen.hits();
+    opt_accesses += optgen.accesses();
+  }
+  fmt::print("{} Hawkeye OPTgen hits: {} accesses: {}\n", intern_->NAME, opt_hits, opt_accesses);
+}
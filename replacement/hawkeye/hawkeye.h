@@ -0,0 +1,52 @@
+#ifndef REPLACEMENT_HAWKEYE_H
+#define REPLACEMENT_HAWKEYE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "cache.h"
+#include "modules.h"
+#include "msl/fwcounter.h"
+#include "msl/optgen.h"
+
+/**
+ * Hawkeye replacement (Jain and Lin, ISCA 2016).
+ *
+ * OPTgen reconstructs Belady's decisions on a sample of the sets. A table of counters, indexed by a hash of the PC, learns whether the loads of each
+ * PC would hit under OPT. Blocks from cache-friendly PCs are inserted at high priority, and blocks from cache-averse PCs are evicted first.
+ */
+struct hawkeye : public champsim::modules::replacement {
+  static constexpr int maxRRPV = 7;
+  static constexpr long SAMPLED_SETS = 64;
+  static constexpr long HISTORY = 8; // The length of the OPTgen window, as a multiple of the associativity
+  static constexpr std::size_t PREDICTOR_SIZE = 2048;
+  static constexpr std::size_t COUNTER_WIDTH = 3;
+
+  long NUM_SET, NUM_WAY;
+  long SAMPLE_STRIDE;
+
+  std::vector<int> rrpv;
+  std::vector<uint32_t> signatures;
+
+  std::vector<champsim::msl::optgen> optgens;
+  std::vector<champsim::msl::reuse_sampler> samplers;
+  std::vector<champsim::msl::fwcounter<COUNTER_WIDTH>> predictor;
+
+  explicit hawkeye(CACHE* cache);
+  hawkeye(CACHE* cache, long sets, long ways);
+
+  [[nodiscard]] static uint32_t get_signature(champsim::address ip, access_type type);
+  [[nodiscard]] bool is_friendly(uint32_t signature) const;
+  void train(long set, champsim::address full_addr, uint32_t signature);
+  void promote(long set, long way, uint32_t signature, bool hit);
+
+  long find_victim(uint32_t triggering_cpu, uint64_t instr_id, long set, const champsim::cache_block* current_set, champsim::address ip,
+                   champsim::address full_addr, access_type type);
+  void replacement_cache_fill(uint32_t triggering_cpu, long set, long way, champsim::address full_addr, champsim::address ip, champsim::address victim_addr,
+                              access_type type);
+  void update_replacement_state(uint32_t triggering_cpu, long set, long way, champsim::address full_addr, champsim::address ip, champsim::address victim_addr,
+                                access_type type, uint8_t hit);
+  void replacement_final_stats();
+};
+
+#endif
@@ -5,7 +5,10 @@
 
 lru::lru(CACHE* cache) : lru(cache, cache->NUM_SET, cache->NUM_WAY) {}
 
-lru::lru(CACHE* cache, long sets, long ways) : replacement(cache), NUM_WAY(ways), last_used_cycles(static_cast<std::size_t>(sets * ways), 0) {}
+lru::lru(CACHE* cache, long sets, long ways)
+    : replacement(cache), NUM_WAY(ways), last_used_cycles(static_cast<std::size_t>(sets * ways), 0), cycles(static_cast<std::size_t>(sets), 0)
+{
+}
 
 long lru::find_victim(uint32_t triggering_cpu, uint64_t instr_id, long set, const champsim::cache_block* current_set, champsim::address ip,
                       champsim::address full_addr, access_type type)
@@ -24,7 +27,7 @@ void lru::replacement_cache_fill(uint32_t triggering_cpu, long set, long way, ch
                                  access_type type)
 {
   // Mark the way as being used on the current cycle
-  last_used_cycles.at((std::size_t)(set * NUM_WAY + way)) = cycle++;
+  last_used_cycles.at((std::size_t)(set * NUM_WAY + way)) = cycles.at(static_cast<std::size_t>(set))++;
 }
 
 void lru::update_replacement_state(uint32_t triggering_cpu, long set, long way, champsim::address full_addr, champsim::address ip,
@@ -32,5 +35,5 @@ void lru::update_replacement_state(uint32_t triggering_cpu, long set, long way,
 {
   // Mark the way as being used on the current cycle
   if (hit && access_type{type} != access_type::WRITE) // Skip this for writeback hits
-    last_used_cycles.at((std::size_t)(set * NUM_WAY + way)) = cycle++;
+    last_used_cycles.at((std::size_t)(set * NUM_WAY + way)) = cycles.at(static_cast<std::size_t>(set))++;
 }
@@ -10,9 +10,11 @@ class lru : public champsim::modules::replacement
 {
   long NUM_WAY;
   std::vector<uint64_t> last_used_cycles;
-  uint64_t cycle = 0;
+  std::vector<uint64_t> cycles; // Counted separately in each set, since only the order within a set matters
 
 public:
+  static constexpr bool set_local = true;
+
   explicit lru(CACHE* cache);
   lru(CACHE* cache, long sets, long ways);
 
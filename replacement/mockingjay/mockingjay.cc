@@ -0,0 +1,157 @@
+#include "mockingjay.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <fmt/core.h>
+
+#include "champsim.h"
+
+mockingjay::mockingjay(CACHE* cache) : mockingjay(cache, cache->NUM_SET, cache->NUM_WAY) {}
+
+mockingjay::mockingjay(CACHE* cache, long sets, long ways)
+    : replacement(cache), NUM_SET(sets), NUM_WAY(ways), SAMPLE_STRIDE(std::max(sets / SAMPLED_SETS, 1L)),
+      INF_RD(std::min(HISTORY * ways - 1, static_cast<long>(champsim::msl::fwcounter<RD_WIDTH>::maximum))), MAX_RD(INF_RD * 5 / 6),
+      INF_ETR(std::max(INF_RD / GRANULARITY, 1L)), etr(static_cast<std::size_t>(sets * ways), 0), etr_clock(static_cast<std::size_t>(sets), 0),
+      rdp(RDP_SIZE), rdp_valid(RDP_SIZE, false)
+{
+  const auto num_sampled = static_cast<std::size_t>((sets + SAMPLE_STRIDE - 1) / SAMPLE_STRIDE);
+  samplers.assign(num_sampled, champsim::msl::reuse_sampler{static_cast<std::size_t>(HISTORY * ways)});
+  sample_clock.assign(num_sampled, 0);
+}
+
+uint32_t mockingjay::get_signature(champsim::address ip, bool hit, access_type type, uint32_t cpu)
+{
+  auto val = (ip.to<uint64_t>() << 2) | (hit ? 2 : 0) | (type == access_type::PREFETCH ? 1 : 0);
+  val ^= (val >> 11) ^ (val >> 22) ^ (uint64_t{cpu} << 7);
+  return static_cast<uint32_t>(val % RDP_SIZE);
+}
+
+int mockingjay::predict_etr(uint32_t signature) const
+{
+  // Without a prediction, a single core keeps the block, but on multiple cores it should not displace the blocks of others
+  if (!rdp_valid.at(signature)) {
+    return NUM_CPUS == 1 ? 0 : static_cast<int>(INF_ETR);
+  }
+  auto distance = rdp.at(signature).value();
+  if (distance > MAX_RD) {
+    return static_cast<int>(INF_ETR);
+  }
+  return static_cast<int>(distance / GRANULARITY);
+}
+
+void mockingjay::train_rdp(uint32_t signature, long distance)
+{
+  auto& predicted = rdp.at(signature);
+  if (!rdp_valid.at(signature)) {
+    predicted = distance;
+    rdp_valid.at(signature) = true;
+    return;
+  }
+
+  // Move the prediction a fraction of the way towards the sample
+  auto diff = static_cast<long>(distance - predicted.value());
+  auto step = std::max(std::abs(diff) / 16, 1L);
+  if (diff > 0) {
+    predicted += std::min(step, diff);
+  } else if (diff < 0) {
+    predicted -= std::min(step, -diff);
+  }
+}
+
+void mockingjay::train(long set, champsim::address full_addr, uint32_t signature)
+{
+  if (set % SAMPLE_STRIDE != 0) {
+    return;
+  }
+
+  auto& sampler = samplers.at(static_cast<std::size_t>(set / SAMPLE_STRIDE));
+  auto& now = sample_clock.at(static_cast<std::size_t>(set / SAMPLE_STRIDE));
+  const auto tag = champsim::block_number{full_addr}.to<uint64_t>();
+
+  if (auto* entry = sampler.find(tag); entry != nullptr) {
+    // Train the PC of the previous access on the observed distance
+    train_rdp(entry->signature, std::min(static_cast<long>(now - entry->last_access), INF_RD));
+    entry->signature = signature;
+    entry->last_access = now;
+  } else {
+    // A replaced entry that was not reused within the longest distance is learned as never reused
+    auto evicted = sampler.insert(tag, signature, now);
+    if (evicted.valid && static_cast<long>(now - evicted.last_access) > INF_RD) {
+      train_rdp(evicted.signature, INF_RD);
+    }
+  }
+
+  ++now;
+}
+
+void mockingjay::age(long set, long way)
+{
+  auto& clock = etr_clock.at(static_cast<std::size_t>(set));
+  if (++clock < GRANULARITY) {
+    return;
+  }
+
+  clock = 0;
+  for (long other = 0; other < NUM_WAY; ++other) {
+    auto& other_etr = etr.at(static_cast<std::size_t>(set * NUM_WAY + other));
+    if (other != way && std::abs(other_etr) < INF_ETR) {
+      --other_etr;
+    }
+  }
+}
+
+long mockingjay::find_victim(uint32_t triggering_cpu, uint64_t instr_id, long set, const champsim::cache_block* current_set, champsim::address ip,
+                             champsim::address full_addr, access_type type)
+{
+  // Bypass a block that is predicted to be reused after every block in the set. Writebacks may not bypass.
+  if (access_type{type} != access_type::WRITE) {
+    auto signature = get_signature(ip, false, type, triggering_cpu);
+    if (rdp_valid.at(signature) && rdp.at(signature).value() > MAX_RD) {
+      ++bypasses;
+      return NUM_WAY;
+    }
+  }
+
+  // Evict the block whose estimated time remaining is furthest from zero. Among equals, prefer one that is overdue.
+  auto begin = std::next(std::begin(etr), set * NUM_WAY);
+  auto end = std::next(begin, NUM_WAY);
+  auto victim = std::max_element(begin, end, [](int lhs, int rhs) { return std::abs(lhs) < std::abs(rhs) || (std::abs(lhs) == std::abs(rhs) && lhs > rhs); });
+  assert(begin <= victim);
+  assert(victim < end);
+  return std::distance(begin, victim);
+}
+
+void mockingjay::replacement_cache_fill(uint32_t triggering_cpu, long set, long way, champsim::address full_addr, champsim::address ip,
+                                        champsim::address victim_addr, access_type type)
+{
+  if (way >= NUM_WAY) {
+    return;
+  }
+
+  // Writebacks are not predicted, and are expected to be reused last
+  auto& block_etr = etr.at(static_cast<std::size_t>(set * NUM_WAY + way));
+  if (access_type{type} == access_type::WRITE) {
+    block_etr = static_cast<int>(INF_ETR);
+  } else {
+    block_etr = predict_etr(get_signature(ip, false, type, triggering_cpu));
+  }
+}
+
+void mockingjay::update_replacement_state(uint32_t triggering_cpu, long set, long way, champsim::address full_addr, champsim::address ip,
+                                          champsim::address victim_addr, access_type type, uint8_t hit)
+{
+  if (access_type{type} == access_type::WRITE) {
+    return;
+  }
+
+  const auto signature = get_signature(ip, hit, type, triggering_cpu);
+  train(set, full_addr, signature);
+  age(set, way);
+
+  if (hit) {
+    etr.at(static_cast<std::size_t>(set * NUM_WAY + way)) = predict_etr(signature);
+  }
+}
+
+void mockingjay::replacement_final_stats() { fmt::print("{} Mockingjay bypasses: {}\n", intern_->NAME, bypasses); }
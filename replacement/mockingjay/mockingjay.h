@@ -0,0 +1,58 @@
+#ifndef REPLACEMENT_MOCKINGJAY_H
+#define REPLACEMENT_MOCKINGJAY_H
+
+#include <cstdint>
+#include <vector>
+
+#include "cache.h"
+#include "modules.h"
+#include "msl/fwcounter.h"
+#include "msl/optgen.h"
+
+/**
+ * Mockingjay replacement (Shah, Jain, and Lin, HPCA 2022).
+ *
+ * A reuse distance predictor, indexed by a hash of the PC, learns the distance between accesses to a block on a sample of the sets.
+ * Each block holds its estimated time remaining until reuse, which counts down as the set is accessed. The block whose estimate is furthest from
+ * zero, either in the future or overdue, is evicted. A block that is predicted to be reused after every block in the set bypasses the cache.
+ */
+struct mockingjay : public champsim::modules::replacement {
+  static constexpr long SAMPLED_SETS = 64;
+  static constexpr long HISTORY = 8; // The longest reuse distance that is learned, as a multiple of the associativity
+  static constexpr long GRANULARITY = 8;
+  static constexpr std::size_t RDP_SIZE = 2048;
+  static constexpr std::size_t RD_WIDTH = 8;
+
+  long NUM_SET, NUM_WAY;
+  long SAMPLE_STRIDE;
+  long INF_RD, MAX_RD, INF_ETR;
+
+  std::vector<int> etr;
+  std::vector<long> etr_clock;
+
+  std::vector<champsim::msl::reuse_sampler> samplers;
+  std::vector<uint64_t> sample_clock;
+  std::vector<champsim::msl::fwcounter<RD_WIDTH>> rdp;
+  std::vector<bool> rdp_valid;
+
+  uint64_t bypasses = 0;
+
+  explicit mockingjay(CACHE* cache);
+  mockingjay(CACHE* cache, long sets, long ways);
+
+  [[nodiscard]] static uint32_t get_signature(champsim::address ip, bool hit, access_type type, uint32_t cpu);
+  [[nodiscard]] int predict_etr(uint32_t signature) const;
+  void train(long set, champsim::address full_addr, uint32_t signature);
+  void train_rdp(uint32_t signature, long distance);
+  void age(long set, long way);
+
+  long find_victim(uint32_t triggering_cpu, uint64_t instr_id, long set, const champsim::cache_block* current_set, champsim::address ip,
+                   champsim::address full_addr, access_type type);
+  void replacement_cache_fill(uint32_t triggering_cpu, long set, long way, champsim::address full_addr, champsim::address ip, champsim::address victim_addr,
+                              access_type type);
+  void update_replacement_state(uint32_t triggering_cpu, long set, long way, champsim::address full_addr, champsim::address ip, champsim::address victim_addr,
+                                access_type type, uint8_t hit);
+  void replacement_final_stats();
+};
+
+#endif
@@ -0,0 +1,372 @@
+#include "opt.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <fmt/core.h>
+
+namespace
+{
+constexpr std::size_t header_size = 5 * sizeof(uint64_t);
+
+bool file_exists(const std::string& path) { return std::ifstream{path}.good(); }
+
+// The descriptions in the header of an index are padded, so that the sections after them stay aligned
+constexpr std::size_t padded(std::size_t size) { return (size + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t); }
+} // namespace
+
+std::string opt_index::file_stamp(const std::string& path)
+{
+  struct stat file_stat {};
+  if (::stat(path.c_str(), &file_stat) != 0) {
+    return {};
+  }
+  return fmt::format("{} {} {}.{:09}", path, file_stat.st_size, file_stat.st_mtim.tv_sec, file_stat.st_mtim.tv_nsec);
+}
+
+void opt_index::begin_recording(std::ostream& trace, std::string_view run)
+{
+  std::array<uint64_t, 2> header{trace_magic, std::size(run)};
+  trace.write(reinterpret_cast<const char*>(header.data()), sizeof(header));
+  trace.write(std::data(run), static_cast<std::streamsize>(std::size(run)));
+}
+
+void opt_index::record(std::ostream& trace, long set, uint64_t block)
+{
+  auto set_idx = static_cast<uint32_t>(set);
+  trace.write(reinterpret_cast<const char*>(&set_idx), sizeof(set_idx));
+  trace.write(reinterpret_cast<const char*>(&block), sizeof(block));
+}
+
+std::optional<std::string> opt_index::recorded_from(const std::string& trace_path)
+{
+  std::ifstream trace{trace_path, std::ios::binary};
+  std::array<uint64_t, 2> header{};
+  if (!trace.read(reinterpret_cast<char*>(header.data()), sizeof(header)) || header[0] != trace_magic) {
+    return std::nullopt;
+  }
+  std::string run(header[1], '\0');
+  if (!trace.read(std::data(run), static_cast<std::streamsize>(std::size(run)))) {
+    return std::nullopt;
+  }
+  return run;
+}
+
+void opt_index::build(const std::string& trace_path, const std::string& index_path, long sets)
+{
+  // Group the recorded accesses by set, preserving their order
+  const auto run = recorded_from(trace_path);
+  if (!run.has_value()) {
+    throw std::invalid_argument{"The file " + trace_path + " is not a recorded access stream"};
+  }
+  const auto source = file_stamp(trace_path);
+
+  std::vector<std::vector<uint64_t>> sequences(static_cast<std::size_t>(sets));
+  std::ifstream trace{trace_path, std::ios::binary};
+  trace.seekg(static_cast<std::streamoff>(2 * sizeof(uint64_t) + std::size(*run)));
+  uint32_t set_idx = 0;
+  uint64_t block = 0;
+  while (trace.read(reinterpret_cast<char*>(&set_idx), sizeof(set_idx)) && trace.read(reinterpret_cast<char*>(&block), sizeof(block))) {
+    if (set_idx >= std::size(sequences)) {
+      throw std::invalid_argument{"The recorded access stream " + trace_path + " does not match the number of sets in the cache"};
+    }
+    sequences[set_idx].push_back(block);
+  }
+
+  std::vector<uint64_t> offsets{0};
+  for (const auto& seq : sequences) {
+    offsets.push_back(offsets.back() + std::size(seq));
+  }
+
+  // Walk each sequence backwards to find the distance to the next use of each access
+  std::vector<uint64_t> blocks;
+  std::vector<uint32_t> distances;
+  blocks.reserve(offsets.back());
+  distances.reserve(offsets.back());
+  for (const auto& seq : sequences) {
+    std::vector<uint32_t> seq_distances(std::size(seq), 0);
+    std::unordered_map<uint64_t, std::size_t> seen;
+    for (auto i = std::size(seq); i > 0; --i) {
+      auto [it, inserted] = seen.try_emplace(seq[i - 1], i - 1);
+      if (!inserted) {
+        // Distances that do not fit are treated as never being used again
+        auto distance = it->second - (i - 1);
+        seq_distances[i - 1] = (distance <= std::numeric_limits<uint32_t>::max()) ? static_cast<uint32_t>(distance) : 0;
+        it->second = i - 1;
+      }
+    }
+    blocks.insert(std::end(blocks), std::begin(seq), std::end(seq));
+    distances.insert(std::end(distances), std::begin(seq_distances), std::end(seq_distances));
+  }
+
+  std::ofstream index{index_path, std::ios::binary};
+  std::array<uint64_t, 5> header{magic, static_cast<uint64_t>(sets), offsets.back(), std::size(*run), std::size(source)};
+  std::string descriptions = *run + source;
+  descriptions.resize(padded(std::size(descriptions)), '\0');
+  index.write(reinterpret_cast<const char*>(header.data()), header_size);
+  index.write(std::data(descriptions), static_cast<std::streamsize>(std::size(descriptions)));
+  index.write(reinterpret_cast<const char*>(offsets.data()), static_cast<std::streamsize>(std::size(offsets) * sizeof(uint64_t)));
+  index.write(reinterpret_cast<const char*>(blocks.data()), static_cast<std::streamsize>(std::size(blocks) * sizeof(uint64_t)));
+  index.write(reinterpret_cast<const char*>(distances.data()), static_cast<std::streamsize>(std::size(distances) * sizeof(uint32_t)));
+  index.close(); // A short write may only be reported when the file is flushed
+  if (!index) {
+    throw std::runtime_error{"Could not write the next-use index " + index_path};
+  }
+}
+
+opt_index::opt_index(const std::string& index_path)
+{
+  auto fd = ::open(index_path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error{"Could not open the next-use index " + index_path};
+  }
+
+  struct stat file_stat {};
+  if (::fstat(fd, &file_stat) != 0 || static_cast<std::size_t>(file_stat.st_size) < header_size) {
+    ::close(fd);
+    throw std::runtime_error{"The next-use index " + index_path + " is truncated"};
+  }
+
+  mapping_size = static_cast<std::size_t>(file_stat.st_size);
+  auto* addr = ::mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    throw std::runtime_error{"Could not map the next-use index " + index_path};
+  }
+  mapping = static_cast<const std::byte*>(addr);
+
+  std::array<uint64_t, 5> header{};
+  std::memcpy(header.data(), mapping, header_size);
+  num_sets = header[1];
+  const auto num_entries = header[2];
+  const auto descriptions_size = padded(header[3] + header[4]);
+  if (header[0] != magic
+      || mapping_size != header_size + descriptions_size + (num_sets + 1) * sizeof(uint64_t) + num_entries * (sizeof(uint64_t) + sizeof(uint32_t))) {
+    ::munmap(const_cast<std::byte*>(mapping), mapping_size);
+    mapping = nullptr;
+    throw std::runtime_error{"The next-use index " + index_path + " is malformed"};
+  }
+
+  recorded_run = std::string_view{reinterpret_cast<const char*>(mapping + header_size), header[3]};
+  recording = std::string_view{std::data(recorded_run) + std::size(recorded_run), header[4]};
+
+  // The sections are laid out in order of decreasing alignment, beginning on a page boundary
+  offsets = reinterpret_cast<const uint64_t*>(mapping + header_size + descriptions_size);
+  blocks = offsets + num_sets + 1;
+  distances = reinterpret_cast<const uint32_t*>(blocks + num_entries);
+}
+
+opt_index::~opt_index()
+{
+  if (mapping != nullptr) {
+    ::munmap(const_cast<std::byte*>(mapping), mapping_size);
+  }
+}
+
+opt_index::opt_index(opt_index&& other) noexcept
+    : mapping(std::exchange(other.mapping, nullptr)), mapping_size(other.mapping_size), num_sets(other.num_sets), recorded_run(other.recorded_run),
+      recording(other.recording), offsets(other.offsets), blocks(other.blocks), distances(other.distances)
+{
+}
+
+opt_index& opt_index::operator=(opt_index&& other) noexcept
+{
+  if (mapping != nullptr) {
+    ::munmap(const_cast<std::byte*>(mapping), mapping_size);
+  }
+  mapping = std::exchange(other.mapping, nullptr);
+  mapping_size = other.mapping_size;
+  num_sets = other.num_sets;
+  recorded_run = other.recorded_run;
+  recording = other.recording;
+  offsets = other.offsets;
+  blocks = other.blocks;
+  distances = other.distances;
+  return *this;
+}
+
+long opt_index::sets() const { return static_cast<long>(num_sets); }
+
+std::string_view opt_index::run() const { return recorded_run; }
+
+std::string_view opt_index::source() const { return recording; }
+
+std::size_t opt_index::size(long set) const { return offsets[set + 1] - offsets[set]; }
+
+uint64_t opt_index::block(long set, std::size_t pos) const
+{
+  assert(pos < size(set));
+  return blocks[offsets[set] + pos];
+}
+
+uint64_t opt_index::next_use(long set, std::size_t pos) const
+{
+  assert(pos < size(set));
+  auto distance = distances[offsets[set] + pos];
+  return distance == 0 ? never : pos + distance;
+}
+
+opt::opt(CACHE* cache) : opt(cache, cache->NUM_SET, cache->NUM_WAY) {}
+
+opt::opt(CACHE* cache, long sets, long ways)
+    : replacement(cache), NUM_SET(sets), NUM_WAY(ways), last_used(static_cast<std::size_t>(sets * ways), 0),
+      way_next_use(static_cast<std::size_t>(sets * ways), opt_index::never)
+{
+}
+
+std::string opt::run_description() const
+{
+  const auto& run = champsim::modules::current_run();
+  auto description = fmt::format("sets {} ways {} warmup {} simulation {}", NUM_SET, NUM_WAY, run.warmup_instructions, run.simulation_instructions);
+  for (const auto& name : run.trace_names) {
+    description += fmt::format("; trace {}", opt_index::file_stamp(name));
+  }
+  return description;
+}
+
+std::string opt::trace_path() const { return fmt::format("{}/{}.opt.trace", champsim::modules::current_run().data_directory, intern_->NAME); }
+
+std::string opt::index_path() const { return fmt::format("{}/{}.opt.index", champsim::modules::current_run().data_directory, intern_->NAME); }
+
+void opt::initialize_replacement()
+{
+  const auto run = run_description();
+
+  // An index is stale if it was made for another run, or from another recording than the one that is present
+  if (::file_exists(index_path())) {
+    try {
+      opt_index existing{index_path()};
+      const auto recording = opt_index::file_stamp(trace_path());
+      if (existing.sets() == NUM_SET && existing.run() == run && (recording.empty() || existing.source() == recording)) {
+        index.emplace(std::move(existing));
+      }
+    } catch (const std::runtime_error&) {
+      // An index that cannot be read, such as one left by a killed run or written in an older format, is also stale
+      std::remove(index_path().c_str());
+    }
+  }
+
+  if (!index.has_value() && opt_index::recorded_from(trace_path()) == run) {
+    opt_index::build(trace_path(), index_path(), NUM_SET);
+    index.emplace(index_path());
+  }
+
+  if (index.has_value()) {
+    cursors.resize(static_cast<std::size_t>(NUM_SET));
+    pending_next_use.resize(static_cast<std::size_t>(NUM_SET));
+  } else {
+    std::remove(index_path().c_str());
+    trace_file.open(trace_path(), std::ios::binary);
+    if (!trace_file) {
+      throw std::runtime_error{"Could not record the access stream to " + trace_path()};
+    }
+    opt_index::begin_recording(trace_file, run);
+  }
+}
+
+uint64_t opt::match_access(long set, uint64_t block)
+{
+  auto& cursor = cursors.at(static_cast<std::size_t>(set));
+  const auto end = std::min(index->size(set), cursor.position + RESYNC_WINDOW);
+
+  // An access that is repeated in this run, but was not in the recording, keeps its place in the sequence
+  if (block == cursor.last_block && (cursor.position == end || index->block(set, cursor.position) != block)) {
+    return cursor.last_next_use;
+  }
+
+  for (auto pos = cursor.position; pos < end; ++pos) {
+    if (index->block(set, pos) == block) {
+      ++(pos == cursor.position ? matched : resynchronized);
+      cursor.position = pos + 1;
+      cursor.last_block = block;
+      cursor.last_next_use = index->next_use(set, pos);
+      return cursor.last_next_use;
+    }
+  }
+
+  ++unmatched;
+  return opt_index::never;
+}
+
+long opt::find_victim(uint32_t triggering_cpu, uint64_t instr_id, long set, const champsim::cache_block* current_set, champsim::address ip,
+                      champsim::address full_addr, access_type type)
+{
+  const auto base = static_cast<std::size_t>(set * NUM_WAY);
+
+  // Evict the block whose next use is furthest away. Among blocks with no known next use, evict the least recently used.
+  auto keep_over = [&](long lhs, long rhs) {
+    auto lhs_idx = base + static_cast<std::size_t>(lhs);
+    auto rhs_idx = base + static_cast<std::size_t>(rhs);
+    if (way_next_use.at(lhs_idx) != way_next_use.at(rhs_idx)) {
+      return way_next_use.at(lhs_idx) < way_next_use.at(rhs_idx);
+    }
+    return last_used.at(lhs_idx) > last_used.at(rhs_idx);
+  };
+
+  long victim = 0;
+  for (long way = 1; way < NUM_WAY; ++way) {
+    if (keep_over(victim, way)) {
+      victim = way;
+    }
+  }
+  assert(victim < NUM_WAY);
+  return victim;
+}
+
+void opt::replacement_cache_fill(uint32_t triggering_cpu, long set, long way, champsim::address full_addr, champsim::address ip, champsim::address victim_addr,
+                                 access_type type)
+{
+  last_used.at(static_cast<std::size_t>(set * NUM_WAY + way)) = ++access_count;
+
+  auto& next_use = way_next_use.at(static_cast<std::size_t>(set * NUM_WAY + way));
+  next_use = opt_index::never;
+  if (index.has_value()) {
+    // The next use was found when the block missed
+    auto& pending = pending_next_use.at(static_cast<std::size_t>(set));
+    if (auto found = pending.find(champsim::block_number{full_addr}.to<uint64_t>()); found != std::end(pending)) {
+      next_use = found->second;
+      pending.erase(found);
+    }
+  }
+}
+
+void opt::update_replacement_state(uint32_t triggering_cpu, long set, long way, champsim::address full_addr, champsim::address ip,
+                                   champsim::address victim_addr, access_type type, uint8_t hit)
+{
+  const auto block = champsim::block_number{full_addr}.to<uint64_t>();
+
+  if (hit && access_type{type} != access_type::WRITE) // Skip this for writeback hits
+    last_used.at(static_cast<std::size_t>(set * NUM_WAY + way)) = ++access_count;
+
+  if (trace_file.is_open()) {
+    opt_index::record(trace_file, set, block);
+    ++recorded;
+  }
+
+  if (index.has_value()) {
+    auto next_use = match_access(set, block);
+    if (hit) {
+      way_next_use.at(static_cast<std::size_t>(set * NUM_WAY + way)) = next_use;
+    } else {
+      pending_next_use.at(static_cast<std::size_t>(set)).insert_or_assign(block, next_use);
+    }
+  }
+}
+
+void opt::replacement_final_stats()
+{
+  if (trace_file.is_open()) {
+    trace_file.flush();
+    fmt::print("{} OPT recorded {} accesses to {}. Run again to replace with future knowledge.\n", intern_->NAME, recorded, trace_path());
+  } else if (index.has_value()) {
+    fmt::print("{} OPT matched {} accesses, resynchronized {}, unmatched {}\n", intern_->NAME, matched, resynchronized, unmatched);
+  }
+}
@@ -0,0 +1,144 @@
+#ifndef REPLACEMENT_OPT_H
+#define REPLACEMENT_OPT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "cache.h"
+#include "modules.h"
+
+/**
+ * A next-use index over an access stream recorded from a cache, memory-mapped from disk.
+ *
+ * The index holds the sequence of blocks accessed in each set, and for each access, the distance in that sequence to the next access of the same block.
+ */
+class opt_index
+{
+  static constexpr uint64_t magic = 0x5844494f4d495343;       // "CSIMOIDX"
+  static constexpr uint64_t trace_magic = 0x5254534f4d495343; // "CSIMOSTR"
+
+  const std::byte* mapping = nullptr;
+  std::size_t mapping_size = 0;
+
+  uint64_t num_sets = 0;
+  std::string_view recorded_run{};
+  std::string_view recording{};
+  const uint64_t* offsets = nullptr;
+  const uint64_t* blocks = nullptr;
+  const uint32_t* distances = nullptr;
+
+public:
+  static constexpr uint64_t never = std::numeric_limits<uint64_t>::max();
+
+  /**
+   * Build an index from a recorded access stream.
+   * The index is stamped with the description of the run that was recorded, and with the path, size, and modification time of the recording.
+   *
+   * :param trace_path: The file of (set, block) records written by the first pass
+   * :param index_path: The file to receive the index
+   * :param sets: The number of sets in the cache
+   */
+  static void build(const std::string& trace_path, const std::string& index_path, long sets);
+
+  /**
+   * Begin a recorded access stream with the description of the run that it is recorded from.
+   */
+  static void begin_recording(std::ostream& trace, std::string_view run);
+
+  /**
+   * Append one access to a recorded access stream.
+   */
+  static void record(std::ostream& trace, long set, uint64_t block);
+
+  /**
+   * :return: The description of the run that a recorded access stream was recorded from, or nothing if the file is not a recording
+   */
+  static std::optional<std::string> recorded_from(const std::string& trace_path);
+
+  /**
+   * :return: The path, size, and modification time of a file, or an empty string if it does not exist
+   */
+  static std::string file_stamp(const std::string& path);
+
+  explicit opt_index(const std::string& index_path);
+  ~opt_index();
+
+  opt_index(const opt_index&) = delete;
+  opt_index& operator=(const opt_index&) = delete;
+  opt_index(opt_index&& other) noexcept;
+  opt_index& operator=(opt_index&& other) noexcept;
+
+  [[nodiscard]] long sets() const;
+  [[nodiscard]] std::string_view run() const;    // The description of the run that was recorded
+  [[nodiscard]] std::string_view source() const; // The stamp of the recording that was indexed
+  [[nodiscard]] std::size_t size(long set) const;
+  [[nodiscard]] uint64_t block(long set, std::size_t pos) const;
+
+  /**
+   * :return: The position in the set's sequence of the next access to the same block as the access at the given position, or never
+   */
+  [[nodiscard]] uint64_t next_use(long set, std::size_t pos) const;
+};
+
+/**
+ * Belady's optimal replacement, using the future knowledge of a prior run.
+ *
+ * If neither file exists, the accesses reaching the cache are recorded to <NAME>.opt.trace and the policy behaves as LRU.
+ * In the next run, the recording is indexed into <NAME>.opt.index, which is memory-mapped, and the block whose next use is furthest away is evicted.
+ * Both files are kept in the data directory of the run, and are stamped with a description of the run: its traces, with their sizes and
+ * modification times, the shape of the cache, and the lengths of its phases. A file that was made for a different run, or that cannot be read, is made again.
+ * Since the timing of the second run differs, accesses are matched to the recording by their sequence within each set,
+ * resynchronizing over a short window when the streams diverge.
+ */
+struct opt : public champsim::modules::replacement {
+  static constexpr std::size_t RESYNC_WINDOW = 64;
+
+  long NUM_SET, NUM_WAY;
+  uint64_t access_count = 0;
+  std::vector<uint64_t> last_used;
+  std::vector<uint64_t> way_next_use;
+
+  // Recording (first pass)
+  std::ofstream trace_file;
+  uint64_t recorded = 0;
+
+  // Replaying (second pass)
+  struct set_cursor {
+    std::size_t position = 0;
+    uint64_t last_block = 0;
+    uint64_t last_next_use = opt_index::never;
+  };
+  std::optional<opt_index> index;
+  std::vector<set_cursor> cursors;
+  std::vector<std::unordered_map<uint64_t, uint64_t>> pending_next_use;
+  uint64_t matched = 0;
+  uint64_t resynchronized = 0;
+  uint64_t unmatched = 0;
+
+  explicit opt(CACHE* cache);
+  opt(CACHE* cache, long sets, long ways);
+
+  [[nodiscard]] std::string run_description() const;
+  [[nodiscard]] std::string trace_path() const;
+  [[nodiscard]] std::string index_path() const;
+
+  uint64_t match_access(long set, uint64_t block);
+
+  void initialize_replacement();
+  long find_victim(uint32_t triggering_cpu, uint64_t instr_id, long set, const champsim::cache_block* current_set, champsim::address ip,
+                   champsim::address full_addr, access_type type);
+  void replacement_cache_fill(uint32_t triggering_cpu, long set, long way, champsim::address full_addr, champsim::address ip, champsim::address victim_addr,
+                              access_type type);
+  void update_replacement_state(uint32_t triggering_cpu, long set, long way, champsim::address full_addr, champsim::address ip, champsim::address victim_addr,
+                                access_type type, uint8_t hit);
+  void replacement_final_stats();
+};
+
+#endif
@@ -24,6 +24,8 @@ struct srrip : public champsim::modules::replacement {
 
   std::vector<srrip_set_helper> sets;
 
+  static constexpr bool set_local = true;
+
   explicit srrip(CACHE* cache);
   srrip(CACHE* cache, long sets_, long ways_);
 
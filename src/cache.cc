@@ -20,10 +20,12 @@
 #include <cassert>
 #include <cmath>
 #include <iomanip>
+#include <limits>
 #include <numeric>
 #include <fmt/core.h>
 
 #include "bandwidth.h"
+#include "cache_dispatch.h"
 #include "champsim.h"
 #include "chrono.h"
 #include "deadlock.h"
@@ -35,16 +37,23 @@
 CACHE::CACHE(CACHE&& other)
     : operable(other),
 
+      tag_banks(std::move(other.tag_banks)),
+
       upper_levels(std::move(other.upper_levels)), lower_level(std::move(other.lower_level)), lower_translate(std::move(other.lower_translate)),
 
-      cpu(other.cpu), NAME(std::move(other.NAME)), NUM_SET(other.NUM_SET), NUM_WAY(other.NUM_WAY), MSHR_SIZE(other.MSHR_SIZE), PQ_SIZE(other.PQ_SIZE),
+      cpu(other.cpu), NAME(std::move(other.NAME)), NUM_SET(other.NUM_SET), NUM_WAY(other.NUM_WAY), MSHR_SIZE(other.MSHR_SIZE),
+      NUM_SAMPLED_SET(other.NUM_SAMPLED_SET), NUM_SECTOR(other.NUM_SECTOR), PQ_SIZE(other.PQ_SIZE),
       HIT_LATENCY(other.HIT_LATENCY), FILL_LATENCY(other.FILL_LATENCY), OFFSET_BITS(other.OFFSET_BITS), block(std::move(other.block)), MAX_TAG(other.MAX_TAG),
-      MAX_FILL(other.MAX_FILL), prefetch_as_load(other.prefetch_as_load), match_offset_bits(other.match_offset_bits), virtual_prefetch(other.virtual_prefetch),
-      pref_activate_mask(std::move(other.pref_activate_mask)),
+      MAX_FILL(other.MAX_FILL), NUM_BANK(other.NUM_BANK), MAX_BANK_TAG(other.MAX_BANK_TAG), BANK_BUSY(other.BANK_BUSY), BANK_HASH(other.BANK_HASH),
+      INCLUSION(other.INCLUSION), prefetch_as_load(other.prefetch_as_load), match_offset_bits(other.match_offset_bits),
+      virtual_prefetch(other.virtual_prefetch), has_directory(other.has_directory), clean_writebacks(other.clean_writebacks),
+      eviction_notices(other.eviction_notices), pref_activate_mask(std::move(other.pref_activate_mask)), directory_ports(std::move(other.directory_ports)),
+      directory(std::move(other.directory)),
+      partitioner(std::move(other.partitioner)), victims(std::move(other.victims)),
 
       sim_stats(std::move(other.sim_stats)), roi_stats(std::move(other.roi_stats)),
 
-      pref_module_pimpl(std::move(other.pref_module_pimpl)), repl_module_pimpl(std::move(other.repl_module_pimpl))
+      pref_module_pimpl(std::move(other.pref_module_pimpl)), repl_module_pimpl(std::move(other.repl_module_pimpl)), bound_operate(other.bound_operate)
 {
   pref_module_pimpl->bind(this);
   repl_module_pimpl->bind(this);
@@ -66,7 +75,8 @@ auto CACHE::operator=(CACHE&& other) -> CACHE&
   this->NUM_WAY = other.NUM_WAY;
   ;
   this->MSHR_SIZE = other.MSHR_SIZE;
-  ;
+  this->NUM_SAMPLED_SET = other.NUM_SAMPLED_SET;
+  this->NUM_SECTOR = other.NUM_SECTOR;
   this->PQ_SIZE = other.PQ_SIZE;
   this->HIT_LATENCY = other.HIT_LATENCY;
   this->FILL_LATENCY = other.FILL_LATENCY;
@@ -75,16 +85,31 @@ auto CACHE::operator=(CACHE&& other) -> CACHE&
   this->block = std::move(other.block);
   this->MAX_TAG = other.MAX_TAG;
   this->MAX_FILL = other.MAX_FILL;
+  this->NUM_BANK = other.NUM_BANK;
+  this->MAX_BANK_TAG = other.MAX_BANK_TAG;
+  this->BANK_BUSY = other.BANK_BUSY;
+  this->BANK_HASH = other.BANK_HASH;
+  this->INCLUSION = other.INCLUSION;
+  this->tag_banks = std::move(other.tag_banks);
   this->prefetch_as_load = other.prefetch_as_load;
   this->match_offset_bits = other.match_offset_bits;
   this->virtual_prefetch = other.virtual_prefetch;
+  this->has_directory = other.has_directory;
+  this->clean_writebacks = other.clean_writebacks;
+  this->eviction_notices = other.eviction_notices;
   this->pref_activate_mask = std::move(other.pref_activate_mask);
+  this->directory_ports = std::move(other.directory_ports);
+  this->directory = std::move(other.directory);
+  this->partitioner = std::move(other.partitioner);
+  this->victims = std::move(other.victims);
+  this->set_samples = other.set_samples;
 
   this->sim_stats = std::move(other.sim_stats);
   this->roi_stats = std::move(other.roi_stats);
 
   this->pref_module_pimpl = std::move(other.pref_module_pimpl);
   this->repl_module_pimpl = std::move(other.repl_module_pimpl);
+  this->bound_operate = other.bound_operate;
 
   pref_module_pimpl->bind(this);
   repl_module_pimpl->bind(this);
@@ -94,13 +119,15 @@ auto CACHE::operator=(CACHE&& other) -> CACHE&
 
 CACHE::tag_lookup_type::tag_lookup_type(const request_type& req, bool local_pref, bool skip)
     : address(req.address), v_address(req.v_address), data(req.data), ip(req.ip), instr_id(req.instr_id), pf_metadata(req.pf_metadata), cpu(req.cpu),
-      type(req.type), prefetch_from_this(local_pref), skip_fill(skip), is_translated(req.is_translated), instr_depend_on_me(req.instr_depend_on_me)
+      type(req.type), prefetch_from_this(local_pref), skip_fill(skip), is_translated(req.is_translated), clean_writeback(req.clean_writeback),
+      is_writeback(req.is_writeback), evicted(req.evicted), instr_depend_on_me(req.instr_depend_on_me)
 {
 }
 
 CACHE::mshr_type::mshr_type(const tag_lookup_type& req, champsim::chrono::clock::time_point _time_enqueued)
     : address(req.address), v_address(req.v_address), ip(req.ip), instr_id(req.instr_id), cpu(req.cpu), type(req.type),
-      prefetch_from_this(req.prefetch_from_this), time_enqueued(_time_enqueued), instr_depend_on_me(req.instr_depend_on_me), to_return(req.to_return)
+      prefetch_from_this(req.prefetch_from_this), clean_writeback(req.clean_writeback), time_enqueued(_time_enqueued), instr_depend_on_me(req.instr_depend_on_me),
+      to_return(req.to_return)
 {
 }
 
@@ -138,16 +165,20 @@ CACHE::mshr_type CACHE::mshr_type::merge(mshr_type predecessor, mshr_type succes
   return retval;
 }
 
-auto CACHE::fill_block(mshr_type mshr, uint32_t metadata) -> BLOCK
+auto CACHE::fill_block(mshr_type mshr, uint32_t metadata, uint64_t sector_mask) -> BLOCK
 {
   CACHE::BLOCK to_fill;
   to_fill.valid = true;
   to_fill.prefetch = mshr.prefetch_from_this;
-  to_fill.dirty = (mshr.type == access_type::WRITE);
+  to_fill.dirty = (mshr.type == access_type::WRITE && !mshr.clean_writeback) || mshr.data_promise->state == champsim::coherence_state::modified;
+  to_fill.valid_sectors = sector_mask;
+  to_fill.dirty_sectors = to_fill.dirty ? sector_mask : 0;
+  to_fill.coherence = to_fill.dirty ? champsim::coherence_state::modified : mshr.data_promise->state;
   to_fill.address = mshr.address;
   to_fill.v_address = mshr.v_address;
   to_fill.data = mshr.data_promise->data;
   to_fill.pf_metadata = metadata;
+  to_fill.cpu = mshr.cpu;
 
   return to_fill;
 }
@@ -159,138 +190,122 @@ auto CACHE::matches_address(champsim::address addr) const
   };
 }
 
-template <typename T>
-champsim::address CACHE::module_address(const T& element) const
+bool CACHE::writeback_block(BLOCK& victim, uint32_t triggering_cpu, uint64_t instr_id, bool evicted)
 {
-  auto address = virtual_prefetch ? element.v_address : element.address;
-  return champsim::address{address.slice_upper(match_offset_bits ? champsim::data::bits{} : OFFSET_BITS)};
-}
+  if (NUM_SECTOR > 1 && victim.dirty) {
+    return writeback_sectors(victim, triggering_cpu, instr_id, evicted);
+  }
 
-bool CACHE::handle_fill(const mshr_type& fill_mshr)
-{
-  cpu = fill_mshr.cpu;
+  request_type writeback_packet;
 
-  // find victim
-  auto [set_begin, set_end] = get_set_span(fill_mshr.address);
-  auto way = std::find_if_not(set_begin, set_end, [](auto x) { return x.valid; });
-  if (way == set_end) {
-    way = std::next(set_begin, impl_find_victim(fill_mshr.cpu, fill_mshr.instr_id, get_set_index(fill_mshr.address), &*set_begin, fill_mshr.ip,
-                                                fill_mshr.address, fill_mshr.type));
-  }
-  assert(set_begin <= way);
-  assert(way <= set_end);
-  assert(way != set_end || fill_mshr.type != access_type::WRITE); // Writes may not bypass
-  const auto way_idx = std::distance(set_begin, way);             // cast protected by earlier assertion
+  writeback_packet.cpu = triggering_cpu;
+  writeback_packet.address = victim.address;
+  writeback_packet.data = victim.data;
+  writeback_packet.instr_id = instr_id;
+  writeback_packet.ip = champsim::address{};
+  writeback_packet.type = access_type::WRITE;
+  writeback_packet.pf_metadata = victim.pf_metadata;
+  writeback_packet.response_requested = false;
+  writeback_packet.clean_writeback = !victim.dirty;
+  writeback_packet.is_writeback = true;
+  writeback_packet.evicted = evicted && eviction_notices;
 
   if constexpr (champsim::debug_print) {
-    fmt::print("[{}] {} instr_id: {} address: {} v_address: {} set: {} way: {} type: {} prefetch_metadata: {} cycle_enqueued: {} cycle: {}\n", NAME, __func__,
-               fill_mshr.instr_id, fill_mshr.address, fill_mshr.v_address, get_set_index(fill_mshr.address), way_idx,
-               access_type_names.at(champsim::to_underlying(fill_mshr.type)), fill_mshr.data_promise->pf_metadata,
-               (fill_mshr.time_enqueued.time_since_epoch()) / clock_period, (current_time.time_since_epoch()) / clock_period);
+    fmt::print("[{}] {} evict address: {} v_address: {} clean: {} prefetch_metadata: {}\n", NAME, __func__, writeback_packet.address,
+               writeback_packet.v_address, writeback_packet.clean_writeback, victim.pf_metadata);
   }
 
-  if (way != set_end && way->valid && way->dirty) {
+  auto success = lower_level->add_wq(writeback_packet);
+  if (!success) {
+    return false;
+  }
+
+  victim.dirty = false;
+  return true;
+}
+
+bool CACHE::writeback_sectors(BLOCK& victim, uint32_t triggering_cpu, uint64_t instr_id, bool evicted)
+{
+  const champsim::dynamic_extent sector_extent{OFFSET_BITS, champsim::lg2(NUM_SECTOR)};
+  for (uint64_t sector = 0; sector < NUM_SECTOR; ++sector) {
+    const auto sector_mask = uint64_t{1} << sector;
+    if ((victim.dirty_sectors & sector_mask) == 0) {
+      continue;
+    }
+
     request_type writeback_packet;
 
-    writeback_packet.cpu = fill_mshr.cpu;
-    writeback_packet.address = way->address;
-    writeback_packet.data = way->data;
-    writeback_packet.instr_id = fill_mshr.instr_id;
+    writeback_packet.cpu = triggering_cpu;
+    writeback_packet.address = champsim::address{champsim::splice(victim.address.slice_upper(get_tag_offset_bits()), champsim::address_slice{sector_extent, sector})};
+    writeback_packet.data = victim.data;
+    writeback_packet.instr_id = instr_id;
     writeback_packet.ip = champsim::address{};
     writeback_packet.type = access_type::WRITE;
-    writeback_packet.pf_metadata = way->pf_metadata;
+    writeback_packet.pf_metadata = victim.pf_metadata;
     writeback_packet.response_requested = false;
+    writeback_packet.is_writeback = true;
+    writeback_packet.evicted = evicted && eviction_notices;
 
     if constexpr (champsim::debug_print) {
-      fmt::print("[{}] {} evict address: {} v_address: {} prefetch_metadata: {}\n", NAME, __func__, writeback_packet.address, writeback_packet.v_address,
-                 fill_mshr.data_promise->pf_metadata);
+      fmt::print("[{}] {} evict address: {} sector: {} prefetch_metadata: {}\n", NAME, __func__, writeback_packet.address, sector, victim.pf_metadata);
     }
 
     auto success = lower_level->add_wq(writeback_packet);
     if (!success) {
       return false;
     }
-  }
-
-  champsim::address evicting_address{};
-  if (way != set_end && way->valid) {
-    evicting_address = module_address(*way);
-  }
-
-  auto metadata_thru = impl_prefetcher_cache_fill(module_address(fill_mshr), get_set_index(fill_mshr.address), way_idx,
-                                                  (fill_mshr.type == access_type::PREFETCH), evicting_address, fill_mshr.data_promise->pf_metadata);
-  impl_replacement_cache_fill(fill_mshr.cpu, get_set_index(fill_mshr.address), way_idx, module_address(fill_mshr), fill_mshr.ip, evicting_address,
-                              fill_mshr.type);
-
-  if (way != set_end) {
-    if (way->valid && way->prefetch) {
-      ++sim_stats.pf_useless;
-    }
-
-    if (fill_mshr.type == access_type::PREFETCH) {
-      ++sim_stats.pf_fill;
-    }
 
-    *way = fill_block(fill_mshr, metadata_thru);
-  }
-
-  // COLLECT STATS
-  if (fill_mshr.type != access_type::PREFETCH)
-    sim_stats.total_miss_latency_cycles += (current_time - (fill_mshr.time_enqueued + clock_period)) / clock_period;
-  sim_stats.mshr_return.increment(std::pair{fill_mshr.type, fill_mshr.cpu});
-
-  response_type response{fill_mshr.address, fill_mshr.v_address, fill_mshr.data_promise->data, metadata_thru, fill_mshr.instr_depend_on_me};
-  for (auto* ret : fill_mshr.to_return) {
-    ret->push_back(response);
+    // Sectors that have been written back are clean, in case the eviction must be retried
+    victim.dirty_sectors &= ~sector_mask;
+    ++sim_stats.sector_writebacks;
   }
 
+  victim.dirty = false;
   return true;
 }
 
-bool CACHE::try_hit(const tag_lookup_type& handle_pkt)
-{
-  cpu = handle_pkt.cpu;
-
-  // access cache
-  auto [set_begin, set_end] = get_set_span(handle_pkt.address);
-  auto way = std::find_if(set_begin, set_end, [matcher = matches_address(handle_pkt.address)](const auto& x) { return x.valid && matcher(x); });
-  const auto hit = (way != set_end);
-  const auto useful_prefetch = (hit && way->prefetch && !handle_pkt.prefetch_from_this);
-
-  if constexpr (champsim::debug_print) {
-    fmt::print("[{}] {} instr_id: {} address: {} v_address: {} data: {} set: {} way: {} ({}) type: {} cycle: {}\n", NAME, __func__, handle_pkt.instr_id,
-               handle_pkt.address, handle_pkt.v_address, handle_pkt.data, get_set_index(handle_pkt.address), std::distance(set_begin, way),
-               hit ? "HIT" : "MISS", access_type_names.at(champsim::to_underlying(handle_pkt.type)), current_time.time_since_epoch() / clock_period);
-  }
-
-  auto metadata_thru = handle_pkt.pf_metadata;
-  if (should_activate_prefetcher(handle_pkt)) {
-    metadata_thru = impl_prefetcher_cache_operate(module_address(handle_pkt), handle_pkt.ip, hit, useful_prefetch, handle_pkt.type, metadata_thru);
-  }
+bool CACHE::is_sampled_set(long set) const { return set % (NUM_SET / NUM_SAMPLED_SET) == 0; }
 
-  // update replacement policy
-  const auto way_idx = std::distance(set_begin, way);
-  impl_update_replacement_state(handle_pkt.cpu, get_set_index(handle_pkt.address), way_idx, module_address(handle_pkt), handle_pkt.ip, {}, handle_pkt.type,
-                                hit);
+bool CACHE::writes_through(const tag_lookup_type& handle_pkt) const
+{
+  return !is_sampled_set(get_set_index(handle_pkt.address)) && handle_pkt.type == access_type::WRITE && !match_offset_bits && !handle_pkt.clean_writeback;
+}
 
-  if (hit) {
-    sim_stats.hits.increment(std::pair{handle_pkt.type, handle_pkt.cpu});
+auto CACHE::write_through_packet(const tag_lookup_type& handle_pkt) const -> request_type
+{
+  request_type writethrough_packet;
+
+  writethrough_packet.cpu = handle_pkt.cpu;
+  writethrough_packet.address = handle_pkt.address;
+  writethrough_packet.data = handle_pkt.data;
+  writethrough_packet.instr_id = handle_pkt.instr_id;
+  writethrough_packet.ip = champsim::address{};
+  writethrough_packet.type = access_type::WRITE;
+  writethrough_packet.pf_metadata = handle_pkt.pf_metadata;
+  writethrough_packet.response_requested = false;
+  writethrough_packet.is_writeback = true;
+
+  return writethrough_packet;
+}
 
-    response_type response{handle_pkt.address, handle_pkt.v_address, way->data, metadata_thru, handle_pkt.instr_depend_on_me};
-    for (auto* ret : handle_pkt.to_return) {
-      ret->push_back(response);
+void CACHE::record_sample(access_type type, long set, bool hit)
+{
+  if (is_sampled_set(set)) {
+    auto& sample = set_samples.at(champsim::to_underlying(type));
+    ++sample.accesses;
+    if (!hit) {
+      ++sample.misses;
     }
 
-    way->dirty |= (handle_pkt.type == access_type::WRITE);
-
-    // update prefetch stats and reset prefetch bit
-    if (useful_prefetch) {
-      ++sim_stats.pf_useful;
-      way->prefetch = false;
+    ++(hit ? sim_stats.sampled_hits : sim_stats.sampled_misses);
+  } else {
+    auto& sample = set_samples.at(champsim::to_underlying(type));
+    if (!hit) {
+      sample.miss_credit -= 1;
     }
-  }
 
-  return hit;
+    ++(hit ? sim_stats.oracle_hits : sim_stats.oracle_misses);
+  }
 }
 
 auto CACHE::mshr_and_forward_packet(const tag_lookup_type& handle_pkt) -> std::pair<mshr_type, request_type>
@@ -366,7 +381,16 @@ bool CACHE::handle_miss(const tag_lookup_type& handle_pkt)
     }
   }
 
+  if (has_directory) {
+    update_directory(handle_pkt);
+  }
+
+  if (partitioner) {
+    monitor_utility(handle_pkt);
+  }
+
   sim_stats.misses.increment(std::pair{handle_pkt.type, handle_pkt.cpu});
+  record_sample(handle_pkt.type, get_set_index(handle_pkt.address), false);
 
   return true;
 }
@@ -384,152 +408,359 @@ bool CACHE::handle_write(const tag_lookup_type& handle_pkt)
   inflight_writes.push_back(to_allocate);
 
   sim_stats.misses.increment(std::pair{handle_pkt.type, handle_pkt.cpu});
+  record_sample(handle_pkt.type, get_set_index(handle_pkt.address), false);
 
   return true;
 }
 
-template <bool UpdateRequest>
-auto CACHE::initiate_tag_check(champsim::channel* ul)
+bool CACHE::needs_write_permission(const BLOCK& way, access_type type)
+{
+  return way.coherence == champsim::coherence_state::shared && (type == access_type::RFO || type == access_type::WRITE);
+}
+
+champsim::coherence_state CACHE::get_granted_state(champsim::address address, const BLOCK* way) const
+{
+  if (has_directory) {
+    const auto& set = directory.at(static_cast<std::size_t>(get_set_index(address)));
+    auto entry = std::find_if(std::begin(set), std::end(set), [match = champsim::block_number{address}](const auto& x) { return x.block == match; });
+    return (entry == std::end(set) || entry->exclusive) ? champsim::coherence_state::exclusive : champsim::coherence_state::shared;
+  }
+
+  // Without a directory, this cache can grant no more than it holds
+  if (way != nullptr && way->coherence == champsim::coherence_state::shared) {
+    return champsim::coherence_state::shared;
+  }
+  return champsim::coherence_state::exclusive;
+}
+
+void CACHE::monitor_utility(const tag_lookup_type& handle_pkt)
 {
-  return [time = current_time + (warmup ? champsim::chrono::clock::duration{} : HIT_LATENCY), ul](const auto& entry) {
-    CACHE::tag_lookup_type retval{entry};
-    retval.event_cycle = time;
+  // Only the demands of each CPU count towards its utility
+  if (handle_pkt.type != access_type::PREFETCH && handle_pkt.type != access_type::WRITE) {
+    partitioner->access(handle_pkt.cpu, get_set_index(handle_pkt.address), champsim::block_number{handle_pkt.address});
+  }
+}
+
+void CACHE::update_directory(const tag_lookup_type& handle_pkt)
+{
+  // Local prefetches have no upper level to track
+  auto port = std::find(std::begin(directory_ports), std::end(directory_ports), handle_pkt.upper_level);
+  if (port == std::end(directory_ports)) {
+    return;
+  }
 
-    if constexpr (UpdateRequest) {
-      if (entry.response_requested) {
-        retval.to_return = {&ul->returned};
+  const auto requester = std::distance(std::begin(directory_ports), port);
+  assert(requester < std::numeric_limits<uint64_t>::digits);
+  const auto requester_mask = uint64_t{1} << requester;
+  auto& set = directory.at(static_cast<std::size_t>(get_set_index(handle_pkt.address)));
+  auto entry = std::find_if(std::begin(set), std::end(set), [match = champsim::block_number{handle_pkt.address}](const auto& x) { return x.block == match; });
+
+  // A block that has left an upper level is no longer shared by it, and is not tracked once no sharers are left.
+  // Other writebacks do not change the sharers.
+  if (handle_pkt.type == access_type::WRITE) {
+    if (handle_pkt.evicted && entry != std::end(set)) {
+      entry->sharers &= ~requester_mask;
+      entry->exclusive = false;
+      if (entry->sharers == 0) {
+        set.erase(entry);
       }
-    } else {
-      (void)ul; // supress warning about ul being unused
     }
+    return;
+  }
 
-    if constexpr (champsim::debug_print) {
-      fmt::print("[TAG] initiate_tag_check instr_id: {} address: {} v_address: {} type: {} response_requested: {}\n", retval.instr_id, retval.address,
-                 retval.v_address, access_type_names.at(champsim::to_underlying(retval.type)), !std::empty(retval.to_return));
+  if (entry == std::end(set)) {
+    // A full set gives up the block that was requested least recently, which is invalidated in the upper levels that share it
+    if (!std::empty(set) && std::size(set) >= NUM_WAY) {
+      ++sim_stats.back_invalidations;
+      send_directory_probes(champsim::address{set.front().block}, handle_pkt.cpu, champsim::probe_type::back_invalidate, set.front().sharers);
+      set.erase(std::begin(set));
     }
+    entry = set.insert(std::end(set), directory_entry_type{champsim::block_number{handle_pkt.address}});
+  } else {
+    std::rotate(entry, std::next(entry), std::end(set));
+    entry = std::prev(std::end(set));
+  }
 
-    return retval;
-  };
+  if ((entry->invalidated & requester_mask) != 0) {
+    ++sim_stats.coherence_misses;
+    entry->invalidated &= ~requester_mask;
+  }
+
+  const auto others = entry->sharers & ~requester_mask;
+  if (handle_pkt.type == access_type::RFO) {
+    send_directory_probes(handle_pkt.address, handle_pkt.cpu, champsim::probe_type::invalidate, others);
+    entry->invalidated |= others;
+    entry->sharers = requester_mask;
+  } else {
+    if (entry->exclusive && others != 0) {
+      send_directory_probes(handle_pkt.address, handle_pkt.cpu, champsim::probe_type::downgrade, others);
+    }
+    entry->sharers |= requester_mask;
+  }
+  entry->exclusive = (entry->sharers == requester_mask);
 }
 
-long CACHE::operate()
+void CACHE::send_directory_probes(champsim::address address, uint32_t triggering_cpu, champsim::probe_type type, uint64_t targets)
 {
-  long progress{0};
+  for (std::size_t i = 0; i < std::size(directory_ports); ++i) {
+    if ((targets & (uint64_t{1} << i)) != 0) {
+      directory_ports[i]->probes.push_back({address, triggering_cpu, type});
+      if (type == champsim::probe_type::invalidate) {
+        ++sim_stats.invalidations_sent;
+      } else if (type == champsim::probe_type::downgrade) {
+        ++sim_stats.downgrades_sent;
+      }
+    }
+  }
+}
 
-  auto is_ready = [time = current_time](const auto& entry) {
-    return entry.event_cycle <= time;
-  };
-  auto is_translated = [](const auto& entry) {
-    return entry.is_translated;
-  };
+void CACHE::back_invalidate(const BLOCK& victim, uint32_t triggering_cpu)
+{
+  if constexpr (champsim::debug_print) {
+    fmt::print("[{}] {} address: {} cycle: {}\n", NAME, __func__, victim.address, current_time.time_since_epoch() / clock_period);
+  }
 
+  ++sim_stats.back_invalidations;
   for (auto* ul : upper_levels) {
-    ul->check_collision();
+    ul->probes.push_back({victim.address, triggering_cpu, champsim::probe_type::back_invalidate});
   }
+}
 
-  // Finish returns
-  std::for_each(std::cbegin(lower_level->returned), std::cend(lower_level->returned), [this](const auto& pkt) { this->finish_packet(pkt); });
-  progress += std::distance(std::cbegin(lower_level->returned), std::cend(lower_level->returned));
-  lower_level->returned.clear();
+auto CACHE::functional_access(request_type req, const std::function<champsim::address(uint32_t, champsim::address)>& translate) -> std::vector<request_type>
+{
+  std::vector<request_type> to_lower{};
 
-  // Finish translations
-  if (lower_translate != nullptr) {
-    std::for_each(std::cbegin(lower_translate->returned), std::cend(lower_translate->returned), [this](const auto& pkt) { this->finish_translation(pkt); });
-    progress += std::distance(std::cbegin(lower_translate->returned), std::cend(lower_translate->returned));
-    lower_translate->returned.clear();
+  if (!req.is_translated) {
+    req.address = translate(req.cpu, req.v_address);
+    req.is_translated = true;
   }
 
-  // Perform fills
-  champsim::bandwidth fill_bw{MAX_FILL};
-  for (auto q : {std::ref(MSHR), std::ref(inflight_writes)}) {
-    auto [fill_begin, fill_end] = champsim::get_span_p(std::cbegin(q.get()), std::cend(q.get()), fill_bw,
-                                                       [time = current_time](const auto& x) { return x.data_promise.is_ready_at(time); });
-    auto complete_end = std::find_if_not(fill_begin, fill_end, [this](const auto& x) { return this->handle_fill(x); });
-    fill_bw.consume(std::distance(fill_begin, complete_end));
-    q.get().erase(fill_begin, complete_end);
+  // A request that expects a response returns it to a stand-in for the upper level, so that an exclusive cache passes the block up
+  std::deque<response_type> discarded{};
+  tag_lookup_type handle_pkt{req};
+  if (req.response_requested) {
+    handle_pkt.to_return = {&discarded};
   }
+  functional_lookup(handle_pkt, to_lower);
+
+  // Each access stands in for a cycle of the prefetcher, and the prefetches that it issues are handled at once
+  impl_prefetcher_cycle_operate();
+  while (!std::empty(internal_PQ)) {
+    auto pf_pkt = internal_PQ.front();
+    internal_PQ.pop_front();
+    if (!pf_pkt.is_translated) {
+      pf_pkt.address = translate(pf_pkt.cpu, pf_pkt.v_address);
+      pf_pkt.is_translated = true;
+    }
+    functional_lookup(pf_pkt, to_lower);
+  }
+
+  return to_lower;
+}
 
-  // Initiate tag checks
-  const champsim::bandwidth::maximum_type bandwidth_from_tag_checks{champsim::to_underlying(MAX_TAG) * (long)(HIT_LATENCY / clock_period)
-                                                                    - (long)std::size(inflight_tag_check)};
-  champsim::bandwidth initiate_tag_bw{std::clamp(bandwidth_from_tag_checks, champsim::bandwidth::maximum_type{0}, MAX_TAG)};
-  auto can_translate = [avail = (std::size(translation_stash) < static_cast<std::size_t>(MSHR_SIZE))](const auto& entry) {
-    return avail || entry.is_translated;
+auto CACHE::functional_access_in_set(const request_type& req) -> std::vector<request_type>
+{
+  assert(req.is_translated);
+
+  std::vector<request_type> to_lower{};
+  std::deque<response_type> discarded{};
+  tag_lookup_type handle_pkt{req};
+  handle_pkt.set_only = true;
+  if (req.response_requested) {
+    handle_pkt.to_return = {&discarded};
+  }
+  functional_lookup(handle_pkt, to_lower);
+
+  return to_lower;
+}
+
+bool CACHE::is_set_local() const
+{
+  return pref_module_pimpl->impl_is_set_local() && repl_module_pimpl->impl_is_set_local() && !victims && !partitioner && !has_directory
+         && NUM_SAMPLED_SET == NUM_SET;
+}
+
+void CACHE::functional_lookup(const tag_lookup_type& handle_pkt, std::vector<request_type>& to_lower)
+{
+  if (writes_through(handle_pkt)) {
+    to_lower.push_back(write_through_packet(handle_pkt));
+  }
+
+  // A functional lookup is not on the timed path, and calls the modules through their concepts
+  if (try_hit<prefetcher_module_concept, replacement_module_concept>(handle_pkt)) {
+    return;
+  }
+
+  const auto set = get_set_index(handle_pkt.address);
+  const auto is_writeback = (handle_pkt.type == access_type::WRITE && !match_offset_bits);
+  const auto is_dirty_write = (handle_pkt.type == access_type::WRITE && !handle_pkt.clean_writeback);
+
+  if (partitioner) {
+    monitor_utility(handle_pkt);
+  }
+  if (!handle_pkt.set_only) {
+    record_sample(handle_pkt.type, set, false);
+  }
+
+  auto write_to_lower = [&](champsim::address address, champsim::address data, uint32_t metadata, bool clean, bool evicted) {
+    request_type write_packet;
+    write_packet.cpu = handle_pkt.cpu;
+    write_packet.address = address;
+    write_packet.data = data;
+    write_packet.instr_id = handle_pkt.instr_id;
+    write_packet.type = access_type::WRITE;
+    write_packet.pf_metadata = metadata;
+    write_packet.response_requested = false;
+    write_packet.clean_writeback = clean;
+    write_packet.is_writeback = true;
+    write_packet.evicted = evicted && eviction_notices;
+    to_lower.push_back(write_packet);
   };
-  auto stash_bandwidth_consumed =
-      champsim::transform_while_n(translation_stash, std::back_inserter(inflight_tag_check), initiate_tag_bw, is_translated, initiate_tag_check<false>());
-  initiate_tag_bw.consume(stash_bandwidth_consumed);
-  std::vector<long long> channels_bandwidth_consumed{};
 
-  if (std::size(upper_levels) > 1) {
-    std::rotate(upper_levels.begin(), upper_levels.begin() + 1, upper_levels.end());
+  // A writeback is filled without reading the lower level
+  if (!is_writeback) {
+    to_lower.push_back(mshr_and_forward_packet(handle_pkt).second);
   }
 
-  // upper levels get an equal portion of the remaining bandwidth
-  champsim::bandwidth::maximum_type per_upper_bandwidth =
-      std::size(upper_levels) >= 1
-          ? (champsim::bandwidth::maximum_type)std::max((size_t)initiate_tag_bw.amount_remaining() / std::size(upper_levels), size_t{1})
-          : champsim::bandwidth::maximum_type{};
+  // Only the sampled sets hold blocks, and writes to the others have been passed through
+  if (!is_sampled_set(set)) {
+    return;
+  }
 
-  for (auto* ul : upper_levels) {
-    for (auto q : {std::ref(ul->WQ), std::ref(ul->RQ), std::ref(ul->PQ)}) {
-      // this needs to be in this loop, we need to ensure that for cases where bandwidth doesn't divide nicely across upstreams,
-      // we don't accidentally consume more bandwidth than expected
-      champsim::bandwidth per_upper_tag_bw{std::min(per_upper_bandwidth, champsim::bandwidth::maximum_type{initiate_tag_bw.amount_remaining()})};
-      auto bandwidth_consumed =
-          champsim::transform_while_n(q.get(), std::back_inserter(inflight_tag_check), per_upper_tag_bw, can_translate, initiate_tag_check<true>(ul));
-      channels_bandwidth_consumed.push_back(bandwidth_consumed);
-      initiate_tag_bw.consume(bandwidth_consumed);
-    }
+  if (handle_pkt.skip_fill) {
+    return;
   }
 
-  auto pq_bandwidth_consumed =
-      champsim::transform_while_n(internal_PQ, std::back_inserter(inflight_tag_check), initiate_tag_bw, can_translate, initiate_tag_check<false>());
-  initiate_tag_bw.consume(pq_bandwidth_consumed);
+  const bool allocate = !(INCLUSION == champsim::cache_inclusion::exclusive && handle_pkt.type != access_type::WRITE && !std::empty(handle_pkt.to_return));
+
+  // The fill takes the place of the response from the lower level
+  mshr_type fill_mshr{handle_pkt, current_time};
+  fill_mshr.data_promise = champsim::waitable{mshr_type::returned_value{handle_pkt.data, handle_pkt.pf_metadata}, current_time};
+  auto write_victim = [&write_to_lower](BLOCK& victim, bool evicted) {
+    write_to_lower(victim.address, victim.data, victim.pf_metadata, !victim.dirty, evicted);
+    victim.dirty = false;
+    return true;
+  };
+  auto placed = place_fill<prefetcher_module_concept, replacement_module_concept>(fill_mshr, allocate, handle_pkt.set_only, write_victim);
 
-  // Issue translations
-  std::for_each(std::begin(inflight_tag_check), std::end(inflight_tag_check), [this](auto& x) { this->issue_translation(x); });
-  std::for_each(std::begin(translation_stash), std::end(translation_stash), [this](auto& x) { this->issue_translation(x); });
+  // A write that the replacement policy bypasses is passed through
+  if (placed->way == get_set_span(handle_pkt.address).second && is_writeback && is_dirty_write) {
+    write_to_lower(handle_pkt.address, handle_pkt.data, handle_pkt.pf_metadata, false, false);
+  }
+}
 
-  // Find entries that would be ready except that they have not finished translation, move them to the stash
-  auto [last_not_missed, stash_end] = champsim::extract_if(std::begin(inflight_tag_check), std::end(inflight_tag_check), std::back_inserter(translation_stash),
-                                                           [is_ready, is_translated](const auto& x) { return is_ready(x) && !is_translated(x); });
-  progress += std::distance(last_not_missed, std::end(inflight_tag_check));
-  inflight_tag_check.erase(last_not_missed, std::end(inflight_tag_check));
+bool CACHE::handle_probe(const typename channel_type::probe_type& probe)
+{
+  if (is_sampled_set(get_set_index(probe.address))) {
+    auto [set_begin, set_end] = get_set_span(probe.address);
+    auto way = std::find_if(set_begin, set_end, [matcher = matches_tag(probe.address)](const auto& x) { return x.valid && matcher(x); });
+    BLOCK* found = (way != set_end) ? &*way : nullptr;
+    if (found == nullptr && victims) {
+      found = victims->find(probe.address);
+    }
 
-  // Perform tag checks
-  auto do_handle_miss = [this](const auto& pkt) {
-    if (pkt.type == access_type::WRITE && !this->match_offset_bits) {
-      return this->handle_write(pkt); // Treat writes (that is, writebacks) like fills
+    if constexpr (champsim::debug_print) {
+      fmt::print("[{}] {} address: {} type: {} found: {} cycle: {}\n", NAME, __func__, probe.address, champsim::to_underlying(probe.type), found != nullptr,
+                 current_time.time_since_epoch() / clock_period);
     }
-    return this->handle_miss(pkt); // Treat writes (that is, stores) like reads
-  };
-  champsim::bandwidth tag_check_bw{MAX_TAG};
-  auto [tag_check_ready_begin, tag_check_ready_end] =
-      champsim::get_span_p(std::begin(inflight_tag_check), std::end(inflight_tag_check), tag_check_bw,
-                           [is_ready, is_translated](const auto& pkt) { return is_ready(pkt) && is_translated(pkt); });
-  auto hits_end = std::stable_partition(tag_check_ready_begin, tag_check_ready_end, [this](const auto& pkt) { return this->try_hit(pkt); });
-  auto finish_tag_check_end = std::stable_partition(hits_end, tag_check_ready_end, do_handle_miss);
-  tag_check_bw.consume(std::distance(tag_check_ready_begin, finish_tag_check_end));
-  inflight_tag_check.erase(tag_check_ready_begin, finish_tag_check_end);
 
-  impl_prefetcher_cycle_operate();
+    if (found != nullptr) {
+      if (found->dirty) {
+        if (!writeback_block(*found, probe.cpu, 0, probe.type != champsim::probe_type::downgrade)) {
+          return false;
+        }
+        ++sim_stats.probe_writebacks;
+      }
 
-  if constexpr (champsim::debug_print) {
-    fmt::print("[{}] {} cycle completed: {} tags checked: {} remaining: {} stash consumed: {} remaining: {} channel consumed: {} pq consumed {} unused consume "
-               "bw {}\n",
-               NAME, __func__, current_time.time_since_epoch() / clock_period, tag_check_bw.amount_consumed(), std::size(inflight_tag_check),
-               stash_bandwidth_consumed, std::size(translation_stash), channels_bandwidth_consumed, pq_bandwidth_consumed, initiate_tag_bw.amount_remaining());
+      if (probe.type == champsim::probe_type::back_invalidate) {
+        ++sim_stats.inclusion_victims;
+      }
+
+      if (probe.type != champsim::probe_type::downgrade) {
+        found->valid = false;
+        found->coherence = champsim::coherence_state::invalid;
+        if (way == set_end) {
+          victims->take(probe.address);
+        }
+      } else {
+        found->coherence = champsim::coherence_state::shared;
+      }
+    }
+  }
+
+  // Blocks that this cache does not hold may still be held above it
+  ++sim_stats.probes_received;
+  for (auto* ul : upper_levels) {
+    ul->probes.push_back(probe);
   }
 
-  return progress + fill_bw.amount_consumed() + initiate_tag_bw.amount_consumed() + tag_check_bw.amount_consumed();
+  return true;
 }
 
+long CACHE::operate() { return (this->*bound_operate)(); }
+
+// The cycle of a cache that calls its modules through their concepts
+template long CACHE::operate_with<CACHE::prefetcher_module_concept, CACHE::replacement_module_concept>();
+
 // LCOV_EXCL_START exclude deprecated function
 uint64_t CACHE::get_set(uint64_t address) const { return static_cast<uint64_t>(get_set_index(champsim::address{address})); }
 // LCOV_EXCL_STOP
 
-long CACHE::get_set_index(champsim::address address) const { return address.slice(champsim::dynamic_extent{OFFSET_BITS, champsim::lg2(NUM_SET)}).to<long>(); }
+long CACHE::get_set_index(champsim::address address) const
+{
+  return address.slice(champsim::dynamic_extent{get_tag_offset_bits(), champsim::lg2(NUM_SET)}).to<long>();
+}
+
+champsim::data::bits CACHE::get_tag_offset_bits() const { return OFFSET_BITS + champsim::data::bits{champsim::lg2(NUM_SECTOR)}; }
+
+long CACHE::get_bank_index(champsim::address address) const
+{
+  if (NUM_BANK == 1) {
+    return 0;
+  }
+
+  if (BANK_HASH == champsim::cache_bank_hash::xor_fold) {
+    uint64_t folded = 0;
+    for (auto upper = address.slice_upper(get_tag_offset_bits()).to<uint64_t>(); upper != 0; upper >>= champsim::lg2(NUM_BANK)) {
+      folded ^= upper;
+    }
+    return static_cast<long>(folded & (NUM_BANK - 1));
+  }
+
+  return get_set_index(address) & (NUM_BANK - 1);
+}
+
+bool CACHE::bank_available(champsim::address address) const
+{
+  const auto& bank = tag_banks.at(static_cast<std::size_t>(get_bank_index(address)));
+
+  // A bank that is still busy from a previous cycle cannot begin any checks
+  if (bank.last_lookup != current_time) {
+    return bank.busy_until <= current_time && champsim::to_underlying(MAX_BANK_TAG) > 0;
+  }
+
+  return bank.lookups < champsim::to_underlying(MAX_BANK_TAG);
+}
+
+void CACHE::reserve_bank(champsim::address address)
+{
+  auto& bank = tag_banks.at(static_cast<std::size_t>(get_bank_index(address)));
+  if (bank.last_lookup != current_time) {
+    bank.last_lookup = current_time;
+    bank.lookups = 0;
+  }
+
+  ++bank.lookups;
+  bank.busy_until = current_time + (warmup ? champsim::chrono::clock::duration{} : BANK_BUSY);
+}
+
+uint64_t CACHE::get_sector_mask(champsim::address address) const
+{
+  if (NUM_SECTOR == 1) {
+    return 1;
+  }
+  return uint64_t{1} << address.slice(champsim::dynamic_extent{OFFSET_BITS, champsim::lg2(NUM_SECTOR)}).to<uint64_t>();
+}
 
 template <typename It>
 std::pair<It, It> get_span(It anchor, typename std::iterator_traits<It>::difference_type set_idx, typename std::iterator_traits<It>::difference_type num_way)
@@ -557,17 +788,22 @@ uint64_t CACHE::get_way(uint64_t address, uint64_t /*unused set index*/) const
 {
   champsim::address intern_addr{address};
   auto [begin, end] = get_set_span(intern_addr);
-  return static_cast<uint64_t>(std::distance(begin, std::find_if(begin, end, matches_address(champsim::address{address}))));
+  return static_cast<uint64_t>(std::distance(begin, std::find_if(begin, end, matches_tag(champsim::address{address}))));
 }
 // LCOV_EXCL_STOP
 
 long CACHE::invalidate_entry(champsim::address inval_addr)
 {
   auto [begin, end] = get_set_span(inval_addr);
-  auto inv_way = std::find_if(begin, end, matches_address(inval_addr));
+  auto inv_way = std::find_if(begin, end, matches_tag(inval_addr));
 
   if (inv_way != end) {
-    inv_way->valid = false;
+    // In a sectored cache, the tag remains until its last sector is invalidated
+    inv_way->valid_sectors &= ~get_sector_mask(inval_addr);
+    inv_way->dirty_sectors &= ~get_sector_mask(inval_addr);
+    inv_way->valid = (NUM_SECTOR > 1 && inv_way->valid_sectors != 0);
+  } else if (victims) {
+    victims->take(inval_addr);
   }
 
   return std::distance(begin, inv_way);
@@ -620,7 +856,7 @@ void CACHE::finish_packet(const response_type& packet)
   }
 
   // MSHR holds the most updated information about this request
-  mshr_type::returned_value finished_value{packet.data, packet.pf_metadata};
+  mshr_type::returned_value finished_value{packet.data, packet.pf_metadata, packet.state};
   mshr_entry->data_promise = champsim::waitable{finished_value, current_time + (warmup ? champsim::chrono::clock::duration{} : FILL_LATENCY)};
   if constexpr (champsim::debug_print) {
     fmt::print("[{}_MSHR] finish_packet instr_id: {} address: {} data: {} type: {} current: {}\n", this->NAME, mshr_entry->instr_id, mshr_entry->address,
@@ -835,6 +1071,12 @@ void CACHE::impl_replacement_cache_fill(uint32_t triggering_cpu, long set, long
   repl_module_pimpl->impl_replacement_cache_fill(triggering_cpu, set, way, full_addr, ip, victim_addr, type);
 }
 
+void CACHE::impl_replacement_sector_fill(uint32_t triggering_cpu, long set, long way, champsim::address full_addr, champsim::address ip,
+                                         access_type type) const
+{
+  repl_module_pimpl->impl_replacement_sector_fill(triggering_cpu, set, way, full_addr, ip, type);
+}
+
 void CACHE::impl_replacement_final_stats() const { repl_module_pimpl->impl_replacement_final_stats(); }
 
 void CACHE::initialize()
@@ -851,6 +1093,23 @@ void CACHE::begin_phase()
   new_roi_stats.name = NAME;
   new_sim_stats.name = NAME;
 
+  new_roi_stats.banks = NUM_BANK;
+  new_sim_stats.banks = NUM_BANK;
+
+  new_roi_stats.sectors_per_tag = NUM_SECTOR;
+  new_sim_stats.sectors_per_tag = NUM_SECTOR;
+
+  new_roi_stats.has_directory = has_directory;
+  new_sim_stats.has_directory = has_directory;
+
+  new_roi_stats.victim_buffer_entries = victims ? victims->capacity() : 0;
+  new_sim_stats.victim_buffer_entries = victims ? victims->capacity() : 0;
+
+  new_roi_stats.sampled_sets = NUM_SAMPLED_SET;
+  new_sim_stats.sampled_sets = NUM_SAMPLED_SET;
+  new_roi_stats.total_sets = NUM_SET;
+  new_sim_stats.total_sets = NUM_SET;
+
   roi_stats = new_roi_stats;
   sim_stats = new_sim_stats;
 
@@ -878,6 +1137,44 @@ void CACHE::end_phase(unsigned finished_cpu)
   roi_stats.pf_useless = sim_stats.pf_useless;
   roi_stats.pf_fill = sim_stats.pf_fill;
 
+  roi_stats.bank_conflict_stalls = sim_stats.bank_conflict_stalls;
+
+  roi_stats.sector_misses = sim_stats.sector_misses;
+  roi_stats.sector_writebacks = sim_stats.sector_writebacks;
+
+  roi_stats.coherence_upgrades = sim_stats.coherence_upgrades;
+  roi_stats.probes_received = sim_stats.probes_received;
+  roi_stats.probe_writebacks = sim_stats.probe_writebacks;
+  roi_stats.coherence_misses = sim_stats.coherence_misses;
+  roi_stats.invalidations_sent = sim_stats.invalidations_sent;
+  roi_stats.downgrades_sent = sim_stats.downgrades_sent;
+
+  roi_stats.back_invalidations = sim_stats.back_invalidations;
+  roi_stats.inclusion_victims = sim_stats.inclusion_victims;
+
+  if (partitioner) {
+    std::vector<long> occupancy(NUM_CPUS, 0);
+    for (const auto& blk : block) {
+      if (blk.valid && blk.cpu < NUM_CPUS) {
+        ++occupancy.at(blk.cpu);
+      }
+    }
+    sim_stats.partition_ways = partitioner->get_allocation();
+    sim_stats.partition_occupancy = occupancy;
+  }
+  roi_stats.partition_ways = sim_stats.partition_ways;
+  roi_stats.partition_occupancy = sim_stats.partition_occupancy;
+  roi_stats.repartitions = sim_stats.repartitions;
+
+  roi_stats.victim_buffer_hits = sim_stats.victim_buffer_hits;
+  roi_stats.victim_buffer_inserts = sim_stats.victim_buffer_inserts;
+  roi_stats.victim_buffer_displaced = sim_stats.victim_buffer_displaced;
+
+  roi_stats.sampled_hits = sim_stats.sampled_hits;
+  roi_stats.sampled_misses = sim_stats.sampled_misses;
+  roi_stats.oracle_hits = sim_stats.oracle_hits;
+  roi_stats.oracle_misses = sim_stats.oracle_misses;
+
   for (auto* ul : upper_levels) {
     ul->roi_stats.RQ_ACCESS = ul->sim_stats.RQ_ACCESS;
     ul->roi_stats.RQ_MERGED = ul->sim_stats.RQ_MERGED;
@@ -897,12 +1194,6 @@ void CACHE::end_phase(unsigned finished_cpu)
   }
 }
 
-template <typename T>
-bool CACHE::should_activate_prefetcher(const T& pkt) const
-{
-  return !pkt.prefetch_from_this && std::count(std::begin(pref_activate_mask), std::end(pref_activate_mask), pkt.type) > 0;
-}
-
 // LCOV_EXCL_START Exclude the following function from LCOV
 void CACHE::print_deadlock()
 {
@@ -1,5 +1,7 @@
 #include "cache_stats.h"
 
+#include <cmath>
+
 cache_stats operator-(cache_stats lhs, cache_stats rhs)
 {
   cache_stats result;
@@ -13,5 +15,68 @@ cache_stats operator-(cache_stats lhs, cache_stats rhs)
   result.misses = lhs.misses - rhs.misses;
 
   result.total_miss_latency_cycles = lhs.total_miss_latency_cycles - rhs.total_miss_latency_cycles;
+
+  result.sectors_per_tag = lhs.sectors_per_tag;
+  result.sector_misses = lhs.sector_misses - rhs.sector_misses;
+  result.sector_writebacks = lhs.sector_writebacks - rhs.sector_writebacks;
+
+  result.banks = lhs.banks;
+  result.bank_conflict_stalls = lhs.bank_conflict_stalls - rhs.bank_conflict_stalls;
+
+  result.has_directory = lhs.has_directory;
+  result.coherence_upgrades = lhs.coherence_upgrades - rhs.coherence_upgrades;
+  result.probes_received = lhs.probes_received - rhs.probes_received;
+  result.probe_writebacks = lhs.probe_writebacks - rhs.probe_writebacks;
+  result.coherence_misses = lhs.coherence_misses - rhs.coherence_misses;
+  result.invalidations_sent = lhs.invalidations_sent - rhs.invalidations_sent;
+  result.downgrades_sent = lhs.downgrades_sent - rhs.downgrades_sent;
+
+  result.back_invalidations = lhs.back_invalidations - rhs.back_invalidations;
+  result.inclusion_victims = lhs.inclusion_victims - rhs.inclusion_victims;
+
+  result.partition_ways = lhs.partition_ways;
+  result.partition_occupancy = lhs.partition_occupancy;
+  result.repartitions = lhs.repartitions - rhs.repartitions;
+
+  result.victim_buffer_entries = lhs.victim_buffer_entries;
+  result.victim_buffer_hits = lhs.victim_buffer_hits - rhs.victim_buffer_hits;
+  result.victim_buffer_inserts = lhs.victim_buffer_inserts - rhs.victim_buffer_inserts;
+  result.victim_buffer_displaced = lhs.victim_buffer_displaced - rhs.victim_buffer_displaced;
+
+  result.sampled_sets = lhs.sampled_sets;
+  result.total_sets = lhs.total_sets;
+  result.sampled_hits = lhs.sampled_hits - rhs.sampled_hits;
+  result.sampled_misses = lhs.sampled_misses - rhs.sampled_misses;
+  result.oracle_hits = lhs.oracle_hits - rhs.oracle_hits;
+  result.oracle_misses = lhs.oracle_misses - rhs.oracle_misses;
   return result;
 }
+
+double cache_stats::sampled_miss_ratio() const
+{
+  auto accesses = sampled_hits + sampled_misses;
+  if (accesses == 0) {
+    return 0;
+  }
+  return std::ceil(sampled_misses) / std::ceil(accesses);
+}
+
+double cache_stats::sampled_miss_ratio_confidence() const
+{
+  // Half-width of the 95% confidence interval, under the normal approximation to the binomial distribution
+  constexpr double z_95 = 1.96;
+  auto accesses = sampled_hits + sampled_misses;
+  if (accesses == 0) {
+    return 1;
+  }
+  auto ratio = sampled_miss_ratio();
+  return z_95 * std::sqrt(ratio * (1 - ratio) / std::ceil(accesses));
+}
+
+double cache_stats::sampling_scale() const
+{
+  if (sampled_sets == 0) {
+    return 1;
+  }
+  return std::ceil(total_sets) / std::ceil(sampled_sets);
+}
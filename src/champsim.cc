@@ -19,11 +19,15 @@
 #include <algorithm>
 #include <chrono>
 #include <numeric>
+#include <optional>
+#include <utility>
 #include <vector>
 #include <fmt/chrono.h>
 #include <fmt/core.h>
 
+#include "convergence_monitor.h"
 #include "environment.h"
+#include "functional_warmup.h"
 #include "ooo_cpu.h"
 #include "operable.h"
 #include "phase_info.h"
@@ -37,7 +41,32 @@ std::chrono::seconds elapsed_time() { return std::chrono::duration_cast<std::chr
 
 namespace champsim
 {
-long do_cycle(environment& env, std::vector<tracereader>& traces, std::vector<std::size_t> trace_index, champsim::chrono::clock& global_clock)
+std::vector<uint32_t> trace_cpus(environment& env)
+{
+  auto cpus = env.cpu_view();
+  std::vector<std::size_t> threads(std::size(cpus));
+  for (const O3_CPU& cpu : cpus) {
+    threads.at(cpu.cpu) = std::size(cpu.threads);
+  }
+
+  std::vector<uint32_t> retval;
+  for (uint32_t cpu = 0; cpu < std::size(threads); ++cpu) {
+    retval.insert(std::end(retval), threads.at(cpu), cpu);
+  }
+  return retval;
+}
+
+namespace
+{
+// The index of the trace that the given thread of the CPU runs
+std::size_t thread_trace(const std::vector<uint32_t>& cpus, const O3_CPU& cpu, std::size_t thread)
+{
+  return static_cast<std::size_t>(std::distance(std::begin(cpus), std::lower_bound(std::begin(cpus), std::end(cpus), cpu.cpu))) + thread;
+}
+} // namespace
+
+long do_cycle(environment& env, std::vector<tracereader>& traces, const std::vector<std::size_t>& trace_index, const std::vector<uint32_t>& cpus,
+              champsim::chrono::clock& global_clock)
 {
   auto operables = env.operable_view();
   std::sort(std::begin(operables), std::end(operables),
@@ -51,19 +80,49 @@ long do_cycle(environment& env, std::vector<tracereader>& traces, std::vector<st
 
   // Read from trace
   for (O3_CPU& cpu : env.cpu_view()) {
-    auto& trace = traces.at(trace_index.at(cpu.cpu));
-    for (auto pkt_count = cpu.IN_QUEUE_SIZE - static_cast<long>(std::size(cpu.input_queue)); !trace.eof() && pkt_count > 0; --pkt_count) {
-      cpu.input_queue.push_back(trace());
+    for (std::size_t thread = 0; thread < std::size(cpu.threads); ++thread) {
+      auto& trace = traces.at(trace_index.at(thread_trace(cpus, cpu, thread)));
+      auto& input_queue = cpu.threads.at(thread).input_queue;
+      for (auto pkt_count = cpu.IN_QUEUE_SIZE - static_cast<long>(std::size(input_queue)); !trace.eof() && pkt_count > 0; --pkt_count) {
+        input_queue.push_back(cpu.assign_to_thread(thread, trace()));
+      }
     }
   }
 
   return progress;
 }
 
+phase_stats collect_phase_stats(const phase_info& phase, environment& env)
+{
+  phase_stats stats;
+  stats.name = phase.name;
+
+  for (std::size_t i = 0; i < std::size(phase.trace_index); ++i) {
+    stats.trace_names.push_back(phase.trace_names.at(phase.trace_index.at(i)));
+  }
+  stats.trace_cpus = trace_cpus(env);
+
+  auto cpus = env.cpu_view();
+  std::transform(std::begin(cpus), std::end(cpus), std::back_inserter(stats.sim_cpu_stats), [](const O3_CPU& cpu) { return cpu.sim_stats; });
+  std::transform(std::begin(cpus), std::end(cpus), std::back_inserter(stats.roi_cpu_stats), [](const O3_CPU& cpu) { return cpu.roi_stats; });
+
+  auto caches = env.cache_view();
+  std::transform(std::begin(caches), std::end(caches), std::back_inserter(stats.sim_cache_stats), [](const CACHE& cache) { return cache.sim_stats; });
+  std::transform(std::begin(caches), std::end(caches), std::back_inserter(stats.roi_cache_stats), [](const CACHE& cache) { return cache.roi_stats; });
+
+  auto dram = env.dram_view();
+  std::transform(std::begin(dram.channels), std::end(dram.channels), std::back_inserter(stats.sim_dram_stats),
+                 [](const DRAM_CHANNEL& chan) { return chan.sim_stats; });
+  std::transform(std::begin(dram.channels), std::end(dram.channels), std::back_inserter(stats.roi_dram_stats),
+                 [](const DRAM_CHANNEL& chan) { return chan.roi_stats; });
+
+  return stats;
+}
+
 phase_stats do_phase(const phase_info& phase, environment& env, std::vector<tracereader>& traces, champsim::chrono::clock& global_clock)
 {
   auto operables = env.operable_view();
-  auto [phase_name, is_warmup, length, trace_index, trace_names] = phase;
+  auto [phase_name, is_warmup, length, trace_index, trace_names, is_functional, functional_threads, convergence] = phase;
 
   // Initialize phase
   for (champsim::operable& op : operables) {
@@ -71,6 +130,11 @@ phase_stats do_phase(const phase_info& phase, environment& env, std::vector<trac
     op.begin_phase();
   }
 
+  std::optional<convergence_monitor> monitor;
+  if (is_warmup && convergence.window > 0) {
+    monitor.emplace(convergence, convergence_monitor::snapshot(env));
+  }
+
   const auto time_quantum = std::accumulate(std::cbegin(operables), std::cend(operables), champsim::chrono::clock::duration::max(),
                                             [](const auto acc, const operable& y) { return std::min(acc, y.clock_period); });
 
@@ -81,6 +145,9 @@ phase_stats do_phase(const phase_info& phase, environment& env, std::vector<trac
   std::vector<double> livelock_threshold{0.01, 0.02, 0.05};
   std::vector<uint64_t> livelock_instr(std::size(env.cpu_view()), 0);
 
+  // The threads of the CPUs do not change during the phase
+  const auto cpus = trace_cpus(env);
+
   // Perform phase
   int stalled_cycle{0};
   std::vector<bool> phase_complete(std::size(env.cpu_view()), false);
@@ -88,7 +155,7 @@ phase_stats do_phase(const phase_info& phase, environment& env, std::vector<trac
     auto next_phase_complete = phase_complete;
     global_clock.tick(time_quantum);
 
-    auto progress = do_cycle(env, traces, trace_index, global_clock);
+    auto progress = do_cycle(env, traces, trace_index, cpus, global_clock);
 
     if (progress == 0) {
       ++stalled_cycle;
@@ -131,6 +198,12 @@ phase_stats do_phase(const phase_info& phase, environment& env, std::vector<trac
       std::fill(std::begin(next_phase_complete), std::end(next_phase_complete), true);
     }
 
+    // An adaptive warmup ends on every CPU at once, when its statistics have settled
+    if (monitor.has_value() && !monitor->converged() && monitor->operate(env)) {
+      fmt::print("{} converged after {} windows of {} instructions\n", phase_name, monitor->windows(), convergence.window);
+      std::fill(std::begin(next_phase_complete), std::end(next_phase_complete), true);
+    }
+
     // Check for phase finish
     for (O3_CPU& cpu : env.cpu_view()) {
       // Phase complete
@@ -156,28 +229,78 @@ phase_stats do_phase(const phase_info& phase, environment& env, std::vector<trac
                cpu.sim_instr(), cpu.sim_cycle(), std::ceil(cpu.sim_instr()) / std::ceil(cpu.sim_cycle()), elapsed_time());
   }
 
-  phase_stats stats;
-  stats.name = phase.name;
+  // A warmup that runs to its limit may not have warmed the hierarchy
+  if (monitor.has_value() && !monitor->converged()) {
+    fmt::print("WARNING: {} did not converge within {} instructions\n", phase_name, length);
+  }
+
+  return collect_phase_stats(phase, env);
+}
+
+phase_stats do_functional_phase(const phase_info& phase, environment& env, std::vector<tracereader>& traces)
+{
+  auto operables = env.operable_view();
+  auto [phase_name, is_warmup, length, trace_index, trace_names, is_functional, functional_threads, convergence] = phase;
 
-  for (std::size_t i = 0; i < std::size(trace_index); ++i) {
-    stats.trace_names.push_back(trace_names.at(trace_index.at(i)));
+  // Initialize phase
+  for (champsim::operable& op : operables) {
+    op.warmup = is_warmup;
+    op.begin_phase();
   }
 
-  auto cpus = env.cpu_view();
-  std::transform(std::begin(cpus), std::end(cpus), std::back_inserter(stats.sim_cpu_stats), [](const O3_CPU& cpu) { return cpu.sim_stats; });
-  std::transform(std::begin(cpus), std::end(cpus), std::back_inserter(stats.roi_cpu_stats), [](const O3_CPU& cpu) { return cpu.roi_stats; });
+  functional_warmup warmer{env, functional_threads};
 
-  auto caches = env.cache_view();
-  std::transform(std::begin(caches), std::end(caches), std::back_inserter(stats.sim_cache_stats), [](const CACHE& cache) { return cache.sim_stats; });
-  std::transform(std::begin(caches), std::end(caches), std::back_inserter(stats.roi_cache_stats), [](const CACHE& cache) { return cache.roi_stats; });
+  // Perform phase, taking one instruction from each thread of each CPU in turn. As in a timed phase, CPUs that have finished continue until all have
+  // finished.
+  const auto cpus = trace_cpus(env);
+  std::vector<bool> phase_complete(std::size(env.cpu_view()), false);
+  while (!std::accumulate(std::begin(phase_complete), std::end(phase_complete), true, std::logical_and{})) {
+    for (O3_CPU& cpu : env.cpu_view()) {
+      for (std::size_t thread = 0; thread < std::size(cpu.threads); ++thread) {
+        auto& trace = traces.at(trace_index.at(thread_trace(cpus, cpu, thread)));
+        auto& input_queue = cpu.threads.at(thread).input_queue;
+        if (std::empty(input_queue) && trace.eof()) {
+          continue;
+        }
 
-  auto dram = env.dram_view();
-  std::transform(std::begin(dram.channels), std::end(dram.channels), std::back_inserter(stats.sim_dram_stats),
-                 [](const DRAM_CHANNEL& chan) { return chan.sim_stats; });
-  std::transform(std::begin(dram.channels), std::end(dram.channels), std::back_inserter(stats.roi_dram_stats),
-                 [](const DRAM_CHANNEL& chan) { return chan.roi_stats; });
+        // Instructions that were read ahead by an earlier phase are used first
+        auto instr = std::empty(input_queue) ? cpu.assign_to_thread(thread, trace()) : input_queue.front();
+        if (!std::empty(input_queue)) {
+          input_queue.pop_front();
+        }
+        warmer.operate(cpu, instr);
+      }
+    }
 
-  return stats;
+    auto next_phase_complete = phase_complete;
+
+    // If any trace reaches EOF, terminate all phases
+    if (std::any_of(std::begin(traces), std::end(traces), [](const auto& tr) { return tr.eof(); })) {
+      std::fill(std::begin(next_phase_complete), std::end(next_phase_complete), true);
+    }
+
+    for (O3_CPU& cpu : env.cpu_view()) {
+      next_phase_complete[cpu.cpu] = next_phase_complete[cpu.cpu] || (cpu.sim_instr() >= length);
+      if (next_phase_complete[cpu.cpu] != phase_complete[cpu.cpu]) {
+        warmer.drain();
+        for (champsim::operable& op : operables) {
+          op.end_phase(cpu.cpu);
+        }
+
+        fmt::print("{} finished CPU {} instructions: {} functional (Simulation time: {:%H hr %M min %S sec})\n", phase_name, cpu.cpu, cpu.sim_instr(),
+                   elapsed_time());
+      }
+    }
+
+    phase_complete = next_phase_complete;
+  }
+
+  for (O3_CPU& cpu : env.cpu_view()) {
+    fmt::print("{} complete CPU {} instructions: {} functional (Simulation time: {:%H hr %M min %S sec})\n", phase_name, cpu.cpu, cpu.sim_instr(),
+               elapsed_time());
+  }
+
+  return collect_phase_stats(phase, env);
 }
 
 // simulation entry point
@@ -189,9 +312,19 @@ std::vector<phase_stats> main(environment& env, std::vector<phase_info>& phases,
 
   champsim::chrono::clock global_clock;
   std::vector<phase_stats> results;
+  std::vector<long long> warmup_instructions;
   for (auto phase : phases) {
-    auto stats = do_phase(phase, env, traces, global_clock);
+    auto stats = phase.is_functional ? do_functional_phase(phase, env, traces) : do_phase(phase, env, traces, global_clock);
+
+    // The length of an adaptive warmup is reported with the phase that follows it
+    if (phase.is_warmup && !phase.is_functional && phase.convergence.window > 0) {
+      warmup_instructions.clear();
+      std::transform(std::begin(stats.sim_cpu_stats), std::end(stats.sim_cpu_stats), std::back_inserter(warmup_instructions),
+                     [](const auto& cpu_stats) { return cpu_stats.instrs(); });
+    }
+
     if (!phase.is_warmup) {
+      stats.warmup_instructions = std::exchange(warmup_instructions, {});
       results.push_back(stats);
     }
   }
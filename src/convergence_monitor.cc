@@ -0,0 +1,120 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "convergence_monitor.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "cache.h"
+#include "dram_controller.h"
+#include "environment.h"
+#include "ooo_cpu.h"
+
+champsim::convergence_monitor::convergence_monitor(convergence_options opts, snapshot_type initial)
+    : options(opts), next_window(opts.window), last_snapshot(std::move(initial))
+{
+  assert(options.window > 0);
+}
+
+auto champsim::convergence_monitor::snapshot(environment& env) -> snapshot_type
+{
+  snapshot_type retval;
+  for (const O3_CPU& cpu : env.cpu_view()) {
+    auto stats = cpu.sim_stats;
+    stats.end_instrs = stats.begin_instrs + cpu.sim_instr();
+    retval.cpus.push_back(stats);
+  }
+  for (const CACHE& cache : env.cache_view()) {
+    retval.caches.push_back(cache.sim_stats);
+  }
+  for (const DRAM_CHANNEL& chan : env.dram_view().channels) {
+    retval.dram.push_back(chan.sim_stats);
+  }
+  return retval;
+}
+
+auto champsim::convergence_monitor::window_metrics(const snapshot_type& begin, const snapshot_type& end) -> metrics_type
+{
+  auto ratio = [](auto numerator, auto denominator) -> std::optional<double> {
+    if (denominator == 0) {
+      return std::nullopt;
+    }
+    return static_cast<double>(numerator) / static_cast<double>(denominator);
+  };
+
+  metrics_type retval;
+  for (std::size_t i = 0; i < std::size(end.cpus); ++i) {
+    auto window = end.cpus.at(i) - begin.cpus.at(i);
+    auto mpki = ratio(window.branch_type_misses.total(), window.instrs());
+    retval.push_back(mpki.has_value() ? std::optional{*mpki * 1000} : std::nullopt);
+  }
+  for (std::size_t i = 0; i < std::size(end.caches); ++i) {
+    auto window = end.caches.at(i) - begin.caches.at(i);
+    auto misses = window.misses.total();
+    retval.push_back(ratio(misses, window.hits.total() + misses));
+  }
+  for (std::size_t i = 0; i < std::size(end.dram); ++i) {
+    auto window = end.dram.at(i) - begin.dram.at(i);
+    auto hits = window.RQ_ROW_BUFFER_HIT + window.WQ_ROW_BUFFER_HIT;
+    retval.push_back(ratio(hits, hits + window.RQ_ROW_BUFFER_MISS + window.WQ_ROW_BUFFER_MISS));
+  }
+  return retval;
+}
+
+bool champsim::convergence_monitor::is_stable(const metrics_type& previous, const metrics_type& current, double tolerance)
+{
+  assert(std::size(previous) == std::size(current));
+  return std::equal(std::begin(previous), std::end(previous), std::begin(current), [tolerance](const auto& prev, const auto& curr) {
+    if (!prev.has_value() || !curr.has_value()) {
+      return true;
+    }
+    return std::abs(*curr - *prev) <= tolerance * std::max(std::abs(*prev), 1.0);
+  });
+}
+
+bool champsim::convergence_monitor::observe(snapshot_type snapshot)
+{
+  auto metrics = window_metrics(last_snapshot, snapshot);
+  if (last_metrics.has_value() && is_stable(*last_metrics, metrics, options.tolerance)) {
+    ++stable_windows;
+  } else {
+    stable_windows = 0;
+  }
+
+  ++completed_windows;
+  last_snapshot = std::move(snapshot);
+  last_metrics = std::move(metrics);
+  return converged();
+}
+
+bool champsim::convergence_monitor::operate(environment& env)
+{
+  auto cpus = env.cpu_view();
+  auto least_instrs = std::min_element(std::begin(cpus), std::end(cpus),
+                                       [](const O3_CPU& lhs, const O3_CPU& rhs) { return lhs.sim_instr() < rhs.sim_instr(); });
+  if (converged() || least_instrs == std::end(cpus) || least_instrs->get().sim_instr() < next_window) {
+    return converged();
+  }
+
+  next_window += options.window;
+  return observe(snapshot(env));
+}
+
+bool champsim::convergence_monitor::converged() const { return stable_windows >= options.stable_windows; }
+
+long long champsim::convergence_monitor::windows() const { return completed_windows; }
@@ -1,15 +1,53 @@
 #include "core_stats.h"
 
+#include <algorithm>
+
+namespace
+{
+// Only a core with more than one thread records its threads, so either list may be empty
+std::vector<long long> subtract_threads(std::vector<long long> lhs, const std::vector<long long>& rhs)
+{
+  for (std::size_t thread = 0; thread < std::min(std::size(lhs), std::size(rhs)); ++thread) {
+    lhs.at(thread) -= rhs.at(thread);
+  }
+  return lhs;
+}
+} // namespace
+
 cpu_stats operator-(cpu_stats lhs, cpu_stats rhs)
 {
   lhs.begin_instrs -= rhs.begin_instrs;
   lhs.begin_cycles -= rhs.begin_cycles;
   lhs.end_instrs -= rhs.end_instrs;
   lhs.end_cycles -= rhs.end_cycles;
+  lhs.thread_begin_instrs = subtract_threads(lhs.thread_begin_instrs, rhs.thread_begin_instrs);
+  lhs.thread_end_instrs = subtract_threads(lhs.thread_end_instrs, rhs.thread_end_instrs);
   lhs.total_rob_occupancy_at_branch_mispredict -= rhs.total_rob_occupancy_at_branch_mispredict;
 
+  lhs.store_buffer_stores -= rhs.store_buffer_stores;
+  lhs.store_buffer_coalesced -= rhs.store_buffer_coalesced;
+  lhs.store_buffer_writes -= rhs.store_buffer_writes;
+  lhs.store_buffer_full_stalls -= rhs.store_buffer_full_stalls;
+  lhs.store_buffer_forwards -= rhs.store_buffer_forwards;
+  lhs.wrong_path_episodes -= rhs.wrong_path_episodes;
+  lhs.wrong_path_fetches -= rhs.wrong_path_fetches;
+  lhs.wrong_path_loads -= rhs.wrong_path_loads;
+  lhs.ftq_occupancy -= rhs.ftq_occupancy;
+  lhs.fdip_prefetches -= rhs.fdip_prefetches;
+  lhs.fdip_lead_cycles -= rhs.fdip_lead_cycles;
+  lhs.fdip_unprefetched -= rhs.fdip_unprefetched;
+  lhs.dependence_predicted_waits -= rhs.dependence_predicted_waits;
+  lhs.dependence_false_waits -= rhs.dependence_false_waits;
+  lhs.dependence_violations -= rhs.dependence_violations;
+  lhs.value_predictions -= rhs.value_predictions;
+  lhs.value_mispredictions -= rhs.value_mispredictions;
+  lhs.address_predictions -= rhs.address_predictions;
+  lhs.address_mispredictions -= rhs.address_mispredictions;
+
   lhs.total_branch_types -= rhs.total_branch_types;
   lhs.branch_type_misses -= rhs.branch_type_misses;
+  lhs.port_issues -= rhs.port_issues;
+  lhs.port_contention -= rhs.port_contention;
 
   return lhs;
 }
@@ -0,0 +1,418 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "functional_warmup.h"
+
+#include <algorithm>
+#include <numeric>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+
+#include "cache.h"
+#include "environment.h"
+#include "instruction.h"
+#include "ooo_cpu.h"
+#include "ptw.h"
+#include "slice_router.h"
+#include "vmem.h"
+
+struct champsim::functional_warmup::stage_type {
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::deque<std::vector<pending_type>> batches{};
+  bool busy = false;   // A batch has been taken, but its requests to the next stage are not yet sent
+  bool closed = false; // No more batches will be sent
+  std::thread worker{};
+
+  // The worker shares each batch with the helpers, which each make the requests to their share of the sets
+  const std::vector<pending_type>* shared_batch = nullptr;
+  uint64_t generation = 0; // The number of batches that have been shared
+  std::size_t shards_done = 0;
+  std::vector<std::vector<std::pair<std::size_t, pending_type>>> results{};
+  std::vector<std::thread> helpers{};
+};
+
+champsim::functional_warmup::functional_warmup(environment& env, std::size_t threads) : last_fetch(std::size(env.cpu_view())), num_threads(threads)
+{
+  for (CACHE& cache : env.cache_view()) {
+    for (auto* ul : cache.upper_levels) {
+      caches.try_emplace(ul, &cache);
+    }
+  }
+
+  for (champsim::operable& op : env.operable_view()) {
+    if (auto* router = dynamic_cast<champsim::slice_router*>(&op); router != nullptr) {
+      routers.push_back(router);
+    }
+  }
+
+  // The virtual memory is shared by all of the page table walkers
+  if (auto ptws = env.ptw_view(); !std::empty(ptws)) {
+    vmem = ptws.front().get().vmem;
+  }
+
+  if (num_threads > 1) {
+    place_caches(env);
+  }
+}
+
+champsim::functional_warmup::~functional_warmup()
+{
+  drain();
+  for (auto& stage : stages) {
+    {
+      std::lock_guard lock{stage->mutex};
+      stage->closed = true;
+    }
+    stage->changed.notify_all();
+    stage->worker.join();
+    for (auto& helper : stage->helpers) {
+      helper.join();
+    }
+  }
+}
+
+void champsim::functional_warmup::place_caches(environment& env)
+{
+  // The caches that the cores and the TLBs read are warmed in order with them
+  std::unordered_set<const CACHE*> serial;
+  std::vector<const channel_type*> roots;
+  for (O3_CPU& cpu : env.cpu_view()) {
+    roots.push_back(cpu.L1I_bus.lower_channel());
+    roots.push_back(cpu.L1D_bus.lower_channel());
+  }
+  for (CACHE& cache : env.cache_view()) {
+    roots.push_back(cache.lower_translate);
+  }
+  for (const auto* root : roots) {
+    for (const auto* cache : caches_below(root)) {
+      serial.insert(cache);
+    }
+  }
+
+  // A cache that translates its prefetches must also be warmed in order, as must every cache above one that is
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (CACHE& cache : env.cache_view()) {
+      auto below = caches_below(cache.lower_level);
+      bool is_serial = (cache.virtual_prefetch && !cache.is_set_local())
+                       || std::any_of(std::begin(below), std::end(below), [&serial](const auto* lower) { return serial.count(lower) > 0; });
+      if (is_serial && serial.insert(&cache).second) {
+        changed = true;
+      }
+    }
+  }
+
+  for (CACHE& cache : env.cache_view()) {
+    if (serial.count(&cache) == 0) {
+      placement.try_emplace(&cache, placement_type{1, cache.is_set_local()});
+    }
+  }
+
+  // Each cache is placed in the stage after the latest of the caches above it
+  changed = true;
+  while (changed) {
+    changed = false;
+    for (CACHE& cache : env.cache_view()) {
+      auto upper = placement.find(&cache);
+      auto upper_stage = (upper == std::end(placement)) ? 0 : upper->second.stage;
+      for (const auto* lower : caches_below(cache.lower_level)) {
+        if (auto where = placement.find(lower); where != std::end(placement) && where->second.stage <= upper_stage) {
+          where->second.stage = upper_stage + 1;
+          changed = true;
+        }
+      }
+    }
+  }
+
+  auto num_stages = std::accumulate(std::begin(placement), std::end(placement), std::size_t{0},
+                                    [](auto acc, const auto& entry) { return std::max(acc, entry.second.stage); });
+  for (std::size_t stage = 1; stage <= num_stages; ++stage) {
+    stages.push_back(std::make_unique<stage_type>());
+    stages.back()->worker = std::thread{[this, stage] { run_stage(stage); }};
+    stages.back()->results.resize(num_threads);
+    for (std::size_t shard = 1; shard < num_threads; ++shard) {
+      stages.back()->helpers.emplace_back([this, stage, shard] { run_shard(stage, shard); });
+    }
+  }
+}
+
+CACHE* champsim::functional_warmup::find_cache(const channel_type* channel, champsim::address address) const
+{
+  // A request to a sliced cache goes to the slice that holds the block
+  for (const auto* router : routers) {
+    if (auto* slice = router->route(channel, address); slice != nullptr) {
+      channel = slice;
+      break;
+    }
+  }
+
+  auto found = caches.find(channel);
+  return found == std::end(caches) ? nullptr : found->second;
+}
+
+std::vector<CACHE*> champsim::functional_warmup::caches_below(const channel_type* channel) const
+{
+  std::vector<const channel_type*> channels{channel};
+  for (const auto* router : routers) {
+    if (auto slices = router->slice_channels(channel); !std::empty(slices)) {
+      channels.assign(std::begin(slices), std::end(slices));
+      break;
+    }
+  }
+
+  std::vector<CACHE*> retval;
+  for (const auto* ch : channels) {
+    if (auto found = caches.find(ch); found != std::end(caches)) {
+      retval.push_back(found->second);
+    }
+  }
+  return retval;
+}
+
+void champsim::functional_warmup::access(const channel_type* channel, request_type req)
+{
+  auto* found = find_cache(channel, req.address);
+  if (found == nullptr) {
+    return;
+  }
+
+  if (placement.count(found) > 0) {
+    outgoing.push_back(pending_type{found, std::move(req)});
+    if (std::size(outgoing) >= BATCH_SIZE) {
+      send(1, std::exchange(outgoing, {}));
+    }
+    return;
+  }
+
+  CACHE& cache = *found;
+  auto to_lower = cache.functional_access(std::move(req), [this, &cache](uint32_t cpu, champsim::address v_address) {
+    return translate(cache.lower_translate, cpu, v_address);
+  });
+  for (auto& lower_req : to_lower) {
+    access(cache.lower_level, std::move(lower_req));
+  }
+}
+
+champsim::address champsim::functional_warmup::translate(const channel_type* translate_channel, uint32_t cpu, champsim::address v_address)
+{
+  auto p_address = v_address;
+  if (vmem != nullptr) {
+    auto p_page = vmem->va_to_pa(cpu, champsim::page_number{v_address}).first;
+    p_address = champsim::address{champsim::splice(p_page, champsim::page_offset{v_address})};
+  }
+
+  // The TLBs hold the physical address as their data, as if it had been returned by the page table walker
+  request_type translation;
+  translation.type = access_type::LOAD;
+  translation.cpu = cpu;
+  translation.address = v_address;
+  translation.v_address = v_address;
+  translation.data = p_address;
+  access(translate_channel, translation);
+
+  return p_address;
+}
+
+void champsim::functional_warmup::operate(O3_CPU& cpu, ooo_model_instr& instr)
+{
+  auto make_request = [&cpu, &instr](champsim::address v_address, access_type type) {
+    request_type packet;
+    packet.address = v_address;
+    packet.v_address = v_address;
+    packet.ip = instr.ip;
+    packet.instr_id = instr.instr_id;
+    packet.cpu = cpu.cpu;
+    packet.type = type;
+    packet.is_translated = false;
+    packet.response_requested = (type != access_type::WRITE);
+    return packet;
+  };
+
+  (cpu.*cpu.bound_predict_branch)(instr);
+
+  // Instructions that hit in the decoded instruction buffer are not fetched, and the instructions in a block are fetched together
+  auto& fetched = last_fetch.at(cpu.cpu);
+  const champsim::block_number fetch_block{instr.ip};
+  if (!cpu.DIB.check_hit(instr.ip).has_value()) {
+    if (fetched != fetch_block) {
+      access(cpu.L1I_bus.lower_channel(), make_request(instr.ip, access_type::LOAD));
+    }
+    cpu.DIB.fill(instr.ip);
+    fetched = fetch_block;
+  } else if (fetched != fetch_block) {
+    fetched.reset();
+  }
+
+  for (auto address : instr.source_memory) {
+    access(cpu.L1D_bus.lower_channel(), make_request(address, access_type::LOAD));
+  }
+  for (auto address : instr.destination_memory) {
+    access(cpu.L1D_bus.lower_channel(), make_request(address, access_type::WRITE));
+  }
+
+  ++cpu.num_retired;
+  ++cpu.threads.at(instr.thread).num_retired;
+}
+
+void champsim::functional_warmup::drain()
+{
+  if (!std::empty(outgoing)) {
+    send(1, std::exchange(outgoing, {}));
+  }
+
+  // Each stage sends its requests onward before it finishes a batch, so the stages are drained in order
+  for (auto& stage : stages) {
+    std::unique_lock lock{stage->mutex};
+    stage->changed.wait(lock, [&stage] { return std::empty(stage->batches) && !stage->busy; });
+  }
+}
+
+void champsim::functional_warmup::send(std::size_t stage, std::vector<pending_type> batch)
+{
+  auto& dest = *stages.at(stage - 1);
+  {
+    std::unique_lock lock{dest.mutex};
+    dest.changed.wait(lock, [&dest] { return std::size(dest.batches) < MAX_BATCHES; });
+    dest.batches.push_back(std::move(batch));
+  }
+  dest.changed.notify_all();
+}
+
+void champsim::functional_warmup::run_stage(std::size_t stage)
+{
+  auto& self = *stages.at(stage - 1);
+  while (true) {
+    std::vector<pending_type> batch;
+    {
+      std::unique_lock lock{self.mutex};
+      self.changed.wait(lock, [&self] { return self.closed || !std::empty(self.batches); });
+      if (std::empty(self.batches)) {
+        return;
+      }
+      batch = std::move(self.batches.front());
+      self.batches.pop_front();
+      self.busy = true;
+    }
+    self.changed.notify_all();
+
+    auto result = process(stage, batch);
+    if (stage < std::size(stages) && !std::empty(result)) {
+      send(stage + 1, std::move(result));
+    }
+
+    {
+      std::lock_guard lock{self.mutex};
+      self.busy = false;
+    }
+    self.changed.notify_all();
+  }
+}
+
+void champsim::functional_warmup::run_shard(std::size_t stage, std::size_t shard)
+{
+  auto& self = *stages.at(stage - 1);
+  uint64_t seen = 0;
+  while (true) {
+    const std::vector<pending_type>* batch = nullptr;
+    {
+      std::unique_lock lock{self.mutex};
+      self.changed.wait(lock, [&self, seen] { return self.closed || self.generation != seen; });
+      if (self.generation == seen) {
+        return;
+      }
+      seen = self.generation;
+      batch = self.shared_batch;
+    }
+
+    process_shard(stage, *batch, shard, self.results.at(shard));
+
+    {
+      std::lock_guard lock{self.mutex};
+      ++self.shards_done;
+    }
+    self.changed.notify_all();
+  }
+}
+
+auto champsim::functional_warmup::process(std::size_t stage, const std::vector<pending_type>& batch) -> std::vector<pending_type>
+{
+  auto& self = *stages.at(stage - 1);
+  for (auto& shard_results : self.results) {
+    shard_results.clear();
+  }
+
+  {
+    std::lock_guard lock{self.mutex};
+    self.shared_batch = &batch;
+    self.shards_done = 0;
+    ++self.generation;
+  }
+  self.changed.notify_all();
+
+  process_shard(stage, batch, 0, self.results.at(0));
+  {
+    std::unique_lock lock{self.mutex};
+    self.changed.wait(lock, [this, &self] { return self.shards_done + 1 == num_threads; });
+  }
+
+  // Restore the order in which the requests would have been made
+  std::vector<std::pair<std::size_t, pending_type>> merged;
+  for (auto& shard_results : self.results) {
+    merged.insert(std::end(merged), std::make_move_iterator(std::begin(shard_results)), std::make_move_iterator(std::end(shard_results)));
+  }
+  std::stable_sort(std::begin(merged), std::end(merged), [](const auto& x, const auto& y) { return x.first < y.first; });
+
+  std::vector<pending_type> retval;
+  std::transform(std::make_move_iterator(std::begin(merged)), std::make_move_iterator(std::end(merged)), std::back_inserter(retval),
+                 [](auto&& entry) { return std::move(entry.second); });
+  return retval;
+}
+
+void champsim::functional_warmup::process_shard(std::size_t stage, const std::vector<pending_type>& batch, std::size_t shard,
+                                                std::vector<std::pair<std::size_t, pending_type>>& result) const
+{
+  // The requests to each set are made by one thread, in order. The requests to the caches of later stages pass through.
+  for (std::size_t i = 0; i < std::size(batch); ++i) {
+    const auto& [cache, req] = batch[i];
+    const auto& where = placement.at(cache);
+    if (where.stage != stage) {
+      if (shard == 0) {
+        result.emplace_back(i, batch[i]);
+      }
+      continue;
+    }
+
+    auto owner = where.set_local ? static_cast<std::size_t>(cache->get_set_index(req.address)) % num_threads : 0;
+    if (owner != shard) {
+      continue;
+    }
+
+    // The caches in the stages do not translate their prefetches, so the translator is never called
+    auto to_lower = where.set_local ? cache->functional_access_in_set(req)
+                                    : cache->functional_access(req, [](uint32_t, champsim::address v_address) { return v_address; });
+    for (auto& lower_req : to_lower) {
+      if (auto* lower = find_cache(cache->lower_level, lower_req.address); lower != nullptr) {
+        result.emplace_back(i, pending_type{lower, std::move(lower_req)});
+      }
+    }
+  }
+}
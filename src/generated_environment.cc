@@ -2,8 +2,10 @@
 
 #include <forward_list>
 
+#include "cache_dispatch.h"
 #include "core_inst.inc"
 #include "environment.h"
+#include "ooo_cpu_dispatch.h"
 
 #if __has_include("legacy_bridge.h")
 #include "legacy_bridge.h"
@@ -22,6 +24,14 @@ auto build(PTWs... builders)
   (..., retval.emplace_front(builders));
   return retval;
 }
+
+template <typename R, typename... PTWs>
+auto build(champsim::modules::static_dispatch_t tag, PTWs... builders)
+{
+  std::forward_list<R> retval{};
+  (..., retval.emplace_front(tag, builders));
+  return retval;
+}
 } // namespace champsim::configured
 
 #if __has_include("core_inst.cc.inc")
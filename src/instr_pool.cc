@@ -0,0 +1,144 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "instr_pool.h"
+
+#include <cassert>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+#include "util/bits.h"
+
+champsim::instr_pool::instr_pool(std::size_t capacity) : storage(capacity), free_list(capacity)
+{
+  // Allocate the lowest handles first
+  std::iota(std::rbegin(free_list), std::rend(free_list), handle_type{0});
+}
+
+auto champsim::instr_pool::allocate(ooo_model_instr instr) -> handle_type
+{
+  if (std::empty(free_list)) {
+    free_list.push_back(std::size(storage));
+    storage.emplace_back(); // Growing a deque at the end does not move its elements
+  }
+
+  auto handle = free_list.back();
+  free_list.pop_back();
+
+  assert(!storage[handle].has_value());
+  storage[handle].emplace(std::move(instr));
+  return handle;
+}
+
+void champsim::instr_pool::release(handle_type handle)
+{
+  assert(storage.at(handle).has_value());
+  storage[handle].reset();
+  free_list.push_back(handle);
+}
+
+ooo_model_instr& champsim::instr_pool::operator[](handle_type handle) { return *storage[handle]; }
+
+const ooo_model_instr& champsim::instr_pool::operator[](handle_type handle) const { return *storage[handle]; }
+
+std::size_t champsim::instr_pool::size() const { return std::size(storage) - std::size(free_list); }
+
+std::size_t champsim::instr_pool::capacity() const { return std::size(storage); }
+
+// The ring is a power of two in size, so that positions wrap with a mask
+champsim::instr_queue::instr_queue(instr_pool& instrs, std::size_t capacity) : pool(&instrs), ring(champsim::next_pow2(std::max<std::size_t>(capacity, 1))) {}
+
+std::size_t champsim::instr_queue::slot(size_type pos) const { return (head + pos) & (std::size(ring) - 1); }
+
+void champsim::instr_queue::grow()
+{
+  std::vector<handle_type> new_ring(2 * std::size(ring));
+  for (size_type pos = 0; pos < count; ++pos) {
+    new_ring[pos] = ring[slot(pos)];
+  }
+  ring = std::move(new_ring);
+  head = 0;
+}
+
+void champsim::instr_queue::count_in(handle_type handle)
+{
+  const auto thread = std::as_const(*pool)[handle].thread;
+  if (thread >= std::size(thread_counts)) {
+    thread_counts.resize(thread + 1, 0);
+  }
+  ++thread_counts[thread];
+}
+
+void champsim::instr_queue::count_out(handle_type handle)
+{
+  const auto thread = std::as_const(*pool)[handle].thread;
+  assert(thread < std::size(thread_counts) && thread_counts[thread] > 0);
+  --thread_counts[thread];
+}
+
+void champsim::instr_queue::push_back_handle(handle_type handle)
+{
+  if (count == std::size(ring)) {
+    grow();
+  }
+  ring[slot(count)] = handle;
+  ++count;
+  count_in(handle);
+}
+
+auto champsim::instr_queue::pop_front_handle() -> handle_type
+{
+  assert(count > 0);
+  auto handle = ring[head];
+  head = slot(1);
+  --count;
+  count_out(handle);
+  return handle;
+}
+
+void champsim::instr_queue::push_back(value_type instr) { push_back_handle(pool->allocate(std::move(instr))); }
+
+void champsim::instr_queue::pop_front() { pool->release(pop_front_handle()); }
+
+auto champsim::instr_queue::erase(const_iterator first, const_iterator last) -> iterator
+{
+  assert(first == cbegin()); // Instructions may only be removed from the front
+  for (auto n = std::distance(first, last); n > 0; --n) {
+    pop_front();
+  }
+  return begin();
+}
+
+auto champsim::instr_queue::operator[](size_type pos) -> reference { return (*pool)[ring[slot(pos)]]; }
+
+auto champsim::instr_queue::operator[](size_type pos) const -> const_reference { return std::as_const(*pool)[ring[slot(pos)]]; }
+
+auto champsim::instr_queue::at(size_type pos) -> reference
+{
+  if (pos >= count) {
+    throw std::out_of_range{"instr_queue::at"};
+  }
+  return (*this)[pos];
+}
+
+auto champsim::instr_queue::at(size_type pos) const -> const_reference
+{
+  if (pos >= count) {
+    throw std::out_of_range{"instr_queue::at"};
+  }
+  return (*this)[pos];
+}
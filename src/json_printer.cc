@@ -37,6 +37,57 @@ void to_json(nlohmann::json& j, const O3_CPU::stats_type& stats)
                      {"cycles", stats.cycles()},
                      {"Avg ROB occupancy at mispredict", std::ceil(stats.total_rob_occupancy_at_branch_mispredict) / std::ceil(total_mispredictions)},
                      {"mispredict", mpki}};
+
+  if (std::size(stats.thread_end_instrs) > 1) {
+    std::vector<nlohmann::json> threads{};
+    for (std::size_t thread = 0; thread < std::size(stats.thread_end_instrs); ++thread) {
+      threads.push_back(nlohmann::json{{"instructions", stats.thread_instrs(thread)}});
+    }
+    j["threads"] = threads;
+  }
+
+  if (stats.store_buffer_stores > 0) {
+    j["store buffer"] = nlohmann::json{{"stores", stats.store_buffer_stores},
+                                       {"coalesced", stats.store_buffer_coalesced},
+                                       {"writes", stats.store_buffer_writes},
+                                       {"full stalls", stats.store_buffer_full_stalls},
+                                       {"forwards", stats.store_buffer_forwards}};
+  }
+
+  if (stats.wrong_path_episodes > 0) {
+    j["wrong path"] = nlohmann::json{{"episodes", stats.wrong_path_episodes}, {"fetches", stats.wrong_path_fetches}, {"loads", stats.wrong_path_loads}};
+  }
+
+  if (auto ports = stats.port_issues.get_keys(); !std::empty(ports)) {
+    std::vector<long> issues{};
+    std::transform(std::begin(ports), std::end(ports), std::back_inserter(issues), [&stats](auto port) { return stats.port_issues.at(port); });
+
+    std::map<std::string, long> contention{};
+    for (std::size_t op = 0; op < std::size(op_class_names); ++op) {
+      contention.emplace(op_class_names.at(op), stats.port_contention.value_or(static_cast<op_class>(op), 0));
+    }
+    j["execution ports"] = nlohmann::json{{"issues", issues}, {"contention", contention}};
+  }
+
+  if (stats.ftq_occupancy > 0 || stats.fdip_prefetches > 0) {
+    j["ftq"] = nlohmann::json{{"occupancy", stats.ftq_occupancy},
+                              {"prefetches", stats.fdip_prefetches},
+                              {"lead cycles", stats.fdip_lead_cycles},
+                              {"unprefetched", stats.fdip_unprefetched}};
+  }
+
+  if (stats.dependence_predicted_waits > 0 || stats.dependence_false_waits > 0 || stats.dependence_violations > 0) {
+    j["memory dependence"] = nlohmann::json{
+        {"predicted waits", stats.dependence_predicted_waits}, {"false waits", stats.dependence_false_waits}, {"violations", stats.dependence_violations}};
+  }
+
+  if (stats.value_predictions > 0) {
+    j["value prediction"] = nlohmann::json{{"predictions", stats.value_predictions}, {"mispredictions", stats.value_mispredictions}};
+  }
+
+  if (stats.address_predictions > 0) {
+    j["address prediction"] = nlohmann::json{{"predictions", stats.address_predictions}, {"mispredictions", stats.address_mispredictions}};
+  }
 }
 
 void to_json(nlohmann::json& j, const CACHE::stats_type& stats)
@@ -71,6 +122,59 @@ void to_json(nlohmann::json& j, const CACHE::stats_type& stats)
     statsmap.emplace(access_type_names.at(champsim::to_underlying(type)), nlohmann::json{{"hit", hits}, {"miss", misses}, {"mshr_merge", mshr_merges}});
   }
 
+  if (stats.banks > 1) {
+    statsmap.emplace("bank conflict stalls", stats.bank_conflict_stalls);
+  }
+
+  if (stats.sectors_per_tag > 1) {
+    std::map<std::string, std::vector<misses_value_type>> sector_misses;
+    for (const auto type : {access_type::LOAD, access_type::RFO, access_type::PREFETCH, access_type::WRITE, access_type::TRANSLATION}) {
+      auto& type_misses = sector_misses[std::string{access_type_names.at(champsim::to_underlying(type))}];
+      for (std::size_t cpu = 0; cpu < NUM_CPUS; ++cpu) {
+        type_misses.push_back(stats.sector_misses.value_or(std::pair{type, cpu}, misses_value_type{}));
+      }
+    }
+
+    statsmap.emplace("sectors", nlohmann::json{{"sectors per tag", stats.sectors_per_tag}, {"sector miss", sector_misses}, {"writebacks", stats.sector_writebacks}});
+  }
+
+  if (stats.has_directory || stats.coherence_upgrades > 0 || stats.probes_received > 0) {
+    statsmap.emplace("coherence", nlohmann::json{{"upgrades", stats.coherence_upgrades},
+                                                 {"probes", stats.probes_received},
+                                                 {"probe writebacks", stats.probe_writebacks},
+                                                 {"invalidations sent", stats.invalidations_sent},
+                                                 {"downgrades sent", stats.downgrades_sent},
+                                                 {"coherence miss", stats.coherence_misses}});
+  }
+
+  if (stats.back_invalidations > 0 || stats.inclusion_victims > 0) {
+    statsmap.emplace("inclusion", nlohmann::json{{"back-invalidations", stats.back_invalidations}, {"inclusion victims", stats.inclusion_victims}});
+  }
+
+  if (!std::empty(stats.partition_ways)) {
+    statsmap.emplace("partition",
+                     nlohmann::json{{"ways", stats.partition_ways}, {"occupancy", stats.partition_occupancy}, {"repartitions", stats.repartitions}});
+  }
+
+  if (stats.victim_buffer_entries > 0) {
+    statsmap.emplace("victim buffer", nlohmann::json{{"entries", stats.victim_buffer_entries},
+                                                     {"hit", stats.victim_buffer_hits},
+                                                     {"insert", stats.victim_buffer_inserts},
+                                                     {"displaced", stats.victim_buffer_displaced}});
+  }
+
+  if (stats.is_set_sampled()) {
+    statsmap.emplace("set sampling", nlohmann::json{{"sampled sets", stats.sampled_sets},
+                                                    {"total sets", stats.total_sets},
+                                                    {"sampled hit", stats.sampled_hits},
+                                                    {"sampled miss", stats.sampled_misses},
+                                                    {"oracle hit", stats.oracle_hits},
+                                                    {"oracle miss", stats.oracle_misses},
+                                                    {"scale", stats.sampling_scale()},
+                                                    {"miss ratio", stats.sampled_miss_ratio()},
+                                                    {"miss ratio confidence", stats.sampled_miss_ratio_confidence()}});
+  }
+
   j = statsmap;
 }
 
@@ -103,6 +207,9 @@ void to_json(nlohmann::json& j, const champsim::phase_stats stats)
   }
 
   std::map<std::string, nlohmann::json> statsmap{{"name", stats.name}, {"traces", stats.trace_names}};
+  if (!std::empty(stats.warmup_instructions)) {
+    statsmap.emplace("warmup_instructions", stats.warmup_instructions);
+  }
   statsmap.emplace("roi", roi_stats);
   statsmap.emplace("sim", sim_stats);
   j = statsmap;
@@ -29,8 +29,10 @@
 #endif
 #include "defaults.hpp"
 #include "environment.h"
+#include "modules.h" // for current_run
 #include "ooo_cpu.h" // for O3_CPU
 #include "phase_info.h"
+#include "pipeline_trace.h"
 #include "stats_printer.h"
 #include "tracereader.h"
 #include "vmem.h"
@@ -38,6 +40,7 @@
 namespace champsim
 {
 std::vector<phase_stats> main(environment& env, std::vector<phase_info>& phases, std::vector<tracereader>& traces);
+std::vector<uint32_t> trace_cpus(environment& env);
 }
 
 #ifndef CHAMPSIM_TEST_BUILD
@@ -59,19 +62,39 @@ int main(int argc, char** argv) // NOLINT(bugprone-exception-escape)
   CLI::App app{"A microarchitecture simulator for research and education"};
 
   bool knob_cloudsuite{false};
+  bool knob_load_values{false};
+  bool knob_functional_warmup{false};
+  std::size_t warmup_threads = 1;
+  champsim::convergence_options convergence{};
   long long warmup_instructions = 0;
   long long simulation_instructions = std::numeric_limits<long long>::max();
   std::string json_file_name;
+  std::string pipeline_trace_name;
+  champsim::pipeline_tracer::options pipeline_trace_opts{};
+  std::size_t pipeline_trace_cpu = 0;
+  std::string module_data_directory{"."};
   std::vector<std::string> trace_names;
 
+  // Each hardware thread of each CPU runs one trace
+  const auto trace_cpus = champsim::trace_cpus(gen_environment);
+
   auto set_heartbeat_callback = [&](auto) {
     for (O3_CPU& cpu : gen_environment.cpu_view()) {
       cpu.show_heartbeat = false;
     }
   };
 
-  app.add_flag("-c,--cloudsuite", knob_cloudsuite, "Read all traces using the cloudsuite format");
+  auto* cloudsuite_option = app.add_flag("-c,--cloudsuite", knob_cloudsuite, "Read all traces using the cloudsuite format");
+  app.add_flag("--load-values", knob_load_values, "Read all traces using the format that records the value of each load and the class of each instruction")->excludes(cloudsuite_option);
   app.add_flag("--hide-heartbeat", set_heartbeat_callback, "Hide the heartbeat output");
+  auto* functional_warmup_option =
+      app.add_flag("--functional-warmup", knob_functional_warmup, "Warm the caches, prefetchers, and branch predictors without timing during the warmup phase");
+  app.add_option("--warmup-threads", warmup_threads, "The number of threads that warm each of the lower levels of cache during a functional warmup");
+  app.add_option("--warmup-window", convergence.window,
+                 "End the warmup once its statistics have settled over windows of this many instructions. The warmup instructions are then its limit.")
+      ->excludes(functional_warmup_option);
+  app.add_option("--warmup-tolerance", convergence.tolerance, "The largest change in a statistic between windows of a settled warmup");
+  app.add_option("--warmup-stable-windows", convergence.stable_windows, "The number of windows in a row over which the statistics of a warmup must settle");
   auto* warmup_instr_option = app.add_option("-w,--warmup-instructions", warmup_instructions, "The number of instructions in the warmup phase");
   auto* deprec_warmup_instr_option =
       app.add_option("--warmup_instructions", warmup_instructions, "[deprecated] use --warmup-instructions instead")->excludes(warmup_instr_option);
@@ -83,7 +106,17 @@ int main(int argc, char** argv) // NOLINT(bugprone-exception-escape)
   auto* json_option =
       app.add_option("--json", json_file_name, "The name of the file to receive JSON output. If no name is specified, stdout will be used")->expected(0, 1);
 
-  app.add_option("traces", trace_names, "The paths to the traces")->required()->expected(NUM_CPUS)->check(CLI::ExistingFile);
+  auto* pipeline_trace_option =
+      app.add_option("--pipeline-trace", pipeline_trace_name, "The name of a file to receive a gzipped trace of the pipeline, in the O3PipeView format");
+  app.add_option("--pipeline-trace-begin", pipeline_trace_opts.begin, "The first instruction ID to trace through the pipeline");
+  app.add_option("--pipeline-trace-end", pipeline_trace_opts.end, "One past the last instruction ID to trace through the pipeline");
+  app.add_option("--pipeline-trace-every", pipeline_trace_opts.period, "Trace one in every this many instructions through the pipeline");
+  app.add_option("--pipeline-trace-cpu", pipeline_trace_cpu, "The CPU whose pipeline is traced");
+
+  app.add_option("--module-dir", module_data_directory,
+                 "The directory in which modules keep files between runs, such as the recordings of the opt replacement policy");
+
+  app.add_option("traces", trace_names, "The paths to the traces")->required()->expected(static_cast<int>(std::size(trace_cpus)))->check(CLI::ExistingFile);
 
   CLI11_PARSE(app, argc, argv);
 
@@ -104,10 +137,14 @@ int main(int argc, char** argv) // NOLINT(bugprone-exception-escape)
     warmup_instructions = simulation_instructions / 5;
   }
 
+  champsim::modules::current_run() = champsim::modules::run_description{trace_names, warmup_instructions, simulation_instructions, module_data_directory};
+
   std::vector<champsim::tracereader> traces;
   std::transform(
       std::begin(trace_names), std::end(trace_names), std::back_inserter(traces),
-      [knob_cloudsuite, repeat = simulation_given, i = uint8_t(0)](auto name) mutable { return get_tracereader(name, i++, knob_cloudsuite, repeat); });
+      [knob_cloudsuite, knob_load_values, repeat = simulation_given, cpu = std::cbegin(trace_cpus)](auto name) mutable {
+        return get_tracereader(name, static_cast<uint8_t>(*cpu++), knob_cloudsuite, knob_load_values, repeat);
+      });
 
   std::vector<champsim::phase_info> phases{
       {champsim::phase_info{"Warmup", true, warmup_instructions, std::vector<std::size_t>(std::size(trace_names), 0), trace_names},
@@ -117,6 +154,22 @@ int main(int argc, char** argv) // NOLINT(bugprone-exception-escape)
     std::iota(std::begin(p.trace_index), std::end(p.trace_index), 0);
   }
 
+  if (pipeline_trace_option->count() > 0) {
+    if (pipeline_trace_opts.period == 0) {
+      fmt::print("ERROR: option --pipeline-trace-every must be at least 1.\n");
+      return 1;
+    }
+    if (pipeline_trace_cpu >= std::size(gen_environment.cpu_view())) {
+      fmt::print("ERROR: option --pipeline-trace-cpu must be less than the number of CPUs, {}.\n", std::size(gen_environment.cpu_view()));
+      return 1;
+    }
+    O3_CPU& traced_cpu = gen_environment.cpu_view().at(pipeline_trace_cpu);
+    traced_cpu.pipeline_trace = std::make_unique<champsim::pipeline_tracer>(pipeline_trace_name, pipeline_trace_opts);
+  }
+  phases.at(0).is_functional = knob_functional_warmup;
+  phases.at(0).functional_threads = std::max(warmup_threads, std::size_t{1});
+  phases.at(0).convergence = convergence;
+
   fmt::print("\n*** ChampSim Multicore Out-of-Order Simulator ***\nWarmup Instructions: {}\nSimulation Instructions: {}\nNumber of CPUs: {}\nPage size: {}\n\n",
              phases.at(0).length, phases.at(1).length, std::size(gen_environment.cpu_view()), PAGE_SIZE);
 
@@ -124,6 +177,15 @@ int main(int argc, char** argv) // NOLINT(bugprone-exception-escape)
 
   fmt::print("\nChampSim completed all CPUs\n\n");
 
+  // Finish writing the pipeline trace
+  for (O3_CPU& cpu : gen_environment.cpu_view()) {
+    if (cpu.pipeline_trace && cpu.pipeline_trace->dropped() > 0) {
+      fmt::print("WARNING: {} instructions were not traced through the pipeline of CPU {}, since too many were in flight\n", cpu.pipeline_trace->dropped(),
+                 cpu.cpu);
+    }
+    cpu.pipeline_trace.reset();
+  }
+
   champsim::plain_printer{std::cout}.print(phase_stats);
 
   for (CACHE& cache : gen_environment.cache_view()) {
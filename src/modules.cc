@@ -18,6 +18,12 @@
 
 #include "cache.h"
 
+auto champsim::modules::current_run() -> run_description&
+{
+  static run_description description{};
+  return description;
+}
+
 bool champsim::modules::prefetcher::prefetch_line(champsim::address pf_addr, bool fill_this_level, uint32_t prefetch_metadata) const
 {
   return intern_->prefetch_line(pf_addr, fill_this_level, prefetch_metadata);
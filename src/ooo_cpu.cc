@@ -28,6 +28,7 @@
 #include "champsim.h"
 #include "deadlock.h"
 #include "instruction.h"
+#include "ooo_cpu_dispatch.h"
 #include "util/span.h"
 
 std::chrono::seconds elapsed_time();
@@ -43,6 +44,7 @@ long O3_CPU::operate()
   progress += schedule_instruction();          // schedule instructions
   progress += handle_memory_return();          // finalize memory transactions
   progress += operate_lsq();                   // execute memory transactions
+  progress += drain_store_buffer();            // write combined stores
 
   progress += dispatch_instruction(); // dispatch
   progress += decode_instruction();   // decode
@@ -51,6 +53,8 @@ long O3_CPU::operate()
   progress += fetch_instruction(); // fetch
   progress += check_dib();
   initialize_instruction();
+  progress += predict_fetch_targets(); // branch prediction, ahead of fetch
+  progress += prefetch_fetch_targets();
 
   // heartbeat
   if (show_heartbeat && (num_retired >= (last_heartbeat_instr + STAT_PRINTING_PERIOD))) {
@@ -76,6 +80,8 @@ void O3_CPU::initialize()
   // BRANCH PREDICTOR & BTB
   impl_initialize_branch_predictor();
   impl_initialize_btb();
+  impl_initialize_dependence_predictor();
+  impl_initialize_value_predictor();
 }
 
 void O3_CPU::begin_phase()
@@ -88,6 +94,9 @@ void O3_CPU::begin_phase()
   stats.name = "CPU " + std::to_string(cpu);
   stats.begin_instrs = num_retired;
   stats.begin_cycles = begin_phase_time.time_since_epoch() / clock_period;
+  if (NUM_THREADS > 1) {
+    std::transform(std::begin(threads), std::end(threads), std::back_inserter(stats.thread_begin_instrs), [](const auto& x) { return x.num_retired; });
+  }
   sim_stats = stats;
 }
 
@@ -96,6 +105,10 @@ void O3_CPU::end_phase(unsigned finished_cpu)
   // Record where the phase ended (overwrite if this is later)
   sim_stats.end_instrs = num_retired;
   sim_stats.end_cycles = current_time.time_since_epoch() / clock_period;
+  sim_stats.thread_end_instrs.clear();
+  if (NUM_THREADS > 1) {
+    std::transform(std::begin(threads), std::end(threads), std::back_inserter(sim_stats.thread_end_instrs), [](const auto& x) { return x.num_retired; });
+  }
 
   if (finished_cpu == this->cpu) {
     finish_phase_instr = num_retired;
@@ -105,23 +118,188 @@ void O3_CPU::end_phase(unsigned finished_cpu)
   }
 }
 
+ooo_model_instr O3_CPU::assign_to_thread(std::size_t thread, ooo_model_instr instr) const
+{
+  instr.thread = thread;
+  if (thread == 0) {
+    return instr;
+  }
+
+  auto move_address = [tag = uint64_t{thread} << THREAD_ADDRESS_SHIFT](champsim::address addr) {
+    return champsim::address{addr.to<uint64_t>() ^ tag};
+  };
+  instr.ip = move_address(instr.ip);
+  instr.branch_target = move_address(instr.branch_target);
+  std::transform(std::begin(instr.source_memory), std::end(instr.source_memory), std::begin(instr.source_memory), move_address);
+  std::transform(std::begin(instr.destination_memory), std::end(instr.destination_memory), std::begin(instr.destination_memory), move_address);
+  return instr;
+}
+
+std::optional<std::size_t> O3_CPU::select_fetch_thread() const
+{
+  auto can_fetch = [time = current_time](const thread_type& x) {
+    return time >= x.fetch_resume_time && !std::empty(x.input_queue);
+  };
+
+  // ICOUNT counts the instructions of each thread in the front end, and in the ROB that have not executed
+  std::vector<long> icount(NUM_THREADS);
+  if (FETCH_POLICY == champsim::thread_fetch_policy::icount && NUM_THREADS > 1) {
+    for (std::size_t thread = 0; thread < NUM_THREADS; ++thread) {
+      const auto in_flight = IFETCH_BUFFER.count_of(thread) + DECODE_BUFFER.count_of(thread) + DIB_HIT_BUFFER.count_of(thread)
+                             + DISPATCH_BUFFER.count_of(thread) + ROB.count_of(thread);
+      icount.at(thread) = static_cast<long>(in_flight) - threads.at(thread).executed_in_rob;
+    }
+  }
+
+  // The threads are considered in turn, beginning after the last to fetch, so that ties are broken round robin
+  std::optional<std::size_t> selected;
+  for (std::size_t i = 1; i <= NUM_THREADS; ++i) {
+    auto thread = (last_fetch_thread + i) % NUM_THREADS;
+    if (can_fetch(threads.at(thread)) && (!selected.has_value() || icount.at(thread) < icount.at(selected.value()))) {
+      selected = thread;
+    }
+  }
+  return selected;
+}
+
 void O3_CPU::initialize_instruction()
 {
+  if (FTQ_SIZE > 0) {
+    initialize_from_ftq();
+    return;
+  }
+
+  // Each cycle, one thread fetches
+  auto thread = select_fetch_thread();
+  if (!thread.has_value()) {
+    return;
+  }
+  last_fetch_thread = thread.value();
+  auto& input_queue = threads.at(thread.value()).input_queue;
+
   champsim::bandwidth instrs_to_read_this_cycle{
       std::min(FETCH_WIDTH, champsim::bandwidth::maximum_type{static_cast<long>(IFETCH_BUFFER_SIZE - std::size(IFETCH_BUFFER))})};
 
   bool stop_fetch = false;
-  while (current_time >= fetch_resume_time && instrs_to_read_this_cycle.has_remaining() && !stop_fetch && !std::empty(input_queue)) {
+  while (instrs_to_read_this_cycle.has_remaining() && !stop_fetch && !std::empty(input_queue)) {
     instrs_to_read_this_cycle.consume();
 
+    if (NUM_THREADS > 1) {
+      input_queue.front().instr_id = next_instr_id++;
+    }
     stop_fetch = do_init_instruction(input_queue.front());
 
     // Add to IFETCH_BUFFER
-    IFETCH_BUFFER.push_back(input_queue.front());
+    IFETCH_BUFFER.push_back(std::move(input_queue.front()));
     input_queue.pop_front();
 
     IFETCH_BUFFER.back().ready_time = current_time;
+    trace_pipeline(champsim::pipeline_tracer::stage::fetch, IFETCH_BUFFER.back());
+  }
+}
+
+void O3_CPU::initialize_from_ftq()
+{
+  champsim::bandwidth instrs_to_read_this_cycle{
+      std::min(FETCH_WIDTH, champsim::bandwidth::maximum_type{static_cast<long>(IFETCH_BUFFER_SIZE - std::size(IFETCH_BUFFER))})};
+
+  // The branches have already been predicted, so fetch continues past a misprediction up to the mispredicted branch
+  bool stop_fetch = false;
+  while (instrs_to_read_this_cycle.has_remaining() && !stop_fetch && !std::empty(FTQ) && FTQ.front().instrs > 0) {
+    instrs_to_read_this_cycle.consume();
+    auto& entry = FTQ.front();
+
+    if (!entry.fetch_begun && entry.needs_prefetch) {
+      if (entry.prefetch_time.has_value()) {
+        sim_stats.fdip_lead_cycles += static_cast<uint64_t>((current_time - entry.prefetch_time.value()) / clock_period);
+      } else {
+        ++sim_stats.fdip_unprefetched;
+      }
+    }
+    entry.fetch_begun = true;
+
+    auto& input_queue = threads.front().input_queue;
+    IFETCH_BUFFER.push_back(std::move(input_queue.front()));
+    input_queue.pop_front();
+    IFETCH_BUFFER.back().ready_time = current_time;
+    trace_pipeline(champsim::pipeline_tracer::stage::fetch, IFETCH_BUFFER.back());
+    --entry.instrs;
+    --ftq_predicted_instrs;
+
+    // The last entry may still be extended by the branch predictor
+    if (entry.instrs == 0 && (entry.ends_taken || std::size(FTQ) > 1)) {
+      stop_fetch = entry.ends_taken;
+      FTQ.pop_front();
+    }
+  }
+}
+
+long O3_CPU::predict_fetch_targets()
+{
+  if (FTQ_SIZE == 0) {
+    return 0;
+  }
+
+  sim_stats.ftq_occupancy += std::size(FTQ);
+
+  // A core with a fetch target queue has only one thread
+  auto& input_queue = threads.front().input_queue;
+  const auto fetch_resume_time = threads.front().fetch_resume_time;
+
+  champsim::bandwidth predict_bw{FETCH_WIDTH};
+  bool stop_predict = false;
+  while (current_time >= fetch_resume_time && predict_bw.has_remaining() && !stop_predict && ftq_predicted_instrs < std::size(input_queue)) {
+    auto& arch_instr = input_queue.at(ftq_predicted_instrs);
+    champsim::block_number block{arch_instr.ip};
+
+    // Begin a new fetch block after a taken branch, or when the instructions cross into another block
+    if (std::empty(FTQ) || FTQ.back().ends_taken || FTQ.back().block != block) {
+      if (std::size(FTQ) >= FTQ_SIZE) {
+        break;
+      }
+      ftq_entry_type entry;
+      entry.block = block;
+      entry.needs_prefetch = std::empty(FTQ) || FTQ.back().block != block;
+      FTQ.push_back(entry);
+    }
+
+    predict_bw.consume();
+    stop_predict = do_init_instruction(arch_instr);
+    ++FTQ.back().instrs;
+    ++ftq_predicted_instrs;
+    FTQ.back().ends_taken = stop_predict;
+  }
+
+  return predict_bw.amount_consumed();
+}
+
+long O3_CPU::prefetch_fetch_targets()
+{
+  if (FTQ_SIZE == 0) {
+    return 0;
+  }
+
+  auto needs_prefetch = [](const ftq_entry_type& entry) {
+    return entry.needs_prefetch && !entry.prefetch_time.has_value();
+  };
+
+  champsim::bandwidth prefetch_bw{L1I_BANDWIDTH};
+  for (auto entry = std::find_if(std::begin(FTQ), std::end(FTQ), needs_prefetch); prefetch_bw.has_remaining() && entry != std::end(FTQ);
+       entry = std::find_if(std::next(entry), std::end(FTQ), needs_prefetch)) {
+    if (!l1i->prefetch_line(champsim::address{entry->block}, true, 0)) {
+      break;
+    }
+
+    if constexpr (champsim::debug_print) {
+      fmt::print("[FTQ] {} block: {} cycle: {}\n", __func__, entry->block, current_time.time_since_epoch() / clock_period);
+    }
+
+    entry->prefetch_time = current_time;
+    ++sim_stats.fdip_prefetches;
+    prefetch_bw.consume();
   }
+
+  return prefetch_bw.amount_consumed();
 }
 
 namespace
@@ -145,48 +323,14 @@ void do_stack_pointer_folding(ooo_model_instr& arch_instr)
     }
   }
 }
-} // namespace
 
-bool O3_CPU::do_predict_branch(ooo_model_instr& arch_instr)
+void insert_in_program_order(std::vector<ooo_model_instr*>& list, ooo_model_instr* instr)
 {
-  bool stop_fetch = false;
-
-  // handle branch prediction for all instructions as at this point we do not know if the instruction is a branch
-  sim_stats.total_branch_types.increment(arch_instr.branch);
-  auto [predicted_branch_target, always_taken] = impl_btb_prediction(arch_instr.ip, arch_instr.branch);
-  arch_instr.branch_prediction = impl_predict_branch(arch_instr.ip, predicted_branch_target, always_taken, arch_instr.branch) || always_taken;
-  if (!arch_instr.branch_prediction) {
-    predicted_branch_target = champsim::address{};
-  }
-
-  if (arch_instr.is_branch) {
-    if constexpr (champsim::debug_print) {
-      fmt::print("[BRANCH] instr_id: {} ip: {} taken: {}\n", arch_instr.instr_id, arch_instr.ip, arch_instr.branch_taken);
-    }
-
-    // call code prefetcher every time the branch predictor is used
-    l1i->impl_prefetcher_branch_operate(arch_instr.ip, arch_instr.branch, predicted_branch_target);
-
-    if (predicted_branch_target != arch_instr.branch_target
-        || (((arch_instr.branch == BRANCH_CONDITIONAL) || (arch_instr.branch == BRANCH_OTHER))
-            && arch_instr.branch_taken != arch_instr.branch_prediction)) { // conditional branches are re-evaluated at decode when the target is computed
-      sim_stats.total_rob_occupancy_at_branch_mispredict += std::size(ROB);
-      sim_stats.branch_type_misses.increment(arch_instr.branch);
-      if (!warmup) {
-        fetch_resume_time = champsim::chrono::clock::time_point::max();
-        stop_fetch = true;
-        arch_instr.branch_mispredicted = true;
-      }
-    } else {
-      stop_fetch = arch_instr.branch_taken; // if correctly predicted taken, then we can't fetch anymore instructions this cycle
-    }
-
-    impl_update_btb(arch_instr.ip, arch_instr.branch_target, arch_instr.branch_taken, arch_instr.branch);
-    impl_last_branch_result(arch_instr.ip, arch_instr.branch_target, arch_instr.branch_taken, arch_instr.branch);
-  }
-
-  return stop_fetch;
+  auto pos = std::upper_bound(std::begin(list), std::end(list), instr,
+                              [](const ooo_model_instr* lhs, const ooo_model_instr* rhs) { return ooo_model_instr::program_order(*lhs, *rhs); });
+  list.insert(pos, instr);
 }
+} // namespace
 
 bool O3_CPU::do_init_instruction(ooo_model_instr& arch_instr)
 {
@@ -196,8 +340,13 @@ bool O3_CPU::do_init_instruction(ooo_model_instr& arch_instr)
     arch_instr.destination_registers.clear();
   }
 
+  // The class that the trace records for an instruction matters only to the execution ports
+  if (std::empty(execution_ports) && (arch_instr.op == OP_FP || arch_instr.op == OP_SLOW_ALU)) {
+    arch_instr.op = OP_ALU;
+  }
+
   ::do_stack_pointer_folding(arch_instr);
-  return do_predict_branch(arch_instr);
+  return (this->*bound_predict_branch)(arch_instr);
 }
 
 long O3_CPU::check_dib()
@@ -216,6 +365,7 @@ void O3_CPU::do_check_dib(ooo_model_instr& instr)
   if (dib_result) {
     // The cache line is in the L0, so we can mark this as complete
     instr.fetch_completed = true;
+    trace_pipeline(champsim::pipeline_tracer::stage::fetch_complete, instr);
 
     // Also mark it as decoded
     instr.decoded = true;
@@ -246,8 +396,9 @@ long O3_CPU::fetch_instruction()
     return champsim::block_number{lhs.ip} != champsim::block_number{rhs.ip};
   };
 
+  champsim::bandwidth l1i_bw{L1I_BANDWIDTH};
   auto l1i_req_begin = std::find_if(std::begin(IFETCH_BUFFER), std::end(IFETCH_BUFFER), fetch_ready);
-  for (champsim::bandwidth l1i_bw{L1I_BANDWIDTH}; l1i_bw.has_remaining() && l1i_req_begin != std::end(IFETCH_BUFFER); l1i_bw.consume()) {
+  for (; l1i_bw.has_remaining() && l1i_req_begin != std::end(IFETCH_BUFFER); l1i_bw.consume()) {
     auto l1i_req_end = std::adjacent_find(l1i_req_begin, std::end(IFETCH_BUFFER), no_match_ip);
     if (l1i_req_end != std::end(IFETCH_BUFFER)) {
       l1i_req_end = std::next(l1i_req_end); // adjacent_find returns the first of the non-equal elements
@@ -256,17 +407,120 @@ long O3_CPU::fetch_instruction()
     // Issue to L1I
     auto success = do_fetch_instruction(l1i_req_begin, l1i_req_end);
     if (success) {
-      std::for_each(l1i_req_begin, l1i_req_end, [](auto& x) { x.fetch_issued = true; });
+      std::for_each(l1i_req_begin, l1i_req_end, [this](auto& x) {
+        x.fetch_issued = true;
+        this->trace_pipeline(champsim::pipeline_tracer::stage::fetch_issue, x);
+      });
       ++progress;
     }
 
     l1i_req_begin = std::find_if(l1i_req_end, std::end(IFETCH_BUFFER), fetch_ready);
   }
 
+  // The remaining bandwidth fetches down the wrong path
+  progress += fetch_wrong_path(l1i_bw);
+
+  return progress;
+}
+
+long O3_CPU::fetch_wrong_path(champsim::bandwidth& l1i_bw)
+{
+  long progress{0};
+  for (; wrong_path.has_value() && wrong_path->remaining_blocks > 0 && l1i_bw.has_remaining(); l1i_bw.consume()) {
+    CacheBus::request_type fetch_packet;
+    fetch_packet.v_address = champsim::address{wrong_path->next_block};
+    fetch_packet.ip = fetch_packet.v_address;
+    fetch_packet.response_requested = false; // No instruction waits for a block on the wrong path
+
+    if constexpr (champsim::debug_print) {
+      fmt::print("[IFETCH] {} address: {} remaining: {}\n", __func__, fetch_packet.v_address, wrong_path->remaining_blocks);
+    }
+
+    if (!L1I_bus.issue_read(fetch_packet)) {
+      break;
+    }
+
+    ++sim_stats.wrong_path_fetches;
+    ++progress;
+    if (WRONG_PATH_LOADS) {
+      do_wrong_path_loads(wrong_path->next_block);
+    }
+
+    ++wrong_path->next_block;
+    --wrong_path->remaining_blocks;
+  }
+
   return progress;
 }
 
-bool O3_CPU::do_fetch_instruction(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end)
+void O3_CPU::do_begin_wrong_path(const ooo_model_instr& branch, champsim::address predicted_target)
+{
+  if (WRONG_PATH_DEPTH == 0) {
+    return;
+  }
+
+  // The wrong path begins at the predicted target, or after the branch if it was predicted not taken
+  auto next_block = (predicted_target != champsim::address{}) ? champsim::block_number{predicted_target} : champsim::block_number{branch.ip} + 1;
+  wrong_path = wrong_path_type{next_block, WRONG_PATH_DEPTH};
+  ++sim_stats.wrong_path_episodes;
+}
+
+void O3_CPU::do_squash_wrong_path()
+{
+  if constexpr (champsim::debug_print) {
+    if (wrong_path.has_value()) {
+      fmt::print("[IFETCH] {} unfetched: {}\n", __func__, wrong_path->remaining_blocks);
+    }
+  }
+
+  wrong_path.reset();
+}
+
+void O3_CPU::do_record_wrong_path_loads(const ooo_model_instr& instr)
+{
+  if (std::empty(instr.source_memory)) {
+    return;
+  }
+
+  wrong_path_load_entry entry{champsim::block_number{instr.ip}, {}};
+  entry = wrong_path_load_table.check_hit(entry).value_or(entry);
+  for (auto smem : instr.source_memory) {
+    // Move the load to the front, displacing the least recent
+    auto found = std::find_if(std::begin(entry.loads), std::end(entry.loads), [ip = instr.ip, smem](const auto& x) { return x.ip == ip && x.address == smem; });
+    if (found == std::end(entry.loads)) {
+      found = std::prev(std::end(entry.loads));
+    }
+    std::rotate(std::begin(entry.loads), found, std::next(found));
+    entry.loads.front() = wrong_path_load{instr.ip, smem};
+  }
+  wrong_path_load_table.fill(entry);
+}
+
+void O3_CPU::do_wrong_path_loads(champsim::block_number code_block)
+{
+  auto entry = wrong_path_load_table.check_hit(wrong_path_load_entry{code_block, {}});
+  if (!entry.has_value()) {
+    return;
+  }
+
+  for (auto load : entry->loads) {
+    if (load.address == champsim::address{}) {
+      continue;
+    }
+
+    // The load is replayed from its own IP, so that the prefetchers that are trained by IP see it as it was seen
+    CacheBus::request_type data_packet;
+    data_packet.v_address = load.address;
+    data_packet.ip = load.ip;
+    data_packet.response_requested = false; // No instruction waits for a load on the wrong path
+
+    if (L1D_bus.issue_read(data_packet)) {
+      ++sim_stats.wrong_path_loads;
+    }
+  }
+}
+
+bool O3_CPU::do_fetch_instruction(champsim::instr_queue::iterator begin, champsim::instr_queue::iterator end)
 {
   CacheBus::request_type fetch_packet;
   fetch_packet.v_address = begin->ip;
@@ -300,7 +554,6 @@ long O3_CPU::promote_to_decode()
   auto fetched_check_end = std::find_if(std::begin(IFETCH_BUFFER), std::end(IFETCH_BUFFER), [](const ooo_model_instr& x) { return !x.fetch_completed; });
   // find the first not fetch completed
   auto [window_begin, window_end] = champsim::get_span_p(std::begin(IFETCH_BUFFER), fetched_check_end, available_fetch_bandwidth, fetch_complete_and_ready);
-  auto decoded_window_end = std::stable_partition(window_begin, window_end, is_decoded); // reorder instructions
   auto mark_for_decode = [time = current_time, lat = DECODE_LATENCY, warmup = warmup](auto& x) {
     return x.ready_time = time + (warmup ? champsim::chrono::clock::duration{} : lat);
   };
@@ -309,15 +562,20 @@ long O3_CPU::promote_to_decode()
     return x.ready_time = time + lat;
   };
 
-  std::for_each(window_begin, decoded_window_end, mark_for_dib); // assume DECODE_LATENCY = DIB_HIT_LATENCY
-  std::move(window_begin, decoded_window_end, std::back_inserter(DIB_HIT_BUFFER));
-  // to DECODE_BUFFER
-
-  std::for_each(decoded_window_end, window_end, mark_for_decode);
-  std::move(decoded_window_end, window_end, std::back_inserter(DECODE_BUFFER));
-
+  // Decoded instructions go to DIB_HIT_BUFFER, and the rest to DECODE_BUFFER, each in order
   long progress{std::distance(window_begin, window_end)};
-  IFETCH_BUFFER.erase(window_begin, window_end);
+  for (long i = 0; i < progress; ++i) {
+    auto handle = IFETCH_BUFFER.pop_front_handle();
+    auto& instr = instr_pool[handle];
+    trace_pipeline(champsim::pipeline_tracer::stage::decode, instr);
+    if (is_decoded(instr)) {
+      mark_for_dib(instr); // assume DECODE_LATENCY = DIB_HIT_LATENCY
+      DIB_HIT_BUFFER.push_back_handle(handle);
+    } else {
+      mark_for_decode(instr);
+      DECODE_BUFFER.push_back_handle(handle);
+    }
+  }
   return progress;
 }
 long O3_CPU::decode_instruction()
@@ -374,7 +632,8 @@ long O3_CPU::decode_instruction()
         // clear the branch_mispredicted bit so we don't attempt to resume fetch again at execute
         db_entry.branch_mispredicted = 0;
         // pay misprediction penalty
-        this->fetch_resume_time = this->current_time + BRANCH_MISPREDICT_PENALTY;
+        this->threads.at(db_entry.thread).fetch_resume_time = this->current_time + BRANCH_MISPREDICT_PENALTY;
+        this->do_squash_wrong_path();
       }
     }
     // Add to dispatch
@@ -394,10 +653,18 @@ long O3_CPU::decode_instruction()
 
   long progress{std::distance(dib_hit_buffer_begin, dib_hit_buffer_end) + std::distance(decode_buffer_begin, decode_buffer_end)};
 
-  std::merge(dib_hit_buffer_begin, dib_hit_buffer_end, decode_buffer_begin, decode_buffer_end, std::back_inserter(DISPATCH_BUFFER),
-             ooo_model_instr::program_order);
-  DECODE_BUFFER.erase(decode_buffer_begin, decode_buffer_end);
-  DIB_HIT_BUFFER.erase(dib_hit_buffer_begin, dib_hit_buffer_end);
+  // Merge the decoded instructions into DISPATCH_BUFFER in program order
+  auto dib_hit_count = std::distance(dib_hit_buffer_begin, dib_hit_buffer_end);
+  auto decode_count = std::distance(decode_buffer_begin, decode_buffer_end);
+  while (dib_hit_count > 0 || decode_count > 0) {
+    if (decode_count > 0 && (dib_hit_count == 0 || ooo_model_instr::program_order(DECODE_BUFFER.front(), DIB_HIT_BUFFER.front()))) {
+      DISPATCH_BUFFER.push_back_handle(DECODE_BUFFER.pop_front_handle());
+      --decode_count;
+    } else {
+      DISPATCH_BUFFER.push_back_handle(DIB_HIT_BUFFER.pop_front_handle());
+      --dib_hit_count;
+    }
+  }
 
   return progress;
 }
@@ -408,17 +675,69 @@ long O3_CPU::dispatch_instruction()
 {
   champsim::bandwidth available_dispatch_bandwidth{DISPATCH_WIDTH};
 
-  // dispatch DISPATCH_WIDTH instructions into the ROB
-  while (available_dispatch_bandwidth.has_remaining() && !std::empty(DISPATCH_BUFFER) && DISPATCH_BUFFER.front().ready_time <= current_time
-         && std::size(ROB) != ROB_SIZE
-         && ((std::size_t)std::count_if(std::begin(LQ), std::end(LQ), [](const auto& lq_entry) { return !lq_entry.has_value(); })
-             >= std::size(DISPATCH_BUFFER.front().source_memory))
-         && ((std::size(DISPATCH_BUFFER.front().destination_memory) + std::size(SQ)) <= SQ_SIZE)) {
-    ROB.push_back(std::move(DISPATCH_BUFFER.front()));
-    DISPATCH_BUFFER.pop_front();
-    do_memory_scheduling(ROB.back());
+  // When the queues are partitioned, each thread may fill only its share of each
+  const bool partitioned = PARTITIONED_QUEUES && NUM_THREADS > 1;
+  std::size_t rob_use = std::size(ROB);
+  std::size_t lq_use = std::size(LQ) - std::size(lq_free_slots);
+  std::size_t sq_use = std::size(SQ);
+  std::vector<std::size_t> thread_rob_use(NUM_THREADS), thread_lq_use(NUM_THREADS), thread_sq_use(NUM_THREADS);
+  for (std::size_t thread = 0; thread < NUM_THREADS; ++thread) {
+    thread_rob_use.at(thread) = ROB.count_of(thread);
+    thread_lq_use.at(thread) = threads.at(thread).lq_occupancy;
+    thread_sq_use.at(thread) = threads.at(thread).sq_occupancy;
+  }
+  auto fits = [&, this](const ooo_model_instr& instr) {
+    const auto loads = std::size(instr.source_memory);
+    const auto stores = std::size(instr.destination_memory);
+    return rob_use < ROB_SIZE && lq_use + loads <= std::size(LQ) && sq_use + stores <= SQ_SIZE
+           && (!partitioned
+               || (thread_rob_use.at(instr.thread) < ROB_SIZE / NUM_THREADS && thread_lq_use.at(instr.thread) + loads <= std::size(LQ) / NUM_THREADS
+                   && thread_sq_use.at(instr.thread) + stores <= SQ_SIZE / NUM_THREADS));
+  };
+
+  // The oldest instructions dispatch first. Each thread dispatches in its own program order, so a thread stops at its first instruction that
+  // cannot dispatch, but the other threads dispatch past it.
+  std::vector<bool> blocked(NUM_THREADS, false);
+  std::size_t threads_blocked = 0;
+  std::vector<const ooo_model_instr*> selected{};
+  bool selected_in_order = true; // The selected instructions are all at the front of the buffer
+  for (auto it = std::cbegin(DISPATCH_BUFFER);
+       it != std::cend(DISPATCH_BUFFER) && available_dispatch_bandwidth.has_remaining() && threads_blocked < NUM_THREADS; ++it) {
+    if (blocked.at(it->thread)) {
+      continue;
+    }
+    if (it->ready_time > current_time || !fits(*it)) {
+      blocked.at(it->thread) = true;
+      ++threads_blocked;
+      continue;
+    }
+
+    ++rob_use;
+    lq_use += std::size(it->source_memory);
+    sq_use += std::size(it->destination_memory);
+    ++thread_rob_use.at(it->thread);
+    thread_lq_use.at(it->thread) += std::size(it->source_memory);
+    thread_sq_use.at(it->thread) += std::size(it->destination_memory);
 
+    selected_in_order = selected_in_order && std::distance(std::cbegin(DISPATCH_BUFFER), it) == available_dispatch_bandwidth.amount_consumed();
+    selected.push_back(&*it);
     available_dispatch_bandwidth.consume();
+  }
+
+  std::vector<champsim::instr_pool::handle_type> handles;
+  if (selected_in_order) {
+    std::generate_n(std::back_inserter(handles), std::size(selected), [this] { return DISPATCH_BUFFER.pop_front_handle(); });
+  } else {
+    handles = DISPATCH_BUFFER.extract_if([&selected](const ooo_model_instr& instr) {
+      return std::find(std::begin(selected), std::end(selected), &instr) != std::end(selected);
+    });
+  }
+
+  // dispatch into the ROB
+  for (auto handle : handles) {
+    ROB.push_back_handle(handle);
+    trace_pipeline(champsim::pipeline_tracer::stage::dispatch, ROB.back());
+    do_memory_scheduling(ROB.back());
     ROB.back().ready_time = current_time + (warmup ? champsim::chrono::clock::duration{} : SCHEDULING_LATENCY);
   }
 
@@ -427,18 +746,47 @@ long O3_CPU::dispatch_instruction()
 
 long O3_CPU::schedule_instruction()
 {
+  // Instructions are scheduled in ROB order, so the search resumes at the first that has not been scheduled.
+  // The scheduled instructions ahead of it hold their place in the scheduler until they execute.
+  scheduled_in_rob = std::min(scheduled_in_rob, std::size(ROB));
+  auto rob_it = std::next(std::begin(ROB), static_cast<long>(scheduled_in_rob));
+  for (; rob_it != std::end(ROB) && rob_it->scheduled; ++rob_it) {
+    ++scheduled_in_rob;
+  }
+
+  const auto executed = std::accumulate(std::begin(threads), std::end(threads), long{0}, [](long acc, const auto& thr) { return acc + thr.executed_in_rob; });
+  const auto waiting = std::max(static_cast<long>(scheduled_in_rob) - executed, long{0});
+
   champsim::bandwidth search_bw{SCHEDULER_SIZE};
+  search_bw.consume(std::min(waiting, search_bw.amount_remaining()));
   int progress{0};
-  for (auto rob_it = std::begin(ROB); rob_it != std::end(ROB) && search_bw.has_remaining(); ++rob_it) {
-    // if there aren't enough physical registers available for the next instruction, stop scheduling
-    unsigned long sources_to_allocate = std::count_if(rob_it->source_registers.begin(), rob_it->source_registers.end(),
-                                                      [&alloc = std::as_const(reg_allocator)](auto srcreg) { return !alloc.isAllocated(srcreg); });
-    if (reg_allocator.count_free_registers() < (sources_to_allocate + rob_it->destination_registers.size())) {
-      break;
-    }
-    if (!rob_it->scheduled && rob_it->ready_time <= current_time) {
-      do_scheduling(*rob_it);
-      ++progress;
+  for (; rob_it != std::end(ROB) && search_bw.has_remaining(); ++rob_it) {
+    const bool resumed = (std::distance(std::begin(ROB), rob_it) == static_cast<long>(scheduled_in_rob));
+    if (!rob_it->scheduled) {
+      // if there aren't enough physical registers available for the next instruction, stop scheduling
+      // The mappings it reads change only when an instruction is renamed, so the requirement of the first is kept until then.
+      auto to_rename = resumed ? registers_to_rename : std::nullopt;
+      if (!to_rename.has_value()) {
+        unsigned long sources_to_allocate = std::count_if(rob_it->source_registers.begin(), rob_it->source_registers.end(),
+                                                          [&alloc = std::as_const(reg_allocator), thread = rob_it->thread](auto srcreg) {
+                                                            return !alloc.isAllocated(srcreg, thread);
+                                                          });
+        to_rename = sources_to_allocate + rob_it->destination_registers.size();
+      }
+      if (reg_allocator.count_free_registers() < to_rename.value()) {
+        if (resumed) {
+          registers_to_rename = to_rename;
+        }
+        break;
+      }
+      if (rob_it->ready_time <= current_time) {
+        do_scheduling(*rob_it);
+        registers_to_rename.reset();
+        if (resumed) {
+          ++scheduled_in_rob;
+        }
+        ++progress;
+      }
     }
 
     if (!rob_it->executed) {
@@ -454,30 +802,161 @@ void O3_CPU::do_scheduling(ooo_model_instr& instr)
   // Mark register dependencies
   for (auto& src_reg : instr.source_registers) {
     // rename source register
-    src_reg = reg_allocator.rename_src_register(src_reg);
+    src_reg = reg_allocator.rename_src_register(src_reg, instr.thread);
   }
 
   for (auto& dreg : instr.destination_registers) {
     // rename destination register
-    dreg = reg_allocator.rename_dest_register(dreg, instr.instr_id);
+    dreg = reg_allocator.rename_dest_register(dreg, instr.instr_id, instr.thread);
+  }
+
+  // Wait for the sources that are not yet valid, or become ready at once
+  instr.num_reg_dependent = 0;
+  for (auto src_reg : instr.source_registers) {
+    if (!reg_allocator.isValid(src_reg)) {
+      register_waiters.at(static_cast<std::size_t>(src_reg)).push_back(&instr);
+      ++instr.num_reg_dependent;
+    }
+  }
+  if (instr.num_reg_dependent == 0) {
+    insert_in_program_order(ready_instrs, &instr);
+  }
+
+  // Only a load whose value the trace records can be checked against a predicted value, but any load can be checked against a predicted address
+  if (VALUE_PREDICTION && !std::empty(instr.source_memory) && !std::empty(instr.destination_registers)) {
+    if (instr.load_value.has_value()) {
+      do_predict_load(instr);
+    }
+    if (!instr.predicted_load.has_value()) {
+      do_predict_load_address(instr);
+    }
   }
 
   instr.scheduled = true;
+  trace_pipeline(champsim::pipeline_tracer::stage::schedule, instr);
+}
+
+void O3_CPU::do_predict_load(ooo_model_instr& instr)
+{
+  instr.predicted_load = impl_predict_load(instr.ip);
+  if (!instr.predicted_load.has_value()) {
+    return;
+  }
+
+  // The consumers of the load proceed with the predicted value, without waiting for the load to complete
+  ++sim_stats.value_predictions;
+  for (auto dreg : instr.destination_registers) {
+    reg_allocator.complete_dest_register(dreg);
+    do_wakeup(dreg);
+  }
+}
+
+void O3_CPU::do_predict_load_address(ooo_model_instr& instr)
+{
+  auto predicted = impl_predict_load_address(instr.ip);
+  if (!predicted.has_value()) {
+    return;
+  }
+
+  // The load issues early to the predicted address, and its consumers wake when that access returns
+  CacheBus::request_type data_packet;
+  data_packet.v_address = predicted.value();
+  data_packet.instr_id = instr.instr_id;
+  data_packet.ip = instr.ip;
+  if (!L1D_bus.issue_read(data_packet)) {
+    return;
+  }
+
+  ++sim_stats.address_predictions;
+  instr.predicted_address = predicted;
+  address_predicted_loads.push_back(&instr);
+}
+
+void O3_CPU::do_verify_load_address(ooo_model_instr& instr)
+{
+  if (!instr.predicted_address.has_value() || instr.predicted_address == instr.source_memory.front()) {
+    return;
+  }
+
+  ++sim_stats.address_mispredictions;
+  instr.predicted_address.reset();
+
+  // If the early access has not returned, no consumer has seen its data
+  auto pending = std::find(std::begin(address_predicted_loads), std::end(address_predicted_loads), &instr);
+  if (pending != std::end(address_predicted_loads)) {
+    address_predicted_loads.erase(pending);
+    return;
+  }
+
+  // The consumers of the load ran with the data at the wrong address, and wait again for the load
+  auto& thread = threads.at(instr.thread);
+  thread.fetch_resume_time = std::max(thread.fetch_resume_time, current_time + REPLAY_PENALTY);
+  for (auto dreg : instr.destination_registers) {
+    reg_allocator.invalidate_dest_register(dreg);
+  }
+  do_replay_consumers(instr, instr.destination_registers);
+
+  if constexpr (champsim::debug_print) {
+    fmt::print("[ROB] {} instr_id: {} address: {}\n", __func__, instr.instr_id, instr.source_memory.front());
+  }
+}
+
+void O3_CPU::do_verify_load(ooo_model_instr& instr)
+{
+  // A load that is replayed completes again, but is checked and reported only once
+  if (instr.load_reported) {
+    return;
+  }
+  instr.load_reported = true;
+
+  if (instr.predicted_load.has_value() && instr.predicted_load != instr.load_value) {
+    // The consumers of the load ran with the wrong value, and execute again with the value that was read
+    ++sim_stats.value_mispredictions;
+    auto& thread = threads.at(instr.thread);
+    thread.fetch_resume_time = std::max(thread.fetch_resume_time, current_time + REPLAY_PENALTY);
+    do_replay_consumers(instr, instr.destination_registers);
+
+    if constexpr (champsim::debug_print) {
+      fmt::print("[ROB] {} instr_id: {} predicted: {:#x} value: {:#x}\n", __func__, instr.instr_id, instr.predicted_load.value(), instr.load_value.value());
+    }
+  }
+
+  impl_last_load_result(instr.ip, instr.source_memory.front(), instr.load_value);
 }
 
 long O3_CPU::execute_instruction()
 {
+  // Select the oldest of the instructions whose sources are ready
   champsim::bandwidth exec_bw{EXEC_WIDTH};
-  for (auto rob_it = std::begin(ROB); rob_it != std::end(ROB) && exec_bw.has_remaining(); ++rob_it) {
-    if (rob_it->scheduled && !rob_it->executed && rob_it->ready_time <= current_time) {
-      bool ready = std::all_of(std::begin(rob_it->source_registers), std::end(rob_it->source_registers),
-                               [&alloc = std::as_const(reg_allocator)](auto srcreg) { return alloc.isValid(srcreg); });
-      if (ready) {
-        do_execution(*rob_it);
-        exec_bw.consume();
+  auto selected = std::begin(ready_instrs);
+  for (auto ready_it = std::begin(ready_instrs); ready_it != std::end(ready_instrs); ++ready_it) {
+    auto& instr = **ready_it;
+    bool can_issue = exec_bw.has_remaining() && instr.ready_time <= current_time;
+
+    // If there are execution ports, the instruction also needs a free port that accepts its class
+    auto port = std::end(execution_ports);
+    if (can_issue && !std::empty(execution_ports)) {
+      port = std::find_if(std::begin(execution_ports), std::end(execution_ports),
+                          [op = instr.op, time = current_time](const auto& x) { return x.accepts.at(op) && x.busy_until <= time; });
+      if (port == std::end(execution_ports)) {
+        sim_stats.port_contention.increment(instr.op);
+        can_issue = false;
       }
     }
+
+    if (can_issue) {
+      do_execution(instr);
+      exec_bw.consume();
+      if (port != std::end(execution_ports)) {
+        port->busy_until = current_time + (OP_UNPIPELINED.at(instr.op) ? std::max(execution_latency(instr), clock_period) : clock_period);
+        sim_stats.port_issues.increment(static_cast<std::size_t>(std::distance(std::begin(execution_ports), port)));
+      }
+    } else {
+      *selected = *ready_it;
+      ++selected;
+    }
   }
+  ready_instrs.erase(selected, std::end(ready_instrs));
 
   return exec_bw.amount_consumed();
 }
@@ -485,58 +964,85 @@ long O3_CPU::execute_instruction()
 void O3_CPU::do_execution(ooo_model_instr& instr)
 {
   instr.executed = true;
-  instr.ready_time = current_time + (warmup ? champsim::chrono::clock::duration{} : EXEC_LATENCY);
+  ++threads.at(instr.thread).executed_in_rob;
+  trace_pipeline(champsim::pipeline_tracer::stage::execute, instr);
+  insert_in_program_order(inflight_instrs, &instr);
+  instr.ready_time = current_time + execution_latency(instr);
+
+  // The address of a load is known once it executes
+  if (VALUE_PREDICTION && !std::empty(instr.source_memory)) {
+    do_verify_load_address(instr);
+  }
 
   // Mark LQ entries as ready to translate
-  for (auto& lq_entry : LQ) {
-    if (lq_entry.has_value() && lq_entry->instr_id == instr.instr_id) {
-      lq_entry->ready_time = current_time + (warmup ? champsim::chrono::clock::duration{} : EXEC_LATENCY);
-    }
+  auto [lq_begin, lq_end] = lq_slots_by_instr.equal_range(instr.instr_id);
+  for (auto it = lq_begin; it != lq_end; ++it) {
+    LQ.at(it->second)->ready_time = instr.ready_time;
   }
 
   // Mark SQ entries as ready to translate
-  for (auto& sq_entry : SQ) {
-    if (sq_entry.instr_id == instr.instr_id) {
-      sq_entry.ready_time = current_time + (warmup ? champsim::chrono::clock::duration{} : EXEC_LATENCY);
-    }
-  }
+  auto [sq_begin, sq_end] = find_sq_entries(instr.instr_id);
+  std::for_each(sq_begin, sq_end, [time = instr.ready_time](auto& sq_entry) { sq_entry.ready_time = time; });
 
   if constexpr (champsim::debug_print) {
     fmt::print("[ROB] {} instr_id: {} ready_time: {}\n", __func__, instr.instr_id, instr.ready_time.time_since_epoch() / clock_period);
   }
 }
 
+champsim::chrono::clock::duration O3_CPU::execution_latency(const ooo_model_instr& instr) const
+{
+  return warmup ? champsim::chrono::clock::duration{} : OP_LATENCY.at(instr.op);
+}
+
 void O3_CPU::do_memory_scheduling(ooo_model_instr& instr)
 {
+  // With speculative loads, the predictor names the store, if any, that the loads of this instruction wait for
+  auto predicted_store = std::numeric_limits<uint64_t>::max();
+  if (SPECULATIVE_LOADS && !std::empty(instr.source_memory)) {
+    predicted_store = impl_predict_dependence(instr.ip, instr.instr_id);
+  }
+
   // load
   for (auto& smem : instr.source_memory) {
-    auto q_entry = std::find_if_not(std::begin(LQ), std::end(LQ), [](const auto& lq_entry) { return lq_entry.has_value(); });
-    assert(q_entry != std::end(LQ));
-    q_entry->emplace(smem, instr.instr_id, instr.ip, instr.asid); // add it to the load queue
+    auto q_entry = &allocate_lq_entry(smem, instr); // add it to the load queue
 
-    // Check for forwarding
-    auto sq_it = std::max_element(std::begin(SQ), std::end(SQ), [smem](const auto& lhs, const auto& rhs) {
-      return lhs.virtual_address != smem || (rhs.virtual_address == smem && LSQ_ENTRY::program_order(lhs, rhs));
-    });
-    if (sq_it != std::end(SQ) && sq_it->virtual_address == smem) {
+    // Check for forwarding from the youngest store to the same address
+    auto sq_it = find_forwarding_store(smem, instr.instr_id);
+    if (sq_it != std::end(SQ)) {
       if (sq_it->fetch_issued) { // Store already executed
         (*q_entry)->finish(instr);
-        q_entry->reset();
+        release_lq_entry(*q_entry);
+      } else if (!SPECULATIVE_LOADS) {
+        do_wait_for_store(*sq_it, *q_entry);
+      } else if (sq_it->instr_id == predicted_store) {
+        ++sim_stats.dependence_predicted_waits;
+        do_wait_for_store(*sq_it, *q_entry);
       } else {
-        assert(sq_it->instr_id < instr.instr_id);      // The found SQ entry is a prior store
-        sq_it->lq_depend_on_me.emplace_back(*q_entry); // Forward the load when the store finishes
-        (*q_entry)->producer_id = sq_it->instr_id;     // The load waits on the store to finish
-
-        if constexpr (champsim::debug_print) {
-          fmt::print("[DISPATCH] {} instr_id: {} waits on: {}\n", __func__, instr.instr_id, sq_it->instr_id);
-        }
+        sq_it->lq_speculated_past_me.emplace_back(instr.instr_id, instr.ip); // The store checks the load for a violation when it executes
+        do_wait_for_predicted_store(predicted_store, *q_entry);
       }
+    } else if (do_forward_from_store_buffer(smem)) { // A store that has retired may still be in the store buffer
+      ++sim_stats.store_buffer_forwards;
+      (*q_entry)->finish(instr);
+      release_lq_entry(*q_entry);
+    } else if (SPECULATIVE_LOADS) {
+      do_wait_for_predicted_store(predicted_store, *q_entry);
     }
   }
 
+  if (WRONG_PATH_LOADS) {
+    do_record_wrong_path_loads(instr);
+  }
+
   // store
   for (auto& dmem : instr.destination_memory) {
-    SQ.emplace_back(dmem, instr.instr_id, instr.ip, instr.asid); // add it to the store queue
+    SQ.emplace_back(dmem, instr); // add it to the store queue
+    ++threads.at(instr.thread).sq_occupancy;
+    sq_ids_by_address[dmem.to<uint64_t>()].push_back(instr.instr_id);
+  }
+
+  if (SPECULATIVE_LOADS && !std::empty(instr.destination_memory)) {
+    impl_store_dispatched(instr.ip, instr.instr_id);
   }
 
   if constexpr (champsim::debug_print) {
@@ -545,15 +1051,146 @@ void O3_CPU::do_memory_scheduling(ooo_model_instr& instr)
   }
 }
 
-long O3_CPU::operate_lsq()
+std::optional<LSQ_ENTRY>& O3_CPU::allocate_lq_entry(champsim::address address, ooo_model_instr& instr)
 {
-  champsim::bandwidth store_bw{SQ_WIDTH};
+  assert(!std::empty(lq_free_slots));
+  auto slot = lq_free_slots.top();
+  lq_free_slots.pop();
+
+  auto& lq_entry = LQ.at(slot);
+  assert(!lq_entry.has_value());
+  lq_entry.emplace(address, instr);
+  ++threads.at(instr.thread).lq_occupancy;
+  lq_slots_by_instr.emplace(instr.instr_id, slot);
+  lq_unissued_slots.insert(slot);
+  return lq_entry;
+}
 
-  const auto complete_id = std::empty(ROB) ? std::numeric_limits<uint64_t>::max() : ROB.front().instr_id;
-  auto do_complete = [time = current_time, finished = LSQ_ENTRY::precedes(complete_id), this](const auto& x) {
-    return finished(x) && x.ready_time <= time && this->do_complete_store(x);
+void O3_CPU::release_lq_entry(std::optional<LSQ_ENTRY>& lq_entry)
+{
+  assert(lq_entry.has_value());
+  const auto slot = static_cast<std::size_t>(std::distance(std::data(LQ), &lq_entry));
+  assert(slot < std::size(LQ));
+
+  auto erase_slot = [slot](auto& index, uint64_t key) {
+    auto [begin, end] = index.equal_range(key);
+    auto found = std::find_if(begin, end, [slot](const auto& x) { return x.second == slot; });
+    assert(found != end);
+    index.erase(found);
   };
 
+  erase_slot(lq_slots_by_instr, lq_entry->instr_id);
+  if (lq_entry->fetch_issued) {
+    erase_slot(lq_slots_by_block, champsim::block_number{lq_entry->virtual_address}.to<uint64_t>());
+  } else {
+    lq_unissued_slots.erase(slot);
+  }
+
+  --threads.at(lq_entry->thread).lq_occupancy;
+  lq_entry.reset();
+  lq_free_slots.push(slot);
+}
+
+auto O3_CPU::find_sq_entries(uint64_t instr_id) -> std::pair<std::deque<LSQ_ENTRY>::iterator, std::deque<LSQ_ENTRY>::iterator>
+{
+  // The store queue is in program order, so the entries of an instruction are contiguous
+  auto begin = std::partition_point(std::begin(SQ), std::end(SQ), LSQ_ENTRY::precedes(instr_id));
+  auto end = std::find_if(begin, std::end(SQ), [instr_id](const auto& sq_entry) { return sq_entry.instr_id != instr_id; });
+  return {begin, end};
+}
+
+auto O3_CPU::find_forwarding_store(champsim::address address, uint64_t load_id) -> std::deque<LSQ_ENTRY>::iterator
+{
+  // The youngest store to the address that is older than the load. The stores to each address are listed in program order.
+  auto found = sq_ids_by_address.find(address.to<uint64_t>());
+  if (found == std::end(sq_ids_by_address)) {
+    return std::end(SQ);
+  }
+
+  auto younger = std::lower_bound(std::begin(found->second), std::end(found->second), load_id);
+  if (younger == std::begin(found->second)) {
+    return std::end(SQ);
+  }
+
+  auto [sq_begin, sq_end] = find_sq_entries(*std::prev(younger));
+  auto sq_it = std::find_if(sq_begin, sq_end, [address](const auto& sq_entry) { return sq_entry.virtual_address == address; });
+  assert(sq_it != sq_end);
+  return sq_it;
+}
+
+void O3_CPU::do_wait_for_store(LSQ_ENTRY& sq_entry, std::optional<LSQ_ENTRY>& lq_entry)
+{
+  assert(sq_entry.instr_id < lq_entry->instr_id); // The SQ entry is a prior store
+  sq_entry.lq_depend_on_me.emplace_back(lq_entry); // Release the load when the store finishes
+  lq_entry->producer_id = sq_entry.instr_id;       // The load waits on the store to finish
+
+  if constexpr (champsim::debug_print) {
+    fmt::print("[DISPATCH] {} instr_id: {} waits on: {}\n", __func__, lq_entry->instr_id, sq_entry.instr_id);
+  }
+}
+
+void O3_CPU::do_wait_for_predicted_store(uint64_t predicted_store, std::optional<LSQ_ENTRY>& lq_entry)
+{
+  // The load does not read from the predicted store, but is held until it executes
+  if (predicted_store >= lq_entry->instr_id) {
+    return;
+  }
+
+  auto [sq_begin, sq_end] = find_sq_entries(predicted_store);
+  if (auto sq_it = std::find_if(sq_begin, sq_end, [](const auto& sq_entry) { return !sq_entry.fetch_issued; }); sq_it != sq_end) {
+    ++sim_stats.dependence_false_waits;
+    do_wait_for_store(*sq_it, lq_entry);
+  }
+}
+
+void O3_CPU::do_check_dependence(const LSQ_ENTRY& sq_entry, uint64_t load_id, champsim::address load_ip)
+{
+  auto [lq_begin, lq_end] = lq_slots_by_instr.equal_range(load_id);
+  auto found = std::find_if(lq_begin, lq_end, [addr = sq_entry.virtual_address, this](const auto& x) { return LQ.at(x.second)->virtual_address == addr; });
+  std::optional<LSQ_ENTRY>* lq_entry = (found != lq_end) ? &LQ.at(found->second) : nullptr;
+
+  if (lq_entry == nullptr || (*lq_entry)->fetch_issued) {
+    // The load read memory before the store wrote it, so the thread of the store refetches after the penalty
+    ++sim_stats.dependence_violations;
+    impl_dependence_violation(load_ip, sq_entry.ip);
+    auto& thread = threads.at(sq_entry.thread);
+    thread.fetch_resume_time = std::max(thread.fetch_resume_time, current_time + VIOLATION_PENALTY);
+
+    if constexpr (champsim::debug_print) {
+      fmt::print("[SQ] {} instr_id: {} violated by load instr_id: {}\n", __func__, sq_entry.instr_id, load_id);
+    }
+
+    // The load issues again, and is forwarded from the store, which has now executed. A request still in flight is abandoned.
+    auto load = std::find_if(std::begin(ROB), std::end(ROB), ooo_model_instr::matches_id(load_id));
+    assert(load != std::end(ROB)); // The store has not retired, so neither has the load
+    if (lq_entry != nullptr) {
+      (*lq_entry)->finish();
+      release_lq_entry(*lq_entry);
+    }
+
+    // The load and the instructions that used its result execute again
+    do_replay(*load);
+    return;
+  }
+
+  if ((*lq_entry)->producer_id != std::numeric_limits<uint64_t>::max()) {
+    // The load is still held by a predicted store, which must not release it again
+    auto [sq_begin, sq_end] = find_sq_entries((*lq_entry)->producer_id);
+    for (auto sq_it = sq_begin; sq_it != sq_end; ++sq_it) {
+      auto& waiters = sq_it->lq_depend_on_me;
+      waiters.erase(std::remove_if(std::begin(waiters), std::end(waiters), [lq_entry](const auto& x) { return &x.get() == lq_entry; }), std::end(waiters));
+    }
+  }
+
+  // A load that has not issued takes the value of the store
+  (*lq_entry)->finish();
+  release_lq_entry(*lq_entry);
+}
+
+long O3_CPU::operate_lsq()
+{
+  champsim::bandwidth store_bw{SQ_WIDTH};
+
   auto unfetched_begin = std::partition_point(std::begin(SQ), std::end(SQ), [](const auto& x) { return x.fetch_issued; });
   auto [fetch_begin, fetch_end] =
       champsim::get_span_p(unfetched_begin, std::end(SQ), store_bw, [time = current_time](const auto& x) { return !x.fetch_issued && x.ready_time <= time; });
@@ -564,20 +1201,59 @@ long O3_CPU::operate_lsq()
     sq_entry.ready_time = time;
   });
 
-  auto [complete_begin, complete_end] = champsim::get_span_p(std::cbegin(SQ), std::cend(SQ), store_bw, do_complete);
-  store_bw.consume(std::distance(complete_begin, complete_end));
-  SQ.erase(complete_begin, complete_end);
+  // Stores complete once they have retired, which is when they precede the oldest instruction of their thread in the ROB
+  std::vector<uint64_t> oldest_unretired(NUM_THREADS, std::numeric_limits<uint64_t>::max());
+  std::size_t threads_found = 0;
+  for (auto rob_it = std::cbegin(ROB); rob_it != std::cend(ROB) && threads_found < NUM_THREADS; ++rob_it) {
+    if (oldest_unretired.at(rob_it->thread) == std::numeric_limits<uint64_t>::max()) {
+      oldest_unretired.at(rob_it->thread) = rob_it->instr_id;
+      ++threads_found;
+    }
+  }
+
+  // The stores of each thread complete in its program order, so a thread stops at its first store that cannot complete
+  std::vector<bool> blocked(NUM_THREADS, false);
+  std::size_t threads_blocked = 0;
+  auto kept_end = std::begin(SQ);
+  auto sq_it = std::begin(SQ);
+  for (; sq_it != std::end(SQ) && store_bw.has_remaining() && threads_blocked < NUM_THREADS; ++sq_it) {
+    if (!blocked.at(sq_it->thread) && LSQ_ENTRY::precedes(oldest_unretired.at(sq_it->thread))(*sq_it) && sq_it->ready_time <= current_time
+        && do_complete_store(*sq_it)) {
+      store_bw.consume();
+      --threads.at(sq_it->thread).sq_occupancy;
+      auto found = sq_ids_by_address.find(sq_it->virtual_address.to<uint64_t>());
+      assert(found != std::end(sq_ids_by_address));
+      assert(found->second.front() == sq_it->instr_id); // Stores leave the queue in program order
+      found->second.pop_front();
+      if (std::empty(found->second)) {
+        sq_ids_by_address.erase(found);
+      }
+    } else {
+      if (!blocked.at(sq_it->thread)) {
+        blocked.at(sq_it->thread) = true;
+        ++threads_blocked;
+      }
+      if (kept_end != sq_it) {
+        *kept_end = std::move(*sq_it);
+      }
+      ++kept_end;
+    }
+  }
+  SQ.erase(kept_end, sq_it);
 
   champsim::bandwidth load_bw{LQ_WIDTH};
 
-  for (auto& lq_entry : LQ) {
-    if (load_bw.has_remaining() && lq_entry.has_value() && lq_entry->producer_id == std::numeric_limits<uint64_t>::max() && !lq_entry->fetch_issued
-        && lq_entry->ready_time < current_time) {
-      auto success = execute_load(*lq_entry);
-      if (success) {
-        load_bw.consume();
-        lq_entry->fetch_issued = true;
-      }
+  for (auto slot_it = std::begin(lq_unissued_slots); load_bw.has_remaining() && slot_it != std::end(lq_unissued_slots);) {
+    auto slot = *slot_it;
+    auto& lq_entry = LQ.at(slot);
+    assert(lq_entry.has_value() && !lq_entry->fetch_issued);
+    if (lq_entry->producer_id == std::numeric_limits<uint64_t>::max() && lq_entry->ready_time < current_time && execute_load(*lq_entry)) {
+      load_bw.consume();
+      lq_entry->fetch_issued = true;
+      lq_slots_by_block.emplace(champsim::block_number{lq_entry->virtual_address}.to<uint64_t>(), slot);
+      slot_it = lq_unissued_slots.erase(slot_it);
+    } else {
+      ++slot_it;
     }
   }
 
@@ -590,20 +1266,42 @@ void O3_CPU::do_finish_store(const LSQ_ENTRY& sq_entry)
     fmt::print("[SQ] {} instr_id: {} vaddr: {}\n", __func__, sq_entry.instr_id, sq_entry.virtual_address);
   }
 
-  sq_entry.finish(std::begin(ROB), std::end(ROB));
+  sq_entry.finish();
+
+  if (SPECULATIVE_LOADS) {
+    impl_store_executed(sq_entry.ip, sq_entry.instr_id);
+  }
 
   // Release dependent loads
   for (std::optional<LSQ_ENTRY>& dependent : sq_entry.lq_depend_on_me) {
     assert(dependent.has_value()); // LQ entry is still allocated
     assert(dependent->producer_id == sq_entry.instr_id);
 
-    dependent->finish(std::begin(ROB), std::end(ROB));
-    dependent.reset();
+    // A load that was held only by a predicted dependence may now issue, and reads from its own store
+    if (SPECULATIVE_LOADS) {
+      if (auto sq_it = find_forwarding_store(dependent->virtual_address, dependent->instr_id);
+          sq_it == std::end(SQ) || sq_it->instr_id != sq_entry.instr_id) {
+        dependent->producer_id = std::numeric_limits<uint64_t>::max();
+        continue;
+      }
+    }
+
+    dependent->finish();
+    release_lq_entry(dependent);
+  }
+
+  // Check the loads that issued without waiting for this store
+  for (auto [load_id, load_ip] : sq_entry.lq_speculated_past_me) {
+    do_check_dependence(sq_entry, load_id, load_ip);
   }
 }
 
 bool O3_CPU::do_complete_store(const LSQ_ENTRY& sq_entry)
 {
+  if (STORE_BUFFER_SIZE > 0) {
+    return do_buffer_store(sq_entry);
+  }
+
   CacheBus::request_type data_packet;
   data_packet.v_address = sq_entry.virtual_address;
   data_packet.instr_id = sq_entry.instr_id;
@@ -616,6 +1314,75 @@ bool O3_CPU::do_complete_store(const LSQ_ENTRY& sq_entry)
   return L1D_bus.issue_write(data_packet);
 }
 
+bool O3_CPU::do_buffer_store(const LSQ_ENTRY& sq_entry)
+{
+  auto entry = std::find_if(std::begin(STORE_BUFFER), std::end(STORE_BUFFER), [block = champsim::block_number{sq_entry.virtual_address}](const auto& x) {
+    return champsim::block_number{x.virtual_address} == block;
+  });
+
+  if (entry == std::end(STORE_BUFFER) && std::size(STORE_BUFFER) >= STORE_BUFFER_SIZE) {
+    ++sim_stats.store_buffer_full_stalls;
+    return false;
+  }
+
+  if (entry != std::end(STORE_BUFFER)) {
+    if (std::find(std::begin(entry->written), std::end(entry->written), sq_entry.virtual_address) == std::end(entry->written)) {
+      entry->written.push_back(sq_entry.virtual_address);
+    }
+    ++sim_stats.store_buffer_coalesced;
+  } else {
+    STORE_BUFFER.push_back({sq_entry.virtual_address, sq_entry.ip, sq_entry.instr_id, {sq_entry.virtual_address}});
+  }
+  ++sim_stats.store_buffer_stores;
+
+  if constexpr (champsim::debug_print) {
+    fmt::print("[SB] {} instr_id: {} vaddr: {} coalesced: {} occupancy: {}\n", __func__, sq_entry.instr_id, sq_entry.virtual_address,
+               entry != std::end(STORE_BUFFER), std::size(STORE_BUFFER));
+  }
+
+  return true;
+}
+
+bool O3_CPU::do_forward_from_store_buffer(champsim::address load_address) const
+{
+  return std::any_of(std::begin(STORE_BUFFER), std::end(STORE_BUFFER), [load_address](const auto& entry) {
+    return std::find(std::begin(entry.written), std::end(entry.written), load_address) != std::end(entry.written);
+  });
+}
+
+long O3_CPU::drain_store_buffer()
+{
+  champsim::bandwidth drain_bw{STORE_BUFFER_WIDTH};
+  while (drain_bw.has_remaining() && !std::empty(STORE_BUFFER)) {
+    const auto& entry = STORE_BUFFER.front();
+
+    // The newest entry waits while the oldest store in the store queue will combine with it
+    const auto combines_next = !std::empty(SQ) && champsim::block_number{SQ.front().virtual_address} == champsim::block_number{entry.virtual_address};
+    if (std::size(STORE_BUFFER) == 1 && combines_next) {
+      break;
+    }
+
+    CacheBus::request_type data_packet;
+    data_packet.v_address = entry.virtual_address;
+    data_packet.instr_id = entry.instr_id;
+    data_packet.ip = entry.ip;
+
+    if constexpr (champsim::debug_print) {
+      fmt::print("[SB] {} instr_id: {} vaddr: {} stores: {}\n", __func__, data_packet.instr_id, data_packet.v_address, std::size(entry.written));
+    }
+
+    if (!L1D_bus.issue_write(data_packet)) {
+      break;
+    }
+
+    ++sim_stats.store_buffer_writes;
+    STORE_BUFFER.pop_front();
+    drain_bw.consume();
+  }
+
+  return drain_bw.amount_consumed();
+}
+
 bool O3_CPU::execute_load(const LSQ_ENTRY& lq_entry)
 {
   CacheBus::request_type data_packet;
@@ -635,12 +1402,114 @@ void O3_CPU::do_complete_execution(ooo_model_instr& instr)
   for (auto dreg : instr.destination_registers) {
     // mark physical register's data as valid
     reg_allocator.complete_dest_register(dreg);
+    do_wakeup(dreg);
   }
 
   instr.completed = true;
+  trace_pipeline(champsim::pipeline_tracer::stage::complete, instr);
+
+  if (VALUE_PREDICTION && !std::empty(instr.source_memory)) {
+    address_predicted_loads.erase(std::remove(std::begin(address_predicted_loads), std::end(address_predicted_loads), &instr),
+                                  std::end(address_predicted_loads));
+    do_verify_load(instr);
+  }
 
   if (instr.branch_mispredicted) {
-    fetch_resume_time = current_time + BRANCH_MISPREDICT_PENALTY;
+    threads.at(instr.thread).fetch_resume_time = current_time + BRANCH_MISPREDICT_PENALTY;
+    do_squash_wrong_path();
+  }
+}
+
+void O3_CPU::do_wakeup(PHYSICAL_REGISTER_ID physreg)
+{
+  auto& waiters = register_waiters.at(static_cast<std::size_t>(physreg));
+  for (auto* waiter : waiters) {
+    assert(waiter->num_reg_dependent > 0);
+    if (--waiter->num_reg_dependent == 0) {
+      insert_in_program_order(ready_instrs, waiter);
+    }
+  }
+  waiters.clear();
+}
+
+void O3_CPU::do_replay(ooo_model_instr& instr)
+{
+  std::vector<PHYSICAL_REGISTER_ID> changed{};
+  do_reset_execution(instr, changed);
+  do_replay_consumers(instr, std::move(changed));
+}
+
+void O3_CPU::do_replay_consumers(const ooo_model_instr& producer, std::vector<PHYSICAL_REGISTER_ID> changed)
+{
+  // A physical register is written only by its producer while that is in the ROB, so the readers of a changed register are its consumers.
+  // The registers written by each consumer that is reset change in turn.
+  auto rob_it = std::find_if(std::begin(ROB), std::end(ROB), ooo_model_instr::matches_id(producer.instr_id));
+  assert(rob_it != std::end(ROB));
+  for (++rob_it; rob_it != std::end(ROB); ++rob_it) {
+    auto reads_changed = std::any_of(std::begin(rob_it->source_registers), std::end(rob_it->source_registers), [&changed](auto src_reg) {
+      return std::find(std::begin(changed), std::end(changed), src_reg) != std::end(changed);
+    });
+    if (rob_it->thread == producer.thread && rob_it->scheduled && reads_changed) {
+      do_reset_execution(*rob_it, changed);
+    }
+  }
+}
+
+void O3_CPU::do_reset_execution(ooo_model_instr& instr, std::vector<PHYSICAL_REGISTER_ID>& changed)
+{
+  if (!instr.scheduled) {
+    return;
+  }
+
+  if constexpr (champsim::debug_print) {
+    fmt::print("[ROB] {} instr_id: {} executed: {} completed: {}\n", __func__, instr.instr_id, instr.executed, instr.completed);
+  }
+
+  auto erase_instr = [&instr](auto& list) {
+    list.erase(std::remove(std::begin(list), std::end(list), &instr), std::end(list));
+  };
+  erase_instr(ready_instrs);
+  erase_instr(inflight_instrs);
+  for (auto src_reg : instr.source_registers) {
+    erase_instr(register_waiters.at(static_cast<std::size_t>(src_reg)));
+  }
+
+  if (instr.executed) {
+    instr.executed = false;
+    --threads.at(instr.thread).executed_in_rob;
+  }
+  if (instr.completed) {
+    instr.completed = false;
+    for (auto dreg : instr.destination_registers) {
+      reg_allocator.invalidate_dest_register(dreg);
+      changed.push_back(dreg);
+    }
+  }
+
+  // The memory operations that have not issued wait for the instruction to execute again. Those that have issued are not repeated.
+  auto [lq_begin, lq_end] = lq_slots_by_instr.equal_range(instr.instr_id);
+  for (auto it = lq_begin; it != lq_end; ++it) {
+    if (auto& lq_entry = LQ.at(it->second); !lq_entry->fetch_issued) {
+      lq_entry->ready_time = champsim::chrono::clock::time_point::max();
+    }
+  }
+  auto [sq_begin, sq_end] = find_sq_entries(instr.instr_id);
+  std::for_each(sq_begin, sq_end, [](auto& sq_entry) {
+    if (!sq_entry.fetch_issued) {
+      sq_entry.ready_time = champsim::chrono::clock::time_point::max();
+    }
+  });
+
+  // Wait again for the sources that are not valid
+  instr.num_reg_dependent = 0;
+  for (auto src_reg : instr.source_registers) {
+    if (!reg_allocator.isValid(src_reg)) {
+      register_waiters.at(static_cast<std::size_t>(src_reg)).push_back(&instr);
+      ++instr.num_reg_dependent;
+    }
+  }
+  if (instr.num_reg_dependent == 0) {
+    insert_in_program_order(ready_instrs, &instr);
   }
 }
 
@@ -648,10 +1517,24 @@ long O3_CPU::complete_inflight_instruction()
 {
   // update ROB entries with completed executions
   champsim::bandwidth complete_bw{EXEC_WIDTH};
-  for (auto rob_it = std::begin(ROB); rob_it != std::end(ROB) && complete_bw.has_remaining(); ++rob_it) {
-    if (rob_it->executed && !rob_it->completed && (rob_it->ready_time <= current_time) && rob_it->completed_mem_ops == rob_it->num_mem_ops()) {
-      do_complete_execution(*rob_it);
+  std::vector<ooo_model_instr*> completing{};
+  auto remaining = std::begin(inflight_instrs);
+  for (auto inflight_it = std::begin(inflight_instrs); inflight_it != std::end(inflight_instrs); ++inflight_it) {
+    auto& instr = **inflight_it;
+    if (complete_bw.has_remaining() && instr.ready_time <= current_time && instr.completed_mem_ops == instr.num_mem_ops()) {
+      completing.push_back(&instr);
       complete_bw.consume();
+    } else {
+      *remaining = *inflight_it;
+      ++remaining;
+    }
+  }
+  inflight_instrs.erase(remaining, std::end(inflight_instrs));
+
+  // An instruction that is replayed by an older one as it completes does not complete
+  for (auto* instr : completing) {
+    if (instr->executed) {
+      do_complete_execution(*instr);
     }
   }
 
@@ -670,6 +1553,7 @@ long O3_CPU::handle_memory_return()
       auto fetched = std::find_if(std::begin(IFETCH_BUFFER), std::end(IFETCH_BUFFER), ooo_model_instr::matches_id(l1i_entry.instr_depend_on_me.front()));
       if (fetched != std::end(IFETCH_BUFFER) && champsim::block_number{fetched->ip} == champsim::block_number{l1i_entry.v_address} && fetched->fetch_issued) {
         fetched->fetch_completed = true;
+        trace_pipeline(champsim::pipeline_tracer::stage::fetch_complete, *fetched);
         fetch_bw.consume();
         ++progress;
 
@@ -690,56 +1574,110 @@ long O3_CPU::handle_memory_return()
 
   auto l1d_it = std::begin(L1D_bus.lower_level->returned);
   for (champsim::bandwidth l1d_bw{L1D_BANDWIDTH}; l1d_bw.has_remaining() && l1d_it != std::end(L1D_bus.lower_level->returned); l1d_bw.consume(), ++l1d_it) {
-    for (auto& lq_entry : LQ) {
-      if (lq_entry.has_value() && lq_entry->fetch_issued && champsim::block_number{lq_entry->virtual_address} == champsim::block_number{l1d_it->v_address}) {
-        lq_entry->finish(std::begin(ROB), std::end(ROB));
-        lq_entry.reset();
-        ++progress;
+    auto [block_begin, block_end] = lq_slots_by_block.equal_range(champsim::block_number{l1d_it->v_address}.to<uint64_t>());
+    std::vector<std::size_t> returned_slots;
+    std::transform(block_begin, block_end, std::back_inserter(returned_slots), [](const auto& x) { return x.second; });
+    for (auto slot : returned_slots) {
+      auto& lq_entry = LQ.at(slot);
+      lq_entry->finish();
+      trace_pipeline(champsim::pipeline_tracer::stage::memory_return, *lq_entry->rob_entry);
+      release_lq_entry(lq_entry);
+      ++progress;
+    }
+
+    // The loads that issued early to a predicted address in this block wake their consumers
+    auto woken = std::stable_partition(std::begin(address_predicted_loads), std::end(address_predicted_loads),
+                                       [block = champsim::block_number{l1d_it->v_address}](const auto* x) {
+                                         return champsim::block_number{x->predicted_address.value()} != block;
+                                       });
+    for (auto it = woken; it != std::end(address_predicted_loads); ++it) {
+      for (auto dreg : (*it)->destination_registers) {
+        reg_allocator.complete_dest_register(dreg);
+        do_wakeup(dreg);
       }
     }
+    address_predicted_loads.erase(woken, std::end(address_predicted_loads));
     ++progress;
   }
   L1D_bus.lower_level->returned.erase(std::begin(L1D_bus.lower_level->returned), l1d_it);
 
+  // The core holds no copies of blocks, so probes from a coherence directory have no effect here
+  L1I_bus.lower_level->probes.clear();
+  L1D_bus.lower_level->probes.clear();
+
   return progress;
 }
 
 long O3_CPU::retire_rob()
 {
-  auto [retire_begin, retire_end] =
-      champsim::get_span_p(std::cbegin(ROB), std::cend(ROB), champsim::bandwidth{RETIRE_WIDTH}, [](const auto& x) { return x.completed; });
-  assert(std::distance(retire_begin, retire_end) >= 0); // end succeeds begin
-  if constexpr (champsim::debug_print) {
-    std::for_each(retire_begin, retire_end, [cycle = current_time.time_since_epoch() / clock_period](const auto& x) {
-      fmt::print("[ROB] retire_rob instr_id: {} is retired cycle: {}\n", x.instr_id, cycle);
-    });
-  }
+  // Each thread retires in its own program order, so a thread stops at its first instruction that has not completed
+  champsim::bandwidth retire_bw{RETIRE_WIDTH};
+  std::vector<bool> blocked(NUM_THREADS, false);
+  std::size_t threads_blocked = 0;
+  bool retired_in_order = true; // The retired instructions are all at the front of the ROB
+  std::vector<uint64_t> retired_ids{};
+  for (auto rob_it = std::cbegin(ROB); rob_it != std::cend(ROB) && retire_bw.has_remaining() && threads_blocked < NUM_THREADS; ++rob_it) {
+    if (blocked.at(rob_it->thread)) {
+      continue;
+    }
+    if (!rob_it->completed) {
+      blocked.at(rob_it->thread) = true;
+      ++threads_blocked;
+      continue;
+    }
 
-  // commit register writes to backend RAT
-  // and recycle the old physical registers
-  for (auto rob_it = retire_begin; rob_it != retire_end; ++rob_it) {
+    if constexpr (champsim::debug_print) {
+      fmt::print("[ROB] retire_rob instr_id: {} is retired cycle: {}\n", rob_it->instr_id, current_time.time_since_epoch() / clock_period);
+    }
+
+    // commit register writes to backend RAT
+    // and recycle the old physical registers
     for (auto dreg : rob_it->destination_registers) {
       reg_allocator.retire_dest_register(dreg);
     }
+    trace_pipeline(champsim::pipeline_tracer::stage::retire, *rob_it);
+
+    retired_in_order = retired_in_order && std::distance(std::cbegin(ROB), rob_it) == retire_bw.amount_consumed();
+    if (NUM_THREADS > 1) {
+      retired_ids.push_back(rob_it->instr_id);
+    }
+    ++threads.at(rob_it->thread).num_retired;
+    if (rob_it->executed) {
+      --threads.at(rob_it->thread).executed_in_rob;
+    }
+    retire_bw.consume();
   }
 
-  auto retire_count = std::distance(retire_begin, retire_end);
+  auto retire_count = retire_bw.amount_consumed();
   num_retired += retire_count;
-  ROB.erase(retire_begin, retire_end);
+  scheduled_in_rob -= std::min(scheduled_in_rob, static_cast<std::size_t>(retire_count));
+  if (retired_in_order) {
+    ROB.erase(std::cbegin(ROB), std::next(std::cbegin(ROB), retire_count));
+  } else {
+    ROB.remove_if([&retired_ids](const auto& x) { return std::find(std::begin(retired_ids), std::end(retired_ids), x.instr_id) != std::end(retired_ids); });
+  }
 
   return retire_count;
 }
 
-void O3_CPU::impl_initialize_branch_predictor() const { branch_module_pimpl->impl_initialize_branch_predictor(); }
+// The branch prediction of a core that calls its modules through their concepts
+template bool O3_CPU::do_predict_branch<O3_CPU::branch_module_concept, O3_CPU::btb_module_concept>(ooo_model_instr& arch_instr);
 
-void O3_CPU::impl_last_branch_result(champsim::address ip, champsim::address target, bool taken, uint8_t branch_type) const
+void O3_CPU::impl_initialize_branch_predictor() const
 {
-  branch_module_pimpl->impl_last_branch_result(ip, target, taken, branch_type);
+  for (const auto& pimpl : branch_module_pimpl) {
+    pimpl->impl_initialize_branch_predictor();
+  }
+}
+
+void O3_CPU::impl_last_branch_result(std::size_t thread, champsim::address ip, champsim::address target, bool taken, uint8_t branch_type) const
+{
+  branch_module_pimpl.at(thread)->impl_last_branch_result(ip, target, taken, branch_type);
 }
 
-bool O3_CPU::impl_predict_branch(champsim::address ip, champsim::address predicted_target, bool always_taken, uint8_t branch_type) const
+bool O3_CPU::impl_predict_branch(std::size_t thread, champsim::address ip, champsim::address predicted_target, bool always_taken, uint8_t branch_type) const
 {
-  return branch_module_pimpl->impl_predict_branch(ip, predicted_target, always_taken, branch_type);
+  return branch_module_pimpl.at(thread)->impl_predict_branch(ip, predicted_target, always_taken, branch_type);
 }
 
 void O3_CPU::impl_initialize_btb() const { btb_module_pimpl->impl_initialize_btb(); }
@@ -754,6 +1692,36 @@ std::pair<champsim::address, bool> O3_CPU::impl_btb_prediction(champsim::address
   return btb_module_pimpl->impl_btb_prediction(ip, branch_type);
 }
 
+void O3_CPU::impl_initialize_dependence_predictor() const { memory_dependence_module_pimpl->impl_initialize_dependence_predictor(); }
+
+uint64_t O3_CPU::impl_predict_dependence(champsim::address ip, uint64_t instr_id) const
+{
+  return memory_dependence_module_pimpl->impl_predict_dependence(ip, instr_id);
+}
+
+void O3_CPU::impl_store_dispatched(champsim::address ip, uint64_t instr_id) const { memory_dependence_module_pimpl->impl_store_dispatched(ip, instr_id); }
+
+void O3_CPU::impl_store_executed(champsim::address ip, uint64_t instr_id) const { memory_dependence_module_pimpl->impl_store_executed(ip, instr_id); }
+
+void O3_CPU::impl_dependence_violation(champsim::address load_ip, champsim::address store_ip) const
+{
+  memory_dependence_module_pimpl->impl_dependence_violation(load_ip, store_ip);
+}
+
+void O3_CPU::impl_initialize_value_predictor() const { value_module_pimpl->impl_initialize_value_predictor(); }
+
+std::optional<uint64_t> O3_CPU::impl_predict_load(champsim::address ip) const { return value_module_pimpl->impl_predict_load(ip); }
+
+std::optional<champsim::address> O3_CPU::impl_predict_load_address(champsim::address ip) const
+{
+  return value_module_pimpl->impl_predict_load_address(ip);
+}
+
+void O3_CPU::impl_last_load_result(champsim::address ip, champsim::address address, std::optional<uint64_t> value) const
+{
+  value_module_pimpl->impl_last_load_result(ip, address, value);
+}
+
 // LCOV_EXCL_START Exclude the following function from LCOV
 void O3_CPU::print_deadlock()
 {
@@ -799,6 +1767,12 @@ void O3_CPU::print_deadlock()
   std::string_view sq_fmt{"instr_id: {} address: {} fetch_issued: {} event_cycle: {} LQ waiting: {}"};
   champsim::range_print_deadlock(LQ, "cpu" + std::to_string(cpu) + "_LQ", lq_fmt, lq_pack);
   champsim::range_print_deadlock(SQ, "cpu" + std::to_string(cpu) + "_SQ", sq_fmt, sq_pack);
+
+  auto sb_pack = [](const auto& entry) {
+    return std::tuple{entry.instr_id, entry.virtual_address, std::size(entry.written)};
+  };
+  std::string_view sb_fmt{"instr_id: {} address: {} stores: {}"};
+  champsim::range_print_deadlock(STORE_BUFFER, "cpu" + std::to_string(cpu) + "_STORE_BUFFER", sb_fmt, sb_pack);
 }
 // LCOV_EXCL_STOP
 
@@ -807,23 +1781,28 @@ LSQ_ENTRY::LSQ_ENTRY(champsim::address addr, champsim::program_ordered<LSQ_ENTRY
 {
 }
 
-void LSQ_ENTRY::finish(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end) const
+LSQ_ENTRY::LSQ_ENTRY(champsim::address addr, ooo_model_instr& instr) : LSQ_ENTRY(addr, instr.instr_id, instr.ip, instr.asid)
+{
+  thread = instr.thread;
+  rob_entry = &instr;
+}
+
+void LSQ_ENTRY::finish() const
 {
-  auto rob_entry = std::partition_point(begin, end, ooo_model_instr::precedes(this->instr_id));
-  assert(rob_entry != end);
+  assert(rob_entry != nullptr);
   finish(*rob_entry);
 }
 
-void LSQ_ENTRY::finish(ooo_model_instr& rob_entry) const
+void LSQ_ENTRY::finish(ooo_model_instr& instr) const
 {
-  assert(rob_entry.instr_id == this->instr_id);
+  assert(instr.instr_id == this->instr_id);
 
-  ++rob_entry.completed_mem_ops;
-  assert(rob_entry.completed_mem_ops <= rob_entry.num_mem_ops());
+  ++instr.completed_mem_ops;
+  assert(instr.completed_mem_ops <= instr.num_mem_ops());
 
   if constexpr (champsim::debug_print) {
     fmt::print("[LSQ] {} instr_id: {} full_address: {} remain_mem_ops: {}\n", __func__, instr_id, virtual_address,
-               rob_entry.num_mem_ops() - rob_entry.completed_mem_ops);
+               instr.num_mem_ops() - instr.completed_mem_ops);
   }
 }
 
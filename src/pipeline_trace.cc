@@ -0,0 +1,126 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pipeline_trace.h"
+
+#include <cassert>
+#include <iterator>
+#include <utility>
+
+namespace
+{
+// The size of the formatted records that are gathered before they are compressed
+constexpr std::size_t FLUSH_SIZE = 1 << 16;
+
+auto tick(const std::optional<champsim::chrono::clock::time_point>& time) { return time.has_value() ? time->time_since_epoch().count() : 0; }
+} // namespace
+
+champsim::pipeline_tracer::pipeline_tracer(std::string filename, options trace_opts)
+    : opts(trace_opts), ring(trace_opts.capacity), output(std::move(filename))
+{
+  assert(opts.period > 0);
+  assert(opts.capacity > 0);
+}
+
+champsim::pipeline_tracer::~pipeline_tracer() { flush(); }
+
+bool champsim::pipeline_tracer::is_sampled(uint64_t instr_id) const
+{
+  return instr_id >= opts.begin && instr_id < opts.end && (instr_id - opts.begin) % opts.period == 0;
+}
+
+auto champsim::pipeline_tracer::slot(uint64_t instr_id) -> record& { return ring.at(((instr_id - opts.begin) / opts.period) % std::size(ring)); }
+
+void champsim::pipeline_tracer::stamp(stage s, const ooo_model_instr& instr, time_point time)
+{
+  if (!is_sampled(instr.instr_id)) {
+    return;
+  }
+
+  auto& rec = slot(instr.instr_id);
+  if (s == stage::fetch) {
+    if (rec.live) {
+      ++num_dropped;
+      return;
+    }
+
+    rec = record{};
+    rec.live = true;
+    rec.instr_id = instr.instr_id;
+    rec.ip = instr.ip.to<uint64_t>();
+    if (!std::empty(instr.source_memory)) {
+      rec.load_address = instr.source_memory.front().to<uint64_t>();
+    }
+    if (!std::empty(instr.destination_memory)) {
+      rec.store_address = instr.destination_memory.front().to<uint64_t>();
+    }
+    rec.is_branch = instr.is_branch;
+  }
+
+  if (!rec.live || rec.instr_id != instr.instr_id) {
+    return;
+  }
+
+  rec.stamps.at(static_cast<std::size_t>(s)) = time;
+
+  if (s == stage::retire) {
+    write(rec);
+    rec.live = false;
+  }
+}
+
+void champsim::pipeline_tracer::write(const record& rec)
+{
+  auto stamp_of = [&rec](stage s) {
+    return tick(rec.stamps.at(static_cast<std::size_t>(s)));
+  };
+  auto out = std::back_inserter(pending);
+
+  // The seven stages of O3PipeView are fixed, so the other stages are described with the instruction
+  fmt::format_to(out, "O3PipeView:fetch:{}:0x{:016x}:0:{}:", stamp_of(stage::fetch), rec.ip, rec.instr_id);
+  if (rec.load_address.has_value()) {
+    fmt::format_to(out, "load 0x{:x}", rec.load_address.value());
+  } else if (rec.store_address.has_value()) {
+    fmt::format_to(out, "store 0x{:x}", rec.store_address.value());
+  } else {
+    fmt::format_to(out, "{}", rec.is_branch ? "branch" : "op");
+  }
+  for (auto [s, name] : {std::pair{stage::fetch_issue, "fetch-issue"}, std::pair{stage::fetch_complete, "fetch-complete"},
+                         std::pair{stage::memory_return, "memory-return"}}) {
+    if (rec.stamps.at(static_cast<std::size_t>(s)).has_value()) {
+      fmt::format_to(out, " {} {}", name, stamp_of(s));
+    }
+  }
+  fmt::format_to(out, "\n");
+
+  fmt::format_to(out, "O3PipeView:decode:{}\n", stamp_of(stage::decode));
+  // The core renames registers as it schedules, so placement in the ROB is shown as rename, and scheduling as dispatch
+  fmt::format_to(out, "O3PipeView:rename:{}\n", stamp_of(stage::dispatch));
+  fmt::format_to(out, "O3PipeView:dispatch:{}\n", stamp_of(stage::schedule));
+  fmt::format_to(out, "O3PipeView:issue:{}\n", stamp_of(stage::execute));
+  fmt::format_to(out, "O3PipeView:complete:{}\n", stamp_of(stage::complete));
+  fmt::format_to(out, "O3PipeView:retire:{}:store:0\n", stamp_of(stage::retire));
+
+  if (std::size(pending) >= FLUSH_SIZE) {
+    flush();
+  }
+}
+
+void champsim::pipeline_tracer::flush()
+{
+  output.write(pending.data(), static_cast<std::streamsize>(std::size(pending)));
+  pending.clear();
+}
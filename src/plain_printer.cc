@@ -14,7 +14,9 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <cmath>
+#include <iterator>
 #include <numeric>
 #include <ratio>
 #include <string_view> // for string_view
@@ -23,6 +25,7 @@
 #include <fmt/chrono.h>
 #include <fmt/core.h>
 #include <fmt/ostream.h>
+#include <fmt/ranges.h>
 
 #include "stats_printer.h"
 
@@ -50,6 +53,12 @@ std::vector<std::string> champsim::plain_printer::format(O3_CPU::stats_type stat
   std::vector<std::string> lines{};
   lines.push_back(fmt::format("{} cumulative IPC: {} instructions: {} cycles: {}", stats.name, ::print_ratio(stats.instrs(), stats.cycles()), stats.instrs(),
                               stats.cycles()));
+  if (std::size(stats.thread_end_instrs) > 1) {
+    for (std::size_t thread = 0; thread < std::size(stats.thread_end_instrs); ++thread) {
+      lines.push_back(fmt::format("{} thread {} cumulative IPC: {} instructions: {}", stats.name, thread,
+                                  ::print_ratio(stats.thread_instrs(thread), stats.cycles()), stats.thread_instrs(thread)));
+    }
+  }
 
   lines.push_back(fmt::format("{} Branch Prediction Accuracy: {}% MPKI: {} Average ROB Occupancy at Mispredict: {}", stats.name,
                               ::print_ratio(100 * (total_branch - total_mispredictions), total_branch),
@@ -62,6 +71,53 @@ std::vector<std::string> champsim::plain_printer::format(O3_CPU::stats_type stat
                                 ::print_ratio(std::kilo::num * stats.branch_type_misses.value_or(idx, 0), stats.instrs())));
   }
 
+  if (stats.store_buffer_stores > 0) {
+    lines.push_back(fmt::format("{} STORE BUFFER STORES: {:10d} WRITES: {:10d} COALESCING RATIO: {} FULL STALLS: {:10d} FORWARDS: {:10d}", stats.name,
+                                stats.store_buffer_stores, stats.store_buffer_writes, ::print_ratio(stats.store_buffer_stores, stats.store_buffer_writes),
+                                stats.store_buffer_full_stalls, stats.store_buffer_forwards));
+  }
+
+  if (stats.wrong_path_episodes > 0) {
+    lines.push_back(fmt::format("{} WRONG PATH EPISODES: {:10d} FETCHES: {:10d} LOADS: {:10d}", stats.name, stats.wrong_path_episodes,
+                                stats.wrong_path_fetches, stats.wrong_path_loads));
+  }
+
+  if (auto ports = stats.port_issues.get_keys(); !std::empty(ports)) {
+    std::vector<std::string> issues{};
+    std::transform(std::begin(ports), std::end(ports), std::back_inserter(issues),
+                   [&stats](auto port) { return fmt::format("{}: {}", port, stats.port_issues.at(port)); });
+    lines.push_back(fmt::format("{} EXECUTION PORT ISSUES {}", stats.name, fmt::join(issues, " ")));
+
+    std::vector<std::string> contention{};
+    for (std::size_t op = 0; op < std::size(op_class_names); ++op) {
+      contention.push_back(fmt::format("{}: {}", op_class_names.at(op), stats.port_contention.value_or(static_cast<op_class>(op), 0)));
+    }
+    lines.push_back(fmt::format("{} EXECUTION PORT CONTENTION {}", stats.name, fmt::join(contention, " ")));
+  }
+
+  if (stats.ftq_occupancy > 0 || stats.fdip_prefetches > 0) {
+    lines.push_back(fmt::format("{} FTQ AVERAGE OCCUPANCY: {} FDIP PREFETCHES: {:10d} AVERAGE LEAD: {} cycles UNPREFETCHED: {:10d}", stats.name,
+                                ::print_ratio(stats.ftq_occupancy, stats.cycles()), stats.fdip_prefetches,
+                                ::print_ratio(stats.fdip_lead_cycles, stats.fdip_prefetches), stats.fdip_unprefetched));
+  }
+
+  if (stats.dependence_predicted_waits > 0 || stats.dependence_false_waits > 0 || stats.dependence_violations > 0) {
+    lines.push_back(fmt::format("{} MEMORY DEPENDENCE PREDICTED WAITS: {:10d} FALSE WAITS: {:10d} VIOLATIONS: {:10d}", stats.name,
+                                stats.dependence_predicted_waits, stats.dependence_false_waits, stats.dependence_violations));
+  }
+
+  if (stats.value_predictions > 0) {
+    lines.push_back(fmt::format("{} VALUE PREDICTIONS: {:10d} MISPREDICTIONS: {:10d} ACCURACY: {}", stats.name, stats.value_predictions,
+                                stats.value_mispredictions,
+                                ::print_ratio(stats.value_predictions - stats.value_mispredictions, stats.value_predictions)));
+  }
+
+  if (stats.address_predictions > 0) {
+    lines.push_back(fmt::format("{} ADDRESS PREDICTIONS: {:10d} MISPREDICTIONS: {:10d} ACCURACY: {}", stats.name, stats.address_predictions,
+                                stats.address_mispredictions,
+                                ::print_ratio(stats.address_predictions - stats.address_mispredictions, stats.address_predictions)));
+  }
+
   return lines;
 }
 
@@ -122,6 +178,59 @@ std::vector<std::string> champsim::plain_printer::format(CACHE::stats_type stats
     uint64_t total_downstream_demands = total_mshr_return - stats.mshr_return.value_or(std::pair{access_type::PREFETCH, cpu}, mshr_return_value_type{});
     lines.push_back(
         fmt::format("cpu{}->{} AVERAGE MISS LATENCY: {} cycles", cpu, stats.name, ::print_ratio(stats.total_miss_latency_cycles, total_downstream_demands)));
+
+    if (stats.sectors_per_tag > 1) {
+      misses_value_type total_sector_misses = 0;
+      for (const auto type : {access_type::LOAD, access_type::RFO, access_type::PREFETCH, access_type::WRITE, access_type::TRANSLATION}) {
+        total_sector_misses += stats.sector_misses.value_or(std::pair{type, cpu}, misses_value_type{});
+      }
+      lines.push_back(fmt::format("cpu{}->{} SECTOR MISS: {:10d} TAG MISS: {:10d}", cpu, stats.name, total_sector_misses, total_misses - total_sector_misses));
+    }
+
+    if (cpu < std::size(stats.partition_ways) && cpu < std::size(stats.partition_occupancy)) {
+      lines.push_back(fmt::format("cpu{}->{} PARTITION WAYS: {:3d} OCCUPANCY: {:10d}", cpu, stats.name, stats.partition_ways.at(cpu),
+                                  stats.partition_occupancy.at(cpu)));
+    }
+  }
+
+  if (stats.banks > 1) {
+    lines.push_back(fmt::format("{} BANKS: {} BANK CONFLICT STALLS: {:10d}", stats.name, stats.banks, stats.bank_conflict_stalls));
+  }
+
+  if (stats.sectors_per_tag > 1) {
+    lines.push_back(fmt::format("{} SECTORS PER TAG: {} SECTOR WRITEBACKS: {:10d}", stats.name, stats.sectors_per_tag, stats.sector_writebacks));
+  }
+
+  if (stats.has_directory) {
+    lines.push_back(fmt::format("{} DIRECTORY INVALIDATIONS: {:10d} DOWNGRADES: {:10d} COHERENCE MISSES: {:10d}", stats.name, stats.invalidations_sent,
+                                stats.downgrades_sent, stats.coherence_misses));
+  }
+
+  if (stats.coherence_upgrades > 0 || stats.probes_received > 0) {
+    lines.push_back(fmt::format("{} COHERENCE UPGRADES: {:10d} PROBES: {:10d} PROBE WRITEBACKS: {:10d}", stats.name, stats.coherence_upgrades,
+                                stats.probes_received, stats.probe_writebacks));
+  }
+
+  if (stats.back_invalidations > 0 || stats.inclusion_victims > 0) {
+    lines.push_back(fmt::format("{} BACK-INVALIDATIONS: {:10d} INCLUSION VICTIMS: {:10d}", stats.name, stats.back_invalidations, stats.inclusion_victims));
+  }
+
+  if (!std::empty(stats.partition_ways)) {
+    lines.push_back(fmt::format("{} REPARTITIONS: {:10d}", stats.name, stats.repartitions));
+  }
+
+  if (stats.victim_buffer_entries > 0) {
+    lines.push_back(fmt::format("{} VICTIM BUFFER ENTRIES: {:3d} HIT: {:10d} INSERT: {:10d} DISPLACED: {:10d}", stats.name, stats.victim_buffer_entries,
+                                stats.victim_buffer_hits, stats.victim_buffer_inserts, stats.victim_buffer_displaced));
+  }
+
+  if (stats.is_set_sampled()) {
+    auto sampled_accesses = stats.sampled_hits + stats.sampled_misses;
+    lines.push_back(fmt::format("{} SET SAMPLING: {}/{} SETS SAMPLED ACCESS: {:10d} MISS: {:10d} SCALED ACCESS: {:10.0f} MISS: {:10.0f}", stats.name,
+                                stats.sampled_sets, stats.total_sets, sampled_accesses, stats.sampled_misses,
+                                std::ceil(sampled_accesses) * stats.sampling_scale(), std::ceil(stats.sampled_misses) * stats.sampling_scale()));
+    lines.push_back(fmt::format("{} SAMPLED MISS RATIO: {:.4g} +/- {:.4g} (95% confidence)", stats.name, stats.sampled_miss_ratio(),
+                                stats.sampled_miss_ratio_confidence()));
   }
 
   return lines;
@@ -156,9 +265,22 @@ std::vector<std::string> champsim::plain_printer::format(champsim::phase_stats&
   std::vector<std::string> lines{};
   lines.push_back(fmt::format("=== {} ===", stats.name));
 
+  // The threads are named only if some CPU runs more than one trace
+  const auto& cpus = stats.trace_cpus;
+  const bool smt = std::adjacent_find(std::begin(cpus), std::end(cpus)) != std::end(cpus);
+  for (std::size_t trace = 0; trace < std::size(stats.trace_names); ++trace) {
+    if (smt) {
+      auto cpu = cpus.at(trace);
+      auto thread = trace - static_cast<std::size_t>(std::distance(std::begin(cpus), std::lower_bound(std::begin(cpus), std::end(cpus), cpu)));
+      lines.push_back(fmt::format("CPU {} thread {} runs {}", cpu, thread, stats.trace_names.at(trace)));
+    } else {
+      lines.push_back(fmt::format("CPU {} runs {}", trace, stats.trace_names.at(trace)));
+    }
+  }
+
   int i = 0;
-  for (auto tn : stats.trace_names) {
-    lines.push_back(fmt::format("CPU {} runs {}", i++, tn));
+  for (auto length : stats.warmup_instructions) {
+    lines.push_back(fmt::format("CPU {} warmed up for {} instructions", i++, length));
   }
 
   if (NUM_CPUS > 1) {
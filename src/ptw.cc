@@ -129,6 +129,7 @@ long PageTableWalker::operate()
   std::for_each(std::cbegin(lower_level->returned), std::cend(lower_level->returned), [this](const auto& pkt) { this->finish_packet(pkt); });
   progress += std::distance(std::cbegin(lower_level->returned), std::cend(lower_level->returned));
   lower_level->returned.clear();
+  lower_level->probes.clear(); // Page table entries are not kept coherent
 
   std::vector<mshr_type> next_steps{};
 
@@ -2,41 +2,48 @@
 
 #include <cassert>
 
-RegisterAllocator::RegisterAllocator(size_t num_physical_registers)
+RegisterAllocator::RegisterAllocator(size_t num_physical_registers, std::size_t num_threads)
+    : frontend_RAT(ARCH_REGISTERS * num_threads, -1), backend_RAT(ARCH_REGISTERS * num_threads, -1) // default value for no mapping
 {
   assert(num_physical_registers <= std::numeric_limits<PHYSICAL_REGISTER_ID>::max());
   for (size_t i = 0; i < num_physical_registers; ++i) {
     free_registers.push(static_cast<PHYSICAL_REGISTER_ID>(i));
   }
   physical_register_file = std::vector<physical_register>(num_physical_registers, {0, 0, false, false});
-  frontend_RAT.fill(-1); // default value for no mapping
-  backend_RAT.fill(-1);
 }
 
-PHYSICAL_REGISTER_ID RegisterAllocator::rename_dest_register(int16_t reg, champsim::program_ordered<ooo_model_instr>::id_type producer_id)
+std::size_t RegisterAllocator::arch_index(int16_t reg, std::size_t thread)
+{
+  assert(reg >= 0 && static_cast<std::size_t>(reg) < ARCH_REGISTERS);
+  return thread * ARCH_REGISTERS + static_cast<std::size_t>(reg);
+}
+
+PHYSICAL_REGISTER_ID RegisterAllocator::rename_dest_register(int16_t reg, champsim::program_ordered<ooo_model_instr>::id_type producer_id, std::size_t thread)
 {
   assert(!free_registers.empty());
 
+  auto arch_reg = arch_index(reg, thread);
   PHYSICAL_REGISTER_ID phys_reg = free_registers.front();
   free_registers.pop();
-  frontend_RAT[reg] = phys_reg;
-  physical_register_file.at(phys_reg) = {(uint16_t)reg, producer_id, false, true}; // arch_reg_index, valid, busy
+  frontend_RAT[arch_reg] = phys_reg;
+  physical_register_file.at(phys_reg) = {(uint16_t)arch_reg, producer_id, false, true}; // arch_reg_index, valid, busy
 
   return phys_reg;
 }
 
-PHYSICAL_REGISTER_ID RegisterAllocator::rename_src_register(int16_t reg)
+PHYSICAL_REGISTER_ID RegisterAllocator::rename_src_register(int16_t reg, std::size_t thread)
 {
-  PHYSICAL_REGISTER_ID phys = frontend_RAT[reg];
+  auto arch_reg = arch_index(reg, thread);
+  PHYSICAL_REGISTER_ID phys = frontend_RAT[arch_reg];
 
   if (phys < 0) {
     // allocate the register if it hasn't yet been mapped
     // (common due to the traces being slices in the middle of a program)
     phys = free_registers.front();
     free_registers.pop();
-    frontend_RAT[reg] = phys;
-    backend_RAT[reg] = phys;                                          // we assume this register's last write has been committed
-    physical_register_file.at(phys) = {(uint16_t)reg, 0, true, true}; // arch_reg_index, producing_inst_id, valid, busy
+    frontend_RAT[arch_reg] = phys;
+    backend_RAT[arch_reg] = phys;                                       // we assume this register's last write has been committed
+    physical_register_file.at(phys) = {(uint16_t)arch_reg, 0, true, true}; // arch_reg_index, producing_inst_id, valid, busy
   }
 
   return phys;
@@ -48,6 +55,12 @@ void RegisterAllocator::complete_dest_register(PHYSICAL_REGISTER_ID physreg)
   physical_register_file.at(physreg).valid = true;
 }
 
+void RegisterAllocator::invalidate_dest_register(PHYSICAL_REGISTER_ID physreg)
+{
+  // the value of the physical register will be written again
+  physical_register_file.at(physreg).valid = false;
+}
+
 void RegisterAllocator::retire_dest_register(PHYSICAL_REGISTER_ID physreg)
 {
   // grab the arch reg index, find old phys reg in backend RAT
@@ -71,7 +84,7 @@ void RegisterAllocator::free_register(PHYSICAL_REGISTER_ID physreg)
 
 bool RegisterAllocator::isValid(PHYSICAL_REGISTER_ID physreg) const { return physical_register_file.at(physreg).valid; }
 
-bool RegisterAllocator::isAllocated(PHYSICAL_REGISTER_ID archreg) const { return frontend_RAT[archreg] != -1; }
+bool RegisterAllocator::isAllocated(PHYSICAL_REGISTER_ID archreg, std::size_t thread) const { return frontend_RAT[arch_index(archreg, thread)] != -1; }
 
 unsigned long RegisterAllocator::count_free_registers() const { return std::size(free_registers); }
 
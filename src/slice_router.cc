@@ -0,0 +1,182 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "slice_router.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <utility>
+#include <fmt/core.h>
+
+#include "champsim.h"
+#include "deadlock.h"
+#include "util/bits.h" // for lg2, next_pow2
+
+champsim::slice_router::slice_router(std::string name, champsim::chrono::picoseconds clock_period_, std::vector<channel_type*> upper_levels,
+                                     std::vector<std::vector<channel_type*>> slice_levels, long latency, slice_hash hash, champsim::data::bits offset_bits)
+    : champsim::operable(clock_period_), NAME(std::move(name)), NUM_SLICE(std::empty(slice_levels) ? 1 : std::size(slice_levels.front())),
+      ROUTE_LATENCY(clock_period_ * latency), HASH(hash), OFFSET_BITS(offset_bits)
+{
+  assert(std::size(upper_levels) == std::size(slice_levels));
+  std::transform(std::begin(upper_levels), std::end(upper_levels), std::begin(slice_levels), std::back_inserter(ports), [this](auto ul, auto slices) {
+    assert(std::size(slices) == NUM_SLICE);
+    port_type port{ul, std::move(slices)};
+    for (auto* queue : {&port.RQ, &port.WQ, &port.PQ}) {
+      queue->per_slice.resize(NUM_SLICE);
+    }
+    return port;
+  });
+}
+
+std::size_t champsim::slice_router::get_slice(champsim::address address) const
+{
+  if (NUM_SLICE == 1) {
+    return 0;
+  }
+
+  auto block = address.slice_upper(OFFSET_BITS).to<uint64_t>();
+  if (HASH == slice_hash::multiplicative) {
+    constexpr uint64_t multiplier = 0x9e3779b97f4a7c15; // 2^64 divided by the golden ratio
+    return static_cast<std::size_t>(((block * multiplier) >> 32) % NUM_SLICE);
+  }
+
+  const auto fold_width = champsim::lg2(champsim::next_pow2(NUM_SLICE));
+  uint64_t folded = 0;
+  for (; block != 0; block >>= fold_width) {
+    folded ^= block & champsim::bitmask(champsim::data::bits{fold_width});
+  }
+  return static_cast<std::size_t>(folded % NUM_SLICE);
+}
+
+auto champsim::slice_router::route(const channel_type* upper_level, champsim::address address) const -> channel_type*
+{
+  auto port = std::find_if(std::begin(ports), std::end(ports), [upper_level](const auto& x) { return x.upper_level == upper_level; });
+  if (port == std::end(ports)) {
+    return nullptr;
+  }
+  return port->slices.at(get_slice(address));
+}
+
+auto champsim::slice_router::slice_channels(const channel_type* upper_level) const -> std::vector<channel_type*>
+{
+  auto port = std::find_if(std::begin(ports), std::end(ports), [upper_level](const auto& x) { return x.upper_level == upper_level; });
+  if (port == std::end(ports)) {
+    return {};
+  }
+  return port->slices;
+}
+
+template <typename F, typename G>
+long champsim::slice_router::accept_requests(std::deque<request_type>& source, routed_queue_type& queue, const std::vector<channel_type*>& slices,
+                                             F&& occupancy_func, G&& size_func)
+{
+  // Accept from the upper level, in order, only while the slice of the next packet has room for it and for the packets already held for it
+  long progress{0};
+  while (!std::empty(source)) {
+    auto slice = get_slice(source.front().address);
+    auto* channel = slices.at(slice);
+    if (std::invoke(occupancy_func, channel) + queue.per_slice.at(slice) >= std::invoke(size_func, channel)) {
+      break;
+    }
+
+    queue.packets.push_back(routed_type<request_type>{source.front(), current_time + ROUTE_LATENCY});
+    ++queue.per_slice.at(slice);
+    source.pop_front();
+    ++progress;
+  }
+  return progress;
+}
+
+template <typename F>
+long champsim::slice_router::route_requests(routed_queue_type& queue, const std::vector<channel_type*>& slices, F&& add_func)
+{
+  // A slice that refuses a packet blocks the later packets to the same slice, but not those to the others
+  std::vector<bool> blocked(NUM_SLICE, false);
+  long progress{0};
+  for (auto it = std::begin(queue.packets); it != std::end(queue.packets) && it->event_cycle <= current_time;) {
+    auto slice = get_slice(it->packet.address);
+    if (!blocked.at(slice) && std::invoke(add_func, slices.at(slice), it->packet)) {
+      it = queue.packets.erase(it);
+      --queue.per_slice.at(slice);
+      ++progress;
+    } else {
+      blocked.at(slice) = true;
+      ++it;
+    }
+  }
+  return progress;
+}
+
+long champsim::slice_router::route_responses(port_type& port)
+{
+  long progress{0};
+  for (auto* slice : port.slices) {
+    std::transform(std::begin(slice->returned), std::end(slice->returned), std::back_inserter(port.returned),
+                   [ready = current_time + ROUTE_LATENCY](const auto& response) { return routed_type<response_type>{response, ready}; });
+    progress += static_cast<long>(std::size(slice->returned));
+    slice->returned.clear();
+
+    // Probes from a directory in the slice are passed through without delay
+    std::move(std::begin(slice->probes), std::end(slice->probes), std::back_inserter(port.upper_level->probes));
+    progress += static_cast<long>(std::size(slice->probes));
+    slice->probes.clear();
+  }
+
+  auto ready_end = std::find_if(std::begin(port.returned), std::end(port.returned), [time = current_time](const auto& x) { return x.event_cycle > time; });
+  std::transform(std::begin(port.returned), ready_end, std::back_inserter(port.upper_level->returned), [](const auto& x) { return x.packet; });
+  progress += std::distance(std::begin(port.returned), ready_end);
+  port.returned.erase(std::begin(port.returned), ready_end);
+
+  return progress;
+}
+
+long champsim::slice_router::operate()
+{
+  long progress{0};
+
+  for (auto& port : ports) {
+    auto* ul = port.upper_level;
+    ul->check_collision();
+
+    progress += accept_requests(ul->RQ, port.RQ, port.slices, &channel_type::rq_occupancy, &channel_type::rq_size);
+    progress += accept_requests(ul->WQ, port.WQ, port.slices, &channel_type::wq_occupancy, &channel_type::wq_size);
+    progress += accept_requests(ul->PQ, port.PQ, port.slices, &channel_type::pq_occupancy, &channel_type::pq_size);
+
+    progress += route_requests(port.RQ, port.slices, &channel_type::add_rq);
+    progress += route_requests(port.WQ, port.slices, &channel_type::add_wq);
+    progress += route_requests(port.PQ, port.slices, &channel_type::add_pq);
+    progress += route_responses(port);
+  }
+
+  return progress;
+}
+
+// LCOV_EXCL_START Exclude the following function from LCOV
+void champsim::slice_router::print_deadlock()
+{
+  std::string_view q_writer{"instr_id: {} address: {} slice: {} event_cycle: {}"};
+  auto q_entry_pack = [this](const auto& entry) {
+    return std::tuple{entry.packet.instr_id, entry.packet.address, get_slice(entry.packet.address), entry.event_cycle.time_since_epoch() / clock_period};
+  };
+
+  for (const auto& port : ports) {
+    champsim::range_print_deadlock(port.RQ.packets, NAME + "_router_RQ", q_writer, q_entry_pack);
+    champsim::range_print_deadlock(port.WQ.packets, NAME + "_router_WQ", q_writer, q_entry_pack);
+    champsim::range_print_deadlock(port.PQ.packets, NAME + "_router_PQ", q_writer, q_entry_pack);
+  }
+}
+// LCOV_EXCL_STOP
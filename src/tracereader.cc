@@ -54,19 +54,28 @@ champsim::tracereader get_tracereader_for_type(std::string fname, uint8_t cpu)
 template <typename T, typename S>
 using repeatable_reader_t = champsim::repeatable<champsim::bulk_tracereader<T, S>, uint8_t, std::string>;
 
-champsim::tracereader get_tracereader(const std::string& fname, uint8_t cpu, bool is_cloudsuite, bool repeat)
+namespace
 {
-  if (is_cloudsuite && repeat) {
-    return champsim::get_tracereader_for_type<repeatable_reader_t, cloudsuite_instr>(fname, cpu);
+template <typename T>
+champsim::tracereader get_tracereader_for_format(const std::string& fname, uint8_t cpu, bool repeat)
+{
+  if (repeat) {
+    return champsim::get_tracereader_for_type<repeatable_reader_t, T>(fname, cpu);
   }
 
-  if (is_cloudsuite && !repeat) {
-    return champsim::get_tracereader_for_type<champsim::bulk_tracereader, cloudsuite_instr>(fname, cpu);
+  return champsim::get_tracereader_for_type<champsim::bulk_tracereader, T>(fname, cpu);
+}
+} // namespace
+
+champsim::tracereader get_tracereader(const std::string& fname, uint8_t cpu, bool is_cloudsuite, bool has_load_values, bool repeat)
+{
+  if (is_cloudsuite) {
+    return get_tracereader_for_format<cloudsuite_instr>(fname, cpu, repeat);
   }
 
-  if (!is_cloudsuite && repeat) {
-    return champsim::get_tracereader_for_type<repeatable_reader_t, input_instr>(fname, cpu);
+  if (has_load_values) {
+    return get_tracereader_for_format<value_instr>(fname, cpu, repeat);
   }
 
-  return champsim::get_tracereader_for_type<champsim::bulk_tracereader, input_instr>(fname, cpu);
+  return get_tracereader_for_format<input_instr>(fname, cpu, repeat);
 }
@@ -0,0 +1,75 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "victim_buffer.h"
+
+#include <cassert>
+
+champsim::victim_buffer::victim_buffer(std::size_t size, champsim::data::bits tag_offset) : SIZE(size), TAG_OFFSET(tag_offset)
+{
+  assert(size > 0);
+  index.reserve(size);
+}
+
+uint64_t champsim::victim_buffer::get_key(champsim::address addr) const { return addr.slice_upper(TAG_OFFSET).to<uint64_t>(); }
+
+champsim::cache_block* champsim::victim_buffer::find(champsim::address addr)
+{
+  auto found = index.find(get_key(addr));
+  return found == std::end(index) ? nullptr : &*found->second;
+}
+
+champsim::cache_block champsim::victim_buffer::take(champsim::address addr)
+{
+  auto found = index.find(get_key(addr));
+  if (found == std::end(index)) {
+    return {};
+  }
+
+  auto retval = *found->second;
+  entries.erase(found->second);
+  index.erase(found);
+  return retval;
+}
+
+champsim::cache_block* champsim::victim_buffer::next_displaced()
+{
+  if (std::size(entries) < SIZE) {
+    return nullptr;
+  }
+  return &entries.back();
+}
+
+champsim::cache_block champsim::victim_buffer::insert(const champsim::cache_block& block)
+{
+  assert(block.valid);
+  assert(find(block.address) == nullptr);
+
+  champsim::cache_block displaced{};
+  if (std::size(entries) >= SIZE) {
+    displaced = entries.back();
+    index.erase(get_key(displaced.address));
+    entries.pop_back();
+  }
+
+  entries.push_front(block);
+  index.emplace(get_key(block.address), std::begin(entries));
+  return displaced;
+}
+
+std::size_t champsim::victim_buffer::size() const { return std::size(entries); }
+
+std::size_t champsim::victim_buffer::capacity() const { return SIZE; }
@@ -0,0 +1,173 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "way_partitioner.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <numeric>
+
+#include "util/bits.h" // for next_pow2
+
+champsim::way_partitioner::way_partitioner(std::size_t num_cpus, long sets, long ways, long umon_sets, uint64_t interval)
+    : NUM_SET(sets), NUM_WAY(ways),
+      NUM_UMON_SET(std::clamp(static_cast<long>(champsim::next_pow2(static_cast<uint64_t>(std::max(umon_sets, 1L)))), 1L, std::max(sets, 1L))),
+      INTERVAL(interval), shadow_tags(num_cpus, std::vector<std::vector<uint64_t>>(static_cast<std::size_t>(NUM_UMON_SET))),
+      stack_hits(num_cpus, std::vector<uint64_t>(static_cast<std::size_t>(ways), 0)), last_used(static_cast<std::size_t>(sets * ways), 0),
+      allocation(num_cpus, 0)
+{
+  // Begin with the ways divided evenly
+  for (long way = 0; way < NUM_WAY && !std::empty(allocation); ++way) {
+    ++allocation.at(static_cast<std::size_t>(way) % std::size(allocation));
+  }
+}
+
+long champsim::way_partitioner::get_umon_index(long set) const
+{
+  const auto stride = std::max(NUM_SET / NUM_UMON_SET, 1L);
+  return (set % stride == 0) ? set / stride : -1;
+}
+
+void champsim::way_partitioner::access(uint32_t cpu, long set, champsim::block_number block)
+{
+  const auto umon_idx = get_umon_index(set);
+  if (cpu >= std::size(shadow_tags) || umon_idx < 0) {
+    return;
+  }
+
+  auto& tags = shadow_tags.at(cpu).at(static_cast<std::size_t>(umon_idx));
+  auto tag = block.to<uint64_t>();
+  auto found = std::find(std::begin(tags), std::end(tags), tag);
+  if (found != std::end(tags)) {
+    ++stack_hits.at(cpu).at(static_cast<std::size_t>(std::distance(std::begin(tags), found)));
+    tags.erase(found);
+  }
+
+  tags.insert(std::begin(tags), tag);
+  if (static_cast<long>(std::size(tags)) > NUM_WAY) {
+    tags.pop_back();
+  }
+}
+
+void champsim::way_partitioner::touch(long set, long way) { last_used.at(static_cast<std::size_t>(set * NUM_WAY + way)) = ++access_count; }
+
+bool champsim::way_partitioner::cycle()
+{
+  if (INTERVAL > 0 && ++cycle_count % INTERVAL == 0) {
+    repartition();
+    return true;
+  }
+  return false;
+}
+
+uint64_t champsim::way_partitioner::marginal_hits(std::size_t cpu, long from, long to) const
+{
+  const auto& hits = stack_hits.at(cpu);
+  return std::accumulate(std::next(std::begin(hits), from), std::next(std::begin(hits), to), uint64_t{0});
+}
+
+void champsim::way_partitioner::repartition()
+{
+  const auto num_cpus = static_cast<long>(std::size(allocation));
+  if (num_cpus == 0 || num_cpus > NUM_WAY) {
+    return; // Not every CPU can be given a way
+  }
+
+  // Every CPU gets at least one way
+  std::vector<long> next_allocation(std::size(allocation), 1);
+  long balance = NUM_WAY - num_cpus;
+
+  // Lookahead: give the next ways to the CPU with the greatest utility per way, over any number of the remaining ways
+  while (balance > 0) {
+    double best_utility = 0;
+    std::size_t best_cpu = 0;
+    long best_ways = 0;
+    for (std::size_t cpu = 0; cpu < std::size(next_allocation); ++cpu) {
+      for (long ways = 1; ways <= balance; ++ways) {
+        auto utility = static_cast<double>(marginal_hits(cpu, next_allocation[cpu], next_allocation[cpu] + ways)) / static_cast<double>(ways);
+        if (utility > best_utility) {
+          best_utility = utility;
+          best_cpu = cpu;
+          best_ways = ways;
+        }
+      }
+    }
+
+    // If no CPU would gain from more ways, divide the rest evenly
+    if (best_ways == 0) {
+      for (std::size_t cpu = 0; balance > 0; cpu = (cpu + 1) % std::size(next_allocation), --balance) {
+        ++next_allocation[cpu];
+      }
+      break;
+    }
+
+    next_allocation[best_cpu] += best_ways;
+    balance -= best_ways;
+  }
+
+  assert(std::accumulate(std::begin(next_allocation), std::end(next_allocation), 0L) == NUM_WAY);
+  allocation = next_allocation;
+
+  // Age the monitors, so that the next interval is weighted more heavily
+  for (auto& hits : stack_hits) {
+    std::for_each(std::begin(hits), std::end(hits), [](auto& x) { x /= 2; });
+  }
+}
+
+long champsim::way_partitioner::enforce(uint32_t cpu, long set, long proposed, const champsim::cache_block* current_set) const
+{
+  if (cpu >= std::size(allocation) || proposed >= NUM_WAY) {
+    return proposed;
+  }
+
+  std::vector<long> occupancy(std::size(allocation), 0);
+  for (long way = 0; way < NUM_WAY; ++way) {
+    if (current_set[way].valid && current_set[way].cpu < std::size(occupancy)) {
+      ++occupancy[current_set[way].cpu];
+    }
+  }
+
+  const bool under_allocation = occupancy[cpu] < allocation[cpu];
+  auto eligible = [&](long way) {
+    const auto& candidate = current_set[way];
+    if (!candidate.valid) {
+      return true;
+    }
+    if (!under_allocation) {
+      return candidate.cpu == cpu;
+    }
+    return candidate.cpu != cpu && (candidate.cpu >= std::size(occupancy) || occupancy[candidate.cpu] > allocation[candidate.cpu]);
+  };
+
+  if (eligible(proposed)) {
+    return proposed;
+  }
+
+  // Fall back to the least recently used of the eligible ways
+  long victim = proposed;
+  uint64_t oldest = std::numeric_limits<uint64_t>::max();
+  for (long way = 0; way < NUM_WAY; ++way) {
+    auto used = last_used.at(static_cast<std::size_t>(set * NUM_WAY + way));
+    if (eligible(way) && used < oldest) {
+      victim = way;
+      oldest = used;
+    }
+  }
+  return victim;
+}
+
+auto champsim::way_partitioner::get_allocation() const -> const std::vector<long>& { return allocation; }
@@ -0,0 +1,78 @@
+#include <catch.hpp>
+
+#include "msl/optgen.h"
+
+SCENARIO("OPTgen reconstructs the hits of the optimal policy")
+{
+  GIVEN("An occupancy vector for a set with one way")
+  {
+    champsim::msl::optgen uut{1, 8};
+
+    auto t_a = uut.now();
+    uut.add_access(); // A
+    auto t_b = uut.now();
+    uut.add_access(); // B
+
+    WHEN("A is reused")
+    {
+      auto hit_a = uut.should_cache(t_a);
+      uut.add_access();
+
+      THEN("OPT keeps A in the only way") { REQUIRE(hit_a); }
+
+      AND_WHEN("B is reused")
+      {
+        auto hit_b = uut.should_cache(t_b);
+
+        THEN("OPT could not have kept B at the same time")
+        {
+          REQUIRE_FALSE(hit_b);
+          REQUIRE(uut.hits() == 1);
+          REQUIRE(uut.accesses() == 3);
+        }
+      }
+    }
+  }
+
+  GIVEN("An occupancy vector with a short window")
+  {
+    champsim::msl::optgen uut{4, 2};
+    auto t_a = uut.now();
+    uut.add_access();
+    uut.add_access();
+    uut.add_access();
+
+    THEN("Accesses that are older than the window are not covered") { REQUIRE_FALSE(uut.in_window(t_a)); }
+  }
+}
+
+SCENARIO("The reuse sampler replaces its oldest entry")
+{
+  GIVEN("A full sampler")
+  {
+    champsim::msl::reuse_sampler uut{2};
+    REQUIRE_FALSE(uut.insert(0xa, 1, 10).valid);
+    REQUIRE_FALSE(uut.insert(0xb, 2, 11).valid);
+
+    WHEN("The first block is accessed again")
+    {
+      auto* entry = uut.find(0xa);
+      REQUIRE(entry != nullptr);
+      entry->last_access = 12;
+
+      AND_WHEN("A new block is inserted")
+      {
+        auto evicted = uut.insert(0xc, 3, 13);
+
+        THEN("The least recently accessed block is replaced")
+        {
+          REQUIRE(evicted.valid);
+          REQUIRE(evicted.tag == 0xb);
+          REQUIRE(evicted.signature == 2);
+          REQUIRE(uut.find(0xb) == nullptr);
+          REQUIRE(uut.find(0xa) != nullptr);
+        }
+      }
+    }
+  }
+}
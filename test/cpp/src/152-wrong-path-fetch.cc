@@ -0,0 +1,174 @@
+#include <catch.hpp>
+
+#include "cache.h"
+#include "defaults.hpp"
+#include "instr.h"
+#include "mocks.hpp"
+#include "ooo_cpu.h"
+
+namespace
+{
+bool fetched(const do_nothing_MRC& mock, champsim::address addr)
+{
+  return std::find(std::begin(mock.addresses), std::end(mock.addresses), addr) != std::end(mock.addresses);
+}
+} // namespace
+
+SCENARIO("A misprediction fetches down the predicted path")
+{
+  GIVEN("A core that fetches four blocks down the wrong path, and a branch with an unknown target that resolves at decode")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D, mock_ll;
+    CACHE l1i{champsim::cache_builder{champsim::defaults::default_l1i}.name("152-l1i").lower_level(&mock_ll.queues)};
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .l1i(&l1i)
+                   .register_file_size(8)
+                   .l1i_bandwidth(champsim::bandwidth::maximum_type{1})
+                   .l1d_bandwidth(champsim::bandwidth::maximum_type{1})
+                   .wrong_path_depth(4)
+                   .set_wrong_path_loads()
+                   .decode_latency(50)};
+    uut.warmup = false;
+
+    // A load was seen in the block that follows the branch
+    auto load = champsim::test::instruction_with_ip_and_source_memory(champsim::address{0x1048}, champsim::address{0xcafe0000});
+    uut.do_record_wrong_path_loads(load);
+
+    auto branch = champsim::test::branch_instruction_with_ip(champsim::address{0x1000});
+    branch.instr_id = 1;
+    branch.branch_target = champsim::address{0x2000};
+    uut.threads.front().input_queue.push_back(branch);
+
+    WHEN("The branch is fetched, but has not resolved")
+    {
+      for (int i = 0; i < 6; ++i) {
+        for (auto op : std::array<champsim::operable*, 3>{{&uut, &mock_L1I, &mock_L1D}})
+          op->_operate();
+      }
+
+      THEN("The blocks after the branch are fetched")
+      {
+        REQUIRE(uut.sim_stats.wrong_path_episodes == 1);
+        REQUIRE(uut.sim_stats.wrong_path_fetches == 4);
+        for (uint64_t block = 1; block <= 4; ++block) {
+          CHECK(fetched(mock_L1I, champsim::address{0x1000 + block * BLOCK_SIZE}));
+        }
+      }
+
+      THEN("The load from a fetched block is replayed")
+      {
+        REQUIRE(uut.sim_stats.wrong_path_loads == 1);
+        REQUIRE(fetched(mock_L1D, champsim::address{0xcafe0000}));
+      }
+    }
+  }
+}
+
+SCENARIO("A load on the wrong path is replayed from its own IP")
+{
+  GIVEN("A core that has seen two loads in a block of code")
+  {
+    do_nothing_MRC mock_L1I;
+    champsim::channel data_queues{};
+    O3_CPU uut{champsim::core_builder{}.fetch_queues(&mock_L1I.queues).data_queues(&data_queues).set_wrong_path_loads()};
+    uut.warmup = false;
+
+    uut.do_record_wrong_path_loads(champsim::test::instruction_with_ip_and_source_memory(champsim::address{0x1048}, champsim::address{0xcafe0000}));
+    uut.do_record_wrong_path_loads(champsim::test::instruction_with_ip_and_source_memory(champsim::address{0x1064}, champsim::address{0xbeef0000}));
+
+    WHEN("The block is fetched down the wrong path")
+    {
+      uut.do_wrong_path_loads(champsim::block_number{champsim::address{0x1040}});
+
+      THEN("Each load is issued with the IP that it was seen from")
+      {
+        REQUIRE(std::size(data_queues.RQ) == 2);
+        auto issued = [&](champsim::address ip, champsim::address addr) {
+          return std::any_of(std::begin(data_queues.RQ), std::end(data_queues.RQ), [&](const auto& x) { return x.ip == ip && x.v_address == addr; });
+        };
+        CHECK(issued(champsim::address{0x1048}, champsim::address{0xcafe0000}));
+        CHECK(issued(champsim::address{0x1064}, champsim::address{0xbeef0000}));
+      }
+    }
+  }
+}
+
+SCENARIO("The wrong path is squashed when the branch resolves")
+{
+  GIVEN("A core that may fetch far down the wrong path")
+  {
+    constexpr std::size_t depth = 1000;
+    do_nothing_MRC mock_L1I, mock_L1D, mock_ll;
+    CACHE l1i{champsim::cache_builder{champsim::defaults::default_l1i}.name("152-l1i").lower_level(&mock_ll.queues)};
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .l1i(&l1i)
+                   .register_file_size(8)
+                   .l1i_bandwidth(champsim::bandwidth::maximum_type{1})
+                   .l1d_bandwidth(champsim::bandwidth::maximum_type{1})
+                   .wrong_path_depth(depth)
+                   .set_wrong_path_loads()};
+    uut.warmup = false;
+
+    auto branch = champsim::test::branch_instruction_with_ip(champsim::address{0x1000});
+    branch.instr_id = 1;
+    branch.branch_target = champsim::address{0x2000};
+    uut.threads.front().input_queue.push_back(branch);
+
+    WHEN("The branch retires")
+    {
+      for (int i = 0; i < 200 && uut.num_retired < 1; ++i) {
+        for (auto op : std::array<champsim::operable*, 3>{{&uut, &mock_L1I, &mock_L1D}})
+          op->_operate();
+      }
+
+      THEN("Fetch down the wrong path has stopped")
+      {
+        REQUIRE(uut.num_retired == 1);
+        REQUIRE_FALSE(uut.wrong_path.has_value());
+        REQUIRE(uut.sim_stats.wrong_path_fetches < depth);
+      }
+    }
+  }
+}
+
+SCENARIO("Without a wrong-path depth, fetch stalls on a misprediction")
+{
+  GIVEN("A core that does not fetch down the wrong path")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D, mock_ll;
+    CACHE l1i{champsim::cache_builder{champsim::defaults::default_l1i}.name("152-l1i").lower_level(&mock_ll.queues)};
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .l1i(&l1i)
+                   .register_file_size(8)
+                   .l1i_bandwidth(champsim::bandwidth::maximum_type{1})
+                   .l1d_bandwidth(champsim::bandwidth::maximum_type{1})
+                   .wrong_path_depth(0)
+                   .set_wrong_path_loads()};
+    uut.warmup = false;
+
+    auto branch = champsim::test::branch_instruction_with_ip(champsim::address{0x1000});
+    branch.instr_id = 1;
+    branch.branch_target = champsim::address{0x2000};
+    uut.threads.front().input_queue.push_back(branch);
+
+    WHEN("The branch is fetched")
+    {
+      for (int i = 0; i < 6; ++i) {
+        for (auto op : std::array<champsim::operable*, 3>{{&uut, &mock_L1I, &mock_L1D}})
+          op->_operate();
+      }
+
+      THEN("Only the branch is fetched")
+      {
+        REQUIRE(uut.sim_stats.wrong_path_fetches == 0);
+        REQUIRE(mock_L1I.packet_count() == 1);
+      }
+    }
+  }
+}
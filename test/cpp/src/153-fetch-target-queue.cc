@@ -0,0 +1,157 @@
+#include <catch.hpp>
+
+#include "cache.h"
+#include "defaults.hpp"
+#include "instr.h"
+#include "mocks.hpp"
+#include "ooo_cpu.h"
+
+namespace
+{
+// Instructions in sequence, with a given number in each block
+std::vector<ooo_model_instr> sequential_blocks(std::size_t blocks, std::size_t per_block)
+{
+  std::vector<ooo_model_instr> retval;
+  uint64_t id = 1;
+  for (std::size_t block = 0; block < blocks; ++block) {
+    for (std::size_t i = 0; i < per_block; ++i) {
+      auto instr = champsim::test::instruction_with_ip(champsim::address{0x10000 + block * BLOCK_SIZE + i * 4});
+      instr.instr_id = id++;
+      retval.push_back(instr);
+    }
+  }
+  return retval;
+}
+} // namespace
+
+SCENARIO("The branch predictor runs ahead of fetch and prefetches the blocks it predicts")
+{
+  GIVEN("A decoupled core with a small fetch buffer, and instructions spread over eight blocks")
+  {
+    do_nothing_MRC mock_L1I{100}, mock_L1D, mock_ll;
+    CACHE l1i{champsim::cache_builder{champsim::defaults::default_l1i}.name("153-l1i").lower_level(&mock_ll.queues)};
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .l1i(&l1i)
+                   .register_file_size(8)
+                   .fetch_width(champsim::bandwidth::maximum_type{2})
+                   .ifetch_buffer_size(2)
+                   .l1i_bandwidth(champsim::bandwidth::maximum_type{4})
+                   .ftq_size(4)};
+
+    auto instrs = sequential_blocks(8, 4);
+    uut.threads.front().input_queue.insert(std::end(uut.threads.front().input_queue), std::begin(instrs), std::end(instrs));
+
+    WHEN("The fetch of the first block is delayed")
+    {
+      for (int i = 0; i < 10; ++i) {
+        uut._operate();
+      }
+
+      THEN("The FTQ fills to its size, ahead of the fetch buffer")
+      {
+        REQUIRE(std::size(uut.FTQ) == 4);
+        REQUIRE(std::size(uut.IFETCH_BUFFER) == 2);
+      }
+
+      THEN("The blocks in the FTQ are prefetched into the L1I")
+      {
+        REQUIRE(uut.sim_stats.fdip_prefetches == 4);
+        REQUIRE(l1i.sim_stats.pf_requested == 4);
+        REQUIRE(uut.sim_stats.ftq_occupancy > 0);
+      }
+    }
+  }
+}
+
+SCENARIO("The branch predictor stops at a misprediction, but fetch continues up to the branch")
+{
+  GIVEN("A decoupled core and a branch that will be mispredicted")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D, mock_ll;
+    CACHE l1i{champsim::cache_builder{champsim::defaults::default_l1i}.name("153-l1i").lower_level(&mock_ll.queues)};
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .l1i(&l1i)
+                   .register_file_size(8)
+                   .fetch_width(champsim::bandwidth::maximum_type{2})
+                   .ifetch_buffer_size(16)
+                   .l1i_bandwidth(champsim::bandwidth::maximum_type{4})
+                   .ftq_size(4)
+                   .decode_latency(50)};
+    uut.warmup = false;
+
+    auto first = champsim::test::instruction_with_ip(champsim::address{0x1000});
+    first.instr_id = 1;
+    auto branch = champsim::test::branch_instruction_with_ip(champsim::address{0x1004});
+    branch.instr_id = 2;
+    branch.branch_target = champsim::address{0x2000};
+    auto after = champsim::test::instruction_with_ip(champsim::address{0x2000});
+    after.instr_id = 3;
+    uut.threads.front().input_queue.insert(std::end(uut.threads.front().input_queue), {first, branch, after});
+
+    WHEN("The instructions are predicted")
+    {
+      uut.predict_fetch_targets();
+
+      THEN("The fetch block ends at the branch, and the instruction after it is not predicted")
+      {
+        REQUIRE(std::size(uut.FTQ) == 1);
+        REQUIRE(uut.FTQ.front().instrs == 2);
+        REQUIRE(uut.FTQ.front().ends_taken);
+        REQUIRE(uut.ftq_predicted_instrs == 2);
+      }
+    }
+
+    WHEN("The core operates")
+    {
+      for (int i = 0; i < 5; ++i) {
+        uut._operate();
+      }
+
+      THEN("The instructions up to the branch are fetched")
+      {
+        REQUIRE(std::empty(uut.FTQ));
+        REQUIRE(std::size(uut.IFETCH_BUFFER) + std::size(uut.DECODE_BUFFER) == 2);
+        REQUIRE(std::size(uut.threads.front().input_queue) == 1);
+      }
+    }
+  }
+}
+
+SCENARIO("A core without an FTQ predicts branches as they are fetched")
+{
+  GIVEN("A core with an FTQ size of zero")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D, mock_ll;
+    CACHE l1i{champsim::cache_builder{champsim::defaults::default_l1i}.name("153-l1i").lower_level(&mock_ll.queues)};
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .l1i(&l1i)
+                   .register_file_size(8)
+                   .fetch_width(champsim::bandwidth::maximum_type{2})
+                   .ifetch_buffer_size(2)
+                   .l1i_bandwidth(champsim::bandwidth::maximum_type{4})
+                   .ftq_size(0)};
+
+    auto instrs = sequential_blocks(4, 4);
+    uut.threads.front().input_queue.insert(std::end(uut.threads.front().input_queue), std::begin(instrs), std::end(instrs));
+
+    WHEN("The core operates")
+    {
+      for (int i = 0; i < 10; ++i) {
+        uut._operate();
+      }
+
+      THEN("Nothing is prefetched")
+      {
+        REQUIRE(std::empty(uut.FTQ));
+        REQUIRE(uut.sim_stats.fdip_prefetches == 0);
+        REQUIRE(l1i.sim_stats.pf_requested == 0);
+      }
+    }
+  }
+}
@@ -137,6 +137,16 @@ SCENARIO("The scheduler can detect RAW hazards")
         // REQUIRE(std::all_of(std::next(std::begin(uut.ROB)), std::next(std::begin(uut.ROB), schedule_width), [old_cycle](ooo_model_instr x){ return
         // x.event_cycle == old_cycle + schedule_latency; })); REQUIRE(uut.ROB.back().event_cycle == old_cycle);
       }
+
+      AND_WHEN("The scheduled instructions execute")
+      {
+        for (auto i = 0; i < 10; ++i) {
+          for (auto op : std::array<champsim::operable*, 3>{{&uut, &mock_L1I, &mock_L1D}})
+            op->_operate();
+        }
+
+        THEN("The scheduler resumes with the instruction it could not reach") { REQUIRE(uut.num_retired == schedule_width + 1); }
+      }
     }
   }
 }
@@ -291,6 +301,60 @@ SCENARIO("The scheduler handles WAW hazards")
   }
 }
 
+SCENARIO("Instructions that are woken by their producers are selected in program order")
+{
+  GIVEN("A producer, a consumer, and an independent instruction, with one instruction executed each cycle")
+  {
+    constexpr unsigned schedule_width = 128;
+
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .schedule_width(champsim::bandwidth::maximum_type{schedule_width})
+                   .register_file_size(128)
+                   .schedule_latency(0)
+                   .execute_latency(0)
+                   .execute_width(champsim::bandwidth::maximum_type{1})
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)};
+
+    uut.ROB.push_back(champsim::test::instruction_with_ip(1));
+    uut.ROB.at(0).instr_id = 1;
+    uut.ROB.at(0).destination_registers.push_back(5);
+    uut.ROB.push_back(champsim::test::instruction_with_ip(2));
+    uut.ROB.at(1).instr_id = 2;
+    uut.ROB.at(1).source_registers.push_back(5);
+    uut.ROB.push_back(champsim::test::instruction_with_ip(3));
+    uut.ROB.at(2).instr_id = 3;
+    for (auto& instr : uut.ROB)
+      instr.ready_time = champsim::chrono::clock::time_point{};
+
+    WHEN("The producer executes")
+    {
+      // Schedule, then execute the producer
+      for (int i = 0; i < 2; ++i) {
+        for (auto op : std::array<champsim::operable*, 3>{{&uut, &mock_L1I, &mock_L1D}})
+          op->_operate();
+      }
+      REQUIRE(uut.ROB.at(0).executed);
+      REQUIRE_FALSE(uut.ROB.at(1).executed);
+      REQUIRE_FALSE(uut.ROB.at(2).executed);
+
+      AND_WHEN("The producer completes")
+      {
+        for (auto op : std::array<champsim::operable*, 3>{{&uut, &mock_L1I, &mock_L1D}})
+          op->_operate();
+
+        THEN("The consumer is selected before the younger instruction")
+        {
+          REQUIRE(uut.ROB.at(0).completed);
+          REQUIRE(uut.ROB.at(1).executed);
+          REQUIRE_FALSE(uut.ROB.at(2).executed);
+        }
+      }
+    }
+  }
+}
+
 TEST_CASE("ooo_cpu Benchmarks") {
   BENCHMARK_ADVANCED("ooo_cpu::operate()")(Catch::Benchmark::Chronometer meter){
     constexpr unsigned schedule_width = 128;
@@ -0,0 +1,114 @@
+#include <catch.hpp>
+
+#include "instr.h"
+#include "instr_pool.h"
+
+SCENARIO("Instructions stay in place while they are passed between queues")
+{
+  GIVEN("A pool and two queues")
+  {
+    champsim::instr_pool pool{4};
+    champsim::instr_queue first{pool, 4};
+    champsim::instr_queue second{pool, 4};
+
+    for (uint64_t id = 1; id <= 3; ++id) {
+      auto instr = champsim::test::instruction_with_ip(champsim::address{0x1000 + 4 * id});
+      instr.instr_id = id;
+      first.push_back(instr);
+    }
+    auto* address = &first.at(1);
+
+    WHEN("The instructions are moved to the second queue by handle")
+    {
+      while (!std::empty(first)) {
+        second.push_back_handle(first.pop_front_handle());
+      }
+
+      THEN("The instructions are in the same order, and have not moved")
+      {
+        REQUIRE(std::empty(first));
+        REQUIRE(std::size(second) == 3);
+        REQUIRE(second.front().instr_id == 1);
+        REQUIRE(second.back().instr_id == 3);
+        REQUIRE(&second.at(1) == address);
+        REQUIRE(std::size(pool) == 3);
+      }
+    }
+
+    WHEN("Instructions are removed from the front")
+    {
+      first.erase(std::cbegin(first), std::next(std::cbegin(first), 2));
+
+      THEN("They are released from the pool")
+      {
+        REQUIRE(std::size(first) == 1);
+        REQUIRE(first.front().instr_id == 3);
+        REQUIRE(std::size(pool) == 1);
+      }
+    }
+  }
+}
+
+SCENARIO("A queue wraps around its ring and grows past its capacity")
+{
+  GIVEN("A queue with a capacity of two")
+  {
+    champsim::instr_pool pool{2};
+    champsim::instr_queue uut{pool, 2};
+
+    WHEN("More instructions are added than the capacity, with some removed along the way")
+    {
+      std::vector<uint64_t> expected;
+      for (uint64_t id = 1; id <= 7; ++id) {
+        auto instr = champsim::test::instruction_with_ip(champsim::address{0x1000 + 4 * id});
+        instr.instr_id = id;
+        uut.push_back(instr);
+        expected.push_back(id);
+        if (id % 3 == 0) {
+          uut.pop_front();
+          expected.erase(std::begin(expected));
+        }
+      }
+
+      THEN("The queue holds the remaining instructions in order")
+      {
+        std::vector<uint64_t> ids;
+        std::transform(std::begin(uut), std::end(uut), std::back_inserter(ids), [](const auto& x) { return x.instr_id; });
+        REQUIRE(ids == expected);
+        REQUIRE(std::size(pool) == std::size(expected));
+        REQUIRE(pool.capacity() >= std::size(expected));
+      }
+    }
+  }
+}
+
+SCENARIO("Instructions may be removed from the middle of a queue")
+{
+  GIVEN("A queue that has wrapped around its ring")
+  {
+    champsim::instr_pool pool{4};
+    champsim::instr_queue uut{pool, 4};
+    for (uint64_t id = 1; id <= 6; ++id) {
+      auto instr = champsim::test::instruction_with_ip(champsim::address{0x1000 + 4 * id});
+      instr.instr_id = id;
+      uut.push_back(instr);
+      if (id <= 2) {
+        uut.pop_front();
+      }
+    }
+
+    WHEN("The even instructions are removed")
+    {
+      auto removed = uut.remove_if([](const auto& x) { return x.instr_id % 2 == 0; });
+
+      THEN("The others remain in order, and the removed instructions are released")
+      {
+        std::vector<uint64_t> ids;
+        std::transform(std::begin(uut), std::end(uut), std::back_inserter(ids), [](const auto& x) { return x.instr_id; });
+        REQUIRE(removed == 2);
+        REQUIRE(ids == std::vector<uint64_t>{3, 5});
+        REQUIRE(std::size(pool) == 2);
+      }
+    }
+  }
+}
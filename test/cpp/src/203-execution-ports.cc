@@ -0,0 +1,206 @@
+#include <catch.hpp>
+
+#include "instr.h"
+#include "mocks.hpp"
+#include "ooo_cpu.h"
+
+namespace
+{
+ooo_model_instr instruction_with_class(uint64_t id, unsigned char instr_class)
+{
+  value_instr i{};
+  i.ip = 0x1000 + 4 * id;
+  i.destination_registers[0] = 1;
+  i.source_registers[0] = 2;
+  i.instr_class = instr_class;
+  ooo_model_instr retval{0, i};
+  retval.instr_id = id;
+  return retval;
+}
+} // namespace
+
+SCENARIO("Instructions are classified from the trace")
+{
+  GIVEN("Instructions with and without a recorded class")
+  {
+    auto fp = instruction_with_class(1, champsim::INSTR_CLASS_FP);
+    auto slow = instruction_with_class(2, champsim::INSTR_CLASS_SLOW_ALU);
+    auto alu = champsim::test::instruction_with_registers(3);
+    auto load = champsim::test::instruction_with_ip_and_source_memory(champsim::address{0x1000}, champsim::address{0xcafe0000});
+    auto store = champsim::test::instruction_with_ip_and_destination_memory(champsim::address{0x1000}, champsim::address{0xcafe0000});
+    auto branch = champsim::test::branch_instruction_with_ip(champsim::address{0x1000});
+
+    THEN("Each has its class")
+    {
+      CHECK(fp.op == OP_FP);
+      CHECK(slow.op == OP_SLOW_ALU);
+      CHECK(alu.op == OP_ALU);
+      CHECK(load.op == OP_LOAD);
+      CHECK(store.op == OP_STORE);
+      CHECK(branch.op == OP_BRANCH);
+    }
+  }
+
+  GIVEN("An instruction in the standard format that writes the highest register numbers")
+  {
+    input_instr i{};
+    i.ip = 0x1000;
+    i.destination_registers[0] = 254;
+    i.destination_registers[1] = 255;
+    ooo_model_instr instr{0, i};
+
+    THEN("Both registers are renamed, and the instruction is an ALU instruction")
+    {
+      REQUIRE(instr.destination_registers == std::vector<PHYSICAL_REGISTER_ID>{254, 255});
+      REQUIRE(instr.op == OP_ALU);
+    }
+  }
+}
+
+SCENARIO("Without execution ports, the recorded class is ignored")
+{
+  GIVEN("A core without ports, and an instruction recorded as floating point")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}.fetch_queues(&mock_L1I.queues).data_queues(&mock_L1D.queues).op_latency(OP_FP, 4)};
+    auto fp = instruction_with_class(1, champsim::INSTR_CLASS_FP);
+
+    WHEN("The instruction is fetched")
+    {
+      uut.do_init_instruction(fp);
+
+      THEN("It is an ALU instruction") { REQUIRE(fp.op == OP_ALU); }
+    }
+  }
+}
+
+SCENARIO("An execution port issues one instruction each cycle")
+{
+  GIVEN("A core with one ALU port, and two ready ALU instructions")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .execute_width(champsim::bandwidth::maximum_type{4})
+                   .execute_latency(1)
+                   .add_execution_port({OP_ALU, OP_BRANCH})
+                   .add_execution_port({OP_LOAD})
+                   .add_execution_port({OP_SLOW_ALU, OP_FP, OP_STORE})};
+
+    auto first = instruction_with_class(1, champsim::INSTR_CLASS_ALU);
+    auto second = instruction_with_class(2, champsim::INSTR_CLASS_ALU);
+    uut.ready_instrs = {&first, &second};
+
+    WHEN("The core executes")
+    {
+      uut.execute_instruction();
+
+      THEN("Only the oldest instruction issues, and the other waits for the port")
+      {
+        REQUIRE(first.executed);
+        REQUIRE_FALSE(second.executed);
+        REQUIRE(uut.sim_stats.port_issues.value_or(0, 0) == 1);
+        REQUIRE(uut.sim_stats.port_issues.value_or(1, 0) == 0);
+        REQUIRE(uut.sim_stats.port_contention.value_or(OP_ALU, 0) == 1);
+      }
+
+      AND_WHEN("The next cycle begins")
+      {
+        uut.current_time += uut.clock_period;
+        uut.execute_instruction();
+
+        THEN("The other instruction issues") { REQUIRE(second.executed); }
+      }
+    }
+  }
+}
+
+SCENARIO("An unpipelined class holds its port for its latency")
+{
+  GIVEN("A core with one port for an unpipelined slow ALU, and two ready slow ALU instructions")
+  {
+    constexpr unsigned latency = 4;
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .execute_width(champsim::bandwidth::maximum_type{4})
+                   .execute_latency(1)
+                   .add_execution_port({OP_SLOW_ALU})
+                   .add_execution_port({OP_ALU, OP_FP, OP_LOAD, OP_STORE, OP_BRANCH})
+                   .op_latency(OP_SLOW_ALU, latency)
+                   .unpipelined_op(OP_SLOW_ALU)};
+    uut.warmup = false;
+
+    auto first = instruction_with_class(1, champsim::INSTR_CLASS_SLOW_ALU);
+    auto second = instruction_with_class(2, champsim::INSTR_CLASS_SLOW_ALU);
+    uut.ready_instrs = {&first, &second};
+
+    WHEN("The core executes for several cycles")
+    {
+      const auto start_time = uut.current_time;
+      std::optional<champsim::chrono::clock::time_point> second_issue;
+      for (unsigned i = 0; i < 2 * latency && !second_issue.has_value(); ++i) {
+        uut.execute_instruction();
+        if (second.executed) {
+          second_issue = uut.current_time;
+        }
+        uut.current_time += uut.clock_period;
+      }
+
+      THEN("The first instruction takes the latency of its class")
+      {
+        REQUIRE(first.executed);
+        REQUIRE(first.ready_time == start_time + latency * uut.clock_period);
+      }
+
+      THEN("The second instruction issues once the first completes")
+      {
+        REQUIRE(second_issue.has_value());
+        REQUIRE(second_issue.value() == start_time + latency * uut.clock_period);
+        REQUIRE(uut.sim_stats.port_contention.value_or(OP_SLOW_ALU, 0) == latency);
+      }
+    }
+  }
+}
+
+SCENARIO("Without execution ports, instructions issue up to the execute width")
+{
+  GIVEN("A core without ports, and two ready ALU instructions")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .execute_width(champsim::bandwidth::maximum_type{4})
+                   .execute_latency(1)};
+
+    auto first = instruction_with_class(1, champsim::INSTR_CLASS_ALU);
+    auto second = instruction_with_class(2, champsim::INSTR_CLASS_ALU);
+    uut.ready_instrs = {&first, &second};
+
+    WHEN("The core executes")
+    {
+      uut.execute_instruction();
+
+      THEN("Both instructions issue")
+      {
+        REQUIRE(first.executed);
+        REQUIRE(second.executed);
+        REQUIRE(std::empty(uut.sim_stats.port_issues.get_keys()));
+      }
+    }
+  }
+}
+
+TEST_CASE("Every class must have an execution port")
+{
+  do_nothing_MRC mock_L1I, mock_L1D;
+  REQUIRE_THROWS_AS(O3_CPU{champsim::core_builder{}
+                             .fetch_queues(&mock_L1I.queues)
+                             .data_queues(&mock_L1D.queues)
+                             .add_execution_port({OP_ALU, OP_BRANCH, OP_LOAD, OP_STORE})
+                             .add_execution_port({OP_SLOW_ALU})},
+                    std::invalid_argument);
+}
@@ -0,0 +1,320 @@
+#include <catch.hpp>
+
+#include "instr.h"
+#include "mocks.hpp"
+#include "ooo_cpu.h"
+#include "register_allocator.h"
+
+namespace
+{
+ooo_model_instr instruction_on_thread(const O3_CPU& cpu, std::size_t thread, uint64_t id)
+{
+  auto instr = cpu.assign_to_thread(thread, champsim::test::instruction_with_ip(champsim::address{0x1000 + 4 * id}));
+  instr.instr_id = id;
+  return instr;
+}
+} // namespace
+
+SCENARIO("Each thread runs in its own address space")
+{
+  GIVEN("A core with two threads, and a load")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .threads(2)
+                   .register_file_size(16)
+                   .ifetch_buffer_size(8)
+                   .fetch_width(champsim::bandwidth::maximum_type{2})
+                   .rob_size(4)
+                   .dispatch_buffer_size(4)
+                   .dispatch_width(champsim::bandwidth::maximum_type{4})
+                   .retire_width(champsim::bandwidth::maximum_type{4})};
+    auto load = champsim::test::instruction_with_ip_and_source_memory(champsim::address{0x1000}, champsim::address{0xcafe0000});
+
+    WHEN("The load is given to each thread")
+    {
+      auto first = uut.assign_to_thread(0, load);
+      auto second = uut.assign_to_thread(1, load);
+
+      THEN("The first thread keeps the addresses of the trace")
+      {
+        REQUIRE(first.thread == 0);
+        REQUIRE(first.ip == champsim::address{0x1000});
+        REQUIRE(first.source_memory == std::vector{champsim::address{0xcafe0000}});
+      }
+
+      THEN("The addresses of the second thread are moved")
+      {
+        REQUIRE(second.thread == 1);
+        REQUIRE(second.ip == champsim::address{0x1000 | (uint64_t{1} << 48)});
+        REQUIRE(second.source_memory == std::vector{champsim::address{0xcafe0000 | (uint64_t{1} << 48)}});
+      }
+    }
+  }
+}
+
+SCENARIO("Round-robin fetch alternates between the threads")
+{
+  GIVEN("A core with two threads that fetch round robin, each with instructions to fetch")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .threads(2)
+                   .register_file_size(16)
+                   .ifetch_buffer_size(8)
+                   .fetch_width(champsim::bandwidth::maximum_type{2})
+                   .rob_size(4)
+                   .dispatch_buffer_size(4)
+                   .dispatch_width(champsim::bandwidth::maximum_type{4})
+                   .retire_width(champsim::bandwidth::maximum_type{4})
+                   .fetch_policy(champsim::thread_fetch_policy::round_robin)};
+    for (std::size_t thread = 0; thread < 2; ++thread) {
+      for (uint64_t id = 0; id < 4; ++id) {
+        uut.threads.at(thread).input_queue.push_back(instruction_on_thread(uut, thread, id));
+      }
+    }
+
+    WHEN("The core fetches for four cycles")
+    {
+      for (int i = 0; i < 4; ++i) {
+        uut.initialize_instruction();
+      }
+
+      THEN("The threads take turns, and the instructions are numbered in the order they were fetched")
+      {
+        std::vector<std::size_t> fetched_threads;
+        std::vector<uint64_t> fetched_ids;
+        for (const auto& instr : uut.IFETCH_BUFFER) {
+          fetched_threads.push_back(instr.thread);
+          fetched_ids.push_back(instr.instr_id);
+        }
+        REQUIRE(fetched_threads == std::vector<std::size_t>{0, 0, 1, 1, 0, 0, 1, 1});
+        REQUIRE(fetched_ids == std::vector<uint64_t>{0, 1, 2, 3, 4, 5, 6, 7});
+      }
+    }
+  }
+}
+
+SCENARIO("ICOUNT fetches for the thread with the fewest instructions in flight")
+{
+  GIVEN("A core with two threads, where the first has unexecuted instructions in the ROB")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .threads(2)
+                   .register_file_size(16)
+                   .ifetch_buffer_size(8)
+                   .fetch_width(champsim::bandwidth::maximum_type{2})
+                   .rob_size(4)
+                   .dispatch_buffer_size(4)
+                   .dispatch_width(champsim::bandwidth::maximum_type{4})
+                   .retire_width(champsim::bandwidth::maximum_type{4})
+                   .fetch_policy(champsim::thread_fetch_policy::icount)};
+    for (std::size_t thread = 0; thread < 2; ++thread) {
+      uut.threads.at(thread).input_queue.push_back(instruction_on_thread(uut, thread, 10));
+    }
+    for (uint64_t id = 0; id < 3; ++id) {
+      uut.ROB.push_back(instruction_on_thread(uut, 0, id));
+    }
+
+    THEN("The second thread is selected")
+    {
+      REQUIRE(uut.select_fetch_thread() == std::optional<std::size_t>{1});
+    }
+
+    WHEN("The second thread is stalled on a misprediction")
+    {
+      uut.threads.at(1).fetch_resume_time = uut.current_time + 10 * uut.clock_period;
+
+      THEN("The first thread is selected") { REQUIRE(uut.select_fetch_thread() == std::optional<std::size_t>{0}); }
+    }
+  }
+}
+
+SCENARIO("A stalled thread does not block retirement of the other")
+{
+  GIVEN("A ROB where the oldest instruction, from the first thread, has not completed")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .threads(2)
+                   .register_file_size(16)
+                   .ifetch_buffer_size(8)
+                   .fetch_width(champsim::bandwidth::maximum_type{2})
+                   .rob_size(4)
+                   .dispatch_buffer_size(4)
+                   .dispatch_width(champsim::bandwidth::maximum_type{4})
+                   .retire_width(champsim::bandwidth::maximum_type{4})};
+
+    uut.ROB.push_back(instruction_on_thread(uut, 0, 0));
+    uut.ROB.push_back(instruction_on_thread(uut, 1, 1));
+    uut.ROB.push_back(instruction_on_thread(uut, 0, 2));
+    uut.ROB.push_back(instruction_on_thread(uut, 1, 3));
+    uut.ROB.at(1).completed = true;
+    uut.ROB.at(2).completed = true;
+    uut.ROB.at(3).completed = true;
+
+    WHEN("The ROB retires")
+    {
+      auto retired = uut.retire_rob();
+
+      THEN("Only the instructions of the second thread retire")
+      {
+        REQUIRE(retired == 2);
+        REQUIRE(uut.threads.at(0).num_retired == 0);
+        REQUIRE(uut.threads.at(1).num_retired == 2);
+        REQUIRE(std::size(uut.ROB) == 2);
+        REQUIRE(uut.ROB.at(0).instr_id == 0);
+        REQUIRE(uut.ROB.at(1).instr_id == 2);
+      }
+    }
+  }
+}
+
+SCENARIO("Partitioned queues limit each thread to its share")
+{
+  GIVEN("Four instructions from one thread waiting to dispatch")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    auto partitioned = GENERATE(true, false);
+    auto builder = champsim::core_builder{}
+                       .fetch_queues(&mock_L1I.queues)
+                       .data_queues(&mock_L1D.queues)
+                       .threads(2)
+                       .register_file_size(16)
+                       .ifetch_buffer_size(8)
+                       .fetch_width(champsim::bandwidth::maximum_type{2})
+                       .rob_size(4)
+                       .dispatch_buffer_size(4)
+                       .dispatch_width(champsim::bandwidth::maximum_type{4})
+                       .retire_width(champsim::bandwidth::maximum_type{4});
+    if (partitioned) {
+      builder.set_partitioned_queues();
+    }
+    O3_CPU uut{builder};
+
+    for (uint64_t id = 0; id < 4; ++id) {
+      uut.DISPATCH_BUFFER.push_back(instruction_on_thread(uut, 0, id));
+    }
+
+    WHEN("The core dispatches")
+    {
+      uut.dispatch_instruction();
+
+      THEN("A partitioned ROB takes only half of them, and a shared ROB takes them all")
+      {
+        REQUIRE(std::size(uut.ROB) == (partitioned ? 2 : 4));
+      }
+    }
+  }
+}
+
+SCENARIO("A thread that cannot dispatch does not block the other")
+{
+  GIVEN("A dispatch buffer where the oldest instruction, from the first thread, is not ready")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .threads(2)
+                   .register_file_size(16)
+                   .ifetch_buffer_size(8)
+                   .fetch_width(champsim::bandwidth::maximum_type{2})
+                   .rob_size(4)
+                   .dispatch_buffer_size(4)
+                   .dispatch_width(champsim::bandwidth::maximum_type{4})
+                   .retire_width(champsim::bandwidth::maximum_type{4})};
+
+    for (uint64_t id = 0; id < 4; ++id) {
+      uut.DISPATCH_BUFFER.push_back(instruction_on_thread(uut, id % 2, id));
+    }
+    uut.DISPATCH_BUFFER.at(0).ready_time = uut.current_time + 10 * uut.clock_period;
+
+    WHEN("The core dispatches")
+    {
+      auto dispatched = uut.dispatch_instruction();
+
+      THEN("Only the instructions of the second thread dispatch, in order")
+      {
+        REQUIRE(dispatched == 2);
+        REQUIRE(std::size(uut.ROB) == 2);
+        REQUIRE(uut.ROB.at(0).instr_id == 1);
+        REQUIRE(uut.ROB.at(1).instr_id == 3);
+        REQUIRE(uut.ROB.count_of(1) == 2);
+      }
+
+      THEN("The first thread keeps its instructions in order")
+      {
+        REQUIRE(std::size(uut.DISPATCH_BUFFER) == 2);
+        REQUIRE(uut.DISPATCH_BUFFER.at(0).instr_id == 0);
+        REQUIRE(uut.DISPATCH_BUFFER.at(1).instr_id == 2);
+        REQUIRE(uut.DISPATCH_BUFFER.count_of(0) == 2);
+      }
+    }
+  }
+}
+
+TEST_CASE("A core with more than one thread may not fetch down the wrong path or have an FTQ")
+{
+  do_nothing_MRC mock_L1I, mock_L1D;
+  REQUIRE_THROWS_AS(O3_CPU{champsim::core_builder{}
+                             .fetch_queues(&mock_L1I.queues)
+                             .data_queues(&mock_L1D.queues)
+                             .threads(2)
+                             .register_file_size(16)
+                             .ifetch_buffer_size(8)
+                             .fetch_width(champsim::bandwidth::maximum_type{2})
+                             .rob_size(4)
+                             .dispatch_buffer_size(4)
+                             .dispatch_width(champsim::bandwidth::maximum_type{4})
+                             .retire_width(champsim::bandwidth::maximum_type{4})
+                             .wrong_path_depth(4)},
+                    std::invalid_argument);
+  REQUIRE_THROWS_AS(O3_CPU{champsim::core_builder{}
+                             .fetch_queues(&mock_L1I.queues)
+                             .data_queues(&mock_L1D.queues)
+                             .threads(2)
+                             .register_file_size(16)
+                             .ifetch_buffer_size(8)
+                             .fetch_width(champsim::bandwidth::maximum_type{2})
+                             .rob_size(4)
+                             .dispatch_buffer_size(4)
+                             .dispatch_width(champsim::bandwidth::maximum_type{4})
+                             .retire_width(champsim::bandwidth::maximum_type{4})
+                             .ftq_size(4)},
+                    std::invalid_argument);
+}
+
+SCENARIO("Each thread renames through its own RAT")
+{
+  GIVEN("A register allocator for two threads")
+  {
+    RegisterAllocator ra{16, 2};
+
+    WHEN("The first thread writes a register")
+    {
+      auto written = ra.rename_dest_register(5, 1, 0);
+
+      THEN("The register is mapped only for the first thread")
+      {
+        REQUIRE(ra.isAllocated(5, 0));
+        REQUIRE_FALSE(ra.isAllocated(5, 1));
+      }
+
+      THEN("A read of the register by the second thread does not see the write")
+      {
+        REQUIRE(ra.rename_src_register(5, 0) == written);
+        REQUIRE(ra.rename_src_register(5, 1) != written);
+      }
+    }
+  }
+}
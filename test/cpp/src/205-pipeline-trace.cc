@@ -0,0 +1,163 @@
+#include <catch.hpp>
+#include <filesystem>
+#include <sstream>
+
+#include "inf_stream.h"
+#include "instr.h"
+#include "mocks.hpp"
+#include "ooo_cpu.h"
+#include "pipeline_trace.h"
+
+namespace
+{
+std::string trace_file_name(std::string name) { return (std::filesystem::temp_directory_path() / name).string(); }
+
+// The lines of a compressed pipeline trace
+std::vector<std::string> read_trace(std::string filename)
+{
+  champsim::inf_istream<champsim::decomp_tags::gzip_tag_t<>> trace{filename};
+  std::string text;
+  std::array<char, 1024> buf;
+  do {
+    trace.read(std::data(buf), std::size(buf));
+    text.append(std::data(buf), static_cast<std::size_t>(trace.gcount()));
+  } while (!trace.eof());
+
+  std::vector<std::string> retval;
+  std::istringstream lines{text};
+  for (std::string line; std::getline(lines, line);) {
+    retval.push_back(line);
+  }
+  return retval;
+}
+
+// The instruction IDs of the fetch lines in a trace
+std::vector<uint64_t> traced_ids(const std::vector<std::string>& lines)
+{
+  std::vector<uint64_t> retval;
+  for (const auto& line : lines) {
+    if (line.rfind("O3PipeView:fetch:", 0) == 0) {
+      std::istringstream fields{line};
+      std::string field;
+      for (int i = 0; i < 6; ++i) {
+        std::getline(fields, field, ':');
+      }
+      retval.push_back(std::stoull(field));
+    }
+  }
+  return retval;
+}
+
+// The time of each stage of an instruction, in the order they are written
+std::vector<long long> stage_ticks(const std::vector<std::string>& lines, std::size_t instr)
+{
+  std::vector<long long> retval;
+  for (std::size_t i = instr * 7; i < (instr + 1) * 7; ++i) {
+    std::istringstream fields{lines.at(i)};
+    std::string field;
+    std::getline(fields, field, ':');
+    std::getline(fields, field, ':');
+    std::getline(fields, field, ':');
+    retval.push_back(std::stoll(field));
+  }
+  return retval;
+}
+
+ooo_model_instr instruction_with_id(uint64_t id)
+{
+  auto instr = champsim::test::instruction_with_ip(champsim::address{0x1000 + 4 * id});
+  instr.instr_id = id;
+  return instr;
+}
+
+void run_through_pipeline(champsim::pipeline_tracer& uut, const ooo_model_instr& instr, champsim::chrono::clock::time_point time)
+{
+  using stage = champsim::pipeline_tracer::stage;
+  for (auto s : {stage::fetch, stage::decode, stage::dispatch, stage::schedule, stage::execute, stage::complete, stage::retire}) {
+    uut.stamp(s, instr, time);
+  }
+}
+} // namespace
+
+SCENARIO("The pipeline tracer writes only the sampled instructions in its window")
+{
+  GIVEN("A tracer for every other instruction from 10 to 20")
+  {
+    const auto filename = trace_file_name("205-window.gz");
+    champsim::pipeline_tracer::options opts{};
+    opts.begin = 10;
+    opts.end = 20;
+    opts.period = 2;
+
+    WHEN("Thirty instructions pass through the pipeline")
+    {
+      {
+        champsim::pipeline_tracer uut{filename, opts};
+        for (uint64_t id = 0; id < 30; ++id) {
+          run_through_pipeline(uut, instruction_with_id(id), champsim::chrono::clock::time_point{});
+        }
+      }
+
+      THEN("The sampled instructions are in the trace")
+      {
+        auto lines = read_trace(filename);
+        REQUIRE(std::size(lines) == 5 * 7);
+        REQUIRE(traced_ids(lines) == std::vector<uint64_t>{10, 12, 14, 16, 18});
+      }
+    }
+  }
+
+  GIVEN("A tracer that can hold only one instruction in flight")
+  {
+    const auto filename = trace_file_name("205-full.gz");
+    champsim::pipeline_tracer::options opts{};
+    opts.capacity = 1;
+
+    WHEN("A second instruction is fetched before the first retires")
+    {
+      champsim::pipeline_tracer uut{filename, opts};
+      uut.stamp(champsim::pipeline_tracer::stage::fetch, instruction_with_id(0), champsim::chrono::clock::time_point{});
+      run_through_pipeline(uut, instruction_with_id(1), champsim::chrono::clock::time_point{});
+
+      THEN("The second instruction is not traced") { REQUIRE(uut.dropped() == 1); }
+    }
+  }
+}
+
+SCENARIO("A traced core records each instruction through its pipeline")
+{
+  GIVEN("A core with a pipeline tracer, and instructions to fetch")
+  {
+    const auto filename = trace_file_name("205-core.gz");
+    constexpr uint64_t num_instrs = 5;
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}.fetch_queues(&mock_L1I.queues).data_queues(&mock_L1D.queues).register_file_size(16)};
+    uut.warmup = false;
+    uut.pipeline_trace = std::make_unique<champsim::pipeline_tracer>(filename, champsim::pipeline_tracer::options{});
+    for (uint64_t id = 0; id < num_instrs; ++id) {
+      uut.threads.front().input_queue.push_back(instruction_with_id(id));
+    }
+
+    WHEN("The instructions retire")
+    {
+      for (int i = 0; i < 100 && uut.num_retired < static_cast<long long>(num_instrs); ++i) {
+        for (auto op : std::array<champsim::operable*, 3>{{&uut, &mock_L1I, &mock_L1D}}) {
+          op->_operate();
+        }
+      }
+      REQUIRE(uut.num_retired == num_instrs);
+      uut.pipeline_trace.reset();
+
+      THEN("Each instruction passes through the stages in order")
+      {
+        auto lines = read_trace(filename);
+        REQUIRE(traced_ids(lines) == std::vector<uint64_t>{0, 1, 2, 3, 4});
+        for (std::size_t i = 0; i < num_instrs; ++i) {
+          auto ticks = stage_ticks(lines, i);
+          REQUIRE(std::is_sorted(std::begin(ticks), std::end(ticks)));
+          REQUIRE(ticks.back() > ticks.front());
+        }
+      }
+    }
+  }
+}
@@ -66,3 +66,83 @@ SCENARIO("The core issues loads only after its registers are finished")
     }
   }
 }
+
+SCENARIO("A load waits on the youngest prior store to the same address")
+{
+  GIVEN("Two stores to the same address, followed by a load from it")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .dispatch_width(champsim::bandwidth::maximum_type{3})
+                   .rob_size(3)
+                   .lq_size(1)
+                   .sq_size(2)};
+
+    std::array instrs{champsim::test::instruction_with_ip_and_destination_memory(champsim::address{2000}, champsim::address{0xcafe0000}),
+                      champsim::test::instruction_with_ip_and_destination_memory(champsim::address{2004}, champsim::address{0xcafe0000}),
+                      champsim::test::instruction_with_ip_and_source_memory(champsim::address{2008}, champsim::address{0xcafe0000})};
+    for (uint64_t i = 0; i < std::size(instrs); ++i) {
+      instrs.at(i).instr_id = i + 1;
+      instrs.at(i).ready_time = champsim::chrono::clock::time_point{};
+      uut.DISPATCH_BUFFER.push_back(instrs.at(i));
+    }
+
+    WHEN("The instructions are dispatched")
+    {
+      for (auto op : std::array<champsim::operable*, 3>{{&uut, &mock_L1I, &mock_L1D}})
+        op->_operate();
+
+      THEN("The load depends on the younger store")
+      {
+        REQUIRE(std::size(uut.SQ) == 2);
+        REQUIRE(uut.LQ.at(0).has_value());
+        REQUIRE(uut.LQ.at(0)->producer_id == 2);
+      }
+    }
+  }
+}
+
+SCENARIO("A large load queue drains completely")
+{
+  GIVEN("A core with 256 load queue entries and a stream of loads, several to each block")
+  {
+    constexpr long long num_loads = 512;
+    do_nothing_MRC mock_L1I, mock_L1D{5};
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .dispatch_width(champsim::bandwidth::maximum_type{8})
+                   .execute_width(champsim::bandwidth::maximum_type{8})
+                   .lq_width(champsim::bandwidth::maximum_type{4})
+                   .retire_width(champsim::bandwidth::maximum_type{8})
+                   .rob_size(256)
+                   .lq_size(256)};
+    uut.begin_phase();
+
+    for (uint64_t i = 0; i < static_cast<uint64_t>(num_loads); ++i) {
+      auto instr = champsim::test::instruction_with_ip_and_source_memory(champsim::address{2000 + 4 * i}, champsim::address{0xcafe0000 + 16 * i});
+      instr.instr_id = i + 1;
+      instr.ready_time = champsim::chrono::clock::time_point{};
+      uut.DISPATCH_BUFFER.push_back(instr);
+    }
+
+    WHEN("The loads are run to completion")
+    {
+      for (int i = 0; i < 10000 && uut.num_retired < num_loads; ++i) {
+        for (auto op : std::array<champsim::operable*, 3>{{&uut, &mock_L1I, &mock_L1D}})
+          op->_operate();
+      }
+
+      THEN("Every load retires, and every load queue entry is free")
+      {
+        REQUIRE(uut.num_retired == num_loads);
+        REQUIRE(std::none_of(std::begin(uut.LQ), std::end(uut.LQ), [](const auto& x) { return x.has_value(); }));
+        REQUIRE(std::size(uut.lq_free_slots) == std::size(uut.LQ));
+        REQUIRE(std::empty(uut.lq_slots_by_instr));
+        REQUIRE(std::empty(uut.lq_slots_by_block));
+      }
+    }
+  }
+}
@@ -0,0 +1,144 @@
+#include <catch.hpp>
+
+#include "instr.h"
+#include "mocks.hpp"
+#include "ooo_cpu.h"
+
+namespace
+{
+void dispatch(O3_CPU& uut, ooo_model_instr instr, uint64_t id)
+{
+  instr.instr_id = id;
+  instr.ready_time = champsim::chrono::clock::time_point{};
+  uut.DISPATCH_BUFFER.push_back(instr);
+}
+
+void run(O3_CPU& uut, do_nothing_MRC& mock_L1I, do_nothing_MRC& mock_L1D)
+{
+  for (int i = 0; i < 100; ++i) {
+    for (auto op : std::array<champsim::operable*, 3>{{&uut, &mock_L1I, &mock_L1D}})
+      op->_operate();
+  }
+}
+} // namespace
+
+SCENARIO("The store buffer combines retired stores to the same block")
+{
+  GIVEN("Four stores to the same block")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    const auto entries = GENERATE(as<std::size_t>{}, 0, 4);
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .dispatch_width(champsim::bandwidth::maximum_type{4})
+                   .execute_width(champsim::bandwidth::maximum_type{4})
+                   .sq_width(champsim::bandwidth::maximum_type{4})
+                   .retire_width(champsim::bandwidth::maximum_type{4})
+                   .rob_size(4)
+                   .lq_size(1)
+                   .sq_size(4)
+                   .store_buffer_size(entries)
+                   .store_buffer_width(champsim::bandwidth::maximum_type{1})};
+    uut.begin_phase();
+
+    for (uint64_t i = 0; i < 4; ++i) {
+      dispatch(uut, champsim::test::instruction_with_ip_and_destination_memory(champsim::address{2000 + 4 * i}, champsim::address{0xcafe0000 + 8 * i}), i + 1);
+    }
+
+    WHEN("The stores retire")
+    {
+      run(uut, mock_L1I, mock_L1D);
+
+      THEN("The stores have all left the core")
+      {
+        REQUIRE(std::empty(uut.ROB));
+        REQUIRE(std::empty(uut.SQ));
+        REQUIRE(std::empty(uut.STORE_BUFFER));
+      }
+
+      THEN("A core without a store buffer writes each store, and a core with one writes the block once")
+      {
+        REQUIRE(mock_L1D.packet_count() == (entries == 0 ? 4 : 1));
+        REQUIRE(uut.sim_stats.store_buffer_stores == (entries == 0 ? 0 : 4));
+        REQUIRE(uut.sim_stats.store_buffer_coalesced == (entries == 0 ? 0 : 3));
+        REQUIRE(uut.sim_stats.store_buffer_writes == (entries == 0 ? 0 : 1));
+      }
+    }
+  }
+}
+
+SCENARIO("Retired stores stall when the store buffer is full")
+{
+  GIVEN("A store buffer of one entry that does not drain")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .dispatch_width(champsim::bandwidth::maximum_type{4})
+                   .execute_width(champsim::bandwidth::maximum_type{4})
+                   .sq_width(champsim::bandwidth::maximum_type{4})
+                   .retire_width(champsim::bandwidth::maximum_type{4})
+                   .rob_size(4)
+                   .lq_size(1)
+                   .sq_size(4)
+                   .store_buffer_size(1)
+                   .store_buffer_width(champsim::bandwidth::maximum_type{0})};
+    uut.begin_phase();
+
+    dispatch(uut, champsim::test::instruction_with_ip_and_destination_memory(champsim::address{2000}, champsim::address{0xcafe0000}), 1);
+    dispatch(uut, champsim::test::instruction_with_ip_and_destination_memory(champsim::address{2004}, champsim::address{0xbeef0000}), 2);
+
+    WHEN("Two stores to different blocks retire")
+    {
+      run(uut, mock_L1I, mock_L1D);
+
+      THEN("The second store waits in the store queue")
+      {
+        REQUIRE(std::size(uut.STORE_BUFFER) == 1);
+        REQUIRE(std::size(uut.SQ) == 1);
+        REQUIRE(uut.sim_stats.store_buffer_full_stalls > 0);
+        REQUIRE(mock_L1D.packet_count() == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("Loads are forwarded from the store buffer")
+{
+  GIVEN("A store that has retired into the store buffer")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .dispatch_width(champsim::bandwidth::maximum_type{4})
+                   .execute_width(champsim::bandwidth::maximum_type{4})
+                   .sq_width(champsim::bandwidth::maximum_type{4})
+                   .retire_width(champsim::bandwidth::maximum_type{4})
+                   .rob_size(4)
+                   .lq_size(1)
+                   .sq_size(4)
+                   .store_buffer_size(1)
+                   .store_buffer_width(champsim::bandwidth::maximum_type{0})};
+    uut.begin_phase();
+
+    dispatch(uut, champsim::test::instruction_with_ip_and_destination_memory(champsim::address{2000}, champsim::address{0xcafe0000}), 1);
+    run(uut, mock_L1I, mock_L1D);
+    REQUIRE(std::size(uut.STORE_BUFFER) == 1);
+
+    WHEN("A load from the same address is dispatched")
+    {
+      dispatch(uut, champsim::test::instruction_with_ip_and_source_memory(champsim::address{2004}, champsim::address{0xcafe0000}), 2);
+      run(uut, mock_L1I, mock_L1D);
+
+      THEN("The load completes without reaching the L1D")
+      {
+        REQUIRE(std::empty(uut.ROB));
+        REQUIRE(uut.sim_stats.store_buffer_forwards == 1);
+        REQUIRE(mock_L1D.packet_count() == 0);
+      }
+    }
+  }
+}
@@ -0,0 +1,326 @@
+#include <catch.hpp>
+#include <map>
+
+#include "../../../memory_dependence/store_sets/store_sets.h"
+#include "instr.h"
+#include "mocks.hpp"
+#include "modules.h"
+#include "ooo_cpu.h"
+
+namespace
+{
+std::map<O3_CPU*, uint64_t> scripted_predictions;
+std::map<O3_CPU*, std::vector<std::pair<champsim::address, champsim::address>>> reported_violations;
+} // namespace
+
+struct scripted_predictor : champsim::modules::memory_dependence_predictor {
+  using memory_dependence_predictor::memory_dependence_predictor;
+
+  uint64_t predict_dependence(champsim::address, uint64_t) { return ::scripted_predictions[intern_]; }
+  void dependence_violation(champsim::address load_ip, champsim::address store_ip) { ::reported_violations[intern_].emplace_back(load_ip, store_ip); }
+};
+
+namespace
+{
+constexpr unsigned violation_penalty = 20;
+
+// A store, then a load from the given address, in the ROB and scheduled into the LSQ
+void schedule_store_and_load(O3_CPU& uut, champsim::address store_addr, champsim::address load_addr)
+{
+  auto store = champsim::test::instruction_with_ip_and_destination_memory(champsim::address{2000}, store_addr);
+  store.instr_id = 1;
+  auto load = champsim::test::instruction_with_ip_and_source_memory(champsim::address{2004}, load_addr);
+  load.instr_id = 2;
+  uut.ROB.push_back(store);
+  uut.ROB.push_back(load);
+
+  for (auto& instr : uut.ROB) {
+    uut.do_memory_scheduling(instr);
+  }
+}
+
+std::optional<LSQ_ENTRY>& the_load(O3_CPU& uut)
+{
+  auto found = std::find_if(std::begin(uut.LQ), std::end(uut.LQ), [](const auto& x) { return x.has_value(); });
+  REQUIRE(found != std::end(uut.LQ));
+  return *found;
+}
+
+void issue_load(O3_CPU& uut)
+{
+  the_load(uut)->ready_time = uut.current_time;
+  uut.current_time += uut.clock_period;
+  uut.operate_lsq();
+}
+
+void execute_store(O3_CPU& uut)
+{
+  uut.SQ.front().ready_time = uut.current_time;
+  uut.operate_lsq();
+}
+
+bool lq_is_empty(const O3_CPU& uut)
+{
+  return std::none_of(std::begin(uut.LQ), std::end(uut.LQ), [](const auto& x) { return x.has_value(); });
+}
+} // namespace
+
+SCENARIO("A load that is not predicted to depend on a store issues before it")
+{
+  GIVEN("A store and a younger load from the same address, with no predicted dependence")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .rob_size(4)
+                   .lq_size(2)
+                   .sq_size(2)
+                   .lq_width(champsim::bandwidth::maximum_type{2})
+                   .sq_width(champsim::bandwidth::maximum_type{2})
+                   .violation_penalty(violation_penalty)
+                   .memory_dependence_predictor<scripted_predictor>()};
+    uut.initialize();
+    uut.warmup = false;
+    ::scripted_predictions[&uut] = std::numeric_limits<uint64_t>::max();
+    ::reported_violations[&uut].clear();
+
+    schedule_store_and_load(uut, champsim::address{0xcafe0000}, champsim::address{0xcafe0000});
+
+    THEN("The load does not wait for the store")
+    {
+      REQUIRE(the_load(uut)->producer_id == std::numeric_limits<uint64_t>::max());
+      REQUIRE(std::size(uut.SQ.front().lq_speculated_past_me) == 1);
+    }
+
+    WHEN("The load issues, and then the store executes")
+    {
+      issue_load(uut);
+      REQUIRE(the_load(uut)->fetch_issued);
+      execute_store(uut);
+
+      THEN("The violation is reported to the predictor")
+      {
+        REQUIRE(uut.sim_stats.dependence_violations == 1);
+        REQUIRE(::reported_violations[&uut] == std::vector{std::pair{champsim::address{2004}, champsim::address{2000}}});
+      }
+
+      THEN("The thread of the store stops fetching for the penalty")
+      {
+        REQUIRE(uut.threads.front().fetch_resume_time == uut.current_time + violation_penalty * uut.clock_period);
+      }
+
+      THEN("The load takes the value of the store")
+      {
+        REQUIRE(lq_is_empty(uut));
+        REQUIRE(uut.ROB.back().completed_mem_ops == 1);
+      }
+    }
+
+    WHEN("The store executes before the load issues")
+    {
+      execute_store(uut);
+
+      THEN("The store forwards to the load without a violation")
+      {
+        REQUIRE(lq_is_empty(uut));
+        REQUIRE(uut.ROB.back().completed_mem_ops == 1);
+        REQUIRE(uut.sim_stats.dependence_violations == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("A load that violated a dependence executes again, with the instructions that used its result")
+{
+  GIVEN("A store, a younger load from the same address that has completed, and an instruction that used its result")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .rob_size(4)
+                   .lq_size(2)
+                   .sq_size(2)
+                   .lq_width(champsim::bandwidth::maximum_type{2})
+                   .sq_width(champsim::bandwidth::maximum_type{2})
+                   .violation_penalty(violation_penalty)
+                   .memory_dependence_predictor<scripted_predictor>()};
+    uut.initialize();
+    uut.warmup = false;
+    ::scripted_predictions[&uut] = std::numeric_limits<uint64_t>::max();
+    ::reported_violations[&uut].clear();
+
+    schedule_store_and_load(uut, champsim::address{0xcafe0000}, champsim::address{0xcafe0000});
+    uut.ROB.push_back(champsim::test::instruction_with_ip(champsim::address{2008}));
+    uut.ROB.at(1).destination_registers.push_back(5);
+    uut.ROB.at(2).instr_id = 3;
+    uut.ROB.at(2).source_registers.push_back(5);
+    for (auto& instr : uut.ROB) {
+      instr.ready_time = champsim::chrono::clock::time_point{};
+      uut.do_scheduling(instr);
+    }
+    uut.ROB.at(0).ready_time = champsim::chrono::clock::time_point::max(); // The store executes only when the test chooses
+
+    auto run_until_completed = [&uut](const ooo_model_instr& instr) {
+      for (int i = 0; i < 100 && !instr.completed; ++i) {
+        uut.current_time += uut.clock_period;
+        uut.execute_instruction();
+        uut.complete_inflight_instruction();
+      }
+    };
+
+    uut.execute_instruction();
+    issue_load(uut);
+    the_load(uut)->finish();
+    uut.release_lq_entry(the_load(uut));
+    run_until_completed(uut.ROB.at(2));
+    REQUIRE(uut.ROB.at(1).completed);
+    REQUIRE(uut.ROB.at(2).completed);
+
+    WHEN("The store executes")
+    {
+      execute_store(uut);
+      const auto store_time = uut.current_time;
+
+      THEN("The load and the instruction that used its result execute again")
+      {
+        REQUIRE(uut.sim_stats.dependence_violations == 1);
+        REQUIRE_FALSE(uut.ROB.at(1).executed);
+        REQUIRE_FALSE(uut.ROB.at(1).completed);
+        REQUIRE_FALSE(uut.ROB.at(2).executed);
+        REQUIRE_FALSE(uut.ROB.at(2).completed);
+        REQUIRE_FALSE(uut.reg_allocator.isValid(uut.ROB.at(1).destination_registers.front()));
+        REQUIRE(uut.ROB.at(2).num_reg_dependent == 1);
+      }
+
+      AND_WHEN("The core runs")
+      {
+        run_until_completed(uut.ROB.at(1));
+        const auto load_time = uut.current_time;
+        run_until_completed(uut.ROB.at(2));
+
+        THEN("The load completes after the store, and the instruction that used its result completes after the load")
+        {
+          REQUIRE(uut.ROB.at(1).completed);
+          REQUIRE(uut.ROB.at(2).completed);
+          REQUIRE(load_time > store_time);
+          REQUIRE(uut.current_time > load_time);
+          REQUIRE(uut.ROB.at(1).completed_mem_ops == 1);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A load that is predicted to depend on its store waits for it")
+{
+  GIVEN("A store and a younger load from the same address, where the load is predicted to depend on the store")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .rob_size(4)
+                   .lq_size(2)
+                   .sq_size(2)
+                   .lq_width(champsim::bandwidth::maximum_type{2})
+                   .sq_width(champsim::bandwidth::maximum_type{2})
+                   .violation_penalty(violation_penalty)
+                   .memory_dependence_predictor<scripted_predictor>()};
+    uut.initialize();
+    uut.warmup = false;
+    ::scripted_predictions[&uut] = 1;
+    ::reported_violations[&uut].clear();
+
+    schedule_store_and_load(uut, champsim::address{0xcafe0000}, champsim::address{0xcafe0000});
+
+    THEN("The load waits for the store")
+    {
+      REQUIRE(the_load(uut)->producer_id == 1);
+      REQUIRE(uut.sim_stats.dependence_predicted_waits == 1);
+    }
+
+    WHEN("The store executes")
+    {
+      issue_load(uut);
+      execute_store(uut);
+
+      THEN("The store forwards to the load without a violation")
+      {
+        REQUIRE(lq_is_empty(uut));
+        REQUIRE(uut.sim_stats.dependence_violations == 0);
+        REQUIRE(std::empty(::reported_violations[&uut]));
+      }
+    }
+  }
+}
+
+SCENARIO("A load that is predicted to depend on a store to another address is held until it executes")
+{
+  GIVEN("A store and a younger load from a different address, where the load is predicted to depend on the store")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .rob_size(4)
+                   .lq_size(2)
+                   .sq_size(2)
+                   .lq_width(champsim::bandwidth::maximum_type{2})
+                   .sq_width(champsim::bandwidth::maximum_type{2})
+                   .violation_penalty(violation_penalty)
+                   .memory_dependence_predictor<scripted_predictor>()};
+    uut.initialize();
+    uut.warmup = false;
+    ::scripted_predictions[&uut] = 1;
+    ::reported_violations[&uut].clear();
+
+    schedule_store_and_load(uut, champsim::address{0xbeef0000}, champsim::address{0xcafe0000});
+
+    THEN("The load waits for the store")
+    {
+      REQUIRE(the_load(uut)->producer_id == 1);
+      REQUIRE(uut.sim_stats.dependence_false_waits == 1);
+    }
+
+    WHEN("The store executes")
+    {
+      execute_store(uut);
+
+      THEN("The load may issue, but is not forwarded")
+      {
+        REQUIRE(the_load(uut)->producer_id == std::numeric_limits<uint64_t>::max());
+        REQUIRE_FALSE(the_load(uut)->fetch_issued);
+        REQUIRE(uut.ROB.back().completed_mem_ops == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("Store sets predict that a load depends on a store it has conflicted with")
+{
+  GIVEN("A store set predictor")
+  {
+    store_sets uut{nullptr};
+    const champsim::address load_ip{0x401000};
+    const champsim::address store_ip{0x401020};
+
+    THEN("A load is not predicted to depend on a store") { REQUIRE(uut.predict_dependence(load_ip, 5) == std::numeric_limits<uint64_t>::max()); }
+
+    WHEN("The load has conflicted with the store, and the store is dispatched")
+    {
+      uut.dependence_violation(load_ip, store_ip);
+      uut.store_dispatched(store_ip, 3);
+
+      THEN("The load is predicted to depend on the store") { REQUIRE(uut.predict_dependence(load_ip, 5) == 3); }
+
+      AND_WHEN("The store executes")
+      {
+        uut.store_executed(store_ip, 3);
+
+        THEN("The load is no longer predicted to depend on it") { REQUIRE(uut.predict_dependence(load_ip, 5) == std::numeric_limits<uint64_t>::max()); }
+      }
+    }
+  }
+}
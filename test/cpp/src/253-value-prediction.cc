@@ -0,0 +1,459 @@
+#include <catch.hpp>
+#include <cstring>
+#include <map>
+
+#include "../../../value_predictor/last_value/last_value.h"
+#include "../../../value_predictor/stride_address/stride_address.h"
+#include "mocks.hpp"
+#include "modules.h"
+#include "ooo_cpu.h"
+#include "tracereader.h"
+
+namespace
+{
+std::map<O3_CPU*, std::optional<uint64_t>> scripted_predictions;
+std::map<O3_CPU*, std::vector<std::optional<uint64_t>>> reported_values;
+std::map<O3_CPU*, std::optional<champsim::address>> scripted_addresses;
+} // namespace
+
+struct scripted_value_predictor : champsim::modules::value_predictor {
+  using value_predictor::value_predictor;
+
+  std::optional<uint64_t> predict_load(champsim::address) { return ::scripted_predictions[intern_]; }
+  void last_load_result(champsim::address, champsim::address, std::optional<uint64_t> value) { ::reported_values[intern_].push_back(value); }
+};
+
+struct scripted_address_predictor : champsim::modules::value_predictor {
+  using value_predictor::value_predictor;
+
+  std::optional<champsim::address> predict_load_address(champsim::address) { return ::scripted_addresses[intern_]; }
+};
+
+namespace
+{
+constexpr unsigned replay_penalty = 20;
+constexpr uint64_t loaded_value = 0x2016;
+
+// A load into register 5 that reads the given value, from a trace that records values
+ooo_model_instr load_with_value(uint64_t value)
+{
+  value_instr i{};
+  i.ip = 0x401000;
+  i.destination_registers[0] = 5;
+  i.source_memory[0] = 0xcafe0000;
+  i.load_value = value;
+  auto retval = ooo_model_instr{0, i};
+  retval.instr_id = 1;
+  return retval;
+}
+
+// An instruction that reads register 5
+ooo_model_instr consumer()
+{
+  input_instr i{};
+  i.ip = 0x401004;
+  i.destination_registers[0] = 6;
+  i.source_registers[0] = 5;
+  auto retval = ooo_model_instr{0, i};
+  retval.instr_id = 2;
+  return retval;
+}
+
+void complete_load(O3_CPU& uut)
+{
+  uut.ROB.front().completed_mem_ops = 1;
+  uut.do_complete_execution(uut.ROB.front());
+}
+} // namespace
+
+SCENARIO("The consumers of a predicted load wake when it is scheduled")
+{
+  GIVEN("A load and an instruction that reads its result, where the load is predicted")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .register_file_size(16)
+                   .replay_penalty(replay_penalty)
+                   .value_predictor<scripted_value_predictor>()};
+    uut.initialize();
+    uut.warmup = false;
+    ::scripted_predictions[&uut] = loaded_value;
+    ::reported_values[&uut].clear();
+
+    uut.ROB.push_back(load_with_value(loaded_value));
+    uut.ROB.push_back(consumer());
+
+    WHEN("Both instructions are scheduled")
+    {
+      for (auto& instr : uut.ROB) {
+        uut.do_scheduling(instr);
+      }
+
+      THEN("The consumer is ready before the load completes")
+      {
+        REQUIRE(uut.ROB.back().num_reg_dependent == 0);
+        REQUIRE(std::count(std::begin(uut.ready_instrs), std::end(uut.ready_instrs), &uut.ROB.back()) == 1);
+        REQUIRE(uut.sim_stats.value_predictions == 1);
+      }
+
+      AND_WHEN("The load completes")
+      {
+        complete_load(uut);
+
+        THEN("The prediction was correct, and the value is reported to the predictor")
+        {
+          REQUIRE(uut.sim_stats.value_mispredictions == 0);
+          REQUIRE(::reported_values[&uut] == std::vector<std::optional<uint64_t>>{loaded_value});
+        }
+      }
+    }
+  }
+
+  GIVEN("A load that reads a value other than the prediction")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .register_file_size(16)
+                   .replay_penalty(replay_penalty)
+                   .value_predictor<scripted_value_predictor>()};
+    uut.initialize();
+    uut.warmup = false;
+    ::scripted_predictions[&uut] = loaded_value + 1;
+    ::reported_values[&uut].clear();
+
+    uut.ROB.push_back(load_with_value(loaded_value));
+    uut.ROB.push_back(consumer());
+    for (auto& instr : uut.ROB) {
+      uut.do_scheduling(instr);
+    }
+
+    WHEN("The consumer completes with the predicted value, and then the load completes")
+    {
+      for (int i = 0; i < 100 && !uut.ROB.back().completed; ++i) {
+        uut.execute_instruction();
+        uut.current_time += uut.clock_period;
+        uut.complete_inflight_instruction();
+      }
+      REQUIRE(uut.ROB.back().completed);
+      complete_load(uut);
+
+      THEN("The consumer executes again, and the thread stops fetching for the penalty")
+      {
+        REQUIRE(uut.sim_stats.value_mispredictions == 1);
+        REQUIRE(uut.threads.front().fetch_resume_time == uut.current_time + replay_penalty * uut.clock_period);
+        REQUIRE_FALSE(uut.ROB.back().executed);
+        REQUIRE_FALSE(uut.ROB.back().completed);
+        REQUIRE(std::count(std::begin(uut.ready_instrs), std::end(uut.ready_instrs), &uut.ROB.back()) == 1);
+      }
+
+      AND_WHEN("The load completes again after a replay")
+      {
+        complete_load(uut);
+
+        THEN("It is checked and reported only once")
+        {
+          REQUIRE(uut.sim_stats.value_mispredictions == 1);
+          REQUIRE(std::size(::reported_values[&uut]) == 1);
+        }
+      }
+    }
+  }
+
+  GIVEN("A load whose value the trace does not record")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .register_file_size(16)
+                   .replay_penalty(replay_penalty)
+                   .value_predictor<scripted_value_predictor>()};
+    uut.initialize();
+    uut.warmup = false;
+    ::scripted_predictions[&uut] = loaded_value;
+    ::reported_values[&uut].clear();
+
+    uut.ROB.push_back(load_with_value(loaded_value));
+    uut.ROB.front().load_value.reset();
+    uut.ROB.push_back(consumer());
+
+    WHEN("Both instructions are scheduled")
+    {
+      for (auto& instr : uut.ROB) {
+        uut.do_scheduling(instr);
+      }
+
+      THEN("The load is not predicted, and the consumer waits for it")
+      {
+        REQUIRE(uut.ROB.back().num_reg_dependent == 1);
+        REQUIRE(uut.sim_stats.value_predictions == 0);
+      }
+    }
+  }
+
+  GIVEN("A load that is not predicted")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .register_file_size(16)
+                   .replay_penalty(replay_penalty)
+                   .value_predictor<scripted_value_predictor>()};
+    uut.initialize();
+    uut.warmup = false;
+    ::scripted_predictions[&uut] = std::nullopt;
+    ::reported_values[&uut].clear();
+
+    uut.ROB.push_back(load_with_value(loaded_value));
+    uut.ROB.push_back(consumer());
+
+    WHEN("Both instructions are scheduled")
+    {
+      for (auto& instr : uut.ROB) {
+        uut.do_scheduling(instr);
+      }
+
+      THEN("The consumer waits for the load")
+      {
+        REQUIRE(uut.ROB.back().num_reg_dependent == 1);
+        REQUIRE(uut.sim_stats.value_predictions == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("A mispredicted load is never faster than one that is not predicted")
+{
+  // The time at which the core retires a load and an instruction that reads its result
+  auto retire_time = [](std::optional<uint64_t> prediction) {
+    do_nothing_MRC mock_L1I, mock_L1D{20};
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .register_file_size(16)
+                   .replay_penalty(replay_penalty)
+                   .value_predictor<scripted_value_predictor>()
+                   .execute_latency(5)};
+    uut.initialize();
+    uut.warmup = false;
+    ::scripted_predictions[&uut] = prediction;
+    ::reported_values[&uut].clear();
+
+    uut.ROB.push_back(load_with_value(loaded_value));
+    uut.ROB.push_back(consumer());
+    for (auto& instr : uut.ROB) {
+      instr.ready_time = champsim::chrono::clock::time_point{};
+      uut.do_memory_scheduling(instr);
+    }
+
+    for (int i = 0; i < 100 && uut.num_retired < 2; ++i) {
+      for (auto op : std::array<champsim::operable*, 3>{{&uut, &mock_L1I, &mock_L1D}}) {
+        op->_operate();
+      }
+    }
+    REQUIRE(uut.num_retired == 2);
+    return uut.current_time;
+  };
+
+  GIVEN("A load and an instruction that reads its result")
+  {
+    const auto unpredicted = retire_time(std::nullopt);
+
+    THEN("A misprediction does not retire them sooner") { REQUIRE(retire_time(loaded_value + 1) >= unpredicted); }
+
+    THEN("A correct prediction retires them sooner") { REQUIRE(retire_time(loaded_value) < unpredicted); }
+  }
+}
+
+SCENARIO("The consumers of a load with a predicted address wake when the access to that address returns")
+{
+  const champsim::address load_address{0xcafe0000};
+
+  GIVEN("A load whose address is predicted correctly, and an instruction that reads its result")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .register_file_size(16)
+                   .replay_penalty(replay_penalty)
+                   .value_predictor<scripted_address_predictor>()};
+    uut.initialize();
+    uut.warmup = false;
+    ::scripted_addresses[&uut] = load_address;
+
+    uut.ROB.push_back(load_with_value(loaded_value));
+    uut.ROB.front().load_value.reset();
+    uut.ROB.push_back(consumer());
+
+    WHEN("Both instructions are scheduled")
+    {
+      for (auto& instr : uut.ROB) {
+        uut.do_scheduling(instr);
+      }
+
+      THEN("The load issues to the predicted address, and the consumer waits for it")
+      {
+        REQUIRE(std::size(mock_L1D.queues.RQ) == 1);
+        REQUIRE(mock_L1D.queues.RQ.front().v_address == load_address);
+        REQUIRE(uut.ROB.back().num_reg_dependent == 1);
+        REQUIRE(uut.sim_stats.address_predictions == 1);
+      }
+
+      AND_WHEN("The access returns, and then the load executes")
+      {
+        mock_L1D._operate();
+        uut.handle_memory_return();
+        const bool woken = (uut.ROB.back().num_reg_dependent == 0);
+        uut.do_execution(uut.ROB.front());
+
+        THEN("The consumer woke before the load executed, and the prediction was correct")
+        {
+          REQUIRE(woken);
+          REQUIRE(std::count(std::begin(uut.ready_instrs), std::end(uut.ready_instrs), &uut.ROB.back()) == 1);
+          REQUIRE(uut.sim_stats.address_mispredictions == 0);
+        }
+      }
+    }
+  }
+
+  GIVEN("A load whose address is predicted incorrectly, and an instruction that reads its result")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+                   .fetch_queues(&mock_L1I.queues)
+                   .data_queues(&mock_L1D.queues)
+                   .register_file_size(16)
+                   .replay_penalty(replay_penalty)
+                   .value_predictor<scripted_address_predictor>()};
+    uut.initialize();
+    uut.warmup = false;
+    ::scripted_addresses[&uut] = champsim::address{0xbeef0000};
+
+    uut.ROB.push_back(load_with_value(loaded_value));
+    uut.ROB.front().load_value.reset();
+    uut.ROB.push_back(consumer());
+    for (auto& instr : uut.ROB) {
+      uut.do_scheduling(instr);
+    }
+
+    WHEN("The access returns, the consumer executes, and then the load executes")
+    {
+      mock_L1D._operate();
+      uut.handle_memory_return();
+      REQUIRE(uut.ROB.back().num_reg_dependent == 0);
+      uut.do_execution(uut.ROB.back());
+      uut.do_execution(uut.ROB.front());
+
+      THEN("The consumer waits again for the load, and the thread stops fetching for the penalty")
+      {
+        REQUIRE(uut.sim_stats.address_mispredictions == 1);
+        REQUIRE(uut.threads.front().fetch_resume_time == uut.current_time + replay_penalty * uut.clock_period);
+        REQUIRE_FALSE(uut.ROB.back().executed);
+        REQUIRE(uut.ROB.back().num_reg_dependent == 1);
+      }
+    }
+
+    WHEN("The load executes before the access returns")
+    {
+      uut.do_execution(uut.ROB.front());
+      mock_L1D._operate();
+      uut.handle_memory_return();
+
+      THEN("The misprediction is found before any consumer saw it")
+      {
+        REQUIRE(uut.sim_stats.address_mispredictions == 1);
+        REQUIRE(uut.threads.front().fetch_resume_time == champsim::chrono::clock::time_point{});
+        REQUIRE(uut.ROB.back().num_reg_dependent == 1);
+      }
+    }
+  }
+}
+
+SCENARIO("A stride address predictor predicts an address once its stride has repeated")
+{
+  GIVEN("A stride address predictor")
+  {
+    stride_address uut{nullptr};
+    const champsim::address ip{0x401000};
+    constexpr champsim::address::difference_type stride = 64;
+
+    THEN("A load is not predicted") { REQUIRE_FALSE(uut.predict_load_address(ip).has_value()); }
+
+    WHEN("A load reads addresses with the same stride many times")
+    {
+      champsim::address address{0xcafe0000};
+      for (int i = 0; i <= champsim::msl::fwcounter<stride_address::CONFIDENCE_BITS>::maximum + 1; ++i) {
+        uut.last_load_result(ip, address, std::nullopt);
+        address += stride;
+      }
+
+      THEN("The next address is predicted") { REQUIRE(uut.predict_load_address(ip) == std::optional<champsim::address>{address}); }
+
+      AND_WHEN("The load reads an address with another stride")
+      {
+        uut.last_load_result(ip, address + 8, std::nullopt);
+
+        THEN("The load is not predicted") { REQUIRE_FALSE(uut.predict_load_address(ip).has_value()); }
+      }
+    }
+  }
+}
+
+SCENARIO("A last value predictor predicts a value once it has repeated")
+{
+  GIVEN("A last value predictor")
+  {
+    last_value uut{nullptr};
+    const champsim::address ip{0x401000};
+    const champsim::address address{0xcafe0000};
+
+    THEN("A load is not predicted") { REQUIRE_FALSE(uut.predict_load(ip).has_value()); }
+
+    WHEN("A load reads the same value many times")
+    {
+      for (int i = 0; i <= champsim::msl::fwcounter<last_value::CONFIDENCE_BITS>::maximum; ++i) {
+        uut.last_load_result(ip, address, loaded_value);
+      }
+
+      THEN("The value is predicted") { REQUIRE(uut.predict_load(ip) == std::optional<uint64_t>{loaded_value}); }
+
+      AND_WHEN("The load reads another value")
+      {
+        uut.last_load_result(ip, address, loaded_value + 1);
+
+        THEN("The load is not predicted") { REQUIRE_FALSE(uut.predict_load(ip).has_value()); }
+      }
+    }
+
+    WHEN("A trace without values reads the same address many times")
+    {
+      for (int i = 0; i <= champsim::msl::fwcounter<last_value::CONFIDENCE_BITS>::maximum; ++i) {
+        uut.last_load_result(ip, address, std::nullopt);
+      }
+
+      THEN("The address is not predicted as the value") { REQUIRE_FALSE(uut.predict_load(ip).has_value()); }
+    }
+  }
+}
+
+TEST_CASE("A tracereader can read the value of a load")
+{
+  value_instr load{};
+  load.ip = 0x401000;
+  load.source_memory[0] = 0xcafe0000;
+  load.load_value = loaded_value;
+
+  std::string trace(sizeof(load), '\0');
+  std::memcpy(std::data(trace), &load, sizeof(load));
+
+  champsim::bulk_tracereader<value_instr, std::istringstream> uut{0, std::istringstream{trace}};
+  auto instr = uut();
+  REQUIRE(instr.source_memory == std::vector{champsim::address{0xcafe0000}});
+  REQUIRE(instr.load_value == std::optional<uint64_t>{loaded_value});
+}
@@ -0,0 +1,236 @@
+#include <catch.hpp>
+
+#include "cache.h"
+#include "defaults.hpp"
+#include "mocks.hpp"
+
+namespace
+{
+constexpr uint32_t num_sets = 16;
+
+// Addresses in set 0 are sampled, addresses in set 1 are not
+champsim::address address_in_set(long set, long tag)
+{
+  return champsim::address{0xbeef0000 + static_cast<uint64_t>((tag * num_sets + set) * static_cast<long>(BLOCK_SIZE))};
+}
+
+void issue(to_rq_MRP& mock_ul, std::array<champsim::operable*, 3> elements, champsim::address addr, uint64_t id)
+{
+  to_rq_MRP::request_type pkt;
+  pkt.address = addr;
+  pkt.is_translated = true;
+  pkt.instr_id = id;
+  pkt.cpu = 0;
+  pkt.type = access_type::LOAD;
+
+  mock_ul.issue(pkt);
+
+  for (auto i = 0; i < 100; ++i) {
+    for (auto elem : elements) {
+      elem->_operate();
+    }
+  }
+}
+} // namespace
+
+TEST_CASE("The number of sampled sets is rounded to a power of two within the cache")
+{
+  CACHE rounded{champsim::cache_builder{}.sets(64).sampled_sets(5)};
+  CACHE clamped{champsim::cache_builder{}.sets(64).sampled_sets(1024)};
+  CACHE unsampled{champsim::cache_builder{}.sets(64)};
+
+  REQUIRE(rounded.NUM_SAMPLED_SET == 8);
+  REQUIRE(clamped.NUM_SAMPLED_SET == 64);
+  REQUIRE(unsampled.NUM_SAMPLED_SET == 64);
+}
+
+TEST_CASE("Sampled sets are spread evenly through the cache")
+{
+  CACHE uut{champsim::cache_builder{}.sets(16).sampled_sets(4)};
+
+  for (long set = 0; set < 16; ++set) {
+    REQUIRE(uut.is_sampled_set(set) == (set % 4 == 0));
+  }
+}
+
+SCENARIO("Accesses to sets that are not sampled follow the sampled miss ratio")
+{
+  GIVEN("A set-sampled cache with no samples")
+  {
+    do_nothing_MRC mock_ll{2};
+    to_rq_MRP mock_ul;
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l2c}
+                  .name("409")
+                  .sets(num_sets)
+                  .ways(4)
+                  .sampled_sets(4)
+                  .offset_bits(champsim::data::bits{LOG2_BLOCK_SIZE})
+                  .upper_levels({&mock_ul.queues})
+                  .lower_level(&mock_ll.queues)};
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_ll, &mock_ul}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    uint64_t id = 1;
+
+    WHEN("A block in a set that is not sampled is accessed twice")
+    {
+      issue(mock_ul, elements, address_in_set(1, 0), id++);
+      issue(mock_ul, elements, address_in_set(1, 0), id++);
+
+      THEN("Both accesses miss, since the block is not allocated")
+      {
+        REQUIRE(uut.sim_stats.oracle_misses == 2);
+        REQUIRE(uut.sim_stats.oracle_hits == 0);
+        REQUIRE(mock_ul.packets.size() == 2);
+      }
+    }
+  }
+
+  GIVEN("A set-sampled cache whose sampled set hits half of the time")
+  {
+    do_nothing_MRC mock_ll{2};
+    to_rq_MRP mock_ul;
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l2c}
+                  .name("409")
+                  .sets(num_sets)
+                  .ways(4)
+                  .sampled_sets(4)
+                  .offset_bits(champsim::data::bits{LOG2_BLOCK_SIZE})
+                  .upper_levels({&mock_ul.queues})
+                  .lower_level(&mock_ll.queues)};
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_ll, &mock_ul}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    uint64_t id = 1;
+    issue(mock_ul, elements, address_in_set(0, 0), id++);
+    issue(mock_ul, elements, address_in_set(0, 0), id++);
+
+    REQUIRE(uut.sim_stats.sampled_hits == 1);
+    REQUIRE(uut.sim_stats.sampled_misses == 1);
+
+    WHEN("Blocks in a set that is not sampled are accessed")
+    {
+      for (long tag = 0; tag < 4; ++tag) {
+        issue(mock_ul, elements, address_in_set(1, tag), id++);
+      }
+
+      THEN("Half of the accesses hit")
+      {
+        REQUIRE(uut.sim_stats.oracle_hits == 2);
+        REQUIRE(uut.sim_stats.oracle_misses == 2);
+        REQUIRE(mock_ul.packets.size() == 6);
+      }
+
+      THEN("The sampled statistics are unchanged")
+      {
+        REQUIRE(uut.sim_stats.sampled_hits == 1);
+        REQUIRE(uut.sim_stats.sampled_misses == 1);
+      }
+    }
+  }
+}
+
+SCENARIO("Writes to sets that are not sampled are passed through whether they hit or miss")
+{
+  GIVEN("A set-sampled cache whose sampled set hits half of the writes")
+  {
+    do_nothing_MRC mock_ll;
+    to_wq_MRP mock_ul;
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l2c}
+                  .name("409-write")
+                  .sets(num_sets)
+                  .ways(4)
+                  .sampled_sets(4)
+                  .offset_bits(champsim::data::bits{LOG2_BLOCK_SIZE})
+                  .upper_levels({&mock_ul.queues})
+                  .lower_level(&mock_ll.queues)};
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_ll, &mock_ul}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    uint64_t id = 1;
+    auto write = [&](champsim::address addr) {
+      to_wq_MRP::request_type pkt;
+      pkt.address = addr;
+      pkt.is_translated = true;
+      pkt.instr_id = id++;
+      pkt.cpu = 0;
+      pkt.type = access_type::WRITE;
+      pkt.response_requested = false;
+
+      mock_ul.issue(pkt);
+
+      for (auto i = 0; i < 100; ++i) {
+        for (auto elem : elements) {
+          elem->_operate();
+        }
+      }
+    };
+
+    write(address_in_set(0, 0));
+    write(address_in_set(0, 0));
+
+    REQUIRE(uut.sim_stats.sampled_hits == 1);
+    REQUIRE(uut.sim_stats.sampled_misses == 1);
+    REQUIRE(mock_ll.packet_count() == 0);
+
+    WHEN("Blocks in a set that is not sampled are written")
+    {
+      for (long tag = 0; tag < 4; ++tag) {
+        write(address_in_set(1, tag));
+      }
+
+      THEN("Every write reaches the lower level")
+      {
+        REQUIRE(uut.sim_stats.oracle_hits == 2);
+        REQUIRE(uut.sim_stats.oracle_misses == 2);
+        REQUIRE(mock_ll.packet_count() == 4);
+      }
+    }
+  }
+}
+
+TEST_CASE("Set sampling statistics are scaled to the whole cache")
+{
+  cache_stats stats;
+  stats.sampled_sets = 4;
+  stats.total_sets = 16;
+  stats.sampled_hits = 75;
+  stats.sampled_misses = 25;
+
+  REQUIRE(stats.is_set_sampled());
+  REQUIRE(stats.sampling_scale() == Approx(4));
+  REQUIRE(stats.sampled_miss_ratio() == Approx(0.25));
+  REQUIRE(stats.sampled_miss_ratio_confidence() == Approx(1.96 * std::sqrt(0.25 * 0.75 / 100)));
+}
+
+TEST_CASE("A cache with every set sampled does not report sampling")
+{
+  cache_stats stats;
+  stats.sampled_sets = 16;
+  stats.total_sets = 16;
+
+  REQUIRE_FALSE(stats.is_set_sampled());
+}
+
+TEST_CASE("A cache without sets samples one set")
+{
+  CACHE uut{champsim::cache_builder{}.name("409-no-sets")};
+
+  REQUIRE(uut.NUM_SET == 0);
+  REQUIRE(uut.NUM_SAMPLED_SET == 1);
+}
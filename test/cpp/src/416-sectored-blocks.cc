@@ -0,0 +1,237 @@
+#include <catch.hpp>
+#include <algorithm>
+#include <deque>
+#include <map>
+
+#include "cache.h"
+#include "defaults.hpp"
+#include "mocks.hpp"
+#include "modules.h"
+
+namespace
+{
+constexpr uint32_t num_sets = 4;
+constexpr uint32_t num_sectors = 4;
+
+// The address of a sector within a tag. Tags that differ by one share a set.
+champsim::address sector_address(long tag, long sector)
+{
+  return champsim::address{0xbeef0000 + static_cast<uint64_t>(((tag * num_sets * num_sectors) + sector) * static_cast<long>(BLOCK_SIZE))};
+}
+
+template <typename MRP>
+void issue(MRP& mock_ul, std::array<champsim::operable*, 4> elements, champsim::address addr, access_type type, uint64_t id)
+{
+  typename MRP::request_type pkt;
+  pkt.address = addr;
+  pkt.is_translated = true;
+  pkt.instr_id = id;
+  pkt.cpu = 0;
+  pkt.type = type;
+
+  mock_ul.issue(pkt);
+
+  for (auto i = 0; i < 100; ++i) {
+    for (auto elem : elements) {
+      elem->_operate();
+    }
+  }
+}
+
+std::map<CACHE*, int> sector_fills;
+std::map<CACHE*, int> hooked_way_updates;
+std::map<CACHE*, int> unhooked_way_updates;
+} // namespace
+
+struct sector_fill_counter : champsim::modules::replacement {
+  using replacement::replacement;
+
+  long find_victim(uint32_t, uint64_t, long, const CACHE::BLOCK*, champsim::address, champsim::address, access_type) { return 0; }
+  void update_replacement_state(uint32_t, long, long way, champsim::address, champsim::address, access_type, bool)
+  {
+    if (way < intern_->NUM_WAY)
+      ++::hooked_way_updates[intern_];
+  }
+  void replacement_cache_fill(uint32_t, long, long, champsim::address, champsim::address, champsim::address, access_type) {}
+  void replacement_sector_fill(uint32_t, long, long, champsim::address, champsim::address, access_type) { ++::sector_fills[intern_]; }
+};
+
+struct way_update_counter : champsim::modules::replacement {
+  using replacement::replacement;
+
+  long find_victim(uint32_t, uint64_t, long, const CACHE::BLOCK*, champsim::address, champsim::address, access_type) { return 0; }
+  void update_replacement_state(uint32_t, long, long way, champsim::address, champsim::address, access_type, bool)
+  {
+    if (way < intern_->NUM_WAY)
+      ++::unhooked_way_updates[intern_];
+  }
+  void replacement_cache_fill(uint32_t, long, long, champsim::address, champsim::address, champsim::address, access_type) {}
+};
+
+TEST_CASE("The number of sectors is rounded to a power of two")
+{
+  CACHE rounded{champsim::cache_builder{}.sets(64).sectors(3)};
+  CACHE clamped{champsim::cache_builder{}.sets(64).sectors(1000)};
+  CACHE unsectored{champsim::cache_builder{}.sets(64)};
+
+  REQUIRE(rounded.NUM_SECTOR == 4);
+  REQUIRE(clamped.NUM_SECTOR == 64);
+  REQUIRE(unsectored.NUM_SECTOR == 1);
+}
+
+TEST_CASE("The number of sets in a sectored cache accounts for the sectors")
+{
+  CACHE uut{champsim::cache_builder{}.size(champsim::data::bytes{1 << 16}).ways(4).sectors(4)};
+  REQUIRE(uut.NUM_SET == (1 << 16) / (4 * 4 * BLOCK_SIZE));
+}
+
+SCENARIO("A sectored cache fetches only the missing sector")
+{
+  GIVEN("A sectored cache with one sector of a tag filled")
+  {
+    do_nothing_MRC mock_ll{2};
+    to_rq_MRP mock_ul_read;
+    to_wq_MRP mock_ul_write;
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l2c}
+                  .name("416")
+                  .sets(num_sets)
+                  .ways(1)
+                  .sectors(num_sectors)
+                  .offset_bits(champsim::data::bits{LOG2_BLOCK_SIZE})
+                  .upper_levels({&mock_ul_read.queues, &mock_ul_write.queues})
+                  .lower_level(&mock_ll.queues)};
+
+    std::array<champsim::operable*, 4> elements{{&uut, &mock_ll, &mock_ul_read, &mock_ul_write}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    uint64_t id = 1;
+    issue(mock_ul_read, elements, sector_address(0, 0), access_type::LOAD, id++);
+    REQUIRE(mock_ll.addresses == std::deque{sector_address(0, 0)});
+
+    WHEN("The same sector is accessed")
+    {
+      mock_ll.addresses.clear();
+      issue(mock_ul_read, elements, sector_address(0, 0), access_type::LOAD, id++);
+
+      THEN("It hits") { REQUIRE(mock_ll.addresses.empty()); }
+    }
+
+    WHEN("Another sector under the same tag is accessed")
+    {
+      mock_ll.addresses.clear();
+      issue(mock_ul_read, elements, sector_address(0, 1), access_type::LOAD, id++);
+
+      THEN("Only that sector is fetched")
+      {
+        REQUIRE(mock_ll.addresses == std::deque{sector_address(0, 1)});
+      }
+
+      THEN("The miss is counted as a sector miss") { REQUIRE(uut.sim_stats.sector_misses.value_or(std::pair{access_type::LOAD, 0}, 0) == 1); }
+
+      AND_WHEN("Both sectors are accessed again")
+      {
+        mock_ll.addresses.clear();
+        issue(mock_ul_read, elements, sector_address(0, 0), access_type::LOAD, id++);
+        issue(mock_ul_read, elements, sector_address(0, 1), access_type::LOAD, id++);
+
+        THEN("Both hit, since the tag was not evicted") { REQUIRE(mock_ll.addresses.empty()); }
+      }
+    }
+  }
+}
+
+SCENARIO("A sectored cache writes back only the dirty sectors")
+{
+  GIVEN("A sectored block with two dirty sectors")
+  {
+    do_nothing_MRC mock_ll{2};
+    to_rq_MRP mock_ul_read;
+    to_wq_MRP mock_ul_write;
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l2c}
+                  .name("416")
+                  .sets(num_sets)
+                  .ways(1)
+                  .sectors(num_sectors)
+                  .offset_bits(champsim::data::bits{LOG2_BLOCK_SIZE})
+                  .upper_levels({&mock_ul_read.queues, &mock_ul_write.queues})
+                  .lower_level(&mock_ll.queues)};
+
+    std::array<champsim::operable*, 4> elements{{&uut, &mock_ll, &mock_ul_read, &mock_ul_write}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    uint64_t id = 1;
+    issue(mock_ul_write, elements, sector_address(0, 0), access_type::WRITE, id++);
+    issue(mock_ul_read, elements, sector_address(0, 1), access_type::LOAD, id++);
+    issue(mock_ul_write, elements, sector_address(0, 2), access_type::WRITE, id++);
+
+    WHEN("The block is evicted")
+    {
+      mock_ll.addresses.clear();
+      issue(mock_ul_read, elements, sector_address(1, 0), access_type::LOAD, id++);
+
+      THEN("The dirty sectors are written back")
+      {
+        auto written_back = [&addrs = mock_ll.addresses](long sector) {
+          return std::count(std::begin(addrs), std::end(addrs), sector_address(0, sector)) > 0;
+        };
+        REQUIRE(written_back(0));
+        REQUIRE_FALSE(written_back(1));
+        REQUIRE(written_back(2));
+        REQUIRE(uut.sim_stats.sector_writebacks == 2);
+      }
+    }
+  }
+}
+
+SCENARIO("A sector fill updates only the replacement modules without a sector fill hook")
+{
+  GIVEN("A sectored cache with one replacement module that handles sector fills and one that does not")
+  {
+    do_nothing_MRC mock_ll{2};
+    to_rq_MRP mock_ul_read;
+    to_wq_MRP mock_ul_write;
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l2c}
+                  .name("416")
+                  .sets(num_sets)
+                  .ways(1)
+                  .sectors(num_sectors)
+                  .offset_bits(champsim::data::bits{LOG2_BLOCK_SIZE})
+                  .upper_levels({&mock_ul_read.queues, &mock_ul_write.queues})
+                  .lower_level(&mock_ll.queues)
+                  .replacement<sector_fill_counter, way_update_counter>()};
+
+    std::array<champsim::operable*, 4> elements{{&uut, &mock_ll, &mock_ul_read, &mock_ul_write}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    uint64_t id = 1;
+    issue(mock_ul_read, elements, sector_address(0, 0), access_type::LOAD, id++);
+
+    WHEN("Another sector under the same tag is filled")
+    {
+      ::sector_fills[&uut] = 0;
+      ::hooked_way_updates[&uut] = 0;
+      ::unhooked_way_updates[&uut] = 0;
+      issue(mock_ul_read, elements, sector_address(0, 1), access_type::LOAD, id++);
+
+      THEN("The module with the hook sees only the sector fill")
+      {
+        REQUIRE(::sector_fills[&uut] == 1);
+        REQUIRE(::hooked_way_updates[&uut] == 0);
+      }
+
+      THEN("The module without the hook is updated exactly once") { REQUIRE(::unhooked_way_updates[&uut] == 1); }
+    }
+  }
+}
@@ -0,0 +1,165 @@
+#include <catch.hpp>
+
+#include "cache.h"
+#include "defaults.hpp"
+#include "matchers.hpp"
+#include "mocks.hpp"
+
+namespace
+{
+constexpr auto hit_latency = 4;
+constexpr auto tag_bandwidth = 2;
+constexpr auto size = 8;
+
+// Issue the packets twice, so that the second time they all hit
+void issue_twice(to_rq_MRP& mock_ul, std::array<champsim::operable*, 3> elements, long stride)
+{
+  champsim::block_number seed_base_addr{0xdeadbe00};
+  std::vector<typename to_rq_MRP::request_type> seeds;
+
+  for (auto i = 0; i < size; ++i) {
+    typename to_rq_MRP::request_type seed;
+    seed.address = champsim::address{seed_base_addr + i * stride};
+    seed.instr_id = (uint64_t)i;
+    seed.cpu = 0;
+
+    seeds.push_back(seed);
+  }
+
+  for (auto round = 0; round < 2; ++round) {
+    for (auto& seed : seeds) {
+      seed.instr_id += 100;
+      REQUIRE(mock_ul.issue(seed));
+    }
+
+    for (auto i = 0; i < 100; ++i)
+      for (auto elem : elements)
+        elem->_operate();
+  }
+}
+} // namespace
+
+SCENARIO("Tag checks to different banks proceed in parallel")
+{
+  GIVEN("A cache with two pipelined banks")
+  {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l1d}
+                  .name("417-uut")
+                  .upper_levels({&mock_ul.queues})
+                  .lower_level(&mock_ll.queues)
+                  .hit_latency(hit_latency)
+                  .fill_latency(1)
+                  .tag_bandwidth(champsim::bandwidth::maximum_type{tag_bandwidth})
+                  .fill_bandwidth(champsim::bandwidth::maximum_type{10})
+                  .banks(2)
+                  .bank_bandwidth(champsim::bandwidth::maximum_type{1})
+                  .bank_busy(1)};
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_ll, &mock_ul}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("Packets alternate between the banks")
+    {
+      issue_twice(mock_ul, elements, 1);
+
+      auto cycle = (size - 1) / tag_bandwidth;
+      THEN("The last packet is served in cycle " + std::to_string(cycle))
+      {
+        REQUIRE_THAT(mock_ul.packets.back(), champsim::test::ReturnedMatcher(hit_latency + cycle, 1));
+      }
+    }
+  }
+}
+
+SCENARIO("Tag checks to the same bank are serialized")
+{
+  GIVEN("A cache with two pipelined banks")
+  {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l1d}
+                  .name("417-uut")
+                  .upper_levels({&mock_ul.queues})
+                  .lower_level(&mock_ll.queues)
+                  .hit_latency(hit_latency)
+                  .fill_latency(1)
+                  .tag_bandwidth(champsim::bandwidth::maximum_type{tag_bandwidth})
+                  .fill_bandwidth(champsim::bandwidth::maximum_type{10})
+                  .banks(2)
+                  .bank_bandwidth(champsim::bandwidth::maximum_type{1})
+                  .bank_busy(1)};
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_ll, &mock_ul}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("Every packet maps to the same bank")
+    {
+      issue_twice(mock_ul, elements, 2);
+
+      auto cycle = size - 1;
+      THEN("The last packet is served in cycle " + std::to_string(cycle))
+      {
+        REQUIRE_THAT(mock_ul.packets.back(), champsim::test::ReturnedMatcher(hit_latency + cycle, 1));
+      }
+
+      THEN("Bank conflicts are counted") { REQUIRE(uut.sim_stats.bank_conflict_stalls > 0); }
+    }
+  }
+
+  GIVEN("A cache with two banks that are busy for two cycles")
+  {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l1d}
+                  .name("417-uut")
+                  .upper_levels({&mock_ul.queues})
+                  .lower_level(&mock_ll.queues)
+                  .hit_latency(hit_latency)
+                  .fill_latency(1)
+                  .tag_bandwidth(champsim::bandwidth::maximum_type{tag_bandwidth})
+                  .fill_bandwidth(champsim::bandwidth::maximum_type{10})
+                  .banks(2)
+                  .bank_bandwidth(champsim::bandwidth::maximum_type{1})
+                  .bank_busy(2)};
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_ll, &mock_ul}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("Every packet maps to the same bank")
+    {
+      issue_twice(mock_ul, elements, 2);
+
+      auto cycle = 2 * (size - 1);
+      THEN("The last packet is served in cycle " + std::to_string(cycle))
+      {
+        REQUIRE_THAT(mock_ul.packets.back(), champsim::test::ReturnedMatcher(hit_latency + cycle, 1));
+      }
+    }
+  }
+}
+
+TEST_CASE("The number of banks is a power of two no greater than the number of sets")
+{
+  CACHE rounded{champsim::cache_builder{}.sets(64).banks(3)};
+  CACHE clamped{champsim::cache_builder{}.sets(4).banks(16)};
+
+  REQUIRE(rounded.NUM_BANK == 4);
+  REQUIRE(clamped.NUM_BANK == 4);
+}
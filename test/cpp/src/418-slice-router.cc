@@ -0,0 +1,210 @@
+#include <catch.hpp>
+#include <algorithm>
+#include <array>
+#include <numeric>
+
+#include "mocks.hpp"
+#include "slice_router.h"
+
+namespace
+{
+constexpr std::size_t num_slices = 4;
+
+std::vector<champsim::channel*> slice_channels(std::array<do_nothing_MRC, num_slices>& mock_slices)
+{
+  std::vector<champsim::channel*> retval{};
+  std::transform(std::begin(mock_slices), std::end(mock_slices), std::back_inserter(retval), [](auto& x) { return &x.queues; });
+  return retval;
+}
+
+std::vector<champsim::operable*> router_elements(champsim::slice_router& uut, to_rq_MRP& mock_ul, std::array<do_nothing_MRC, num_slices>& mock_slices)
+{
+  std::vector<champsim::operable*> retval{&uut, &mock_ul};
+  std::transform(std::begin(mock_slices), std::end(mock_slices), std::back_inserter(retval), [](auto& x) { return &x; });
+  return retval;
+}
+
+void issue(to_rq_MRP& mock_ul, champsim::address addr, uint64_t id)
+{
+  to_rq_MRP::request_type pkt;
+  pkt.address = addr;
+  pkt.instr_id = id;
+  pkt.cpu = 0;
+  REQUIRE(mock_ul.issue(pkt));
+}
+
+void run(const std::vector<champsim::operable*>& elements, long cycles)
+{
+  for (long i = 0; i < cycles; ++i) {
+    for (auto elem : elements) {
+      elem->_operate();
+    }
+  }
+}
+} // namespace
+
+TEMPLATE_TEST_CASE_SIG("Requests are routed to the slice selected by the hash", "", ((champsim::slice_hash H), H), champsim::slice_hash::xor_fold,
+                       champsim::slice_hash::multiplicative)
+{
+  to_rq_MRP mock_ul;
+  std::array<do_nothing_MRC, num_slices> mock_slices{};
+  champsim::slice_router uut{"418",
+                             champsim::chrono::picoseconds{1},
+                             {&mock_ul.queues},
+                             {slice_channels(mock_slices)},
+                             0,
+                             H,
+                             champsim::data::bits{LOG2_BLOCK_SIZE}};
+
+  auto elements = router_elements(uut, mock_ul, mock_slices);
+  for (auto elem : elements) {
+    elem->initialize();
+    elem->warmup = false;
+    elem->begin_phase();
+  }
+
+  constexpr long num_blocks = 64;
+  for (long i = 0; i < num_blocks; ++i) {
+    issue(mock_ul, champsim::address{champsim::block_number{0xdead00} + i}, static_cast<uint64_t>(i + 1));
+  }
+  run(elements, 100);
+
+  for (std::size_t slice = 0; slice < num_slices; ++slice) {
+    const auto& addrs = mock_slices.at(slice).addresses;
+    REQUIRE(std::all_of(std::begin(addrs), std::end(addrs), [&](auto addr) { return uut.get_slice(addr) == slice; }));
+    REQUIRE_FALSE(std::empty(addrs));
+  }
+
+  auto total = std::accumulate(std::begin(mock_slices), std::end(mock_slices), std::size_t{0}, [](auto acc, const auto& x) { return acc + x.packet_count(); });
+  REQUIRE(total == num_blocks);
+  REQUIRE(std::all_of(std::begin(mock_ul.packets), std::end(mock_ul.packets), [](const auto& x) { return x.return_time > 0; }));
+}
+
+TEST_CASE("The xor-fold hash spreads consecutive blocks among all slices")
+{
+  to_rq_MRP mock_ul;
+  std::array<do_nothing_MRC, num_slices> mock_slices{};
+  champsim::slice_router uut{"418",
+                             champsim::chrono::picoseconds{1},
+                             {&mock_ul.queues},
+                             {slice_channels(mock_slices)},
+                             0,
+                             champsim::slice_hash::xor_fold,
+                             champsim::data::bits{LOG2_BLOCK_SIZE}};
+
+  std::array<bool, num_slices> seen{};
+  for (long i = 0; i < static_cast<long>(num_slices); ++i) {
+    seen.at(uut.get_slice(champsim::address{champsim::block_number{0xdead00} + i})) = true;
+  }
+  REQUIRE(std::all_of(std::begin(seen), std::end(seen), [](auto x) { return x; }));
+}
+
+SCENARIO("The routing latency is paid in each direction")
+{
+  GIVEN("A router with no latency and a router with a routing latency")
+  {
+    constexpr long latency = 5;
+    to_rq_MRP fast_ul;
+    to_rq_MRP slow_ul;
+    std::array<do_nothing_MRC, num_slices> fast_slices{};
+    std::array<do_nothing_MRC, num_slices> slow_slices{};
+    champsim::slice_router fast{"418-fast",
+                                champsim::chrono::picoseconds{1},
+                                {&fast_ul.queues},
+                                {slice_channels(fast_slices)},
+                                0,
+                                champsim::slice_hash::xor_fold,
+                                champsim::data::bits{LOG2_BLOCK_SIZE}};
+    champsim::slice_router slow{"418-slow",
+                                champsim::chrono::picoseconds{1},
+                                {&slow_ul.queues},
+                                {slice_channels(slow_slices)},
+                                latency,
+                                champsim::slice_hash::xor_fold,
+                                champsim::data::bits{LOG2_BLOCK_SIZE}};
+
+    auto fast_elements = router_elements(fast, fast_ul, fast_slices);
+    auto slow_elements = router_elements(slow, slow_ul, slow_slices);
+    for (auto elem : fast_elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+    for (auto elem : slow_elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("The same request is sent through each")
+    {
+      issue(fast_ul, champsim::address{0xdeadbeef}, 1);
+      issue(slow_ul, champsim::address{0xdeadbeef}, 1);
+      run(fast_elements, 100);
+      run(slow_elements, 100);
+
+      THEN("The response through the slower router arrives " + std::to_string(2 * latency) + " cycles later")
+      {
+        auto fast_packet = fast_ul.packets.front();
+        REQUIRE_THAT(slow_ul.packets.front(), champsim::test::ReturnedMatcher(fast_packet.return_time - fast_packet.issue_time + 2 * latency, 0));
+      }
+    }
+  }
+}
+
+SCENARIO("The router holds no more requests for a slice than the slice's queue can take")
+{
+  GIVEN("A router to slices with short read queues")
+  {
+    constexpr std::size_t rq_size = 2;
+    constexpr long num_requests = 6;
+    to_rq_MRP mock_ul;
+    std::array<do_nothing_MRC, num_slices> mock_slices{};
+    champsim::slice_router uut{"418",
+                               champsim::chrono::picoseconds{1},
+                               {&mock_ul.queues},
+                               {slice_channels(mock_slices)},
+                               5,
+                               champsim::slice_hash::xor_fold,
+                               champsim::data::bits{LOG2_BLOCK_SIZE}};
+
+    auto elements = router_elements(uut, mock_ul, mock_slices);
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    for (auto& slice : mock_slices) {
+      slice.queues = champsim::channel{rq_size, rq_size, rq_size, champsim::data::bits{LOG2_BLOCK_SIZE}, false};
+    }
+
+    WHEN("More requests than the queue can take are sent to one slice")
+    {
+      auto target = uut.get_slice(champsim::address{0xdeadbeef});
+      long issued = 0;
+      for (auto block = champsim::block_number{0xdead00}; issued < num_requests; ++block) {
+        if (uut.get_slice(champsim::address{block}) == target) {
+          issue(mock_ul, champsim::address{block}, static_cast<uint64_t>(issued + 1));
+          ++issued;
+        }
+      }
+      uut._operate();
+
+      THEN("Only as many as the slice's queue can take leave the upper level")
+      {
+        REQUIRE(std::size(mock_ul.queues.RQ) == num_requests - rq_size);
+      }
+
+      AND_WHEN("The slice drains its queue")
+      {
+        run(elements, 100);
+
+        THEN("Every request reaches the slice")
+        {
+          REQUIRE(mock_slices.at(target).packet_count() == num_requests);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,318 @@
+#include <catch.hpp>
+#include <algorithm>
+#include <array>
+
+#include "cache.h"
+#include "defaults.hpp"
+#include "mocks.hpp"
+
+namespace
+{
+constexpr auto hit_latency = 2;
+constexpr auto fill_latency = 1;
+
+void issue(to_rq_MRP& ul, std::array<champsim::operable*, 6> elements, champsim::address addr, access_type type, uint64_t id)
+{
+  to_rq_MRP::request_type pkt;
+  pkt.address = addr;
+  pkt.type = type;
+  pkt.instr_id = id;
+  pkt.cpu = 0;
+  REQUIRE(ul.issue(pkt));
+
+  for (auto i = 0; i < 100; ++i) {
+    for (auto elem : elements) {
+      elem->_operate();
+    }
+  }
+}
+
+champsim::coherence_state state_of(const CACHE& cache, champsim::address addr)
+{
+  auto way = std::find_if(std::begin(cache.block), std::end(cache.block), [match = champsim::block_number{addr}](const auto& x) {
+    return x.valid && champsim::block_number{x.address} == match;
+  });
+  return way == std::end(cache.block) ? champsim::coherence_state::invalid : way->coherence;
+}
+} // namespace
+
+SCENARIO("A directory grants exclusive permission to the only sharer")
+{
+  GIVEN("Two private caches below a directory")
+  {
+    do_nothing_MRC mock_ll{5};
+    champsim::channel a_to_llc{}, b_to_llc{};
+    to_rq_MRP mock_ul_a, mock_ul_b;
+    CACHE llc{champsim::cache_builder{champsim::defaults::default_llc}
+                  .name("419-llc")
+                  .upper_levels({&a_to_llc, &b_to_llc})
+                  .lower_level(&mock_ll.queues)
+                  .ways(16)
+                  .hit_latency(hit_latency)
+                  .fill_latency(fill_latency)
+                  .set_coherence_directory()};
+    CACHE l1a{champsim::cache_builder{champsim::defaults::default_l1d}
+                  .name("419-l1a")
+                  .upper_levels({&mock_ul_a.queues})
+                  .lower_level(&a_to_llc)
+                  .hit_latency(hit_latency)
+                  .fill_latency(fill_latency)};
+    CACHE l1b{champsim::cache_builder{champsim::defaults::default_l1d}
+                  .name("419-l1b")
+                  .upper_levels({&mock_ul_b.queues})
+                  .lower_level(&b_to_llc)
+                  .hit_latency(hit_latency)
+                  .fill_latency(fill_latency)};
+
+    std::array<champsim::operable*, 6> elements{{&mock_ll, &llc, &l1a, &l1b, &mock_ul_a, &mock_ul_b}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    uint64_t id = 1;
+    const champsim::address addr{0xdeadbeef};
+
+    WHEN("One cache reads a block")
+    {
+      issue(mock_ul_a, elements, addr, access_type::LOAD, id++);
+
+      THEN("The block is held in the exclusive state")
+      {
+        REQUIRE(state_of(l1a, addr) == champsim::coherence_state::exclusive);
+        REQUIRE(llc.sim_stats.downgrades_sent == 0);
+      }
+
+      AND_WHEN("The other cache reads the same block")
+      {
+        issue(mock_ul_b, elements, addr, access_type::LOAD, id++);
+
+        THEN("The owner is downgraded and both caches share the block")
+        {
+          REQUIRE(llc.sim_stats.downgrades_sent == 1);
+          REQUIRE(l1a.sim_stats.probes_received == 1);
+          REQUIRE(state_of(l1a, addr) == champsim::coherence_state::shared);
+          REQUIRE(state_of(l1b, addr) == champsim::coherence_state::shared);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A write to a shared block invalidates the other sharers")
+{
+  GIVEN("Two private caches that share a block")
+  {
+    do_nothing_MRC mock_ll{5};
+    champsim::channel a_to_llc{}, b_to_llc{};
+    to_rq_MRP mock_ul_a, mock_ul_b;
+    CACHE llc{champsim::cache_builder{champsim::defaults::default_llc}
+                  .name("419-llc")
+                  .upper_levels({&a_to_llc, &b_to_llc})
+                  .lower_level(&mock_ll.queues)
+                  .ways(16)
+                  .hit_latency(hit_latency)
+                  .fill_latency(fill_latency)
+                  .set_coherence_directory()};
+    CACHE l1a{champsim::cache_builder{champsim::defaults::default_l1d}
+                  .name("419-l1a")
+                  .upper_levels({&mock_ul_a.queues})
+                  .lower_level(&a_to_llc)
+                  .hit_latency(hit_latency)
+                  .fill_latency(fill_latency)};
+    CACHE l1b{champsim::cache_builder{champsim::defaults::default_l1d}
+                  .name("419-l1b")
+                  .upper_levels({&mock_ul_b.queues})
+                  .lower_level(&b_to_llc)
+                  .hit_latency(hit_latency)
+                  .fill_latency(fill_latency)};
+
+    std::array<champsim::operable*, 6> elements{{&mock_ll, &llc, &l1a, &l1b, &mock_ul_a, &mock_ul_b}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    uint64_t id = 1;
+    const champsim::address addr{0xdeadbeef};
+    issue(mock_ul_a, elements, addr, access_type::LOAD, id++);
+    issue(mock_ul_b, elements, addr, access_type::LOAD, id++);
+
+    WHEN("One cache writes the block")
+    {
+      issue(mock_ul_a, elements, addr, access_type::RFO, id++);
+
+      THEN("The write misses as a coherence upgrade")
+      {
+        REQUIRE(l1a.sim_stats.coherence_upgrades == 1);
+        REQUIRE(state_of(l1a, addr) == champsim::coherence_state::exclusive);
+        REQUIRE(std::all_of(std::begin(mock_ul_a.packets), std::end(mock_ul_a.packets), [](const auto& x) { return x.return_time > 0; }));
+      }
+
+      THEN("The other sharer is invalidated")
+      {
+        REQUIRE(llc.sim_stats.invalidations_sent == 1);
+        REQUIRE(state_of(l1b, addr) == champsim::coherence_state::invalid);
+      }
+
+      AND_WHEN("The invalidated cache reads the block again")
+      {
+        issue(mock_ul_b, elements, addr, access_type::LOAD, id++);
+
+        THEN("The miss is counted as a coherence miss")
+        {
+          REQUIRE(llc.sim_stats.coherence_misses == 1);
+          REQUIRE(state_of(l1b, addr) == champsim::coherence_state::shared);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A directory stops tracking a block that has left every sharer")
+{
+  GIVEN("A private cache that tells the directory of its evictions, and holds a block exclusively")
+  {
+    do_nothing_MRC mock_ll{5};
+    champsim::channel a_to_llc{}, b_to_llc{};
+    to_rq_MRP mock_ul_a, mock_ul_b;
+    CACHE llc{champsim::cache_builder{champsim::defaults::default_llc}
+                  .name("419-llc")
+                  .upper_levels({&a_to_llc, &b_to_llc})
+                  .lower_level(&mock_ll.queues)
+                  .ways(16)
+                  .hit_latency(hit_latency)
+                  .fill_latency(fill_latency)
+                  .set_coherence_directory()};
+    CACHE l1a{champsim::cache_builder{champsim::defaults::default_l1d}
+                  .name("419-l1a")
+                  .upper_levels({&mock_ul_a.queues})
+                  .lower_level(&a_to_llc)
+                  .hit_latency(hit_latency)
+                  .fill_latency(fill_latency)
+                  .set_eviction_notices()};
+    CACHE l1b{champsim::cache_builder{champsim::defaults::default_l1d}
+                  .name("419-l1b")
+                  .upper_levels({&mock_ul_b.queues})
+                  .lower_level(&b_to_llc)
+                  .hit_latency(hit_latency)
+                  .fill_latency(fill_latency)
+                  .set_eviction_notices()};
+
+    std::array<champsim::operable*, 6> elements{{&mock_ll, &llc, &l1a, &l1b, &mock_ul_a, &mock_ul_b}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    uint64_t id = 1;
+    const champsim::address addr{0xdeadbeef};
+    issue(mock_ul_a, elements, addr, access_type::LOAD, id++);
+
+    WHEN("The block is evicted from the private cache")
+    {
+      const auto set_stride = static_cast<uint64_t>(l1a.NUM_SET) * BLOCK_SIZE;
+      for (uint64_t i = 1; i <= l1a.NUM_WAY; ++i) {
+        issue(mock_ul_a, elements, champsim::address{addr.to<uint64_t>() + i * set_stride}, access_type::LOAD, id++);
+      }
+      REQUIRE(state_of(l1a, addr) == champsim::coherence_state::invalid);
+
+      AND_WHEN("The other cache reads the block")
+      {
+        issue(mock_ul_b, elements, addr, access_type::LOAD, id++);
+
+        THEN("The block is granted exclusively, without a downgrade")
+        {
+          REQUIRE(llc.sim_stats.downgrades_sent == 0);
+          REQUIRE(state_of(l1b, addr) == champsim::coherence_state::exclusive);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A full set of the directory back-invalidates the block that was requested least recently")
+{
+  GIVEN("A directory that tracks one block in each set")
+  {
+    do_nothing_MRC mock_ll{5};
+    champsim::channel a_to_llc{}, b_to_llc{};
+    to_rq_MRP mock_ul_a, mock_ul_b;
+    CACHE llc{champsim::cache_builder{champsim::defaults::default_llc}
+                  .name("419-llc")
+                  .upper_levels({&a_to_llc, &b_to_llc})
+                  .lower_level(&mock_ll.queues)
+                  .ways(1)
+                  .hit_latency(hit_latency)
+                  .fill_latency(fill_latency)
+                  .set_coherence_directory()};
+    CACHE l1a{champsim::cache_builder{champsim::defaults::default_l1d}
+                  .name("419-l1a")
+                  .upper_levels({&mock_ul_a.queues})
+                  .lower_level(&a_to_llc)
+                  .hit_latency(hit_latency)
+                  .fill_latency(fill_latency)};
+    CACHE l1b{champsim::cache_builder{champsim::defaults::default_l1d}
+                  .name("419-l1b")
+                  .upper_levels({&mock_ul_b.queues})
+                  .lower_level(&b_to_llc)
+                  .hit_latency(hit_latency)
+                  .fill_latency(fill_latency)};
+
+    std::array<champsim::operable*, 6> elements{{&mock_ll, &llc, &l1a, &l1b, &mock_ul_a, &mock_ul_b}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    uint64_t id = 1;
+    const champsim::address addr{0xdeadbeef};
+    issue(mock_ul_a, elements, addr, access_type::LOAD, id++);
+
+    WHEN("Another block in the same set is requested")
+    {
+      const auto set_stride = static_cast<uint64_t>(llc.NUM_SET) * BLOCK_SIZE;
+      issue(mock_ul_a, elements, champsim::address{addr.to<uint64_t>() + set_stride}, access_type::LOAD, id++);
+
+      THEN("The first block is invalidated in the private cache")
+      {
+        REQUIRE(llc.sim_stats.back_invalidations == 1);
+        REQUIRE(l1a.sim_stats.inclusion_victims == 1);
+        REQUIRE(state_of(l1a, addr) == champsim::coherence_state::invalid);
+      }
+    }
+  }
+}
+
+TEST_CASE("A cache without a directory holds every block exclusively")
+{
+  do_nothing_MRC mock_ll;
+  to_rq_MRP mock_ul;
+  CACHE uut{champsim::cache_builder{champsim::defaults::default_l1d}.name("419-uut").upper_levels({&mock_ul.queues}).lower_level(&mock_ll.queues)};
+
+  std::array<champsim::operable*, 3> elements{{&mock_ll, &uut, &mock_ul}};
+  for (auto elem : elements) {
+    elem->initialize();
+    elem->warmup = false;
+    elem->begin_phase();
+  }
+
+  decltype(mock_ul)::request_type pkt;
+  pkt.address = champsim::address{0xdeadbeef};
+  pkt.cpu = 0;
+  REQUIRE(mock_ul.issue(pkt));
+
+  for (auto i = 0; i < 100; ++i) {
+    for (auto elem : elements) {
+      elem->_operate();
+    }
+  }
+
+  REQUIRE(state_of(uut, pkt.address) == champsim::coherence_state::exclusive);
+  REQUIRE(uut.sim_stats.probes_received == 0);
+  REQUIRE(uut.sim_stats.coherence_upgrades == 0);
+}
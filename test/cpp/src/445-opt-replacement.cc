@@ -0,0 +1,162 @@
+#include <catch.hpp>
+#include <cstdio>
+#include <fstream>
+
+#include "../replacement/opt/opt.h"
+#include "cache.h"
+#include "defaults.hpp"
+
+SCENARIO("The OPT index finds the next use of each access within its set")
+{
+  GIVEN("A recorded access stream over two sets")
+  {
+    const std::string trace_path{"445-opt.trace"};
+    const std::string index_path{"445-opt.index"};
+
+    {
+      std::ofstream trace{trace_path, std::ios::binary};
+      opt_index::begin_recording(trace, "a run");
+      opt_index::record(trace, 0, 0xa); // set 0, position 0
+      opt_index::record(trace, 1, 0xa); // set 1, position 0
+      opt_index::record(trace, 0, 0xb); // set 0, position 1
+      opt_index::record(trace, 0, 0xc); // set 0, position 2
+      opt_index::record(trace, 0, 0xa); // set 0, position 3
+      opt_index::record(trace, 1, 0xa); // set 1, position 1
+    }
+
+    WHEN("The index is built and mapped")
+    {
+      opt_index::build(trace_path, index_path, 2);
+      opt_index uut{index_path};
+
+      THEN("The index is stamped with the recorded run and the recording")
+      {
+        REQUIRE(uut.run() == "a run");
+        REQUIRE(uut.source() == opt_index::file_stamp(trace_path));
+      }
+
+      THEN("Each set holds its own sequence")
+      {
+        REQUIRE(uut.sets() == 2);
+        REQUIRE(uut.size(0) == 4);
+        REQUIRE(uut.size(1) == 2);
+        REQUIRE(uut.block(0, 2) == 0xc);
+      }
+
+      THEN("Reused blocks point to their next access in the same set")
+      {
+        REQUIRE(uut.next_use(0, 0) == 3);
+        REQUIRE(uut.next_use(1, 0) == 1);
+      }
+
+      THEN("Blocks that are not reused are never used again")
+      {
+        REQUIRE(uut.next_use(0, 1) == opt_index::never);
+        REQUIRE(uut.next_use(0, 3) == opt_index::never);
+      }
+    }
+
+    std::remove(trace_path.c_str());
+    std::remove(index_path.c_str());
+  }
+}
+
+TEST_CASE("The OPT index rejects a malformed file")
+{
+  const std::string index_path{"445-opt-malformed.index"};
+  {
+    std::ofstream index{index_path, std::ios::binary};
+    index << "not an index, but long enough to hold a header";
+  }
+
+  REQUIRE_THROWS_AS(opt_index{index_path}, std::runtime_error);
+  std::remove(index_path.c_str());
+}
+
+SCENARIO("The OPT policy records again when its files were made for another run")
+{
+  GIVEN("An access stream recorded by the policy")
+  {
+    const auto saved_run = champsim::modules::current_run();
+    champsim::modules::current_run().warmup_instructions = 100;
+    champsim::modules::current_run().simulation_instructions = 1000;
+
+    CACHE cache{champsim::cache_builder{champsim::defaults::default_l1d}.name("445-cache")};
+    {
+      opt first{&cache, 1, 2};
+      first.initialize_replacement();
+      REQUIRE(first.trace_file.is_open());
+      first.update_replacement_state(0, 0, 0, champsim::address{0xdeadbeef}, champsim::address{}, champsim::address{}, access_type::LOAD, false);
+    }
+
+    WHEN("The next run is the same")
+    {
+      opt uut{&cache, 1, 2};
+      uut.initialize_replacement();
+
+      THEN("The recording is indexed") { REQUIRE(uut.index.has_value()); }
+    }
+
+    WHEN("The next run has a different warmup")
+    {
+      champsim::modules::current_run().warmup_instructions = 200;
+      opt uut{&cache, 1, 2};
+      uut.initialize_replacement();
+
+      THEN("The access stream is recorded again")
+      {
+        REQUIRE_FALSE(uut.index.has_value());
+        REQUIRE(uut.trace_file.is_open());
+      }
+    }
+
+    WHEN("The index was left unreadable by an earlier run")
+    {
+      {
+        std::ofstream index{"./445-cache.opt.index", std::ios::binary};
+        index << "not an index, but long enough to hold a header";
+      }
+      opt uut{&cache, 1, 2};
+      uut.initialize_replacement();
+
+      THEN("The recording is indexed again")
+      {
+        REQUIRE(uut.index.has_value());
+        REQUIRE(uut.index->size(0) == 1);
+      }
+    }
+
+    WHEN("The index was left unreadable, and the next run is different")
+    {
+      {
+        std::ofstream index{"./445-cache.opt.index", std::ios::binary};
+        index << "not an index, but long enough to hold a header";
+      }
+      champsim::modules::current_run().warmup_instructions = 200;
+      opt uut{&cache, 1, 2};
+      uut.initialize_replacement();
+
+      THEN("The access stream is recorded again")
+      {
+        REQUIRE_FALSE(uut.index.has_value());
+        REQUIRE(uut.trace_file.is_open());
+      }
+    }
+
+    WHEN("The next run has a different number of ways")
+    {
+      opt uut{&cache, 1, 4};
+      uut.initialize_replacement();
+
+      THEN("The access stream is recorded again")
+      {
+        REQUIRE_FALSE(uut.index.has_value());
+        REQUIRE(uut.trace_file.is_open());
+      }
+    }
+
+    std::remove("./445-cache.opt.trace");
+    std::remove("./445-cache.opt.index");
+    champsim::modules::current_run() = saved_run;
+  }
+}
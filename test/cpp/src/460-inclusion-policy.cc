@@ -0,0 +1,209 @@
+#include <catch.hpp>
+#include <algorithm>
+#include <array>
+
+#include "cache.h"
+#include "defaults.hpp"
+#include "mocks.hpp"
+
+namespace
+{
+void load(to_rq_MRP& mock_ul, std::array<champsim::operable*, 4> elements, champsim::address addr, uint64_t id)
+{
+  to_rq_MRP::request_type pkt;
+  pkt.address = addr;
+  pkt.instr_id = id;
+  pkt.cpu = 0;
+  REQUIRE(mock_ul.issue(pkt));
+
+  for (auto i = 0; i < 100; ++i) {
+    for (auto elem : elements) {
+      elem->_operate();
+    }
+  }
+}
+
+bool holds(const CACHE& cache, champsim::address addr)
+{
+  return std::any_of(std::begin(cache.block), std::end(cache.block),
+                     [match = champsim::block_number{addr}](const auto& x) { return x.valid && champsim::block_number{x.address} == match; });
+}
+} // namespace
+
+SCENARIO("An inclusive cache invalidates the blocks it evicts in its upper levels")
+{
+  GIVEN("An inclusive cache that is smaller than its upper level")
+  {
+    do_nothing_MRC mock_ll{5};
+    champsim::channel upper_to_lower{};
+    to_rq_MRP mock_ul;
+    CACHE lower{champsim::cache_builder{champsim::defaults::default_llc}
+                    .name("460-lower")
+                    .sets(1)
+                    .ways(1)
+                    .upper_levels({&upper_to_lower})
+                    .lower_level(&mock_ll.queues)
+                    .hit_latency(2)
+                    .fill_latency(1)
+                    .inclusion(champsim::cache_inclusion::inclusive)};
+    CACHE upper{champsim::cache_builder{champsim::defaults::default_l2c}
+                    .name("460-upper")
+                    .sets(1)
+                    .ways(4)
+                    .upper_levels({&mock_ul.queues})
+                    .lower_level(&upper_to_lower)
+                    .hit_latency(2)
+                    .fill_latency(1)};
+
+    std::array<champsim::operable*, 4> elements{{&mock_ll, &lower, &upper, &mock_ul}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    uint64_t id = 1;
+    const champsim::address addr_a{0xdeadbe00};
+    const champsim::address addr_b{0xcafeba00};
+
+    WHEN("Two blocks are read")
+    {
+      load(mock_ul, elements, addr_a, id++);
+      load(mock_ul, elements, addr_b, id++);
+
+      THEN("The first block is evicted from both levels")
+      {
+        REQUIRE(lower.sim_stats.back_invalidations == 1);
+        REQUIRE(upper.sim_stats.inclusion_victims == 1);
+        REQUIRE_FALSE(holds(upper, addr_a));
+        REQUIRE(holds(upper, addr_b));
+        REQUIRE(holds(lower, addr_b));
+      }
+    }
+  }
+
+  GIVEN("A non-inclusive cache that is smaller than its upper level")
+  {
+    do_nothing_MRC mock_ll{5};
+    champsim::channel upper_to_lower{};
+    to_rq_MRP mock_ul;
+    CACHE lower{champsim::cache_builder{champsim::defaults::default_llc}
+                    .name("460-lower")
+                    .sets(1)
+                    .ways(1)
+                    .upper_levels({&upper_to_lower})
+                    .lower_level(&mock_ll.queues)
+                    .hit_latency(2)
+                    .fill_latency(1)
+                    .inclusion(champsim::cache_inclusion::non_inclusive)};
+    CACHE upper{champsim::cache_builder{champsim::defaults::default_l2c}
+                    .name("460-upper")
+                    .sets(1)
+                    .ways(4)
+                    .upper_levels({&mock_ul.queues})
+                    .lower_level(&upper_to_lower)
+                    .hit_latency(2)
+                    .fill_latency(1)};
+
+    std::array<champsim::operable*, 4> elements{{&mock_ll, &lower, &upper, &mock_ul}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    uint64_t id = 1;
+    const champsim::address addr_a{0xdeadbe00};
+    const champsim::address addr_b{0xcafeba00};
+
+    WHEN("Two blocks are read")
+    {
+      load(mock_ul, elements, addr_a, id++);
+      load(mock_ul, elements, addr_b, id++);
+
+      THEN("The upper level keeps both blocks")
+      {
+        REQUIRE(lower.sim_stats.back_invalidations == 0);
+        REQUIRE(holds(upper, addr_a));
+        REQUIRE(holds(upper, addr_b));
+      }
+    }
+  }
+}
+
+SCENARIO("An exclusive cache holds only the victims of its upper level")
+{
+  GIVEN("An exclusive cache below an upper level with a single way")
+  {
+    do_nothing_MRC mock_ll{5};
+    champsim::channel upper_to_lower{};
+    to_rq_MRP mock_ul;
+    CACHE lower{champsim::cache_builder{champsim::defaults::default_llc}
+                    .name("460-lower")
+                    .sets(1)
+                    .ways(4)
+                    .upper_levels({&upper_to_lower})
+                    .lower_level(&mock_ll.queues)
+                    .hit_latency(2)
+                    .fill_latency(1)
+                    .inclusion(champsim::cache_inclusion::exclusive)};
+    CACHE upper{champsim::cache_builder{champsim::defaults::default_l2c}
+                    .name("460-upper")
+                    .sets(1)
+                    .ways(1)
+                    .upper_levels({&mock_ul.queues})
+                    .lower_level(&upper_to_lower)
+                    .hit_latency(2)
+                    .fill_latency(1)
+                    .set_clean_writebacks()};
+
+    std::array<champsim::operable*, 4> elements{{&mock_ll, &lower, &upper, &mock_ul}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    uint64_t id = 1;
+    const champsim::address addr_a{0xdeadbe00};
+    const champsim::address addr_b{0xcafeba00};
+
+    WHEN("A block is read")
+    {
+      load(mock_ul, elements, addr_a, id++);
+
+      THEN("The block is passed through to the upper level")
+      {
+        REQUIRE(holds(upper, addr_a));
+        REQUIRE_FALSE(holds(lower, addr_a));
+      }
+
+      AND_WHEN("A second block evicts the first from the upper level")
+      {
+        load(mock_ul, elements, addr_b, id++);
+
+        THEN("The victim is written to the exclusive cache, clean")
+        {
+          REQUIRE(holds(lower, addr_a));
+          REQUIRE_FALSE(holds(lower, addr_b));
+          REQUIRE(std::none_of(std::begin(lower.block), std::end(lower.block), [](const auto& x) { return x.dirty; }));
+        }
+
+        AND_WHEN("The first block is read again")
+        {
+          load(mock_ul, elements, addr_a, id++);
+
+          THEN("It hits in the exclusive cache and moves to the upper level")
+          {
+            REQUIRE(lower.sim_stats.hits.value_or(std::pair{access_type::LOAD, uint32_t{0}}, 0) == 1);
+            REQUIRE(holds(upper, addr_a));
+            REQUIRE_FALSE(holds(lower, addr_a));
+            REQUIRE(holds(lower, addr_b));
+          }
+
+          THEN("Only the two initial misses reach memory") { REQUIRE(mock_ll.packet_count() == 2); }
+        }
+      }
+    }
+  }
+}
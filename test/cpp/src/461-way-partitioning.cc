@@ -0,0 +1,98 @@
+#include <catch.hpp>
+#include <array>
+#include <numeric>
+
+#include "way_partitioner.h"
+
+namespace
+{
+std::array<champsim::cache_block, 8> owned_set(std::array<uint32_t, 8> owners)
+{
+  std::array<champsim::cache_block, 8> set{};
+  for (std::size_t way = 0; way < std::size(set); ++way) {
+    set[way].valid = true;
+    set[way].cpu = owners[way];
+  }
+  return set;
+}
+} // namespace
+
+SCENARIO("The lookahead allocator gives more ways to the core that uses them")
+{
+  GIVEN("A partitioner for two cores that begins with an even split")
+  {
+    champsim::way_partitioner uut{2, 64, 8, 4, 0};
+    REQUIRE(uut.get_allocation() == std::vector<long>{4, 4});
+
+    WHEN("One core reuses six blocks per set and the other streams")
+    {
+      for (auto pass = 0; pass < 4; ++pass) {
+        for (long set = 0; set < 64; ++set) {
+          for (uint64_t blk = 0; blk < 6; ++blk) {
+            uut.access(0, set, champsim::block_number{(static_cast<uint64_t>(set) << 8) + blk});
+          }
+          uut.access(1, set, champsim::block_number{(static_cast<uint64_t>(set) << 16) + static_cast<uint64_t>(pass)});
+        }
+      }
+      uut.repartition();
+
+      THEN("The reusing core receives the ways that its stack hits need") { REQUIRE(uut.get_allocation() == std::vector<long>{7, 1}); }
+    }
+
+    WHEN("Neither core has any hits")
+    {
+      uut.repartition();
+
+      THEN("The ways are divided evenly") { REQUIRE(uut.get_allocation() == std::vector<long>{4, 4}); }
+    }
+  }
+
+  GIVEN("A partitioner for more cores than ways")
+  {
+    champsim::way_partitioner uut{4, 64, 2, 4, 0};
+
+    WHEN("The ways are repartitioned")
+    {
+      uut.repartition();
+
+      THEN("Every way is still allocated")
+      {
+        auto alloc = uut.get_allocation();
+        REQUIRE(std::accumulate(std::begin(alloc), std::end(alloc), 0L) == 2);
+      }
+    }
+  }
+}
+
+SCENARIO("The partition is enforced on the victim of the replacement policy")
+{
+  GIVEN("A set where core 1 holds more blocks than its allocation")
+  {
+    champsim::way_partitioner uut{2, 1, 8, 1, 0};
+    auto set = ::owned_set({1, 1, 1, 1, 1, 1, 0, 0});
+    for (long way = 0; way < 8; ++way) {
+      uut.touch(0, way);
+    }
+
+    WHEN("Core 0 misses and the replacement policy proposes one of core 0's blocks")
+    {
+      auto victim = uut.enforce(0, 0, 7, set.data());
+
+      THEN("The least recently used block of core 1 is evicted instead") { REQUIRE(victim == 0); }
+    }
+
+    WHEN("Core 0 misses and the replacement policy proposes one of core 1's blocks")
+    {
+      auto victim = uut.enforce(0, 0, 3, set.data());
+
+      THEN("The proposal is kept") { REQUIRE(victim == 3); }
+    }
+
+    WHEN("Core 1 misses")
+    {
+      auto victim = uut.enforce(1, 0, 6, set.data());
+
+      THEN("It must replace one of its own blocks") { REQUIRE(victim == 0); }
+    }
+  }
+}
@@ -0,0 +1,273 @@
+#include <catch.hpp>
+#include <algorithm>
+#include <array>
+
+#include "cache.h"
+#include "defaults.hpp"
+#include "mocks.hpp"
+#include "victim_buffer.h"
+
+namespace
+{
+bool holds(const CACHE& cache, champsim::address addr)
+{
+  return std::any_of(std::begin(cache.block), std::end(cache.block),
+                     [addr](const auto& x) { return x.valid && champsim::block_number{x.address} == champsim::block_number{addr}; });
+}
+
+champsim::cache_block make_block(champsim::address addr)
+{
+  champsim::cache_block blk{};
+  blk.valid = true;
+  blk.address = addr;
+  return blk;
+}
+
+template <typename MRP>
+void issue(MRP& mock_ul, std::array<champsim::operable*, 4> elements, champsim::address addr, access_type type, uint64_t id, uint32_t cpu = 0)
+{
+  typename MRP::request_type pkt;
+  pkt.address = addr;
+  pkt.instr_id = id;
+  pkt.cpu = cpu;
+  pkt.type = type;
+  REQUIRE(mock_ul.issue(pkt));
+
+  for (auto i = 0; i < 100; ++i) {
+    for (auto elem : elements) {
+      elem->_operate();
+    }
+  }
+}
+} // namespace
+
+SCENARIO("A victim buffer is indexed by tag and displaces its oldest entry")
+{
+  GIVEN("A victim buffer with two entries")
+  {
+    champsim::victim_buffer uut{2, champsim::data::bits{LOG2_BLOCK_SIZE}};
+
+    WHEN("Three blocks are inserted")
+    {
+      auto first = uut.insert(make_block(champsim::address{0xdead'0000}));
+      auto second = uut.insert(make_block(champsim::address{0xbeef'0000}));
+      auto* next = uut.next_displaced();
+      REQUIRE(next != nullptr);
+      REQUIRE(next->address == champsim::address{0xdead'0000});
+      auto third = uut.insert(make_block(champsim::address{0xcafe'0000}));
+
+      THEN("Only the third insertion displaced a block, which was the oldest")
+      {
+        REQUIRE_FALSE(first.valid);
+        REQUIRE_FALSE(second.valid);
+        REQUIRE(third.valid);
+        REQUIRE(third.address == champsim::address{0xdead'0000});
+        REQUIRE(uut.size() == 2);
+      }
+
+      THEN("The remaining blocks are found by any address in the block")
+      {
+        REQUIRE(uut.find(champsim::address{0xdead'0000}) == nullptr);
+        REQUIRE(uut.find(champsim::address{0xbeef'0008}) != nullptr);
+        REQUIRE(uut.find(champsim::address{0xcafe'0010}) != nullptr);
+      }
+    }
+
+    WHEN("A block is taken")
+    {
+      uut.insert(make_block(champsim::address{0xdead'0000}));
+      auto taken = uut.take(champsim::address{0xdead'0000});
+
+      THEN("The buffer has room again")
+      {
+        REQUIRE(taken.valid);
+        REQUIRE(uut.find(champsim::address{0xdead'0000}) == nullptr);
+        REQUIRE(uut.next_displaced() == nullptr);
+        REQUIRE(uut.size() == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("A victim buffer turns conflict misses into hits")
+{
+  GIVEN("A cache with one set of two ways and a victim buffer of two entries")
+  {
+    do_nothing_MRC mock_ll{5};
+    to_rq_MRP mock_ul_read;
+    to_wq_MRP mock_ul_write;
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l2c}
+                  .name("462-uut")
+                  .sets(1)
+                  .ways(2)
+                  .upper_levels({&mock_ul_read.queues, &mock_ul_write.queues})
+                  .lower_level(&mock_ll.queues)
+                  .hit_latency(2)
+                  .fill_latency(1)
+                  .victim_buffer(2)};
+
+    std::array<champsim::operable*, 4> elements{{&mock_ll, &uut, &mock_ul_read, &mock_ul_write}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    uint64_t id = 1;
+
+    WHEN("Three blocks that conflict are loaded, and then the first is loaded again")
+    {
+      issue(mock_ul_read, elements, champsim::address{0xdead'0000}, access_type::LOAD, id++);
+      issue(mock_ul_read, elements, champsim::address{0xbeef'0000}, access_type::LOAD, id++);
+      issue(mock_ul_read, elements, champsim::address{0xcafe'0000}, access_type::LOAD, id++);
+      auto requests_before = std::size(mock_ll.addresses);
+      issue(mock_ul_read, elements, champsim::address{0xdead'0000}, access_type::LOAD, id++);
+
+      THEN("The reload hits in the victim buffer and does not reach the lower level")
+      {
+        REQUIRE(std::size(mock_ll.addresses) == requests_before);
+        REQUIRE(uut.sim_stats.victim_buffer_hits == 1);
+        REQUIRE(uut.sim_stats.victim_buffer_inserts == 2);
+        REQUIRE(uut.sim_stats.hits.value_or(std::pair{access_type::LOAD, uint32_t{0}}, 0) == 1);
+      }
+
+      THEN("The block is swapped back into the set")
+      {
+        REQUIRE(std::any_of(std::begin(uut.block), std::end(uut.block), [](const auto& x) {
+          return x.valid && champsim::block_number{x.address} == champsim::block_number{champsim::address{0xdead'0000}};
+        }));
+      }
+    }
+  }
+
+  GIVEN("The same cache without a victim buffer")
+  {
+    do_nothing_MRC mock_ll{5};
+    to_rq_MRP mock_ul_read;
+    to_wq_MRP mock_ul_write;
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l2c}
+                  .name("462-uut")
+                  .sets(1)
+                  .ways(2)
+                  .upper_levels({&mock_ul_read.queues, &mock_ul_write.queues})
+                  .lower_level(&mock_ll.queues)
+                  .hit_latency(2)
+                  .fill_latency(1)
+                  .victim_buffer(0)};
+
+    std::array<champsim::operable*, 4> elements{{&mock_ll, &uut, &mock_ul_read, &mock_ul_write}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    uint64_t id = 1;
+
+    WHEN("The same loads are issued")
+    {
+      issue(mock_ul_read, elements, champsim::address{0xdead'0000}, access_type::LOAD, id++);
+      issue(mock_ul_read, elements, champsim::address{0xbeef'0000}, access_type::LOAD, id++);
+      issue(mock_ul_read, elements, champsim::address{0xcafe'0000}, access_type::LOAD, id++);
+      auto requests_before = std::size(mock_ll.addresses);
+      issue(mock_ul_read, elements, champsim::address{0xdead'0000}, access_type::LOAD, id++);
+
+      THEN("The reload misses") { REQUIRE(std::size(mock_ll.addresses) == requests_before + 1); }
+    }
+  }
+}
+
+SCENARIO("A dirty block is written back when it leaves the victim buffer")
+{
+  GIVEN("A cache with one set of two ways and a victim buffer of one entry")
+  {
+    do_nothing_MRC mock_ll{5};
+    to_rq_MRP mock_ul_read;
+    to_wq_MRP mock_ul_write;
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l2c}
+                  .name("462-uut")
+                  .sets(1)
+                  .ways(2)
+                  .upper_levels({&mock_ul_read.queues, &mock_ul_write.queues})
+                  .lower_level(&mock_ll.queues)
+                  .hit_latency(2)
+                  .fill_latency(1)
+                  .victim_buffer(1)};
+
+    std::array<champsim::operable*, 4> elements{{&mock_ll, &uut, &mock_ul_read, &mock_ul_write}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    uint64_t id = 1;
+
+    WHEN("A block is written, and then three conflicting blocks are loaded")
+    {
+      issue(mock_ul_write, elements, champsim::address{0xdead'0000}, access_type::WRITE, id++);
+      issue(mock_ul_read, elements, champsim::address{0xbeef'0000}, access_type::LOAD, id++);
+      issue(mock_ul_read, elements, champsim::address{0xcafe'0000}, access_type::LOAD, id++);
+      auto requests_before = std::size(mock_ll.addresses);
+      issue(mock_ul_read, elements, champsim::address{0xf00d'0000}, access_type::LOAD, id++);
+
+      THEN("The written block is displaced from the victim buffer and written back")
+      {
+        REQUIRE(uut.sim_stats.victim_buffer_displaced == 1);
+        REQUIRE(std::size(mock_ll.addresses) == requests_before + 2);
+        REQUIRE(mock_ll.addresses.back() == champsim::address{0xdead'0000});
+      }
+    }
+  }
+}
+
+SCENARIO("A swap from the victim buffer keeps the set within the partition")
+{
+  GIVEN("A partitioned cache with one set of two ways and a victim buffer of two entries")
+  {
+    // The tests are built for one CPU, so the blocks of CPU 1 are outside of the allocation, and may be taken by CPU 0
+    do_nothing_MRC mock_ll{5};
+    to_rq_MRP mock_ul_read;
+    to_wq_MRP mock_ul_write;
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l2c}
+                  .name("462-uut")
+                  .sets(1)
+                  .ways(2)
+                  .upper_levels({&mock_ul_read.queues, &mock_ul_write.queues})
+                  .lower_level(&mock_ll.queues)
+                  .hit_latency(2)
+                  .fill_latency(1)
+                  .victim_buffer(2)
+                  .set_way_partitioning()};
+
+    std::array<champsim::operable*, 4> elements{{&mock_ll, &uut, &mock_ul_read, &mock_ul_write}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    uint64_t id = 1;
+
+    WHEN("CPU 0 reloads a victim while the least recently used block in the set is its own")
+    {
+      issue(mock_ul_read, elements, champsim::address{0xdead'0000}, access_type::LOAD, id++, 0);
+      issue(mock_ul_read, elements, champsim::address{0xbeef'0000}, access_type::LOAD, id++, 1);
+      issue(mock_ul_read, elements, champsim::address{0xcafe'0000}, access_type::LOAD, id++, 1);
+      issue(mock_ul_read, elements, champsim::address{0xf00d'0000}, access_type::LOAD, id++, 0);
+      issue(mock_ul_read, elements, champsim::address{0xcafe'0000}, access_type::LOAD, id++, 1);
+      REQUIRE(uut.sim_stats.victim_buffer_inserts == 2);
+
+      issue(mock_ul_read, elements, champsim::address{0xdead'0000}, access_type::LOAD, id++, 0);
+
+      THEN("The reload hits in the victim buffer") { REQUIRE(uut.sim_stats.victim_buffer_hits == 1); }
+
+      THEN("The block of CPU 1 is swapped out, rather than the block of CPU 0")
+      {
+        REQUIRE(::holds(uut, champsim::address{0xdead'0000}));
+        REQUIRE(::holds(uut, champsim::address{0xf00d'0000}));
+        REQUIRE_FALSE(::holds(uut, champsim::address{0xcafe'0000}));
+      }
+    }
+  }
+}
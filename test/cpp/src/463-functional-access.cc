@@ -0,0 +1,136 @@
+#include <catch.hpp>
+#include <algorithm>
+
+#include "../../../prefetcher/next_line/next_line.h"
+#include "cache.h"
+#include "defaults.hpp"
+#include "mocks.hpp"
+
+namespace
+{
+auto identity = [](uint32_t, champsim::address v_address) {
+  return v_address;
+};
+
+champsim::channel::request_type make_request(champsim::address addr, access_type type)
+{
+  champsim::channel::request_type pkt;
+  pkt.address = addr;
+  pkt.v_address = addr;
+  pkt.cpu = 0;
+  pkt.type = type;
+  pkt.response_requested = (type != access_type::WRITE);
+  return pkt;
+}
+} // namespace
+
+SCENARIO("A functional access fills the cache at once")
+{
+  GIVEN("An empty cache with one set of two ways")
+  {
+    do_nothing_MRC mock_ll;
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l2c}.name("463-uut").sets(1).ways(2).lower_level(&mock_ll.queues)};
+    uut.initialize();
+    uut.warmup = true;
+    uut.begin_phase();
+
+    const champsim::address addr{0xdeadbeef};
+
+    WHEN("A load is accessed")
+    {
+      auto to_lower = uut.functional_access(make_request(addr, access_type::LOAD), identity);
+
+      THEN("The miss is sent to the lower level")
+      {
+        REQUIRE(std::size(to_lower) == 1);
+        REQUIRE(to_lower.front().address == addr);
+        REQUIRE(to_lower.front().type == access_type::LOAD);
+      }
+
+      THEN("No packets are placed in the queues") { REQUIRE(std::empty(mock_ll.queues.RQ)); }
+
+      AND_WHEN("The load is accessed again")
+      {
+        auto second_to_lower = uut.functional_access(make_request(addr, access_type::LOAD), identity);
+
+        THEN("It hits") { REQUIRE(std::empty(second_to_lower)); }
+      }
+    }
+
+    WHEN("A writeback is accessed, then two loads to other blocks")
+    {
+      auto wb_to_lower = uut.functional_access(make_request(addr, access_type::WRITE), identity);
+      uut.functional_access(make_request(champsim::address{0xcafe0000}, access_type::LOAD), identity);
+      auto to_lower = uut.functional_access(make_request(champsim::address{0xbeef0000}, access_type::LOAD), identity);
+
+      THEN("The writeback does not read the lower level") { REQUIRE(std::empty(wb_to_lower)); }
+
+      THEN("The dirty block is written back when it is evicted")
+      {
+        REQUIRE(std::size(to_lower) == 2);
+        REQUIRE(std::count_if(std::begin(to_lower), std::end(to_lower), [addr](const auto& x) {
+                  return x.type == access_type::WRITE && champsim::block_number{x.address} == champsim::block_number{addr};
+                }) == 1);
+      }
+    }
+
+    WHEN("An untranslated load is accessed")
+    {
+      const champsim::address p_addr{0x1234'5678};
+      auto req = make_request(addr, access_type::LOAD);
+      req.is_translated = false;
+      auto to_lower = uut.functional_access(req, [p_addr](uint32_t, champsim::address) { return p_addr; });
+
+      THEN("The lower level receives the translated address")
+      {
+        REQUIRE(std::size(to_lower) == 1);
+        REQUIRE(to_lower.front().address == p_addr);
+        REQUIRE(to_lower.front().v_address == addr);
+      }
+    }
+  }
+}
+
+SCENARIO("A functional access handles the prefetches that it triggers")
+{
+  GIVEN("An empty cache with a next line prefetcher")
+  {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l1d}
+                  .name("463-uut-pref")
+                  .upper_levels({&mock_ul.queues})
+                  .lower_level(&mock_ll.queues)
+                  .prefetcher<next_line>()};
+    uut.initialize();
+    uut.warmup = true;
+    uut.begin_phase();
+
+    const champsim::address addr{0xffff'003f};
+
+    WHEN("A load is accessed")
+    {
+      auto to_lower = uut.functional_access(make_request(addr, access_type::LOAD), identity);
+
+      THEN("The miss and the prefetch are sent to the lower level")
+      {
+        REQUIRE(std::size(to_lower) == 2);
+        REQUIRE(to_lower.back().type == access_type::PREFETCH);
+        REQUIRE(champsim::block_number{to_lower.back().address} == champsim::block_number{addr} + 1);
+      }
+
+      THEN("The prefetch queue is empty") { REQUIRE(std::empty(mock_ll.queues.PQ)); }
+
+      AND_WHEN("The next line is loaded")
+      {
+        auto next_to_lower = uut.functional_access(make_request(champsim::address{champsim::block_number{addr} + 1}, access_type::LOAD), identity);
+
+        THEN("It hits, but prefetches the line after it")
+        {
+          REQUIRE(std::size(next_to_lower) == 1);
+          REQUIRE(next_to_lower.front().type == access_type::PREFETCH);
+        }
+      }
+    }
+  }
+}
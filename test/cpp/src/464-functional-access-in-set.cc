@@ -0,0 +1,132 @@
+#include <catch.hpp>
+#include <thread>
+
+#include "../../../prefetcher/next_line/next_line.h"
+#include "../../../prefetcher/no/no.h"
+#include "../../../replacement/lru/lru.h"
+#include "../../../replacement/ship/ship.h"
+#include "../../../replacement/srrip/srrip.h"
+#include "cache.h"
+#include "defaults.hpp"
+#include "mocks.hpp"
+
+static_assert(champsim::modules::replacement::is_set_local<lru>);
+static_assert(champsim::modules::replacement::is_set_local<srrip>);
+static_assert(!champsim::modules::replacement::is_set_local<ship>);
+static_assert(champsim::modules::prefetcher::is_set_local<no>);
+static_assert(!champsim::modules::prefetcher::is_set_local<next_line>);
+
+namespace
+{
+champsim::channel::request_type make_request(champsim::address addr, access_type type)
+{
+  champsim::channel::request_type pkt;
+  pkt.address = addr;
+  pkt.v_address = addr;
+  pkt.cpu = 0;
+  pkt.type = type;
+  pkt.response_requested = (type != access_type::WRITE);
+  return pkt;
+}
+} // namespace
+
+SCENARIO("A cache is set-local only if its modules are")
+{
+  GIVEN("A cache with LRU replacement and no prefetcher")
+  {
+    do_nothing_MRC mock_ll;
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l2c}
+                  .name("464-uut-local")
+                  .sets(8)
+                  .lower_level(&mock_ll.queues)
+                  .replacement<lru>()
+                  .prefetcher<no>()};
+
+    THEN("It is set-local") { REQUIRE(uut.is_set_local()); }
+  }
+
+  GIVEN("A cache with SHiP replacement")
+  {
+    do_nothing_MRC mock_ll;
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l2c}
+                  .name("464-uut-ship")
+                  .sets(8)
+                  .lower_level(&mock_ll.queues)
+                  .replacement<ship>()
+                  .prefetcher<no>()};
+
+    THEN("It is not set-local") { REQUIRE_FALSE(uut.is_set_local()); }
+  }
+}
+
+SCENARIO("Lookups in different sets may be made from different threads")
+{
+  GIVEN("Two caches with LRU replacement and no prefetcher")
+  {
+    constexpr long num_sets = 16;
+    constexpr std::size_t num_threads = 4;
+
+    do_nothing_MRC mock_ll;
+    auto builder = champsim::cache_builder{champsim::defaults::default_l2c}.sets(num_sets).ways(2).lower_level(&mock_ll.queues).replacement<lru>().prefetcher<no>();
+    CACHE serial{champsim::cache_builder{builder}.name("464-serial")};
+    CACHE parallel{champsim::cache_builder{builder}.name("464-parallel")};
+    for (auto* cache : {&serial, &parallel}) {
+      cache->initialize();
+      cache->warmup = true;
+      cache->begin_phase();
+    }
+
+    // A stream of loads and stores that is several times larger than the cache
+    std::vector<champsim::channel::request_type> stream;
+    for (uint64_t i = 0; i < 2000; ++i) {
+      auto block = (i * 7919) % 211;
+      stream.push_back(make_request(champsim::address{block << LOG2_BLOCK_SIZE}, (i % 3 == 0) ? access_type::WRITE : access_type::LOAD));
+    }
+
+    WHEN("The stream is looked up in order in one, and split by set among threads in the other")
+    {
+      std::vector<std::vector<champsim::channel::request_type>> serial_to_lower;
+      for (const auto& req : stream) {
+        serial_to_lower.push_back(serial.functional_access_in_set(req));
+      }
+
+      std::vector<std::vector<champsim::channel::request_type>> parallel_to_lower(std::size(stream));
+      std::vector<std::thread> workers;
+      for (std::size_t shard = 0; shard < num_threads; ++shard) {
+        workers.emplace_back([&, shard] {
+          for (std::size_t i = 0; i < std::size(stream); ++i) {
+            if (static_cast<std::size_t>(parallel.get_set_index(stream.at(i).address)) % num_threads == shard) {
+              parallel_to_lower.at(i) = parallel.functional_access_in_set(stream.at(i));
+            }
+          }
+        });
+      }
+      for (auto& worker : workers) {
+        worker.join();
+      }
+
+      THEN("The caches hold the same blocks")
+      {
+        REQUIRE(std::size(serial.block) == std::size(parallel.block));
+        for (std::size_t i = 0; i < std::size(serial.block); ++i) {
+          CHECK(serial.block[i].valid == parallel.block[i].valid);
+          CHECK(serial.block[i].dirty == parallel.block[i].dirty);
+          CHECK(serial.block[i].address == parallel.block[i].address);
+        }
+      }
+
+      THEN("The same requests are sent to the lower level")
+      {
+        for (std::size_t i = 0; i < std::size(stream); ++i) {
+          REQUIRE(std::size(serial_to_lower.at(i)) == std::size(parallel_to_lower.at(i)));
+          for (std::size_t j = 0; j < std::size(serial_to_lower.at(i)); ++j) {
+            CHECK(serial_to_lower.at(i).at(j).address == parallel_to_lower.at(i).at(j).address);
+            CHECK(serial_to_lower.at(i).at(j).type == parallel_to_lower.at(i).at(j).type);
+          }
+        }
+      }
+
+      THEN("No statistics are kept") { REQUIRE(serial.sim_stats.hits.total() == 0); }
+    }
+  }
+}
@@ -0,0 +1,107 @@
+#include <catch.hpp>
+
+#include "convergence_monitor.h"
+
+namespace
+{
+// A snapshot of one CPU and one cache, with the given cumulative counts
+champsim::convergence_monitor::snapshot_type make_snapshot(long long instrs, long branch_misses, long hits, long misses)
+{
+  champsim::convergence_monitor::snapshot_type snapshot;
+
+  cpu_stats cpu;
+  cpu.end_instrs = instrs;
+  cpu.branch_type_misses.set(BRANCH_CONDITIONAL, branch_misses);
+  snapshot.cpus.push_back(cpu);
+
+  cache_stats cache;
+  cache.hits.set(std::pair{access_type::LOAD, uint32_t{0}}, hits);
+  cache.misses.set(std::pair{access_type::LOAD, uint32_t{0}}, misses);
+  snapshot.caches.push_back(cache);
+
+  snapshot.dram.emplace_back();
+  return snapshot;
+}
+} // namespace
+
+SCENARIO("The metrics of a window are taken from the difference between snapshots")
+{
+  GIVEN("Two snapshots")
+  {
+    auto begin = make_snapshot(1000, 5, 50, 50);
+    auto end = make_snapshot(3000, 25, 125, 75);
+
+    WHEN("The metrics of the window are found")
+    {
+      auto metrics = champsim::convergence_monitor::window_metrics(begin, end);
+
+      THEN("The branch MPKI, the miss rate, and the row buffer hit rate are found")
+      {
+        REQUIRE(std::size(metrics) == 3);
+        REQUIRE(metrics.at(0).value() == Approx(10.0));
+        REQUIRE(metrics.at(1).value() == Approx(0.25));
+      }
+
+      THEN("A DRAM channel with no accesses has no row buffer hit rate") { REQUIRE_FALSE(metrics.at(2).has_value()); }
+    }
+  }
+}
+
+SCENARIO("Metrics are stable if they change by no more than the tolerance")
+{
+  using metrics_type = champsim::convergence_monitor::metrics_type;
+
+  GIVEN("A rate that changes by less than the tolerance") { REQUIRE(champsim::convergence_monitor::is_stable(metrics_type{0.5}, metrics_type{0.51}, 0.02)); }
+
+  GIVEN("A rate that changes by more than the tolerance")
+  {
+    REQUIRE_FALSE(champsim::convergence_monitor::is_stable(metrics_type{0.5}, metrics_type{0.53}, 0.02));
+  }
+
+  GIVEN("A large MPKI that changes by a small fraction")
+  {
+    REQUIRE(champsim::convergence_monitor::is_stable(metrics_type{100.0}, metrics_type{101.5}, 0.02));
+  }
+
+  GIVEN("A metric that was not measured in one window")
+  {
+    REQUIRE(champsim::convergence_monitor::is_stable(metrics_type{std::nullopt}, metrics_type{0.9}, 0.02));
+  }
+}
+
+SCENARIO("A warmup converges after a number of stable windows")
+{
+  GIVEN("A monitor that requires two stable windows")
+  {
+    champsim::convergence_monitor uut{champsim::convergence_options{1000, 0.02, 2}, make_snapshot(0, 0, 0, 0)};
+
+    WHEN("The miss rate falls, then settles")
+    {
+      std::vector<bool> results;
+      results.push_back(uut.observe(make_snapshot(1000, 10, 0, 100)));
+      results.push_back(uut.observe(make_snapshot(2000, 20, 50, 150)));
+      results.push_back(uut.observe(make_snapshot(3000, 30, 100, 200)));
+      results.push_back(uut.observe(make_snapshot(4000, 40, 150, 250)));
+
+      THEN("It converges when the second stable window ends")
+      {
+        REQUIRE(results == std::vector<bool>{false, false, false, true});
+        REQUIRE(uut.converged());
+        REQUIRE(uut.windows() == 4);
+      }
+    }
+
+    WHEN("The miss rate changes again")
+    {
+      uut.observe(make_snapshot(1000, 10, 50, 50));
+      uut.observe(make_snapshot(2000, 20, 100, 100));
+      auto result = uut.observe(make_snapshot(3000, 30, 100, 200));
+
+      THEN("The count of stable windows restarts")
+      {
+        REQUIRE_FALSE(result);
+        REQUIRE_FALSE(uut.converged());
+      }
+    }
+  }
+}
@@ -0,0 +1,143 @@
+#include <catch.hpp>
+#include <map>
+
+#include "cache.h"
+#include "cache_dispatch.h"
+#include "defaults.hpp"
+#include "instr.h"
+#include "mocks.hpp"
+#include "modules.h"
+#include "ooo_cpu.h"
+#include "ooo_cpu_dispatch.h"
+
+namespace
+{
+std::map<CACHE*, int> static_prefetcher_operate_calls;
+std::map<CACHE*, int> static_prefetcher_fill_calls;
+std::map<CACHE*, int> static_replacement_fill_calls;
+std::map<O3_CPU*, int> static_predict_calls;
+std::map<O3_CPU*, int> static_last_result_calls;
+
+struct counting_prefetcher : champsim::modules::prefetcher {
+  using prefetcher::prefetcher;
+
+  uint32_t prefetcher_cache_operate(champsim::address, champsim::address, uint8_t, bool, access_type, uint32_t metadata_in)
+  {
+    ++::static_prefetcher_operate_calls[intern_];
+    return metadata_in;
+  }
+
+  uint32_t prefetcher_cache_fill(champsim::address, long, long, uint8_t, champsim::address, uint32_t metadata_in)
+  {
+    ++::static_prefetcher_fill_calls[intern_];
+    return metadata_in;
+  }
+};
+
+struct counting_replacement : champsim::modules::replacement {
+  using replacement::replacement;
+
+  long find_victim(uint32_t, uint64_t, long, const CACHE::BLOCK*, champsim::address, champsim::address, uint32_t) { return 0; }
+
+  void replacement_cache_fill(uint32_t, long, long, champsim::address, champsim::address, champsim::address, access_type)
+  {
+    ++::static_replacement_fill_calls[intern_];
+  }
+};
+
+struct counting_predictor : champsim::modules::branch_predictor {
+  using branch_predictor::branch_predictor;
+
+  bool predict_branch(champsim::address)
+  {
+    ++::static_predict_calls[intern_];
+    return true;
+  }
+
+  void last_branch_result(champsim::address, champsim::address, bool, uint8_t) { ++::static_last_result_calls[intern_]; }
+};
+} // namespace
+
+SCENARIO("A cache built with static dispatch calls its modules")
+{
+  GIVEN("A single cache that is compiled for its modules")
+  {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{champsim::modules::static_dispatch, champsim::cache_builder{champsim::defaults::default_l1d}
+                                                      .name("466-uut")
+                                                      .upper_levels({&mock_ul.queues})
+                                                      .lower_level(&mock_ll.queues)
+                                                      .prefetcher<::counting_prefetcher>()
+                                                      .replacement<::counting_replacement>()};
+
+    std::array<champsim::operable*, 3> elements{{&mock_ll, &mock_ul, &uut}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A packet is issued")
+    {
+      ::static_prefetcher_operate_calls.insert_or_assign(&uut, 0);
+      ::static_prefetcher_fill_calls.insert_or_assign(&uut, 0);
+      ::static_replacement_fill_calls.insert_or_assign(&uut, 0);
+
+      decltype(mock_ul)::request_type test;
+      test.address = champsim::address{0xdeadbeef};
+      test.cpu = 0;
+      auto test_result = mock_ul.issue(test);
+
+      THEN("The issue is received") { REQUIRE(test_result); }
+
+      // Run the uut for a bunch of cycles to fill the cache
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("The prefetcher operate hook is called") { REQUIRE(::static_prefetcher_operate_calls.at(&uut) == 1); }
+
+      THEN("The prefetcher fill hook is called") { REQUIRE(::static_prefetcher_fill_calls.at(&uut) == 1); }
+
+      THEN("The replacement fill hook is called") { REQUIRE(::static_replacement_fill_calls.at(&uut) == 1); }
+    }
+  }
+}
+
+SCENARIO("A core built with static dispatch calls its branch predictor")
+{
+  GIVEN("A core that is compiled for its branch predictor")
+  {
+    do_nothing_MRC mock_L1I, mock_L1D, mock_ll;
+    CACHE l1i{champsim::cache_builder{champsim::defaults::default_l1i}.name("466-l1i").lower_level(&mock_ll.queues)};
+    O3_CPU uut{champsim::modules::static_dispatch, champsim::core_builder{}
+                                                       .fetch_queues(&mock_L1I.queues)
+                                                       .data_queues(&mock_L1D.queues)
+                                                       .l1i(&l1i)
+                                                       .branch_predictor<::counting_predictor>()};
+    uut.initialize();
+    uut.warmup = false;
+
+    ::static_predict_calls.insert_or_assign(&uut, 0);
+    ::static_last_result_calls.insert_or_assign(&uut, 0);
+
+    auto branch = champsim::test::branch_instruction_with_ip(champsim::address{0x1000});
+    branch.instr_id = 1;
+    branch.branch_target = champsim::address{0x2000};
+    uut.threads.front().input_queue.push_back(branch);
+
+    WHEN("The branch is fetched")
+    {
+      for (int i = 0; i < 6; ++i) {
+        for (auto op : std::array<champsim::operable*, 3>{{&uut, &mock_L1I, &mock_L1D}})
+          op->_operate();
+      }
+
+      THEN("The branch predictor is called once for the branch") { REQUIRE(::static_predict_calls.at(&uut) == 1); }
+
+      THEN("The branch predictor learns the result of the branch") { REQUIRE(::static_last_result_calls.at(&uut) == 1); }
+    }
+  }
+}
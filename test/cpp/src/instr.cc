@@ -70,3 +70,19 @@ ooo_model_instr champsim::test::instruction_with_ip_and_source_memory(champsim::
   i.source_memory[0] = smem.to<uint64_t>();
   return ooo_model_instr{0, i};
 }
+
+ooo_model_instr champsim::test::instruction_with_ip_and_destination_memory(champsim::address ip, champsim::address dmem)
+{
+  input_instr i;
+  i.ip = ip.to<uint64_t>();
+  i.is_branch = false;
+  i.branch_taken = false;
+
+  std::fill(std::begin(i.destination_registers), std::end(i.destination_registers), 0);
+  std::fill(std::begin(i.source_registers), std::end(i.source_registers), 0);
+
+  std::fill(std::begin(i.destination_memory), std::end(i.destination_memory), 0);
+  std::fill(std::begin(i.source_memory), std::end(i.source_memory), 0);
+  i.destination_memory[0] = dmem.to<uint64_t>();
+  return ooo_model_instr{0, i};
+}
@@ -68,12 +68,44 @@ class CpuBuilderTest(unittest.TestCase):
     def test_sq_width(self):
         self.get_element_diff(['.sq_width(champsim::bandwidth::maximum_type{1})'], sq_width=1)
 
+    def test_store_buffer_size(self):
+        self.get_element_diff(['.store_buffer_size(8)'], store_buffer_size=8)
+
+    def test_store_buffer_width(self):
+        self.get_element_diff(['.store_buffer_width(champsim::bandwidth::maximum_type{1})'], store_buffer_width=1)
+
+    def test_wrong_path_depth(self):
+        self.get_element_diff(['.wrong_path_depth(8)'], wrong_path_depth=8)
+
+    def test_wrong_path_loads(self):
+        self.get_element_diff(['.set_wrong_path_loads()'], wrong_path_loads=True)
+        self.get_element_diff(['.reset_wrong_path_loads()'], wrong_path_loads=False)
+
+    def test_ftq_size(self):
+        self.get_element_diff(['.ftq_size(32)'], ftq_size=32)
+
+    def test_threads(self):
+        self.get_element_diff(['.threads(2)'], threads=2)
+
+    def test_fetch_policy(self):
+        self.get_element_diff(['.fetch_policy(champsim::thread_fetch_policy::round_robin)'], fetch_policy='round_robin')
+
+    def test_partitioned_queues(self):
+        self.get_element_diff(['.set_partitioned_queues()'], partitioned_queues=True)
+        self.get_element_diff(['.reset_partitioned_queues()'], partitioned_queues=False)
+
     def test_retire_width(self):
         self.get_element_diff(['.retire_width(champsim::bandwidth::maximum_type{1})'], retire_width=1)
 
     def test_mispredict_penalty(self):
         self.get_element_diff(['.mispredict_penalty(1)'], mispredict_penalty=1)
 
+    def test_violation_penalty(self):
+        self.get_element_diff(['.violation_penalty(1)'], violation_penalty=1)
+
+    def test_replay_penalty(self):
+        self.get_element_diff(['.replay_penalty(1)'], replay_penalty=1)
+
     def test_decode_latency(self):
         self.get_element_diff(['.decode_latency(1)'], decode_latency=1)
 
@@ -112,6 +144,28 @@ class CpuBuilderTest(unittest.TestCase):
         self.get_element_diff(['.btb<class a_class>()'], _btb_data=[{ 'name': 'a', 'class': 'a_class' }])
         self.get_element_diff(['.btb<class a_class, class b_class>()'], _btb_data=[{ 'name': 'a', 'class': 'a_class' }, { 'name': 'b', 'class': 'b_class' }])
 
+    def test_memory_dependence_predictor(self):
+        self.get_element_diff(['.memory_dependence_predictor<class a_class>()'], _memory_dependence_predictor_data=[{ 'name': 'a', 'class': 'a_class' }])
+
+    def test_value_predictor(self):
+        self.get_element_diff(['.value_predictor<class a_class>()'], _value_predictor_data=[{ 'name': 'a', 'class': 'a_class' }])
+
+    def test_execution_ports(self):
+        self.get_element_diff(['.add_execution_port({OP_ALU, OP_BRANCH})', '.add_execution_port({OP_LOAD})'], execution_ports=[['ALU', 'BRANCH'], ['LOAD']])
+
+    def test_functional_units(self):
+        self.get_element_diff(['.op_latency(OP_SLOW_ALU, 3)', '.unpipelined_op(OP_SLOW_ALU)'], functional_units={ 'SLOW_ALU': { 'latency': 3, 'pipelined': False } })
+        self.get_element_diff(['.op_latency(OP_FP, 4)'], functional_units={ 'FP': { 'latency': 4, 'pipelined': True } })
+
+    def test_l1i_and_l1d_are_found_in_the_built_caches(self):
+        # The caches are held in the reverse of the order they are listed
+        cpu = { 'name': 'test_cpu', 'L1I': 'test_l1i', 'L1D': 'test_l1d' }
+        caches = [{ 'name': 'test_l1i' }, { 'name': 'test_l1d' }, { 'name': 'test_l2c' }]
+        ul_pairs = [('test_l1i', 'test_cpu'), ('test_l1d', 'test_cpu')]
+        lines = [l.strip() for l in config.instantiation_file.get_cpu_builder(cpu, caches, ul_pairs)]
+        self.assertIn('.l1i(&(*std::next(std::begin(caches), 2)))', lines)
+        self.assertIn('.l1d_bandwidth((*std::next(std::begin(caches), 1)).MAX_TAG)', lines)
+
 class CacheBuilderTests(unittest.TestCase):
 
     def get_element_diff(self, added_lines, **kwargs):
@@ -139,6 +193,12 @@ class CacheBuilderTests(unittest.TestCase):
     def test_log2_ways(self):
         self.get_element_diff(['.log2_ways(1)'], log2_ways=1)
 
+    def test_sampled_sets(self):
+        self.get_element_diff(['.sampled_sets(1)'], sampled_sets=1)
+
+    def test_sectors(self):
+        self.get_element_diff(['.sectors(4)'], sectors=4)
+
     def test_pq_size(self):
         self.get_element_diff(['.pq_size(1)'], pq_size=1)
 
@@ -160,6 +220,22 @@ class CacheBuilderTests(unittest.TestCase):
     def test_max_fill(self):
         self.get_element_diff(['.fill_bandwidth(champsim::bandwidth::maximum_type{1})'], max_fill=1)
 
+    def test_banks(self):
+        self.get_element_diff(['.banks(4)'], banks=4)
+
+    def test_max_bank_tag_check(self):
+        self.get_element_diff(['.bank_bandwidth(champsim::bandwidth::maximum_type{1})'], max_bank_tag_check=1)
+
+    def test_bank_busy(self):
+        self.get_element_diff(['.bank_busy(2)'], bank_busy=2)
+
+    def test_bank_hash(self):
+        self.get_element_diff(['.bank_hash(champsim::cache_bank_hash::xor_fold)'], bank_hash='xor_fold')
+
+    def test_inclusion(self):
+        self.get_element_diff(['.inclusion(champsim::cache_inclusion::inclusive)'], inclusion='inclusive')
+        self.get_element_diff(['.inclusion(champsim::cache_inclusion::exclusive)'], inclusion='exclusive')
+
     def test_prefetch_as_load(self):
         self.get_element_diff(['.set_prefetch_as_load()'], prefetch_as_load=True)
         self.get_element_diff(['.reset_prefetch_as_load()'], prefetch_as_load=False)
@@ -172,6 +248,29 @@ class CacheBuilderTests(unittest.TestCase):
         self.get_element_diff(['.set_virtual_prefetch()'], virtual_prefetch=True)
         self.get_element_diff(['.reset_virtual_prefetch()'], virtual_prefetch=False)
 
+    def test_directory(self):
+        self.get_element_diff(['.set_coherence_directory()'], directory=True)
+        self.get_element_diff(['.reset_coherence_directory()'], directory=False)
+
+    def test_clean_writebacks(self):
+        self.get_element_diff(['.set_clean_writebacks()'], _clean_writebacks=True)
+
+    def test_eviction_notices(self):
+        self.get_element_diff(['.set_eviction_notices()'], _eviction_notices=True)
+
+    def test_way_partitioning(self):
+        self.get_element_diff(['.set_way_partitioning()'], way_partitioning=True)
+        self.get_element_diff(['.reset_way_partitioning()'], way_partitioning=False)
+
+    def test_partition_interval(self):
+        self.get_element_diff(['.partition_interval(1000)'], partition_interval=1000)
+
+    def test_umon_sets(self):
+        self.get_element_diff(['.umon_sets(16)'], umon_sets=16)
+
+    def test_victim_buffer(self):
+        self.get_element_diff(['.victim_buffer(8)'], victim_buffer=8)
+
     def test_prefetch_activate(self):
         self.get_element_diff(['.prefetch_activate(access_type::LOAD)'], prefetch_activate=['LOAD'])
         self.get_element_diff(['.prefetch_activate(access_type::LOAD, access_type::WRITE)'], prefetch_activate=['LOAD', 'WRITE'])
@@ -304,3 +403,56 @@ class GetQueueInfoTests(unittest.TestCase):
             { 'is_good_boy': False }
         ]
         self.assertEqual(expected, evaluated)
+
+class ExpandSlicesTests(unittest.TestCase):
+    def test_unsliced_caches_are_unchanged(self):
+        caches = [{'name': 'test_llc', 'lower_level': 'DRAM', 'sets': 2048}]
+        evaluated_caches, evaluated_routers = config.instantiation_file.expand_slices(caches)
+        self.assertEqual(caches, evaluated_caches)
+        self.assertEqual([], evaluated_routers)
+
+    def test_slices_divide_the_sets(self):
+        caches = [{'name': 'test_llc', 'lower_level': 'DRAM', 'sets': 2048, 'ways': 16, 'slices': 4}]
+        evaluated_caches, _ = config.instantiation_file.expand_slices(caches)
+        self.assertEqual(['test_llc_slice0', 'test_llc_slice1', 'test_llc_slice2', 'test_llc_slice3'], [c['name'] for c in evaluated_caches])
+        for cache in evaluated_caches:
+            self.assertEqual(512, cache['sets'])
+            self.assertEqual(16, cache['ways'])
+            self.assertEqual('DRAM', cache['lower_level'])
+            self.assertNotIn('slices', cache)
+
+    def test_slices_divide_log2_sizes(self):
+        caches = [{'name': 'test_llc', 'log2_size': 20, 'slices': 4}]
+        evaluated_caches, _ = config.instantiation_file.expand_slices(caches)
+        self.assertEqual(2**18, evaluated_caches[0]['size'])
+        self.assertNotIn('log2_size', evaluated_caches[0])
+
+    def test_routers_have_defaults(self):
+        caches = [{'name': 'test_llc', 'slices': 2}]
+        _, evaluated_routers = config.instantiation_file.expand_slices(caches)
+        self.assertEqual([{'name': 'test_llc', 'slices': 2, 'slice_hash': 'xor_fold', 'slice_latency': 0}], evaluated_routers)
+
+    def test_each_upper_level_has_a_channel_to_each_slice(self):
+        routers = [{'name': 'test_llc', 'slices': 2}]
+        ul_pairs = [('test_llc', 'test_l2a'), ('test_llc', 'test_l2b'), ('DRAM', 'test_llc_slice0')]
+        expected = [
+            ('test_llc_slice0', 'test_l2a'), ('test_llc_slice1', 'test_l2a'),
+            ('test_llc_slice0', 'test_l2b'), ('test_llc_slice1', 'test_l2b')
+        ]
+        self.assertEqual(expected, config.instantiation_file.get_slice_pairs(routers, ul_pairs))
+
+    def test_router_connects_upper_levels_to_slices(self):
+        router = {'name': 'test_llc', 'slices': 2, 'slice_hash': 'xor_fold', 'slice_latency': 3, '_offset_bits': 6, 'frequency': 4000}
+        ul_pairs = [('test_llc', 'test_l2a'), ('test_llc_slice0', 'test_l2a'), ('test_llc_slice1', 'test_l2a')]
+        evaluated = config.instantiation_file.get_slice_router(router, ul_pairs, 250)
+        expected = 'champsim::slice_router{"test_llc", champsim::chrono::picoseconds{250}, {&channels.at(0)}, {std::vector<champsim::channel*>{&channels.at(1), &channels.at(2)}}, 3, champsim::slice_hash::xor_fold, champsim::data::bits{6}}'
+        self.assertEqual(expected, evaluated)
+
+class BuilderFunctionCallTests(unittest.TestCase):
+    def test_builders_are_passed_in_order(self):
+        evaluated = list(config.instantiation_file.get_builder_function_call('CACHE', [['a'], ['b']]))
+        self.assertEqual(['build<CACHE>(', '  a,', '  b', ')'], evaluated)
+
+    def test_static_dispatch_tag_is_the_first_parameter(self):
+        evaluated = list(config.instantiation_file.get_builder_function_call('CACHE', [['a'], ['b']], static_dispatch=True))
+        self.assertEqual(['build<CACHE>(', '  champsim::modules::static_dispatch,', '  a,', '  b', ')'], evaluated)
@@ -192,16 +192,28 @@ class ParseNormalizedTests(unittest.TestCase):
 
         for key in ('L1I', 'L1D', 'ITLB', 'DTLB'):
             with self.subTest(cache=key):
-                result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
+                result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
                 cache_name = result[0]['cores'][0][key]
                 caches = result[0]['caches']
 
                 self.assertIn(cache_name, [c['name'] for c in caches])
 
+    def test_multithreaded_core_may_not_fetch_down_the_wrong_path(self):
+        for key in ('wrong_path_depth', 'ftq_size'):
+            with self.subTest(key=key):
+                with self.assertRaises(ValueError):
+                    config.parse.NormalizedConfiguration({ 'ooo_cpu': [{ 'name': 'test_cpu', 'threads': 2, key: 4 }] })
+
+    def test_single_threaded_core_may_fetch_down_the_wrong_path(self):
+        for key in ('wrong_path_depth', 'ftq_size'):
+            with self.subTest(key=key):
+                test_config = config.parse.NormalizedConfiguration({ 'ooo_cpu': [{ 'name': 'test_cpu', 'threads': 1, key: 4 }] })
+                self.assertEqual(test_config.cores[0][key], 4)
+
     def test_generates_default_ptws(self):
         test_config = config.parse.NormalizedConfiguration({ 'ooo_cpu': [{ 'name': 'test_cpu' }] })
 
-        result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
+        result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
         ptw_name = result[0]['cores'][0]['PTW']
         ptws = result[0]['ptws']
 
@@ -212,7 +224,7 @@ class ParseNormalizedTests(unittest.TestCase):
             with self.subTest(num_cores=num_cores):
                 test_config = config.parse.NormalizedConfiguration({ 'ooo_cpu': [{ 'name': 'test_cpu'+str(i) } for i in range(num_cores)] })
 
-                result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
+                result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
                 cache_names = [core['L1I'] for core in result[0]['cores']]
                 caches = result[0]['caches']
 
@@ -225,7 +237,7 @@ class ParseNormalizedTests(unittest.TestCase):
             with self.subTest(num_cores=num_cores):
                 test_config = config.parse.NormalizedConfiguration({ 'ooo_cpu': [{ 'name': 'test_cpu'+str(i) } for i in range(num_cores)] })
 
-                result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
+                result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
                 cache_names = [core['L1I'] for core in result[0]['cores']] + [core['L1D'] for core in result[0]['cores']]
                 caches = result[0]['caches']
 
@@ -239,7 +251,7 @@ class ParseNormalizedTests(unittest.TestCase):
             with self.subTest(ptw=name, num_cores=num_cores):
                 test_config = config.parse.NormalizedConfiguration({ 'ooo_cpu': [{ 'name': 'test_cpu'+str(i) } for i in range(num_cores)] })
 
-                result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
+                result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
                 cache_names = [c['name'] for c in result[0]['caches']]
                 ll_names = [c.get('lower_level') for c in result[0]['caches']]
 
@@ -257,7 +269,7 @@ class ParseNormalizedTests(unittest.TestCase):
             with self.subTest(ptw=name, num_cores=num_cores):
                 test_config = config.parse.NormalizedConfiguration({ 'ooo_cpu': [{ 'name': 'test_cpu'+str(i) } for i in range(num_cores)] })
 
-                result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
+                result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
                 cache_names = [c['name'] for c in result[0]['caches']]
                 ptw_names = [c['name'] for c in result[0]['ptws']]
                 ll_names = [c.get('lower_level') for c in result[0]['caches']]
@@ -276,7 +288,7 @@ class ParseNormalizedTests(unittest.TestCase):
             with self.subTest(num_cores=num_cores):
                 test_config = config.parse.NormalizedConfiguration({ 'ooo_cpu': [{ 'name': 'test_cpu'+str(i) } for i in range(num_cores)] })
 
-                result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
+                result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
                 cache_names = [core['ITLB'] for core in result[0]['cores']] + [core['DTLB'] for core in result[0]['cores']]
                 caches = result[0]['caches']
 
@@ -290,7 +302,7 @@ class ParseNormalizedTests(unittest.TestCase):
             with self.subTest(num_cores=num_cores):
                 test_config = config.parse.NormalizedConfiguration({ 'ooo_cpu': [{ 'name': 'test_cpu'+str(i), 'frequency': random.randrange(20162016) } for i in range(num_cores)] })
 
-                result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
+                result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
                 for name in ('L1I', 'L1D', 'ITLB', 'DTLB'):
                     cache_names_and_frequencies = [(core[name], core['frequency']) for core in result[0]['cores']]
                     caches = result[0]['caches']
@@ -300,11 +312,11 @@ class ParseNormalizedTests(unittest.TestCase):
                         self.assertEqual(frequency, cache_freq)
 
     def test_cores_have_branch_predictors_and_btbs(self):
-        for num_cores, module_key in itertools.product((1,2,4,8), ('_branch_predictor_data', '_btb_data')):
+        for num_cores, module_key in itertools.product((1,2,4,8), ('_branch_predictor_data', '_btb_data', '_memory_dependence_predictor_data', '_value_predictor_data')):
             with self.subTest(num_cores=num_cores, module_key=module_key):
                 test_config = config.parse.NormalizedConfiguration({ 'ooo_cpu': [{ 'name': 'test_cpu'+str(i) } for i in range(num_cores)] })
 
-                result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
+                result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
                 cores = result[0]['cores']
 
                 module_names = [c.get(module_key) for c in cores]
@@ -315,12 +327,54 @@ class ParseNormalizedTests(unittest.TestCase):
             with self.subTest(num_cores=num_cores, module_key=module_key):
                 test_config = config.parse.NormalizedConfiguration({ 'ooo_cpu': [{ 'name': 'test_cpu'+str(i) } for i in range(num_cores)] })
 
-                result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
+                result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
                 caches = result[0]['caches']
 
                 module_names = [c.get(module_key) for c in caches]
                 self.assertNotIn(None, module_names)
 
+    def test_upper_levels_of_exclusive_caches_write_back_clean_victims(self):
+        for num_cores in (1,2,4,8):
+            with self.subTest(num_cores=num_cores):
+                test_config = config.parse.NormalizedConfiguration({
+                    'num_cores': num_cores,
+                    'ooo_cpu': [{ 'name': 'test_cpu'+str(i) } for i in range(num_cores)],
+                    'LLC': { 'inclusion': 'exclusive' }
+                })
+
+                result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
+                caches = result[0]['caches']
+
+                clean_writebacks = {c['name'] for c in caches if c.get('_clean_writebacks', False)}
+                self.assertEqual(clean_writebacks, {c['name'] for c in caches if c.get('lower_level') == 'LLC'})
+                self.assertEqual(len(clean_writebacks), num_cores)
+
+    def test_caches_above_a_directory_send_eviction_notices_if_they_are_last_in_the_core(self):
+        for inclusion, notified in (('non_inclusive', False), ('inclusive', True), ('exclusive', True)):
+            with self.subTest(inclusion=inclusion):
+                test_config = config.parse.NormalizedConfiguration({
+                    'L2C': { 'inclusion': inclusion },
+                    'LLC': { 'directory': True }
+                })
+
+                result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
+                caches = result[0]['caches']
+
+                expected = {c['name'] for c in caches if c.get('lower_level') == 'LLC'} if notified else set()
+                self.assertEqual({c['name'] for c in caches if c.get('_eviction_notices', False)}, expected)
+
+    def test_first_level_caches_above_a_directory_send_eviction_notices(self):
+        test_config = config.parse.NormalizedConfiguration({
+            'L1D': { 'lower_level': 'LLC' },
+            'LLC': { 'directory': True }
+        })
+
+        result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
+        caches = result[0]['caches']
+
+        l1d = next(c for c in caches if c['name'].endswith('L1D'))
+        self.assertTrue(l1d.get('_eviction_notices', False))
+
 class NormalizeConfigTest(unittest.TestCase):
 
     def test_empty_config_creates_defaults(self):
@@ -417,7 +471,7 @@ class NormalizeConfigTest(unittest.TestCase):
         self.assertEqual(result.vmem.get('__test__'), True)
 
     def test_core_params_are_moved_to_core_array(self):
-        core_keys_to_copy = ('frequency', 'ifetch_buffer_size', 'decode_buffer_size', 'dispatch_buffer_size', 'register_file_size', 'rob_size', 'lq_size', 'sq_size', 'fetch_width', 'decode_width', 'dispatch_width', 'execute_width', 'lq_width', 'sq_width', 'retire_width', 'mispredict_penalty', 'scheduler_size', 'decode_latency', 'dispatch_latency', 'schedule_latency', 'execute_latency', 'branch_predictor', 'btb', 'DIB')
+        core_keys_to_copy = ('frequency', 'ifetch_buffer_size', 'decode_buffer_size', 'dispatch_buffer_size', 'register_file_size', 'rob_size', 'lq_size', 'sq_size', 'fetch_width', 'decode_width', 'dispatch_width', 'execute_width', 'lq_width', 'sq_width', 'store_buffer_size', 'store_buffer_width', 'wrong_path_depth', 'wrong_path_loads', 'ftq_size', 'threads', 'fetch_policy', 'partitioned_queues', 'retire_width', 'mispredict_penalty', 'scheduler_size', 'decode_latency', 'dispatch_latency', 'schedule_latency', 'execute_latency', 'branch_predictor', 'btb', 'memory_dependence_predictor', 'violation_penalty', 'value_predictor', 'replay_penalty', 'DIB', 'execution_ports', 'functional_units')
         for k in core_keys_to_copy:
             with self.subTest(key=k):
                 result = config.parse.NormalizedConfiguration({ k: '__test__' })
@@ -680,7 +734,7 @@ class ConfigRootPassthroughParseTests(unittest.TestCase):
         test_config = config.parse.NormalizedConfiguration({
             'block_size': 27
         })
-        result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
+        result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
         self.assertIn('block_size', result[2])
         self.assertEqual(test_config.root.get('block_size'), result[2].get('block_size'))
 
@@ -688,7 +742,7 @@ class ConfigRootPassthroughParseTests(unittest.TestCase):
         test_config = config.parse.NormalizedConfiguration({
             'page_size': 27
         })
-        result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
+        result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
         self.assertIn('page_size', result[2])
         self.assertEqual(test_config.root.get('page_size'), result[2].get('page_size'))
 
@@ -696,10 +750,18 @@ class ConfigRootPassthroughParseTests(unittest.TestCase):
         test_config = config.parse.NormalizedConfiguration({
             'heartbeat_frequency': 27
         })
-        result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
+        result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
         self.assertIn('heartbeat_frequency', result[2])
         self.assertEqual(test_config.root.get('heartbeat_frequency'), result[2].get('heartbeat_frequency'))
 
+    def test_static_module_dispatch_passes_through(self):
+        test_config = config.parse.NormalizedConfiguration({
+            'static_module_dispatch': True
+        })
+        result = test_config.apply_defaults_in(PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext())
+        self.assertIn('static_module_dispatch', result[2])
+        self.assertEqual(test_config.root.get('static_module_dispatch'), result[2].get('static_module_dispatch'))
+
 class FoundMoreContext:
     def find(self, module):
         return {'name': module, 'fname': 'xxyzzy/'+module}
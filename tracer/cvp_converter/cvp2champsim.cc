@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <cstddef>
 #include <cstdint>
 #include <map>
 #include <stdio.h>
@@ -39,9 +40,13 @@
 #endif
 
 bool verbose = false;
+bool load_values = false;
 
-// use non-cloudsuite ChampSim trace format
-using trace_instr_format = input_instr;
+// use non-cloudsuite ChampSim trace format, optionally followed by the value of each load
+using trace_instr_format = value_instr;
+static_assert(offsetof(value_instr, load_value) == sizeof(input_instr));
+
+void write_instr(const trace_instr_format& ct) { fwrite(&ct, load_values ? sizeof(value_instr) : sizeof(input_instr), 1, stdout); }
 
 // orginal instruction types from CVP-1 traces
 
@@ -364,6 +369,8 @@ int main(int argc, char** argv)
   for (int i = 1; i < argc; i++) {
     if (!strcmp(argv[i], "-v"))
       verbose = true;
+    else if (!strcmp(argv[i], "-l"))
+      load_values = true;
     else
       strcpy(tracefilename, argv[i]);
   }
@@ -413,6 +420,8 @@ int main(int argc, char** argv)
     trace_instr_format ct;
     ct.ip = t.PC;
     ct.is_branch = false;
+    ct.load_value = 0;
+    ct.instr_class = champsim::INSTR_CLASS_ALU;
     // we are going to figure out the op type
 
     OpType c = OPTYPE_OP;
@@ -518,7 +527,7 @@ int main(int argc, char** argv)
       default:
         assert(0);
       }
-      fwrite(&ct, sizeof(ct), 1, stdout); // write a branch trace
+      write_instr(ct); // write a branch trace
     } else {
       memset(ct.destination_registers, 0, sizeof(ct.destination_registers));
       memset(ct.source_registers, 0, sizeof(ct.source_registers));
@@ -558,13 +567,18 @@ int main(int argc, char** argv)
         switch (t.type) {
         case loadInstClass:
           ct.source_memory[0] = transform(t.EA);
+          ct.load_value = t.output_reg_values[0][0];
           break;
         case storeInstClass:
           ct.destination_memory[0] = transform(t.EA);
           break;
         case aluInstClass:
+          break;
         case fpInstClass:
+          ct.instr_class = champsim::INSTR_CLASS_FP;
+          break;
         case slowAluInstClass:
+          ct.instr_class = champsim::INSTR_CLASS_SLOW_ALU;
           break;
         case uncondDirectBranchInstClass:
         case condBranchInstClass:
@@ -572,7 +586,7 @@ int main(int argc, char** argv)
         case undefInstClass:
           assert(0);
         }
-        fwrite(&ct, sizeof(ct), 1, stdout); // write a non-branch trace
+        write_instr(ct); // write a non-branch trace
       }
     }
 
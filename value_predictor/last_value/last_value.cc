@@ -0,0 +1,40 @@
+#include "last_value.h"
+
+std::size_t last_value::table_index(champsim::address ip)
+{
+  constexpr champsim::data::bits LOG2_TABLE_SIZE{champsim::lg2(TABLE_SIZE)};
+
+  auto hash = ip.slice<LOG2_TABLE_SIZE, champsim::data::bits{}>().to<std::size_t>();
+  hash ^= ip.slice<2 * LOG2_TABLE_SIZE, LOG2_TABLE_SIZE>().to<std::size_t>();
+  return hash % TABLE_SIZE;
+}
+
+std::optional<uint64_t> last_value::predict_load(champsim::address ip)
+{
+  const auto& entry = table.at(table_index(ip));
+  if (entry.ip != ip || !entry.confidence.is_max()) {
+    return std::nullopt;
+  }
+  return entry.outcome;
+}
+
+void last_value::last_load_result(champsim::address ip, champsim::address, std::optional<uint64_t> value)
+{
+  // The address of a load does not predict its value
+  if (!value.has_value()) {
+    return;
+  }
+
+  auto& entry = table.at(table_index(ip));
+  const auto outcome = value.value();
+
+  if (entry.ip != ip) {
+    // Another load held this entry, and is replaced
+    entry = table_entry{ip, outcome, {}};
+  } else if (entry.outcome == outcome) {
+    ++entry.confidence;
+  } else {
+    entry.outcome = outcome;
+    entry.confidence = 0;
+  }
+}
@@ -0,0 +1,36 @@
+#ifndef VALUE_PREDICTOR_LAST_VALUE_H
+#define VALUE_PREDICTOR_LAST_VALUE_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#include "address.h"
+#include "modules.h"
+#include "msl/fwcounter.h"
+
+/*
+ * Last value prediction, after Lipasti, Wilkerson, and Shen (ASPLOS 1996).
+ * A load is predicted to read the same value as its last instance, once that value has repeated often enough to be trusted.
+ * Loads whose values the trace does not record are not learned.
+ */
+struct last_value : champsim::modules::value_predictor {
+  static constexpr std::size_t TABLE_SIZE = 4096;   // Load value table, indexed by instruction address
+  static constexpr std::size_t CONFIDENCE_BITS = 3; // A prediction is made only when the counter is saturated
+
+  struct table_entry {
+    champsim::address ip{};
+    uint64_t outcome = 0;
+    champsim::msl::fwcounter<CONFIDENCE_BITS> confidence{};
+  };
+
+  std::array<table_entry, TABLE_SIZE> table{};
+
+  using value_predictor::value_predictor;
+
+  static std::size_t table_index(champsim::address ip);
+  std::optional<uint64_t> predict_load(champsim::address ip);
+  void last_load_result(champsim::address ip, champsim::address address, std::optional<uint64_t> value);
+};
+
+#endif
@@ -0,0 +1,39 @@
+#include "stride_address.h"
+
+std::size_t stride_address::table_index(champsim::address ip)
+{
+  constexpr champsim::data::bits LOG2_TABLE_SIZE{champsim::lg2(TABLE_SIZE)};
+
+  auto hash = ip.slice<LOG2_TABLE_SIZE, champsim::data::bits{}>().to<std::size_t>();
+  hash ^= ip.slice<2 * LOG2_TABLE_SIZE, LOG2_TABLE_SIZE>().to<std::size_t>();
+  return hash % TABLE_SIZE;
+}
+
+std::optional<champsim::address> stride_address::predict_load_address(champsim::address ip)
+{
+  const auto& entry = table.at(table_index(ip));
+  if (entry.ip != ip || !entry.confidence.is_max()) {
+    return std::nullopt;
+  }
+  return entry.last_address + entry.stride;
+}
+
+void stride_address::last_load_result(champsim::address ip, champsim::address address, std::optional<uint64_t>)
+{
+  auto& entry = table.at(table_index(ip));
+
+  if (entry.ip != ip) {
+    // Another load held this entry, and is replaced
+    entry = table_entry{ip, address, 0, {}};
+    return;
+  }
+
+  const auto stride = champsim::offset(entry.last_address, address);
+  if (stride == entry.stride) {
+    ++entry.confidence;
+  } else {
+    entry.stride = stride;
+    entry.confidence = 0;
+  }
+  entry.last_address = address;
+}
@@ -0,0 +1,37 @@
+#ifndef VALUE_PREDICTOR_STRIDE_ADDRESS_H
+#define VALUE_PREDICTOR_STRIDE_ADDRESS_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#include "address.h"
+#include "modules.h"
+#include "msl/fwcounter.h"
+
+/*
+ * Stride load-address prediction, after Eickemeyer and Vassiliadis (IBM J. Res. Dev. 1993).
+ * A load is predicted to read the address of its last instance plus the stride between its last two instances, once that stride has repeated often
+ * enough to be trusted. A load that always reads the same address has a stride of zero.
+ */
+struct stride_address : champsim::modules::value_predictor {
+  static constexpr std::size_t TABLE_SIZE = 1024;   // Load address table, indexed by instruction address
+  static constexpr std::size_t CONFIDENCE_BITS = 2; // A prediction is made only when the counter is saturated
+
+  struct table_entry {
+    champsim::address ip{};
+    champsim::address last_address{};
+    champsim::address::difference_type stride = 0;
+    champsim::msl::fwcounter<CONFIDENCE_BITS> confidence{};
+  };
+
+  std::array<table_entry, TABLE_SIZE> table{};
+
+  using value_predictor::value_predictor;
+
+  static std::size_t table_index(champsim::address ip);
+  std::optional<champsim::address> predict_load_address(champsim::address ip);
+  void last_load_result(champsim::address ip, champsim::address address, std::optional<uint64_t> value);
+};
+
+#endif